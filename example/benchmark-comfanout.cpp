@@ -0,0 +1,215 @@
+//============================================================================
+// Name        : benchmark-comfanout.cpp
+// Author      : Juan Manuel Fernndez Muoz
+// Date        : October, 2026
+// Description : Benchmark of a ComFanout delivering a stream to 1, 10, 100
+//               and 1000 loopback TCP subscribers, and to subscribers with
+//               a stalled one that drops the data
+//============================================================================
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/thread.hpp>
+
+#include "cominterface/comfanout.hpp"
+#include "cominterface/comsocket.hpp"
+
+// TCP port of the benchmark
+static const unsigned int port = 3448;
+
+// Bytes of each published buffer
+static const size_t buffer_size = 4096;
+
+// Bytes delivered in each measure, adding all the subscribers
+static const unsigned long long delivered_size = 400ULL * 1024 * 1024;
+
+// Queue limit of each subscriber
+static const size_t max_queued = 256 * 1024;
+
+// Open a listening socket on the loopback interface
+static int listen_loopback()
+{
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    struct sockaddr_in address = sockaddr_in();
+
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    if (::bind(fd, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) != 0 ||
+        ::listen(fd, 1024) != 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+// Read the data of the peers of the subscribers until the measure stops
+static void drain(const std::vector<int> *peers, boost::atomic<unsigned long long> *received,
+                  boost::atomic<bool> *stop)
+{
+    std::vector<struct pollfd> fds(peers->size());
+    std::vector<char> buffer(65536);
+
+    for (size_t i = 0; i < peers->size(); ++i)
+    {
+        fds[i].fd = (*peers)[i];
+        fds[i].events = POLLIN;
+    }
+
+    while (!stop->load())
+    {
+        if (::poll(&fds[0], fds.size(), 10) <= 0)
+            continue;
+
+        for (size_t i = 0; i < fds.size(); ++i)
+        {
+            if (!(fds[i].revents & POLLIN))
+                continue;
+
+            ssize_t len = ::read(fds[i].fd, &buffer[0], buffer.size());
+
+            if (len > 0)
+                received->fetch_add(len);
+        }
+    }
+}
+
+// Publish the data to the subscribers and print the delivery speed. The
+// first subscriber is stalled, if requested: its peer never reads
+static void measure(int listener, size_t subscribers, bool stalled)
+{
+    std::vector<ComSocket *> sinks;
+    std::vector<int> peers;
+    std::vector<int> drained;
+    ComFanout fanout;
+    ComBufferPool pool;
+    boost::atomic<unsigned long long> received(0);
+    boost::atomic<bool> stop(false);
+    bool ok = true;
+
+    for (size_t i = 0; i < subscribers && ok; ++i)
+    {
+        ComSocket *sink = new ComSocket("127.0.0.1", port, 5000);
+
+        sinks.push_back(sink);
+        ok = sink->Open();
+
+        int peer = ok ? ::accept(listener, NULL, NULL) : -1;
+
+        peers.push_back(peer);
+        ok = ok && peer >= 0 &&
+             fanout.Subscribe(sink, max_queued, stalled && i == 0 ? ComFanout::policy_drop
+                                                                  : ComFanout::policy_block);
+
+        if (!(stalled && i == 0))
+            drained.push_back(peer);
+    }
+
+    if (ok && fanout.Start())
+    {
+        size_t readers = drained.size();
+        unsigned long long published = 0;
+        boost::thread reader(boost::bind(drain, &drained, &received, &stop));
+        boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+
+        while (published * readers < delivered_size)
+        {
+            ComBuffer buffer = pool.Allocate(buffer_size);
+
+            buffer.SetSize(buffer_size);
+            fanout.Publish(buffer);
+            published += buffer_size;
+        }
+
+        // Wait until the data arrives to all the readers
+        while (received.load() < published * readers)
+            boost::this_thread::sleep_for(boost::chrono::microseconds(100));
+
+        boost::chrono::duration<double> elapsed = boost::chrono::steady_clock::now() - start;
+
+        stop = true;
+        reader.join();
+        fanout.Stop();
+
+        std::cout << subscribers << " subscribers" << (stalled ? ", the first one stalled" : "")
+                  << ": " << received.load() / elapsed.count() / 1e6 << " MB/s aggregate, "
+                  << published / elapsed.count() / 1e6 << " MB/s published";
+
+        if (stalled)
+        {
+            ComFanoutStats stats;
+
+            fanout.GetStats(sinks[0], stats);
+
+            std::cout << ", stalled: " << stats.queued_bytes << " bytes queued, "
+                      << stats.dropped_buffers << " buffers dropped";
+        }
+
+        std::cout << std::endl;
+    }
+    else
+    {
+        std::cout << subscribers << " subscribers: the connections could not be opened" << std::endl;
+    }
+
+    for (size_t i = 0; i < sinks.size(); ++i)
+    {
+        fanout.Unsubscribe(sinks[i]);
+        delete sinks[i];
+
+        if (peers[i] >= 0)
+            ::close(peers[i]);
+    }
+}
+
+int main()
+{
+    const size_t counts[] = {1, 10, 100, 1000};
+
+    // Each subscriber needs a socket, its peer and the descriptors of its reactor
+    struct rlimit limit;
+
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < 8192)
+    {
+        limit.rlim_cur = std::min<rlim_t>(8192, limit.rlim_max);
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    int listener = listen_loopback();
+
+    if (listener < 0)
+    {
+        std::cout << "The TCP port could not be listened" << std::endl;
+        return 1;
+    }
+
+    std::cout << delivered_size / (1024 * 1024) << " MiB delivered in buffers of "
+              << buffer_size << " bytes, " << max_queued << " bytes of queue limit" << std::endl;
+
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i)
+        measure(listener, counts[i], false);
+
+    measure(listener, 10, true);
+
+    ::close(listener);
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+//============================================================================
+// Name        : benchmark-comfec.cpp
+// Author      : Juan Manuel Fernndez Muoz
+// Date        : October, 2026
+// Description : Benchmark of the ComFec encoding kernels, and of the goodput
+//               of a one-way lossy link with several redundancies
+//============================================================================
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <boost/chrono.hpp>
+
+#include "cominterface/comfaultinjector.hpp"
+#include "cominterface/comfec.hpp"
+#include "cominterface/compipe.hpp"
+
+// Data frames of each block
+static const size_t data_shards = 16;
+
+// Bytes of each frame
+static const size_t shard_size = 256;
+
+// Bytes transferred in each measure of the goodput
+static const size_t num_bytes = 256 * 1024;
+
+// Delay in milliseconds of each write of the link, that limits its speed
+static const unsigned int latency = 1;
+
+// Measure the speed of the encoding with the current kernel
+static double encode_speed()
+{
+    const size_t parity_shards = 4;
+    const size_t size = 4096;
+    const size_t rounds = 2000;
+    std::vector<unsigned char> data(data_shards * size);
+    std::vector<unsigned char> parity(parity_shards * size);
+
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<unsigned char>(std::rand());
+
+    boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < rounds; ++i)
+        ComFec::Encode(&data[0], data_shards, &parity[0], parity_shards, size);
+
+    boost::chrono::duration<double> elapsed = boost::chrono::steady_clock::now() - start;
+
+    return data.size() * rounds / elapsed.count() / 1e6;
+}
+
+int main()
+{
+    const char *kernels[] = {"scalar", "ssse3", "avx2"};
+    const std::string fastest = ComFec::GetKernel();
+
+    for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); ++i)
+    {
+        if (!ComFec::SetKernel(kernels[i]))
+        {
+            std::cout << kernels[i] << ": not supported" << std::endl;
+            continue;
+        }
+
+        std::cout << kernels[i] << ": encoding 16+4 at " << encode_speed() << " MB/s" << std::endl;
+    }
+
+    ComFec::SetKernel(fastest);
+
+    const double loss_rates[] = {0, 0.01, 0.05, 0.1, 0.2};
+    const size_t parities[] = {0, 2, 4, 8};
+    std::vector<unsigned char> data(num_bytes);
+
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<unsigned char>(std::rand());
+
+    for (size_t i = 0; i < sizeof(loss_rates) / sizeof(loss_rates[0]); ++i)
+    {
+        for (size_t j = 0; j < sizeof(parities) / sizeof(parities[0]); ++j)
+        {
+            ComPipe pipe(4 * num_bytes);
+            ComFaultInjector link(pipe.GetEnd(0));
+            ComFaultConfig faults;
+
+            faults.latency = latency;
+            faults.drop_rate = loss_rates[i];
+
+            link.SetWriteFaults(faults);
+
+            ComFec sender(&link, data_shards, parities[j], shard_size);
+            ComFec receiver(pipe.GetEnd(1), data_shards, parities[j], shard_size);
+
+            if (!sender.Open() || !receiver.Open())
+            {
+                std::cout << "The link could not be opened" << std::endl;
+                return 1;
+            }
+
+            boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+
+            sender.Write(&data[0], data.size());
+
+            boost::chrono::duration<double> elapsed = boost::chrono::steady_clock::now() - start;
+
+            // The frames are in the pipe when the write returns
+            std::vector<unsigned char> buffer(data.size());
+
+            receiver.SetReadTimeout(100);
+            receiver.Read(&buffer[0], buffer.size());
+
+            ComFecStats stats;
+
+            receiver.GetStats(stats);
+
+            double delivered = static_cast<double>(stats.blocks_received) /
+                               static_cast<double>(stats.blocks_received + stats.blocks_lost);
+
+            std::cout << "loss " << loss_rates[i] * 100 << "%, "
+                      << data_shards << "+" << parities[j] << ": "
+                      << delivered * 100 << "% of the blocks delivered, goodput "
+                      << delivered * data.size() / elapsed.count() / 1024 << " KB/s, "
+                      << stats.blocks_recovered << " blocks recovered"
+                      << std::endl;
+
+            sender.Close();
+            receiver.Close();
+        }
+    }
+
+    return 0;
+}
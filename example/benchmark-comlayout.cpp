@@ -0,0 +1,319 @@
+//============================================================================
+// Name        : benchmark-comlayout.cpp
+// Author      : Juan Manuel Fernndez Muoz
+// Date        : October, 2026
+// Description : Benchmark of the messages with a wire layout, accessed in
+//               place, against a serialization that copies the fields and the
+//               payload with memcpy to and from a structure
+//============================================================================
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/endian/conversion.hpp>
+#include <boost/thread.hpp>
+
+#include "cominterface/comlayout.hpp"
+#include "cominterface/compipe.hpp"
+
+// Messages of each measure
+static const size_t num_messages = 200000;
+
+// Bytes of the payload of each message
+static const size_t payload_size = 1024;
+
+/**
+ * @brief Wire layout of a telemetry message.
+ */
+struct Telemetry
+{
+    typedef ComField<boost::uint16_t, 0> Id;
+    typedef ComField<boost::uint32_t, Id::end, com_little_endian> Sequence;
+    typedef ComField<boost::uint64_t, Sequence::end> Time;
+    typedef ComField<double, Time::end> Value;
+    typedef ComArray<8, Value::end> Name;
+    typedef ComField<boost::uint16_t, Name::end> Length;
+    typedef ComTail<Length::end, Length> Tail;
+
+    static const size_t size = Tail::offset;
+};
+
+/**
+ * @brief Telemetry message of the manual serialization.
+ */
+struct TelemetryRecord
+{
+    boost::uint16_t id;
+    boost::uint32_t sequence;
+    boost::uint64_t time;
+    double value;
+    unsigned char name[8];
+    std::vector<unsigned char> payload;
+};
+
+// Serialize a message, field by field
+static void serialize(const TelemetryRecord& record, std::vector<unsigned char>& data)
+{
+    boost::uint16_t id = boost::endian::native_to_big(record.id);
+    boost::uint32_t sequence = boost::endian::native_to_little(record.sequence);
+    boost::uint64_t time = boost::endian::native_to_big(record.time);
+    boost::uint64_t value;
+    boost::uint16_t length = boost::endian::native_to_big(static_cast<boost::uint16_t>(record.payload.size()));
+
+    std::memcpy(&value, &record.value, sizeof(value));
+    value = boost::endian::native_to_big(value);
+
+    data.resize(Telemetry::size + record.payload.size());
+    std::memcpy(&data[0], &id, 2);
+    std::memcpy(&data[2], &sequence, 4);
+    std::memcpy(&data[6], &time, 8);
+    std::memcpy(&data[14], &value, 8);
+    std::memcpy(&data[22], record.name, 8);
+    std::memcpy(&data[30], &length, 2);
+    std::memcpy(&data[32], &record.payload[0], record.payload.size());
+}
+
+// Parse the fixed fields of a message, and get the size of its payload
+static size_t parse_header(const unsigned char *data, TelemetryRecord& record)
+{
+    boost::uint64_t value;
+    boost::uint16_t length;
+
+    std::memcpy(&record.id, data, 2);
+    std::memcpy(&record.sequence, data + 2, 4);
+    std::memcpy(&record.time, data + 6, 8);
+    std::memcpy(&value, data + 14, 8);
+    std::memcpy(record.name, data + 22, 8);
+    std::memcpy(&length, data + 30, 2);
+
+    record.id = boost::endian::big_to_native(record.id);
+    record.sequence = boost::endian::little_to_native(record.sequence);
+    record.time = boost::endian::big_to_native(record.time);
+    value = boost::endian::big_to_native(value);
+    std::memcpy(&record.value, &value, sizeof(value));
+
+    return boost::endian::big_to_native(length);
+}
+
+// Parse a message, copying its payload
+static void parse(const unsigned char *data, TelemetryRecord& record)
+{
+    size_t length = parse_header(data, record);
+
+    record.payload.assign(data + Telemetry::size, data + Telemetry::size + length);
+}
+
+// Fill the fields of a message
+static void fill_record(TelemetryRecord& record, size_t i)
+{
+    record.id = 7;
+    record.sequence = static_cast<boost::uint32_t>(i);
+    record.time = i * 1000;
+    record.value = i * 0.5;
+    std::memcpy(record.name, "sensor01", 8);
+    record.payload.assign(payload_size, static_cast<unsigned char>(i));
+}
+
+// Fill the fields of a message in place
+static void fill_message(ComMessage<Telemetry>& message, size_t i)
+{
+    message.Set<Telemetry::Id>(7);
+    message.Set<Telemetry::Sequence>(static_cast<boost::uint32_t>(i));
+    message.Set<Telemetry::Time>(i * 1000);
+    message.Set<Telemetry::Value>(i * 0.5);
+    message.Set<Telemetry::Name>(reinterpret_cast<const unsigned char *>("sensor01"));
+    std::memset(message.GetTail(), static_cast<unsigned char>(i), payload_size);
+}
+
+// Check a received message, adding its fields
+static bool check_record(const TelemetryRecord& record, size_t i, boost::uint64_t& sum)
+{
+    sum += record.time + record.payload[payload_size - 1];
+
+    return record.sequence == i && record.value == i * 0.5 && record.payload.size() == payload_size;
+}
+
+// Check a received message in place, adding its fields
+static bool check_message(const ComMessage<Telemetry>& message, size_t i, boost::uint64_t& sum)
+{
+    sum += message.Get<Telemetry::Time>() + message.GetTail()[payload_size - 1];
+
+    return message.Get<Telemetry::Sequence>() == i && message.Get<Telemetry::Value>() == i * 0.5 &&
+           message.GetTailSize() == payload_size;
+}
+
+// Print the speed of a measure
+static void print(const char *label, boost::chrono::steady_clock::time_point start, bool ok)
+{
+    boost::chrono::duration<double> elapsed = boost::chrono::steady_clock::now() - start;
+
+    std::cout << label << ": " << num_messages / elapsed.count() / 1e6 << " M messages/s, "
+              << elapsed.count() * 1e9 / num_messages << " ns/message" << (ok ? "" : " (failed)")
+              << std::endl;
+}
+
+// Encode and decode the messages with the manual serialization
+static void cpu_manual()
+{
+    TelemetryRecord record;
+    std::vector<unsigned char> data;
+    boost::uint64_t sum = 0;
+    bool ok = true;
+
+    boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < num_messages; ++i)
+    {
+        fill_record(record, i);
+        serialize(record, data);
+    }
+
+    print("memcpy serialization, encode", start, !data.empty());
+    start = boost::chrono::steady_clock::now();
+
+    // The same received bytes are decoded each time
+    for (size_t i = 0; i < num_messages; ++i)
+    {
+        parse(&data[0], record);
+        ok = check_record(record, num_messages - 1, sum) && ok;
+    }
+
+    print("memcpy serialization, decode", start, ok && sum != 0);
+}
+
+// Encode and decode the messages in place
+static void cpu_layout()
+{
+    std::vector<unsigned char> data(Telemetry::size + payload_size);
+    ComMessage<Telemetry> message(&data[0], data.size());
+    boost::uint64_t sum = 0;
+    bool ok = true;
+
+    boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < num_messages; ++i)
+    {
+        message.Set<Telemetry::Length>(payload_size);
+        fill_message(message, i);
+    }
+
+    print("ComMessage in place, encode", start, message.Valid());
+    start = boost::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < num_messages; ++i)
+    {
+        ComMessage<Telemetry> received(&data[0], data.size());
+
+        ok = received.Valid() && check_message(received, num_messages - 1, sum) && ok;
+    }
+
+    print("ComMessage in place, decode", start, ok && sum != 0);
+}
+
+// Send the messages with the manual serialization
+static void send_manual(ComInterface *link)
+{
+    TelemetryRecord record;
+    std::vector<unsigned char> data;
+
+    for (size_t i = 0; i < num_messages; ++i)
+    {
+        fill_record(record, i);
+        serialize(record, data);
+
+        if (link->Write(&data[0], data.size()) < 0)
+            break;
+    }
+}
+
+// Send the messages in place
+static void send_layout(ComInterface *link)
+{
+    ComBufferPool pool;
+
+    for (size_t i = 0; i < num_messages; ++i)
+    {
+        ComMessage<Telemetry> message = ComMessage<Telemetry>::Create(pool, payload_size);
+
+        fill_message(message, i);
+
+        if (link->Send(message) < 0)
+            break;
+    }
+}
+
+// Transfer the messages through a pipe with the manual serialization
+static void pipe_manual()
+{
+    ComPipe pipe;
+    ComInterface *sender = pipe.GetEnd(0);
+    ComInterface *receiver = pipe.GetEnd(1);
+
+    sender->Open();
+    receiver->Open();
+
+    boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+    boost::thread thread(boost::bind(send_manual, sender));
+    TelemetryRecord record;
+    std::vector<unsigned char> data(Telemetry::size);
+    boost::uint64_t sum = 0;
+    bool ok = true;
+
+    for (size_t i = 0; i < num_messages && ok; ++i)
+    {
+        ok = receiver->Read(&data[0], Telemetry::size) == static_cast<int>(Telemetry::size);
+
+        if (!ok)
+            break;
+
+        size_t length = parse_header(&data[0], record);
+
+        record.payload.resize(length);
+        ok = receiver->Read(&record.payload[0], length) == static_cast<int>(length) &&
+             check_record(record, i, sum);
+    }
+
+    thread.join();
+    print("memcpy serialization, through a pipe", start, ok);
+}
+
+// Transfer the messages through a pipe in place
+static void pipe_layout()
+{
+    ComPipe pipe;
+    ComInterface *sender = pipe.GetEnd(0);
+    ComInterface *receiver = pipe.GetEnd(1);
+
+    sender->Open();
+    receiver->Open();
+
+    boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+    boost::thread thread(boost::bind(send_layout, sender));
+    ComBufferPool pool;
+    ComMessage<Telemetry> message;
+    boost::uint64_t sum = 0;
+    bool ok = true;
+
+    for (size_t i = 0; i < num_messages && ok; ++i)
+        ok = receiver->Receive(pool, message) > 0 && check_message(message, i, sum);
+
+    thread.join();
+    print("ComMessage in place, through a pipe", start, ok);
+}
+
+int main()
+{
+    std::cout << num_messages << " messages of " << Telemetry::size << " + " << payload_size
+              << " bytes" << std::endl;
+
+    cpu_manual();
+    cpu_layout();
+    pipe_manual();
+    pipe_layout();
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+//============================================================================
+// Name        : benchmark-commulticast.cpp
+// Author      : Juan Manuel Fernndez Muoz
+// Date        : October, 2026
+// Description : Benchmark of a multicast publisher and subscriber over the
+//               loopback interface, sending and receiving the messages one
+//               by one and in batches
+//============================================================================
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/thread.hpp>
+
+#include "cominterface/commulticast.hpp"
+
+// Messages of each measure
+static const size_t num_messages = 200000;
+
+// Bytes of each message
+static const size_t message_size = 256;
+
+// Group of the measures
+static const char group[] = "239.255.0.1";
+
+// Port of the group
+static const unsigned int port = 3445;
+
+// Send the messages, in batches of a number of messages
+static void publish(ComMulticastPublisher *publisher, size_t batch)
+{
+    ComBufferPool pool;
+    std::vector<ComBuffer> messages;
+
+    for (size_t sent = 0; sent < num_messages; )
+    {
+        messages.clear();
+
+        for (size_t i = 0; i < batch && sent + i < num_messages; ++i)
+        {
+            ComBuffer message = pool.Allocate(message_size);
+            boost::uint32_t index = static_cast<boost::uint32_t>(sent + i);
+
+            std::memset(message.Data(), 0, message_size);
+            std::memcpy(message.Data(), &index, sizeof(index));
+            message.SetSize(message_size);
+            messages.push_back(message);
+        }
+
+        int ret_code = publisher->WriteBatch(messages);
+
+        if (ret_code <= 0)
+            break;
+
+        sent += ret_code;
+    }
+}
+
+// Send and receive the messages, and print their speed
+static void measure(size_t batch)
+{
+    ComMulticastPublisher publisher(group, port, "127.0.0.1");
+    ComMulticastSubscriber subscriber(group, port, "127.0.0.1", 200);
+    ComBufferPool pool;
+    std::vector<ComBuffer> messages;
+    size_t received = 0;
+    bool ok = true;
+
+    subscriber.SetReceiveBufferSize(8 * 1024 * 1024);
+
+    if (!publisher.Open() || !subscriber.Open())
+    {
+        std::cout << "The multicast group could not be joined" << std::endl;
+        return;
+    }
+
+    boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+    boost::thread thread(boost::bind(publish, &publisher, batch));
+
+    // The reception ends when no message arrives before the timeout
+    while (subscriber.ReceiveBatch(pool, messages, batch) > 0)
+    {
+        for (size_t i = 0; i < messages.size(); ++i)
+        {
+            boost::uint32_t index;
+
+            std::memcpy(&index, messages[i].Data(), sizeof(index));
+            ok = ok && messages[i].Size() == message_size && index >= received;
+            received = index + 1;
+        }
+    }
+
+    thread.join();
+
+    boost::chrono::duration<double> elapsed = boost::chrono::steady_clock::now() - start -
+                                              boost::chrono::milliseconds(200);
+    ComMulticastStats stats;
+
+    subscriber.GetStats(stats);
+
+    std::cout << "batches of " << batch << ": " << stats.datagrams_received / elapsed.count() / 1e3
+              << " K messages/s, " << stats.bytes_received / elapsed.count() / 1e6 << " MB/s, "
+              << num_messages - stats.datagrams_received << " lost, " << stats.gaps << " gaps"
+              << (ok ? "" : " (wrong sequence)") << std::endl;
+}
+
+int main()
+{
+    const size_t batches[] = {1, 8, ComMulticast::batch_size};
+
+    std::cout << num_messages << " messages of " << message_size << " bytes through "
+              << group << ":" << port << std::endl;
+
+    for (size_t i = 0; i < sizeof(batches) / sizeof(batches[0]); ++i)
+        measure(batches[i]);
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+//============================================================================
+// Name        : benchmark-compost.cpp
+// Author      : Juan Manuel Fernndez Muoz
+// Date        : October, 2026
+// Description : Benchmark of many threads writing small messages to a
+//               ComSocket, with Write and with the lock-free Post
+//============================================================================
+
+#include <iostream>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/thread.hpp>
+
+#include "cominterface/comsocket.hpp"
+
+// TCP port of the benchmark
+static const unsigned int port = 3445;
+
+// Messages written in each measure, shared by the producers
+static const size_t num_messages = 200000;
+
+// Size of each message
+static const size_t message_size = 64;
+
+// Open the server socket
+static void open_server(ComSocket *server, bool *opened)
+{
+    *opened = server->Open();
+}
+
+// Read the expected bytes
+static void consume(ComSocket *server, size_t expected)
+{
+    std::vector<unsigned char> buffer(65536);
+    size_t received = 0;
+
+    while (received < expected)
+    {
+        int ret_code = server->ReadBatch(&buffer[0], buffer.size());
+
+        if (ret_code < 0)
+            break;
+
+        received += ret_code;
+    }
+}
+
+// Write messages, with the mutex of the socket or posting them
+static void produce(ComSocket *client, const ComBuffer *message, size_t count, bool post)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (post)
+            client->Post(*message);
+        else
+            client->Write(message->Data(), message->Size());
+    }
+}
+
+int main()
+{
+    const size_t thread_counts[] = {1, 2, 4, 8, 16, 32, 64};
+    ComSocket server("", port, 5000);
+    ComSocket client("127.0.0.1", port, 5000);
+    ComBufferPool pool;
+    bool opened = false;
+
+    boost::thread acceptor(boost::bind(open_server, &server, &opened));
+
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+
+    bool connected = client.Open();
+
+    acceptor.join();
+
+    if (!connected || !opened)
+    {
+        std::cout << "The connection could not be opened" << std::endl;
+        return 1;
+    }
+
+    client.SetNoDelay(true);
+
+    ComBuffer message = pool.Allocate(message_size);
+
+    message.SetSize(message_size);
+
+    for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); ++i)
+    {
+        size_t per_thread = num_messages / thread_counts[i];
+        double rates[2];
+
+        for (int post = 0; post < 2; ++post)
+        {
+            boost::thread consumer(boost::bind(consume, &server,
+                                               per_thread * thread_counts[i] * message_size));
+            boost::thread_group producers;
+            boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+
+            for (size_t thread = 0; thread < thread_counts[i]; ++thread)
+                producers.create_thread(boost::bind(produce, &client, &message,
+                                                    per_thread, post != 0));
+
+            producers.join_all();
+            consumer.join();
+
+            boost::chrono::duration<double> elapsed = boost::chrono::steady_clock::now() - start;
+
+            rates[post] = per_thread * thread_counts[i] / elapsed.count() / 1e6;
+        }
+
+        std::cout << thread_counts[i] << " producers: "
+                  << "Write " << rates[0] << " Mmsg/s, "
+                  << "Post " << rates[1] << " Mmsg/s"
+                  << std::endl;
+    }
+
+    return 0;
+}
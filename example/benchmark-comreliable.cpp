@@ -0,0 +1,125 @@
+//============================================================================
+// Name        : benchmark-comreliable.cpp
+// Author      : Juan Manuel Fernndez Muoz
+// Date        : October, 2026
+// Description : Benchmark of a ComReliable transfer over an emulated lossy
+//               link, with stop-and-wait and with sliding windows
+//============================================================================
+
+#include <iostream>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/thread.hpp>
+
+#include "cominterface/comfaultinjector.hpp"
+#include "cominterface/compipe.hpp"
+#include "cominterface/comreliable.hpp"
+
+// Bytes transferred in each measure
+static const size_t num_bytes = 256 * 1024;
+
+// Delay in milliseconds of each write of the link
+static const unsigned int latency = 2;
+
+// Write all the data
+static void produce(ComReliable *sender, const std::vector<unsigned char> *data)
+{
+    size_t written = 0;
+
+    while (written < data->size())
+    {
+        int ret_code = sender->Write(&(*data)[written], data->size() - written);
+
+        if (ret_code < 0)
+            break;
+
+        written += ret_code;
+    }
+}
+
+// Read all the data and check it
+static bool consume(ComReliable *receiver, const std::vector<unsigned char>& data)
+{
+    std::vector<unsigned char> buffer(data.size());
+    size_t received = 0;
+
+    while (received < buffer.size())
+    {
+        int ret_code = receiver->Read(&buffer[received], buffer.size() - received);
+
+        if (ret_code < 0)
+            return false;
+
+        received += ret_code;
+    }
+
+    return buffer == data;
+}
+
+int main()
+{
+    const double loss_rates[] = {0, 0.01, 0.05, 0.1};
+    const size_t windows[] = {1, 8, 32};
+    std::vector<unsigned char> data(num_bytes);
+
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<unsigned char>(i * 31 + (i >> 8));
+
+    for (size_t i = 0; i < sizeof(loss_rates) / sizeof(loss_rates[0]); ++i)
+    {
+        for (size_t j = 0; j < sizeof(windows) / sizeof(windows[0]); ++j)
+        {
+            ComPipe pipe;
+            ComFaultInjector link_a(pipe.GetEnd(0), 1);
+            ComFaultInjector link_b(pipe.GetEnd(1), 2);
+            ComFaultConfig faults;
+
+            // Lost writes, and some corrupted bytes for the same amount of frames
+            faults.latency = latency;
+            faults.drop_rate = loss_rates[i];
+            faults.corrupt_rate = loss_rates[i] / 1000;
+
+            link_a.SetWriteFaults(faults);
+            link_b.SetWriteFaults(faults);
+
+            ComReliable sender(&link_a, windows[j]);
+            ComReliable receiver(&link_b, windows[j]);
+
+            if (!sender.Open() || !receiver.Open())
+            {
+                std::cout << "The link could not be opened" << std::endl;
+                return 1;
+            }
+
+            sender.SetWriteTimeout(60000);
+            receiver.SetReadTimeout(60000);
+
+            boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+            boost::thread producer(boost::bind(produce, &sender, &data));
+
+            bool valid = consume(&receiver, data);
+
+            producer.join();
+
+            boost::chrono::duration<double> elapsed = boost::chrono::steady_clock::now() - start;
+            ComReliableStats stats;
+
+            sender.GetStats(stats);
+
+            std::cout << "loss " << loss_rates[i] * 100 << "%, window " << windows[j] << ": "
+                      << data.size() / elapsed.count() / 1024 << " KB/s, "
+                      << stats.retransmissions << " retransmissions ("
+                      << stats.fast_retransmissions << " fast), "
+                      << "rto " << stats.rto << " ms"
+                      << (valid ? "" : ", DATA MISMATCH")
+                      << std::endl;
+
+            sender.Close();
+            receiver.Close();
+        }
+    }
+
+    return 0;
+}
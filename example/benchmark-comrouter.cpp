@@ -0,0 +1,94 @@
+//============================================================================
+// Name        : benchmark-comrouter.cpp
+// Author      : Juan Manuel Fernndez Muoz
+// Date        : October, 2026
+// Description : Benchmark of the frames per second routed by ComRouter
+//============================================================================
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+
+#include "cominterface/comrouter.hpp"
+
+// Frames routed in each measure
+static const size_t num_frames = 4000000;
+
+// Header: device address (1 byte), function code (1 byte) and message
+// type (2 bytes)
+static const size_t header_size = 4;
+
+// Handler of the frames, that counts the calls
+static void count_frame(unsigned long long *counter, ComInterface *, const ComBuffer&)
+{
+    ++*counter;
+}
+
+int main()
+{
+    const size_t rule_counts[] = {10, 100, 1000, 5000, 10000};
+    ComBufferPool pool;
+
+    std::srand(1);
+
+    for (size_t i = 0; i < sizeof(rule_counts) / sizeof(rule_counts[0]); ++i)
+    {
+        ComRouter router;
+        unsigned long long calls = 0;
+        std::vector<ComBuffer> frames;
+
+        // Rules of a device, function and message type, plus one rule
+        // that receives all the frames of each device
+        for (size_t rule = 0; rule < rule_counts[i]; ++rule)
+        {
+            ComRouteRule match;
+
+            match.Match(0, static_cast<unsigned char>(rule % 64));
+
+            if (rule >= 64)
+            {
+                match.Match(1, static_cast<unsigned char>(rule / 64 % 16));
+                match.MatchField(2, 2, static_cast<unsigned int>(rule / 1024));
+            }
+
+            router.Add(match, boost::bind(count_frame, &calls, _1, _2));
+        }
+
+        boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+        size_t states = router.Compile();
+        boost::chrono::duration<double> compile = boost::chrono::steady_clock::now() - start;
+
+        // Frames with random headers, most of them matching some rule
+        for (size_t frame = 0; frame < 1024; ++frame)
+        {
+            ComBuffer buffer = pool.Allocate(header_size + 16);
+            unsigned int rule = std::rand() % (rule_counts[i] * 2);
+
+            buffer.SetSize(header_size + 16);
+            buffer.Data()[0] = static_cast<unsigned char>(rule % 64);
+            buffer.Data()[1] = static_cast<unsigned char>(rule / 64 % 16);
+            buffer.Data()[2] = static_cast<unsigned char>(rule / 1024 >> 8);
+            buffer.Data()[3] = static_cast<unsigned char>(rule / 1024);
+            frames.push_back(buffer);
+        }
+
+        start = boost::chrono::steady_clock::now();
+
+        for (size_t frame = 0; frame < num_frames; ++frame)
+            router.Route(NULL, frames[frame % frames.size()]);
+
+        boost::chrono::duration<double> elapsed = boost::chrono::steady_clock::now() - start;
+
+        std::cout << rule_counts[i] << " rules: "
+                  << states << " states, compiled in "
+                  << compile.count() * 1000 << " ms, "
+                  << num_frames / elapsed.count() / 1e6 << " Mframes/s, "
+                  << static_cast<double>(calls) / num_frames << " handlers per frame"
+                  << std::endl;
+    }
+
+    return 0;
+}
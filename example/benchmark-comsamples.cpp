@@ -0,0 +1,213 @@
+//============================================================================
+// Name        : benchmark-comsamples.cpp
+// Author      : Juan Manuel Fernndez Muoz
+// Date        : October, 2026
+// Description : Benchmark of the ComSampleDecoder conversions of interleaved
+//               16, 24 and 32 bit samples to float and integer arrays,
+//               against a scalar loop, checking the output of each kernel
+//============================================================================
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <boost/chrono.hpp>
+#include <boost/cstdint.hpp>
+
+#include "cominterface/comsamples.hpp"
+
+// Samples of each measure, of all the channels
+static const size_t num_samples = 1 << 20;
+
+// Times that the samples are decoded in each measure
+static const unsigned int repetitions = 20;
+
+// Bytes of the chunks in which the stream is received
+static const size_t chunk_size = 1399;
+
+// Decode the samples with a straightforward loop, sample by sample
+static void decode_loop(const unsigned char *data, size_t frames, unsigned int bytes,
+                        ComByteOrder order, size_t channels, boost::int32_t *const *ints,
+                        float *const *floats)
+{
+    const float scale = 1.0f / static_cast<float>(1UL << (8 * bytes - 1));
+    const unsigned int unused_bits = 32 - 8 * bytes;
+
+    for (size_t i = 0; i < frames; ++i)
+    {
+        for (size_t channel = 0; channel < channels; ++channel, data += bytes)
+        {
+            boost::uint32_t value = 0;
+
+            for (unsigned int j = 0; j < bytes; ++j)
+            {
+                unsigned int shift = order == com_little_endian ? 8 * j : 8 * (bytes - 1 - j);
+
+                value |= static_cast<boost::uint32_t>(data[j]) << shift;
+            }
+
+            // Sign extension from the most significant bit of the sample
+            boost::int32_t sample = static_cast<boost::int32_t>(value << unused_bits) >> unused_bits;
+
+            ints[channel][i] = sample;
+            floats[channel][i] = sample * scale;
+        }
+    }
+}
+
+// Fill the float arrays with NaN, which is different from any decoded sample
+static void reset(std::vector<std::vector<float> >& out, const std::vector<std::vector<float> >& /*expected*/)
+{
+    for (size_t channel = 0; channel < out.size(); ++channel)
+        std::fill(out[channel].begin(), out[channel].end(), std::numeric_limits<float>::quiet_NaN());
+}
+
+// Fill the integer arrays with the complement of the expected samples
+static void reset(std::vector<std::vector<boost::int32_t> >& out,
+                  const std::vector<std::vector<boost::int32_t> >& expected)
+{
+    for (size_t channel = 0; channel < out.size(); ++channel)
+    {
+        for (size_t i = 0; i < out[channel].size(); ++i)
+            out[channel][i] = ~expected[channel][i];
+    }
+}
+
+// Decode the samples the repetitions of a measure, as whole frames or as a
+// stream received in chunks that split the frames, and check them
+template <typename T>
+static double decode(ComSampleDecoder& decoder, const std::vector<unsigned char>& data,
+                     const std::vector<std::vector<T> >& expected, bool chunked, bool& ok)
+{
+    const size_t frames = expected[0].size();
+    std::vector<std::vector<T> > decoded(expected.size(), std::vector<T>(frames));
+    std::vector<T *> out(expected.size());
+
+    reset(decoded, expected);
+    decoder.Reset();
+
+    boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+
+    for (unsigned int i = 0; i < repetitions; ++i)
+    {
+        size_t decoded_frames = 0;
+
+        for (size_t done = 0; done < data.size(); )
+        {
+            size_t len = chunked ? std::min(chunk_size, data.size() - done) : data.size();
+
+            for (size_t channel = 0; channel < out.size(); ++channel)
+                out[channel] = &decoded[channel][0] + decoded_frames;
+
+            if (chunked)
+                decoded_frames += decoder.Push(&data[done], len, &out[0]);
+            else
+                decoder.Decode(&data[0], frames, &out[0]);
+
+            done += len;
+        }
+    }
+
+    boost::chrono::duration<double> elapsed = boost::chrono::steady_clock::now() - start;
+
+    ok = decoded == expected;
+
+    return elapsed.count();
+}
+
+// Print the speed of a measure
+static void print(const std::string& label, double elapsed)
+{
+    std::cout << num_samples * repetitions / elapsed / 1e6 << " M samples/s " << label;
+}
+
+// Print the speeds of a kernel to floats and to integers
+static void print(const std::string& label, double floats, bool floats_ok, double ints, bool ints_ok)
+{
+    std::cout << "  " << label << ": ";
+    print("to floats", floats);
+    std::cout << (floats_ok ? "" : " (wrong samples)") << ", ";
+    print("to integers", ints);
+    std::cout << (ints_ok ? "" : " (wrong samples)") << std::endl;
+}
+
+// Measure the decoders of a format
+static void measure(unsigned int bits, ComByteOrder order, size_t channels)
+{
+    const size_t frames = num_samples / channels;
+    ComSampleDecoder decoder(bits, order, channels);
+    std::vector<unsigned char> data(frames * decoder.GetFrameSize());
+    std::vector<std::vector<float> > floats(channels, std::vector<float>(frames));
+    std::vector<std::vector<boost::int32_t> > ints(channels, std::vector<boost::int32_t>(frames));
+    std::vector<float *> floats_out(channels);
+    std::vector<boost::int32_t *> ints_out(channels);
+
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<unsigned char>(std::rand());
+
+    for (size_t channel = 0; channel < channels; ++channel)
+    {
+        floats_out[channel] = &floats[channel][0];
+        ints_out[channel] = &ints[channel][0];
+    }
+
+    std::cout << bits << " bit " << (order == com_little_endian ? "little" : "big")
+              << " endian, " << channels << " channels" << std::endl;
+
+    boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+
+    for (unsigned int i = 0; i < repetitions; ++i)
+        decode_loop(&data[0], frames, bits / 8, order, channels, &ints_out[0], &floats_out[0]);
+
+    boost::chrono::duration<double> elapsed = boost::chrono::steady_clock::now() - start;
+
+    std::cout << "  scalar loop: ";
+    print("to floats and integers", elapsed.count());
+    std::cout << std::endl;
+
+    const char *kernels[] = {"scalar", "ssse3", "avx2"};
+    std::string fastest = ComSampleDecoder::GetKernel();
+
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k)
+    {
+        if (!ComSampleDecoder::SetKernel(kernels[k]))
+            continue;
+
+        bool floats_ok;
+        bool ints_ok;
+        double floats_elapsed = decode(decoder, data, floats, false, floats_ok);
+        double ints_elapsed = decode(decoder, data, ints, false, ints_ok);
+
+        print(std::string("ComSampleDecoder ") + kernels[k], floats_elapsed, floats_ok,
+              ints_elapsed, ints_ok);
+
+        floats_elapsed = decode(decoder, data, floats, true, floats_ok);
+        ints_elapsed = decode(decoder, data, ints, true, ints_ok);
+
+        print(std::string("ComSampleDecoder ") + kernels[k] + ", chunks of 1399 bytes",
+              floats_elapsed, floats_ok, ints_elapsed, ints_ok);
+    }
+
+    ComSampleDecoder::SetKernel(fastest);
+}
+
+int main()
+{
+    const unsigned int bits[] = {16, 24, 32};
+    const ComByteOrder orders[] = {com_little_endian, com_big_endian};
+    const size_t channels[] = {1, 2, 4, 6, 8};
+
+    for (size_t i = 0; i < sizeof(bits) / sizeof(bits[0]); ++i)
+    {
+        for (size_t j = 0; j < sizeof(orders) / sizeof(orders[0]); ++j)
+        {
+            for (size_t k = 0; k < sizeof(channels) / sizeof(channels[0]); ++k)
+                measure(bits[i], orders[j], channels[k]);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,304 @@
+//============================================================================
+// Name        : benchmark-comzmodem.cpp
+// Author      : Juan Manuel Fernndez Muoz
+// Date        : October, 2026
+// Description : Benchmark of the ComZmodem file transfers between two
+//               pseudoterminals, relayed at the speed and latency of a line,
+//               comparing the streaming windows with a block-ack transfer
+//============================================================================
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "cominterface/comserial.hpp"
+#include "cominterface/comzmodem.hpp"
+
+// Bytes per second of the line (1 Mbaud, 10 bits per byte)
+static const double line_rate = 100000;
+
+// Delay in milliseconds of each direction of the line
+static const unsigned int latency = 10;
+
+// Bytes of the transferred file
+static const size_t file_size = 256 * 1024;
+
+// Names of the sent and the received file
+static const char sent_file[] = "benchmark-comzmodem.in";
+static const char received_file[] = "benchmark-comzmodem.out";
+
+/**
+ * @brief One direction of the line, between the masters of two pseudoterminals.
+ */
+class Line
+{
+public:
+    Line(int from, int to) : m_from(from), m_to(to), m_stop(false),
+        m_free(boost::chrono::steady_clock::now())
+    {
+        m_reader = boost::thread(boost::bind(&Line::reader, this));
+        m_writer = boost::thread(boost::bind(&Line::writer, this));
+    }
+
+    ~Line()
+    {
+        {
+            boost::lock_guard<boost::mutex> lock(m_mutex);
+
+            m_stop = true;
+            m_cond.notify_all();
+        }
+
+        m_reader.join();
+        m_writer.join();
+    }
+
+private:
+    struct Chunk
+    {
+        boost::chrono::steady_clock::time_point delivery;
+        std::vector<char> data;
+    };
+
+    int m_from;
+    int m_to;
+    bool m_stop;
+    boost::chrono::steady_clock::time_point m_free;
+    std::deque<Chunk> m_chunks;
+    boost::mutex m_mutex;
+    boost::condition_variable m_cond;
+    boost::thread m_reader;
+    boost::thread m_writer;
+
+    // Take the bytes written to a pseudoterminal and compute when they arrive
+    void reader()
+    {
+        char buffer[256];
+
+        while (true)
+        {
+            struct pollfd fd = {m_from, POLLIN, 0};
+
+            {
+                boost::lock_guard<boost::mutex> lock(m_mutex);
+
+                if (m_stop)
+                    return;
+            }
+
+            if (poll(&fd, 1, 100) <= 0)
+                continue;
+
+            ssize_t len = read(m_from, buffer, sizeof(buffer));
+
+            if (len <= 0)
+                continue;
+
+            boost::chrono::steady_clock::time_point now = boost::chrono::steady_clock::now();
+            Chunk chunk;
+
+            // The bytes are serialized after the previous ones
+            m_free = std::max(m_free, now) +
+                     boost::chrono::duration_cast<boost::chrono::steady_clock::duration>(
+                         boost::chrono::duration<double>(len / line_rate));
+
+            chunk.delivery = m_free + boost::chrono::milliseconds(latency);
+            chunk.data.assign(buffer, buffer + len);
+
+            boost::lock_guard<boost::mutex> lock(m_mutex);
+
+            m_chunks.push_back(chunk);
+            m_cond.notify_all();
+        }
+    }
+
+    // Deliver the bytes to the other pseudoterminal at their time
+    void writer()
+    {
+        boost::unique_lock<boost::mutex> lock(m_mutex);
+
+        while (true)
+        {
+            while (!m_stop && m_chunks.empty())
+                m_cond.wait(lock);
+
+            if (m_stop)
+                return;
+
+            Chunk chunk = m_chunks.front();
+
+            m_chunks.pop_front();
+            lock.unlock();
+
+            boost::this_thread::sleep_until(chunk.delivery);
+
+            for (size_t done = 0; done < chunk.data.size(); )
+            {
+                ssize_t len = write(m_to, &chunk.data[done], chunk.data.size() - done);
+
+                if (len <= 0)
+                    break;
+
+                done += len;
+            }
+
+            lock.lock();
+        }
+    }
+};
+
+// Open the master of a pseudoterminal in raw mode, and get the name of its slave
+static int open_pty(std::string& name)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+        return -1;
+
+    struct termios attributes;
+
+    tcgetattr(master, &attributes);
+    cfmakeraw(&attributes);
+    tcsetattr(master, TCSANOW, &attributes);
+
+    name = ptsname(master);
+
+    return master;
+}
+
+// Read a whole file
+static std::string read_file(const char *path)
+{
+    std::ifstream file(path, std::ios::binary);
+
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// Receive the files of a session
+static void receive(ComZmodem *receiver, bool *ret_code)
+{
+    std::vector<std::string> files;
+
+    *ret_code = receiver->ReceiveFiles(".", files);
+}
+
+// Transfer the file, and print its speed as a fraction of the line rate. The
+// receiver has the first bytes of the file, as after a broken transfer, or
+// a different file with the same name, that must not be resumed
+static bool transfer(ComSerial *sender_port, ComSerial *receiver_port, const std::string& label,
+                     size_t subpacket, size_t window, size_t partial = 0, bool different = false)
+{
+    std::string data = read_file(sent_file);
+    std::string prefix = data.substr(0, partial);
+    std::ofstream file(received_file, std::ios::binary | std::ios::trunc);
+
+    if (different && partial > 0)
+        prefix[partial / 2] = static_cast<char>(prefix[partial / 2] ^ 0xFF);
+
+    file.write(prefix.data(), prefix.size());
+    file.close();
+
+    ComZmodem sender(sender_port);
+    ComZmodem receiver(receiver_port);
+    bool received = false;
+
+    sender.SetSubpacketSize(subpacket);
+    sender.SetWindow(window);
+
+    boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+    boost::thread thread(boost::bind(receive, &receiver, &received));
+
+    bool sent = sender.SendFile(sent_file, received_file);
+
+    thread.join();
+
+    boost::chrono::duration<double> elapsed = boost::chrono::steady_clock::now() - start;
+    ComZmodemStats stats;
+
+    sender.GetStats(stats);
+
+    double rate = stats.bytes / elapsed.count();
+
+    std::cout << label << ": " << stats.bytes / 1024 << " KB in " << elapsed.count() << " s, "
+              << rate / 1024 << " KB/s, " << rate / line_rate * 100 << "% of the line rate, "
+              << stats.resumed / 1024 << " KB resumed, " << stats.errors << " errors" << std::endl;
+
+    return sent && received && read_file(received_file) == data;
+}
+
+int main()
+{
+    std::string names[2];
+    int masters[2] = {open_pty(names[0]), open_pty(names[1])};
+
+    if (masters[0] < 0 || masters[1] < 0)
+    {
+        std::cout << "The pseudoterminals could not be opened" << std::endl;
+        return 1;
+    }
+
+    ComSerial sender_port(names[0], 115200, 8, 1, 'n', 'n');
+    ComSerial receiver_port(names[1], 115200, 8, 1, 'n', 'n');
+
+    if (!sender_port.Open() || !receiver_port.Open())
+    {
+        std::cout << "The serial ports could not be opened" << std::endl;
+        return 1;
+    }
+
+    {
+        std::ofstream file(sent_file, std::ios::binary);
+
+        for (size_t i = 0; i < file_size; ++i)
+            file.put(static_cast<char>(std::rand()));
+    }
+
+    bool ok = true;
+
+    {
+        Line forward(masters[0], masters[1]);
+        Line backward(masters[1], masters[0]);
+
+        std::cout << "Line of " << line_rate / 1024 << " KB/s with " << latency
+                  << " ms of latency" << std::endl;
+
+        // Each block waits for its acknowledgement, like XMODEM
+        ok = transfer(&sender_port, &receiver_port, "block-ack, 1 KB", 1024, 1024) && ok;
+        ok = transfer(&sender_port, &receiver_port, "window 4 KB", 1024, 4096) && ok;
+        ok = transfer(&sender_port, &receiver_port, "window 32 KB", 1024, 32768) && ok;
+        ok = transfer(&sender_port, &receiver_port, "streaming", 1024, 0) && ok;
+        ok = transfer(&sender_port, &receiver_port, "streaming, 8 KB subpackets", 8192, 0) && ok;
+        ok = transfer(&sender_port, &receiver_port, "resumed at half", 1024, 32768, file_size / 2) && ok;
+        ok = transfer(&sender_port, &receiver_port, "different file at half", 1024, 32768,
+                      file_size / 2, true) && ok;
+    }
+
+    if (!ok)
+        std::cout << "The received file is not correct" << std::endl;
+
+    sender_port.Close();
+    receiver_port.Close();
+    close(masters[0]);
+    close(masters[1]);
+    std::remove(sent_file);
+    std::remove(received_file);
+
+    return ok ? 0 : 1;
+}
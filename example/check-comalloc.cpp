@@ -0,0 +1,275 @@
+//============================================================================
+// Name        : check-comalloc.cpp
+// Author      : Juan Manuel Fernndez Muoz
+// Date        : October, 2026
+// Description : Check that the steady state blocking Read and Write of a
+//               ComSocket and of a ComSerial (on a pseudo terminal) don't
+//               allocate memory in the heap, counting the calls to the
+//               global operator new
+//============================================================================
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/thread.hpp>
+
+#include "cominterface/comserial.hpp"
+#include "cominterface/comsocket.hpp"
+
+// TCP port of the check
+static const unsigned int port = 3447;
+
+// Round trips of each measure
+static const size_t round_trips = 1000;
+
+// Bytes of each message
+static const size_t message_size = 64;
+
+// Number of calls to the global operator new
+static size_t allocations = 0;
+
+void *operator new(std::size_t size)
+{
+    ++allocations;
+
+    void *pointer = std::malloc(size ? size : 1);
+
+    if (!pointer)
+        throw std::bad_alloc();
+
+    return pointer;
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *pointer) throw()
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) throw()
+{
+    std::free(pointer);
+}
+
+#if defined(__cpp_sized_deallocation)
+void operator delete(void *pointer, std::size_t /*size*/) throw()
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t /*size*/) throw()
+{
+    std::free(pointer);
+}
+#endif
+
+// Open the server socket
+static void open_server(ComSocket *server, bool *opened)
+{
+    *opened = server->Open();
+}
+
+// Write a message in each direction and read it at the other end
+static bool round_trip(ComSocket& server, ComSocket& client, unsigned char *buffer)
+{
+    return client.Write(buffer, message_size) == static_cast<int>(message_size) &&
+           server.Read(buffer, message_size) == static_cast<int>(message_size) &&
+           server.Write(buffer, message_size) == static_cast<int>(message_size) &&
+           client.Read(buffer, message_size) == static_cast<int>(message_size);
+}
+
+// Read without data, until the timeout expires
+static bool timed_out_read(ComInterface& com, unsigned char *buffer)
+{
+    return com.Read(buffer, message_size) <= 0;
+}
+
+// Write a message from the master of the pseudo terminal to the serial
+// port, and back
+static bool serial_round_trip(int master, ComSerial& serial, unsigned char *buffer)
+{
+    if (::write(master, buffer, message_size) != static_cast<ssize_t>(message_size) ||
+        serial.Read(buffer, message_size) != static_cast<int>(message_size) ||
+        serial.Write(buffer, message_size) != static_cast<int>(message_size))
+        return false;
+
+    for (size_t received = 0; received < message_size; )
+    {
+        ssize_t len = ::read(master, buffer + received, message_size - received);
+
+        if (len <= 0)
+            return false;
+
+        received += len;
+    }
+
+    return true;
+}
+
+// Print the result of a measure
+static bool check(const char *label, size_t count, bool ok)
+{
+    std::cout << label << ": " << count << " allocations" << (ok ? "" : " (wrong data)") << std::endl;
+
+    return ok && count == 0;
+}
+
+// Open a pseudo terminal, whose slave is used as a serial port
+static int open_pty(std::string& slave)
+{
+    int master = ::posix_openpt(O_RDWR | O_NOCTTY);
+
+    if (master < 0)
+        return -1;
+
+    if (::grantpt(master) != 0 || ::unlockpt(master) != 0 || !::ptsname(master))
+    {
+        ::close(master);
+        return -1;
+    }
+
+    slave = ::ptsname(master);
+
+    return master;
+}
+
+// Check the allocations of the blocking Read and Write of a ComSerial
+static bool check_serial(unsigned char *buffer)
+{
+    std::string slave;
+    int master = open_pty(slave);
+
+    if (master < 0)
+    {
+        std::cout << "The pseudo terminal could not be opened" << std::endl;
+        return false;
+    }
+
+    ComSerial serial(slave, 38400, 8, 1, 'n', 'n', 5000);
+
+    if (!serial.Open())
+    {
+        std::cout << "The serial port could not be opened" << std::endl;
+        ::close(master);
+        return false;
+    }
+
+    // Warm up
+    bool ok = serial_round_trip(master, serial, buffer);
+
+    serial.SetReadTimeout(10);
+    ok = timed_out_read(serial, buffer) && ok;
+    serial.SetReadTimeout(5000);
+    ok = serial_round_trip(master, serial, buffer) && ok;
+
+    if (!ok)
+    {
+        std::cout << "The warm up of the serial port failed" << std::endl;
+        ::close(master);
+        return false;
+    }
+
+    // Steady state round trips
+    size_t start = allocations;
+
+    for (size_t i = 0; i < round_trips && ok; ++i)
+        ok = serial_round_trip(master, serial, buffer);
+
+    bool passed = check("ComSerial Write/Read round trips", allocations - start, ok);
+
+    // Timed out reads, and a round trip after them
+    serial.SetReadTimeout(10);
+    start = allocations;
+    ok = timed_out_read(serial, buffer) && timed_out_read(serial, buffer);
+    serial.SetReadTimeout(5000);
+    ok = ok && serial_round_trip(master, serial, buffer);
+
+    passed = check("ComSerial timed out Read", allocations - start, ok) && passed;
+
+    serial.Close();
+    ::close(master);
+
+    return passed;
+}
+
+int main()
+{
+    ComSocket server("", port, 5000);
+    ComSocket client("127.0.0.1", port, 5000);
+    unsigned char buffer[message_size] = {0};
+    bool opened = false;
+
+    boost::thread acceptor(boost::bind(open_server, &server, &opened));
+
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+
+    bool connected = client.Open();
+
+    acceptor.join();
+
+    if (!connected || !opened)
+    {
+        std::cout << "The connection could not be opened" << std::endl;
+        return 1;
+    }
+
+    // The Open of the sockets allocates memory, else the counter is not used
+    if (allocations == 0)
+    {
+        std::cout << "The allocations are not counted" << std::endl;
+        return 1;
+    }
+
+    client.SetNoDelay(true);
+    server.SetNoDelay(true);
+
+    // Warm up: the first operations create the reactor and its descriptors
+    bool ok = round_trip(server, client, buffer);
+
+    client.SetReadTimeout(10);
+    ok = timed_out_read(client, buffer) && ok;
+    client.SetReadTimeout(5000);
+    ok = round_trip(server, client, buffer) && ok;
+
+    if (!ok)
+    {
+        std::cout << "The warm up failed" << std::endl;
+        return 1;
+    }
+
+    // Steady state round trips
+    size_t start = allocations;
+
+    for (size_t i = 0; i < round_trips && ok; ++i)
+        ok = round_trip(server, client, buffer);
+
+    bool passed = check("Write/Read round trips", allocations - start, ok);
+
+    // Timed out reads, and a round trip after them
+    client.SetReadTimeout(10);
+    start = allocations;
+    ok = timed_out_read(client, buffer) && timed_out_read(client, buffer);
+    client.SetReadTimeout(5000);
+    ok = ok && round_trip(server, client, buffer);
+
+    passed = check("Timed out Read", allocations - start, ok) && passed;
+
+    // The same steady state of a serial port
+    passed = check_serial(buffer) && passed;
+
+    std::cout << (passed ? "PASSED" : "FAILED") << std::endl;
+
+    return passed ? 0 : 1;
+}
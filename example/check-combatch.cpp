@@ -0,0 +1,124 @@
+//============================================================================
+// Name        : check-combatch.cpp
+// Author      : Juan Manuel Fernndez Muoz
+// Date        : October, 2026
+// Description : Check that a ComSocket restores its receive low watermark
+//               after a coalesced ReadBatch, so that a plain Read of fewer
+//               bytes than the batch returns as soon as they arrive
+//============================================================================
+
+#include <iostream>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/thread.hpp>
+
+#include "cominterface/comsocket.hpp"
+
+// TCP port of the check
+static const unsigned int port = 3450;
+
+// Bytes that complete a batch
+static const size_t min_batch = 1024;
+
+// Maximum latency of a batch, in milliseconds
+static const unsigned int max_latency = 50;
+
+// Read timeout, in milliseconds
+static const unsigned int read_timeout = 500;
+
+// Bytes of the messages, shorter than a batch
+static const size_t message_size = 10;
+
+// Delay of the messages written while the reads wait, in milliseconds
+static const unsigned int write_delay = 10;
+
+// Open the server socket
+static void open_server(ComSocket *server, bool *opened)
+{
+    *opened = server->Open();
+}
+
+// Write a message after a delay, so that the read waits for it
+static void write_later(ComSocket *server, const unsigned char *buffer)
+{
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(write_delay));
+    server->Write(buffer, message_size);
+}
+
+// Read a message while the server writes it
+static int read_message(ComSocket& server, ComSocket& client, unsigned char *buffer)
+{
+    unsigned char message[message_size] = {0};
+    boost::thread writer(boost::bind(write_later, &server, message));
+    int ret_code = client.Read(buffer, message_size);
+
+    writer.join();
+
+    return ret_code;
+}
+
+// Print the result of a read and its elapsed time
+static bool check(const char *label, int ret_code, size_t expected,
+                  const boost::chrono::steady_clock::time_point& start)
+{
+    boost::chrono::milliseconds elapsed = boost::chrono::duration_cast<boost::chrono::milliseconds>(
+                                              boost::chrono::steady_clock::now() - start);
+    bool ok = ret_code == static_cast<int>(expected) && elapsed.count() < max_latency * 2;
+
+    std::cout << label << ": " << ret_code << " bytes in " << elapsed.count() << " ms" << std::endl;
+
+    return ok;
+}
+
+int main()
+{
+    ComSocket server("", port, read_timeout);
+    ComSocket client("127.0.0.1", port, read_timeout);
+    unsigned char buffer[min_batch] = {0};
+    bool opened = false;
+
+    boost::thread acceptor(boost::bind(open_server, &server, &opened));
+
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+
+    bool connected = client.Open();
+
+    acceptor.join();
+
+    if (!connected || !opened || !client.SetReadCoalescing(min_batch, max_latency))
+    {
+        std::cout << "The connection could not be opened" << std::endl;
+        return 1;
+    }
+
+    // A message shorter than the batch: ReadBatch raises the watermark and
+    // returns it when the maximum latency expires
+    server.Write(buffer, message_size);
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+
+    boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+    bool passed = check("Coalesced ReadBatch", client.ReadBatch(buffer, sizeof(buffer)),
+                        message_size, start);
+
+    // A plain Read right after it returns the message as soon as it arrives
+    start = boost::chrono::steady_clock::now();
+    passed = check("Read after the ReadBatch", read_message(server, client, buffer),
+                   message_size, start) && passed;
+
+    // And so does a completed batch followed by a plain Read
+    server.Write(buffer, min_batch);
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+
+    start = boost::chrono::steady_clock::now();
+    passed = check("Completed ReadBatch", client.ReadBatch(buffer, sizeof(buffer)),
+                   min_batch, start) && passed;
+
+    start = boost::chrono::steady_clock::now();
+    passed = check("Read after the ReadBatch", read_message(server, client, buffer),
+                   message_size, start) && passed;
+
+    std::cout << (passed ? "PASSED" : "FAILED") << std::endl;
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+//============================================================================
+// Name        : check-commulticast.cpp
+// Author      : Juan Manuel Fernndez Muoz
+// Date        : October, 2026
+// Description : Check that a ComMulticastSubscriber whose payload size is
+//               raised while it is opened keeps receiving with the size of
+//               its Open, discarding the longer datagrams, and applies the
+//               new size on the next Open
+//============================================================================
+
+#include <iostream>
+#include <vector>
+
+#include "cominterface/commulticast.hpp"
+
+// Group of the check
+static const char group[] = "239.255.0.1";
+
+// Port of the group
+static const unsigned int port = 3449;
+
+// Payload size set while the subscriber is opened
+static const size_t payload_size = 60000;
+
+// Datagrams of each round
+static const size_t num_messages = 16;
+
+// Send the datagrams of a round, each one filled with its index
+static bool publish(ComMulticastPublisher& publisher)
+{
+    ComBufferPool pool;
+    std::vector<ComBuffer> messages;
+
+    for (size_t i = 0; i < num_messages; ++i)
+    {
+        ComBuffer message = pool.Allocate(payload_size);
+
+        for (size_t j = 0; j < payload_size; ++j)
+            message.Data()[j] = static_cast<unsigned char>(i + j);
+
+        message.SetSize(payload_size);
+        messages.push_back(message);
+    }
+
+    return publisher.WriteBatch(messages) == static_cast<int>(num_messages);
+}
+
+// Receive until the timeout expires, and count the valid datagrams
+static size_t receive(ComMulticastSubscriber& subscriber)
+{
+    ComBufferPool pool;
+    std::vector<ComBuffer> messages;
+    size_t valid = 0;
+
+    while (subscriber.ReceiveBatch(pool, messages) > 0)
+    {
+        for (size_t i = 0; i < messages.size(); ++i)
+        {
+            const unsigned char *data = messages[i].Data();
+            bool ok = messages[i].Size() == payload_size;
+
+            for (size_t j = 0; j < payload_size && ok; ++j)
+                ok = data[j] == static_cast<unsigned char>(data[0] + j);
+
+            if (ok)
+                ++valid;
+        }
+
+        messages.clear();
+    }
+
+    return valid;
+}
+
+int main()
+{
+    ComMulticastPublisher publisher(group, port, "127.0.0.1");
+    ComMulticastSubscriber subscriber(group, port, "127.0.0.1", 200);
+    ComMulticastStats stats;
+
+    subscriber.SetReceiveBufferSize(8 * 1024 * 1024);
+
+    if (!publisher.SetPayloadSize(payload_size) || !publisher.Open() || !subscriber.Open())
+    {
+        std::cout << "The multicast group could not be joined" << std::endl;
+        return 1;
+    }
+
+    // The subscriber received with the default size, so the longer datagrams
+    // are discarded until it is opened again
+    bool passed = subscriber.SetPayloadSize(payload_size) && publish(publisher);
+    size_t valid = receive(subscriber);
+
+    subscriber.GetStats(stats);
+    passed = passed && valid == 0 && stats.bad > 0;
+
+    std::cout << "Payload size set while opened: " << valid << " datagrams received, "
+              << stats.bad << " discarded" << std::endl;
+
+    // Opened again, the datagrams are received with the new size
+    passed = subscriber.Close() && subscriber.Open() && publish(publisher) && passed;
+    valid = receive(subscriber);
+    passed = passed && valid > 0;
+
+    std::cout << "Payload size applied on Open: " << valid << " of " << num_messages
+              << " datagrams received" << std::endl;
+
+    std::cout << (passed ? "PASSED" : "FAILED") << std::endl;
+
+    return passed ? 0 : 1;
+}
@@ -103,9 +103,10 @@ int main()
             // Receive data from the interface
             do
             {
-                // In case of an event driven GUI you better use a non blocking
-                // ReadSome(...) in your idle function. Here we have to wait for
-                // the response before we send another user command
+                // In case of an event driven GUI you better use the streaming
+                // mode (StartStreaming(...)), that calls you back with the
+                // received data. Here we have to wait for the response before
+                // we send another user command
                 received = interface->Read(receive_buffer, sizeof(receive_buffer) - 1);
 
                 // Something received?
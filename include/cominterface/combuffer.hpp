@@ -0,0 +1,193 @@
+/**
+ * @file    combuffer.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Pooled and reference counted message buffers.
+ */
+
+#ifndef _COMBUFFER_HPP_
+#define _COMBUFFER_HPP_
+
+#include <cstddef>
+
+#include <boost/container/pmr/memory_resource.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/smart_ptr/detail/atomic_count.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <boost/thread/mutex.hpp>
+
+class ComBufferPool;
+
+/**
+ * @brief Header of a memory block managed by a ComBufferPool.
+ * The data of the buffer is placed just after it.
+ */
+struct ComBufferBlock
+{
+    ComBufferBlock(ComBufferPool *owner, std::size_t block_capacity,
+                   unsigned int block_size_class) :
+        refs(1), pool(owner), capacity(block_capacity), size(0),
+        size_class(block_size_class), next(NULL) {}
+
+    boost::detail::atomic_count refs;   ///< Number of ComBuffer referencing the block.
+    ComBufferPool *pool;                ///< Pool that owns the block.
+    std::size_t capacity;               ///< Number of bytes of data.
+    std::size_t size;                   ///< Number of bytes of valid data.
+    unsigned int size_class;            ///< Size class of the block in the pool.
+    ComBufferBlock *next;               ///< Next block in the free list of the pool.
+};
+
+/**
+ * @brief Reference counted handler of a buffer taken from a ComBufferPool.
+ * Copying a ComBuffer doesn't copy the data, it shares it. When the last
+ * handler is destroyed, the memory returns to the pool.
+ * @note The data shouldn't be modified while it is shared (UseCount() > 1).
+ */
+class ComBuffer
+{
+public:
+    /**
+     * @brief Build an empty handler, without memory.
+     */
+    ComBuffer() : m_block(NULL) {}
+
+    ComBuffer(const ComBuffer& other);
+
+    ComBuffer& operator=(const ComBuffer& other);
+
+    ~ComBuffer();
+
+    /**
+     * @brief Check if the handler references a memory block.
+     * @return true if it has memory, false if it is empty.
+     */
+    bool Valid() const { return m_block != NULL; }
+
+    /**
+     * @brief Get the data of the buffer.
+     * @return Pointer to the data or NULL if the handler is empty.
+     */
+    unsigned char *Data() const
+    {
+        return m_block ? reinterpret_cast<unsigned char *>(m_block + 1) : NULL;
+    }
+
+    /**
+     * @brief Get the number of bytes of valid data.
+     * @return Number of bytes.
+     */
+    std::size_t Size() const { return m_block ? m_block->size : 0; }
+
+    /**
+     * @brief Set the number of bytes of valid data.
+     * @param size Number of bytes. It can't be greater than the capacity.
+     * @return true if the function executes correctly, false otherwise.
+     */
+    bool SetSize(std::size_t size);
+
+    /**
+     * @brief Get the maximum number of bytes that the buffer can hold.
+     * @return Number of bytes.
+     */
+    std::size_t Capacity() const { return m_block ? m_block->capacity : 0; }
+
+    /**
+     * @brief Get the number of handlers sharing the buffer.
+     * @return Number of handlers, 0 if the handler is empty.
+     */
+    long UseCount() const { return m_block ? static_cast<long>(m_block->refs) : 0; }
+
+    /**
+     * @brief Drop the reference to the buffer, leaving the handler empty.
+     */
+    void Reset();
+
+private:
+    friend class ComBufferPool;
+
+    explicit ComBuffer(ComBufferBlock *block) : m_block(block) {}
+
+    ComBufferBlock *m_block;    ///< Referenced memory block.
+};
+
+/**
+ * @brief Pool of reference counted buffers grouped by size classes.
+ * The released buffers are kept in a free list of their class to be
+ * reused, so the steady state doesn't need to allocate memory.
+ * @note All the buffers must be released before the pool is destroyed.
+ */
+class ComBufferPool : private boost::noncopyable
+{
+public:
+    /**
+     * @brief Number of size classes. The first one is 64 bytes and each
+     * one is 4 times greater than the previous one (64 B to 64 KiB).
+     */
+    static const unsigned int num_size_classes = 6;
+
+    /**
+     * @brief Buffer pool constructor.
+     * @param upstream Memory resource from which the blocks are taken.
+     * If NULL, the default memory resource is used.
+     * @param max_cached Maximum number of free blocks kept for each size class.
+     */
+    explicit ComBufferPool(boost::container::pmr::memory_resource *upstream = NULL,
+                           std::size_t max_cached = 64);
+
+    ~ComBufferPool();
+
+    /**
+     * @brief Get a buffer with, at least, the requested capacity.
+     * Buffers greater than the largest size class are not cached.
+     * @param capacity Number of bytes.
+     * @return Buffer with size 0, or an empty handler if there is no memory.
+     */
+    ComBuffer Allocate(std::size_t capacity);
+
+    /**
+     * @brief Return the cached free blocks to the upstream memory resource.
+     */
+    void Trim();
+
+    /**
+     * @brief Get the memory resource from which the blocks are taken.
+     * @return Memory resource.
+     */
+    boost::container::pmr::memory_resource *GetUpstreamResource();
+
+    /**
+     * @brief Get the number of free blocks kept by the pool.
+     * @return Number of blocks.
+     */
+    std::size_t GetCachedBlocks();
+
+private:
+    friend class ComBuffer;
+
+    boost::container::pmr::memory_resource *m_upstream; ///< Source of the memory blocks.
+    std::size_t m_max_cached;                           ///< Maximum number of free blocks per size class.
+    ComBufferBlock *m_free[num_size_classes];           ///< Free list of each size class.
+    std::size_t m_free_count[num_size_classes];         ///< Number of blocks in each free list.
+    boost::mutex m_mutex;                               ///< Mutex to make the pool thread safe.
+
+    /**
+     * @brief Get the capacity of a size class.
+     * @param size_class Size class.
+     * @return Number of bytes.
+     */
+    static std::size_t class_capacity(unsigned int size_class);
+
+    /**
+     * @brief Return a block whose reference count reached 0.
+     * @param block Memory block.
+     */
+    void release(ComBufferBlock *block);
+
+    /**
+     * @brief Give back the memory of a block to the upstream resource.
+     * @param block Memory block.
+     */
+    void free_block(ComBufferBlock *block);
+};
+
+#endif // _COMBUFFER_HPP_
@@ -0,0 +1,200 @@
+/**
+ * @file    comclock.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Source of time of the timeouts of the communication interfaces.
+ */
+
+#ifndef _COMCLOCK_HPP_
+#define _COMCLOCK_HPP_
+
+#include <list>
+
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+class ComTimer;
+
+/**
+ * @brief Completion handler of a ComTimer wait.
+ */
+typedef boost::function<void (const boost::system::error_code&)> ComTimerHandler;
+
+/**
+ * @brief Source of time of the timeouts. Every timeout of the interfaces
+ * is measured with a clock, so it can be replaced by a ComVirtualClock
+ * in the tests.
+ * @note The default clock of the interfaces is the system clock
+ * (GetSystemClock()), and the clocks must outlive the interfaces that use them.
+ */
+class ComClock : private boost::noncopyable
+{
+public:
+    typedef boost::chrono::steady_clock::duration duration;        ///< Duration of the clock.
+    typedef boost::chrono::steady_clock::time_point time_point;    ///< Time point of the clock.
+
+    virtual ~ComClock();
+
+    /**
+     * @brief Get the current time.
+     * @return Current time.
+     */
+    virtual time_point Now() = 0;
+
+    /**
+     * @brief Wait on a condition variable until it is notified or the
+     * deadline of the clock expires, as boost::condition_variable::wait_until.
+     * @param cond Condition variable.
+     * @param lock Lock of the mutex of the condition, that is locked.
+     * @param deadline Time at which the wait expires.
+     * @return boost::cv_status::timeout if the deadline has expired,
+     * boost::cv_status::no_timeout otherwise.
+     */
+    virtual boost::cv_status WaitUntil(boost::condition_variable& cond,
+                                       boost::unique_lock<boost::mutex>& lock,
+                                       const time_point& deadline) = 0;
+
+    /**
+     * @brief Get the clock of the system (the steady clock).
+     * @return System clock.
+     */
+    static ComClock *GetSystemClock();
+
+protected:
+    friend class ComTimer;
+
+    /**
+     * @brief Start a wait of a timer, when the clock keeps its own timers.
+     * @param timer Timer.
+     * @param expiry Time at which the wait expires.
+     * @param handler Handler executed in the I/O service of the timer.
+     * @return true if the clock keeps the wait, false if the timer must
+     * wait on the I/O service.
+     */
+    virtual bool schedule(ComTimer& timer, const time_point& expiry,
+                          const ComTimerHandler& handler);
+
+    /**
+     * @brief Cancel the waits of a timer kept by the clock. Their handlers
+     * are executed with boost::asio::error::operation_aborted.
+     * @param timer Timer.
+     * @return Number of canceled waits.
+     */
+    virtual size_t cancel(ComTimer& timer);
+
+    /**
+     * @brief Count a wait kept by the clock in its timer, so the I/O service
+     * of the timer keeps running until the wait is completed.
+     * @param timer Timer.
+     */
+    static void hold(ComTimer& timer);
+
+    /**
+     * @brief Complete a wait kept by the clock, executing its handler in
+     * the I/O service of the timer.
+     * @param timer Timer.
+     * @param handler Handler of the wait.
+     * @param error Result of the wait.
+     */
+    static void complete(ComTimer& timer, const ComTimerHandler& handler,
+                         const boost::system::error_code& error);
+};
+
+/**
+ * @brief Clock whose time only changes when it is advanced, so the tests
+ * of the timeouts don't wait for them: an operation with a 10 s timeout
+ * expires as soon as the test advances the clock 10 s.
+ *
+ * The waits that expire when the clock is advanced are woken up
+ * immediately, and the timers of the interfaces execute their handlers.
+ * The time starts at the epoch of the steady clock.
+ */
+class ComVirtualClock : public ComClock
+{
+public:
+    ComVirtualClock();
+
+    virtual ~ComVirtualClock();
+
+    virtual time_point Now();
+
+    virtual boost::cv_status WaitUntil(boost::condition_variable& cond,
+                                       boost::unique_lock<boost::mutex>& lock,
+                                       const time_point& deadline);
+
+    /**
+     * @brief Advance the time and wake up the expired waits.
+     * @param time Time in milliseconds.
+     */
+    void Advance(unsigned int time);
+
+    /**
+     * @brief Advance the time to the earliest pending deadline, if it is
+     * in the future, and wake up the expired waits.
+     * @return true if there was a pending wait, false otherwise.
+     */
+    bool AdvanceToNext();
+
+    /**
+     * @brief Get the number of pending waits, of the conditions and of the timers.
+     * @return Number of waits.
+     */
+    size_t GetPending();
+
+    /**
+     * @brief Wait until there are pending waits, e.g. until the thread under
+     * test has started an operation, before advancing the time.
+     * @param count Number of waits.
+     * @param timeout Maximum real time to wait in milliseconds.
+     * @return true if there are count or more pending waits, false if
+     * the timeout has expired.
+     */
+    bool WaitPending(size_t count, unsigned int timeout);
+
+protected:
+    virtual bool schedule(ComTimer& timer, const time_point& expiry,
+                          const ComTimerHandler& handler);
+
+    virtual size_t cancel(ComTimer& timer);
+
+private:
+    /**
+     * @brief Wait on a condition variable.
+     */
+    struct Waiter
+    {
+        boost::condition_variable *cond;    ///< Condition variable of the wait.
+        boost::mutex *mutex;                ///< Mutex of the condition.
+        time_point deadline;                ///< Time at which the wait expires.
+        bool busy;                          ///< The wait is being woken up by Advance.
+    };
+
+    /**
+     * @brief Wait of a timer.
+     */
+    struct Timer
+    {
+        ComTimer *timer;                    ///< Timer of the wait.
+        time_point expiry;                  ///< Time at which the wait expires.
+        ComTimerHandler handler;            ///< Handler of the wait.
+    };
+
+    time_point m_now;                       ///< Current time.
+    std::list<Waiter *> m_waiters;          ///< Waits on condition variables.
+    std::list<Timer> m_timers;              ///< Waits of the timers.
+    boost::mutex m_mutex;                   ///< Mutex of the clock.
+    boost::condition_variable m_cond;       ///< Signals new waits and the end of the wake ups.
+
+    /**
+     * @brief Set the time and wake up the expired waits.
+     * @param lock Lock of the mutex of the clock, that is locked.
+     * @param now New time.
+     */
+    void set_time(boost::unique_lock<boost::mutex>& lock, const time_point& now);
+};
+
+#endif // _COMCLOCK_HPP_
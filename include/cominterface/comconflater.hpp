@@ -0,0 +1,99 @@
+/**
+ * @file    comconflater.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Send queue that keeps only the latest message of each key.
+ */
+
+#ifndef _COMCONFLATER_HPP_
+#define _COMCONFLATER_HPP_
+
+#include <deque>
+#include <map>
+
+#include <boost/noncopyable.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "cominterface/cominterface.hpp"
+
+/**
+ * @brief Conflating send queue for a communication interface. Each message
+ * carries a key, and a new message replaces the unsent message with the
+ * same key, keeping its position in the queue. For telemetry streams, where
+ * only the newest value of each key matters, a slow consumer receives the
+ * latest values instead of accumulating backlog: the memory and the latency
+ * are bounded by the number of keys instead of the message rate.
+ *
+ * The messages are written with non blocking writes, from Send(...) and
+ * from Flush(). While WantsWrite(), Flush() must be called when the
+ * interface is writable (e.g. from an event loop or a ComPoller).
+ * @note A message that has been partially written is completed before
+ * the next one, so the messages are never mixed.
+ */
+class ComConflater : private boost::noncopyable
+{
+public:
+    /**
+     * @brief Conflating queue constructor.
+     * @param sink Interface to which the messages are written.
+     */
+    explicit ComConflater(ComInterface *sink);
+
+    /**
+     * @brief Queue a message and write the queue that the interface accepts.
+     * @param key Key of the message.
+     * @param message Message. It must not be modified after the call.
+     * @return true if the function executes correctly, false if the
+     * interface failed.
+     */
+    bool Send(unsigned int key, const ComBuffer& message);
+
+    /**
+     * @brief Write the queued messages that the interface accepts without blocking.
+     * @return Number of bytes written or -1 in case of error.
+     */
+    int Flush();
+
+    /**
+     * @brief Check if there are messages waiting for the interface to be writable.
+     * @return true if Flush() must be called, false otherwise.
+     */
+    bool WantsWrite();
+
+    /**
+     * @brief Get the number of messages waiting to be written.
+     * @return Number of messages, at most one per key plus a partially
+     * written one.
+     */
+    size_t GetPending();
+
+    /**
+     * @brief Get the number of messages replaced by newer ones before being sent.
+     * @return Number of messages.
+     */
+    unsigned long long GetConflated();
+
+    /**
+     * @brief Discard the messages waiting to be written, except the
+     * partially written one.
+     */
+    void Clear();
+
+private:
+    ComInterface *m_sink;                           ///< Interface to which the messages are written.
+    std::deque<unsigned int> m_order;               ///< Keys with an unsent message, in send order.
+    std::map<unsigned int, ComBuffer> m_pending;    ///< Latest unsent message of each key.
+    ComBuffer m_current;                            ///< Message being written.
+    size_t m_offset;                                ///< Bytes already written of the current message.
+    unsigned long long m_conflated;                 ///< Number of replaced messages.
+    boost::mutex m_mutex;                           ///< Mutex to make the queue thread safe.
+
+    /**
+     * @brief Write the queue without blocking. The mutex must be locked.
+     * @return Number of bytes written or -1 in case of error.
+     */
+    int flush();
+};
+
+#endif // _COMCONFLATER_HPP_
@@ -0,0 +1,175 @@
+/**
+ * @file    comdispatcher.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Ordered parallel processing of the received frames.
+ */
+
+#ifndef _COMDISPATCHER_HPP_
+#define _COMDISPATCHER_HPP_
+
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/tss.hpp>
+
+#include "cominterface/cominterface.hpp"
+
+/**
+ * @brief Latency metrics of a stage of a ComDispatcher.
+ */
+struct ComDispatchStageStats
+{
+    ComDispatchStageStats() : count(0), total_ns(0), max_ns(0) {}
+
+    unsigned long long count;       ///< Number of frames that have gone through the stage.
+    unsigned long long total_ns;    ///< Sum of the latencies in nanoseconds.
+    unsigned long long max_ns;      ///< Maximum latency in nanoseconds.
+};
+
+/**
+ * @brief Metrics of a ComDispatcher.
+ */
+struct ComDispatchStats
+{
+    ComDispatchStats() : steals(0) {}
+
+    ComDispatchStageStats queue;    ///< From Dispatch(...) to the start of the handler.
+    ComDispatchStageStats handler;  ///< Execution of the handler.
+    unsigned long long steals;      ///< Number of frame sequences taken from another worker.
+};
+
+/**
+ * @brief Dispatch stage that processes the frames received from the
+ * interfaces in a pool of worker threads, instead of in the I/O thread,
+ * keeping the order of the frames of the same key (e.g. the same interface).
+ *
+ * The frames of a key are queued in a strand, a lock-free queue that is
+ * processed by only one worker at a time. A strand with pending frames is
+ * scheduled in the lock-free work queue of a worker, and the idle workers
+ * steal the strands of the busy ones, so the load is balanced between the
+ * cores without losing the order.
+ * @note The keys are mapped to a fixed number of strands, so different
+ * keys can share a strand and be processed in sequence.
+ */
+class ComDispatcher : private boost::noncopyable
+{
+public:
+    /**
+     * @brief Handler of the frames. It receives the key and the frame.
+     */
+    typedef boost::function<void (unsigned int, const ComBuffer&)> Handler;
+
+    /**
+     * @brief Dispatcher constructor.
+     * @param handler Handler called for each frame, from the worker threads.
+     * @param workers Number of worker threads. If 0, one per core.
+     * @param strands Number of strands in which the keys are distributed.
+     */
+    explicit ComDispatcher(const Handler& handler, size_t workers = 0, size_t strands = 1024);
+
+    /**
+     * @brief Dispatcher destructor. The pending frames are processed
+     * before returning.
+     */
+    ~ComDispatcher();
+
+    /**
+     * @brief Queue a frame to be processed after the previous frames of its key.
+     * It can be called from any thread, including the handler.
+     * @param key Key of the frame.
+     * @param frame Frame. It must not be modified after the call.
+     * @return true if the frame has been queued, false if the dispatcher
+     * is stopped.
+     */
+    bool Dispatch(unsigned int key, const ComBuffer& frame);
+
+    /**
+     * @brief Queue a frame to be processed after the previous frames of
+     * the same interface.
+     * @param source Interface from which the frame has been received.
+     * @param frame Frame. It must not be modified after the call.
+     * @return true if the frame has been queued, false if the dispatcher
+     * is stopped.
+     */
+    bool Dispatch(ComInterface *source, const ComBuffer& frame);
+
+    /**
+     * @brief Process the pending frames and stop the worker threads. The
+     * frames dispatched while it is called are either processed or
+     * rejected by Dispatch(...).
+     */
+    void Stop();
+
+    /**
+     * @brief Get the number of frames queued and not processed yet.
+     * @return Number of frames.
+     */
+    size_t GetPending();
+
+    /**
+     * @brief Get the latency metrics of the stages.
+     * @param stats Metrics.
+     */
+    void GetStats(ComDispatchStats& stats);
+
+private:
+    struct Node;
+    struct Strand;
+    struct Worker;
+    class StrandQueue;
+    class NodePool;
+
+    Handler m_handler;                      ///< Handler of the frames.
+    std::vector<Strand *> m_strands;        ///< Strands of the keys.
+    std::vector<Worker *> m_workers;        ///< Worker threads and their work queues.
+    StrandQueue *m_injected;                ///< Strands scheduled from outside the workers.
+    boost::thread_group m_threads;          ///< Worker threads.
+    boost::atomic<size_t> m_pending;        ///< Number of frames not processed yet.
+    boost::atomic<bool> m_stop;             ///< The workers must finish when there is no work.
+    boost::atomic<unsigned int> m_sleeping; ///< Number of idle workers waiting for work.
+    boost::mutex m_sleep_mutex;             ///< Mutex of the idle workers.
+    boost::condition_variable m_sleep_cond; ///< Wakes up the idle workers.
+    NodePool *m_nodes;                      ///< Recycled queue nodes.
+    boost::thread_specific_ptr<Worker> m_current;   ///< Worker of the current thread.
+
+    /**
+     * @brief Cleanup of m_current, that doesn't own the workers.
+     * @param worker Worker of the thread.
+     */
+    static void keep_worker(Worker *worker);
+
+    /**
+     * @brief Schedule a strand with pending frames.
+     * @param strand Strand.
+     */
+    void schedule(Strand *strand);
+
+    /**
+     * @brief Find a strand to process: from the own queue, the strands
+     * scheduled from outside, or stolen from other worker.
+     * @param self Worker that looks for work.
+     * @return Strand, or NULL if there is no work.
+     */
+    Strand *find_work(Worker& self);
+
+    /**
+     * @brief Process the pending frames of a strand, up to a limit.
+     * @param self Worker that processes the strand.
+     * @param strand Strand.
+     */
+    void run_strand(Worker& self, Strand *strand);
+
+    /**
+     * @brief Body of a worker thread.
+     * @param self Worker.
+     */
+    void worker(Worker *self);
+};
+
+#endif // _COMDISPATCHER_HPP_
@@ -0,0 +1,49 @@
+/**
+ * @file    comevent.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Event that can be waited through a file descriptor.
+ */
+
+#ifndef _COMEVENT_HPP_
+#define _COMEVENT_HPP_
+
+#include <boost/noncopyable.hpp>
+
+/**
+ * @brief Event with a descriptor that is readable while the event is set,
+ * so it can be waited with poll, epoll or an external event loop together
+ * with the descriptors of the interfaces. It is an eventfd in Linux and a
+ * pipe in other POSIX systems.
+ * @note It is not available in Windows, where GetHandle() returns -1.
+ */
+class ComEvent : private boost::noncopyable
+{
+public:
+    ComEvent();
+
+    ~ComEvent();
+
+    /**
+     * @brief Get the descriptor of the event.
+     * @return Descriptor that is readable while the event is set, or -1
+     * if the event couldn't be created.
+     */
+    int GetHandle() const;
+
+    /**
+     * @brief Set the event. Setting an event that is already set has no effect.
+     * @return true if the function executes correctly, false otherwise.
+     */
+    bool Set();
+
+    /**
+     * @brief Clear the event.
+     */
+    void Clear();
+
+private:
+    int m_handle[2];    ///< Descriptors to read and to write the event (the same one for an eventfd).
+};
+
+#endif // _COMEVENT_HPP_
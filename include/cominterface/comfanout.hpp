@@ -0,0 +1,171 @@
+/**
+ * @file    comfanout.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Delivery of one input stream to many communication interfaces.
+ */
+
+#ifndef _COMFANOUT_HPP_
+#define _COMFANOUT_HPP_
+
+#include <deque>
+#include <map>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "cominterface/cominterface.hpp"
+#include "cominterface/comevent.hpp"
+
+/**
+ * @brief Statistics of a subscriber of a ComFanout.
+ */
+struct ComFanoutStats
+{
+    ComFanoutStats() : sent_bytes(0), queued_bytes(0), dropped_buffers(0), disconnected(false) {}
+
+    unsigned long long sent_bytes;          ///< Bytes written to the subscriber.
+    size_t queued_bytes;                    ///< Bytes waiting for the subscriber to be writable.
+    unsigned long long dropped_buffers;     ///< Buffers not delivered due to the drop policy.
+    bool disconnected;                      ///< The subscriber has been disconnected, by its policy or a write error.
+};
+
+/**
+ * @brief Fan-out of one input stream to many subscribers. The data is read
+ * once from the source into pooled buffers, and the same buffers are queued
+ * to all the subscribers, without copying the data.
+ *
+ * The data is written directly to the subscribers that are keeping up. The
+ * rest of the data is queued and written by a writer thread when the
+ * subscriber is writable. The queue of each subscriber is limited, and a
+ * policy decides what to do with a slow subscriber when its queue is full.
+ */
+class ComFanout : private boost::noncopyable
+{
+public:
+    /**
+     * @brief Policy for the subscribers whose queue is full.
+     */
+    enum SlowPolicy
+    {
+        policy_drop,        ///< The new buffers are not delivered to the subscriber.
+        policy_disconnect,  ///< The subscriber is disconnected.
+        policy_block        ///< The source waits until the subscriber has room.
+    };
+
+    /**
+     * @brief Fan-out constructor.
+     * @param source Interface from which the data is read. It must be
+     * opened before Start(). If NULL, the data is only delivered with
+     * Publish(...).
+     * @param buffer_size Maximum number of bytes of each read from the source.
+     */
+    explicit ComFanout(ComInterface *source = NULL, size_t buffer_size = 4096);
+
+    ~ComFanout();
+
+    /**
+     * @brief Start reading the source (in its streaming mode) and the
+     * writer thread.
+     * @return true if it has started, false otherwise.
+     */
+    bool Start();
+
+    /**
+     * @brief Stop reading the source and the writer thread. The queued
+     * data is kept.
+     */
+    void Stop();
+
+    /**
+     * @brief Add a subscriber.
+     * @param sink Opened interface to which the data is written. It must
+     * be unsubscribed before it is closed or destroyed.
+     * @param max_queued Maximum number of bytes waiting for the subscriber.
+     * @param policy Policy when the queue is full.
+     * @return true if the function executes correctly, false otherwise.
+     */
+    bool Subscribe(ComInterface *sink, size_t max_queued = 262144, SlowPolicy policy = policy_drop);
+
+    /**
+     * @brief Remove a subscriber. Its queued data is discarded.
+     * @param sink Subscriber.
+     * @return true if the function executes correctly, false otherwise.
+     */
+    bool Unsubscribe(ComInterface *sink);
+
+    /**
+     * @brief Get the number of subscribers, including the disconnected ones.
+     * @return Number of subscribers.
+     */
+    size_t GetSubscribers();
+
+    /**
+     * @brief Get the statistics of a subscriber.
+     * @param sink Subscriber.
+     * @param stats Statistics.
+     * @return true if the function executes correctly, false otherwise.
+     */
+    bool GetStats(ComInterface *sink, ComFanoutStats& stats);
+
+    /**
+     * @brief Deliver a buffer to all the subscribers. It is called with
+     * the data read from the source, and it can also be called directly.
+     * @param buffer Data. It must not be modified after the call, because
+     * it is shared by the queues of the subscribers.
+     */
+    void Publish(const ComBuffer& buffer);
+
+private:
+    /**
+     * @brief Subscriber of the fan-out.
+     */
+    struct Subscriber
+    {
+        ComInterface *sink;                 ///< Interface to which the data is written.
+        int handle;                         ///< Native handle to wait until it is writable, or -1.
+        size_t max_queued;                  ///< Maximum number of bytes of the queue.
+        SlowPolicy policy;                  ///< Policy when the queue is full.
+        std::deque<ComBuffer> queue;        ///< Buffers pending to be written.
+        size_t offset;                      ///< Bytes already written of the first buffer.
+        bool writing;                       ///< The writer thread is in a blocking write to the sink.
+        ComFanoutStats stats;               ///< Statistics.
+    };
+
+    typedef boost::shared_ptr<Subscriber> SubscriberPtr;
+    typedef std::map<ComInterface *, SubscriberPtr> SubscriberMap;
+
+    ComInterface *m_source;                 ///< Interface from which the data is read.
+    size_t m_buffer_size;                   ///< Maximum number of bytes of each read.
+    SubscriberMap m_subscribers;            ///< Subscribers.
+    boost::thread m_writer;                 ///< Writer thread.
+    bool m_running;                         ///< The fan-out has been started.
+    bool m_stop;                            ///< The writer thread must finish.
+    ComEvent m_wake;                        ///< Wakes up the writer thread while it waits on the subscribers.
+    boost::mutex m_mutex;                   ///< Mutex of the subscribers.
+    boost::condition_variable m_work_cond;  ///< Signals that there is queued data.
+    boost::condition_variable m_room_cond;  ///< Signals that a queue has room for the blocked sources.
+
+    /**
+     * @brief Write the queued data that the subscriber accepts without
+     * blocking. The mutex must be locked.
+     * @param subscriber Subscriber.
+     */
+    void flush(Subscriber& subscriber);
+
+    /**
+     * @brief Disconnect a subscriber, discarding its queue. The mutex must be locked.
+     * @param subscriber Subscriber.
+     */
+    void disconnect(Subscriber& subscriber);
+
+    /**
+     * @brief Body of the writer thread.
+     */
+    void writer();
+};
+
+#endif // _COMFANOUT_HPP_
@@ -0,0 +1,215 @@
+/**
+ * @file    comfaultinjector.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Communication interface decorator that injects faults.
+ */
+
+#ifndef _COMFAULTINJECTOR_HPP_
+#define _COMFAULTINJECTOR_HPP_
+
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "cominterface/cominterface.hpp"
+#include "cominterface/comclock.hpp"
+
+/**
+ * @brief Faults injected in one direction of a ComFaultInjector. The
+ * probabilities are from 0 (never) to 1 (always), and they are checked in
+ * each operation, except the corruption, that is checked for each byte.
+ */
+struct ComFaultConfig
+{
+    ComFaultConfig() : latency(0), jitter(0), short_rate(0), corrupt_rate(0),
+                       drop_rate(0), timeout_rate(0), disconnect_rate(0) {}
+
+    unsigned int latency;       ///< Delay in milliseconds added to each operation.
+    unsigned int jitter;        ///< Maximum random delay in milliseconds added to the latency.
+    double short_rate;          ///< Probability of transferring only part of the requested bytes.
+    double corrupt_rate;        ///< Probability of flipping a bit of each transferred byte.
+    double drop_rate;           ///< Probability of losing the data of an operation.
+    double timeout_rate;        ///< Probability of an operation expiring without transferring data.
+    double disconnect_rate;     ///< Probability of closing the interface in an operation.
+};
+
+/**
+ * @brief Number of faults injected by a ComFaultInjector.
+ */
+struct ComFaultStats
+{
+    ComFaultStats() : delays(0), shorts(0), corrupted_bytes(0), drops(0),
+                      timeouts(0), disconnects(0) {}
+
+    unsigned long long delays;          ///< Operations delayed.
+    unsigned long long shorts;          ///< Operations shortened.
+    unsigned long long corrupted_bytes; ///< Bytes with a flipped bit.
+    unsigned long long drops;           ///< Operations whose data has been lost.
+    unsigned long long timeouts;        ///< Operations expired.
+    unsigned long long disconnects;     ///< Closes of the interface.
+};
+
+/**
+ * @brief Decorator of a communication interface (a ComSerial, a ComSocket,
+ * a ComPipeEnd...) that injects latency, jitter, short reads and writes,
+ * corrupted bytes, lost data, timeouts and disconnections, to measure the
+ * performance and test the recovery of the protocols under bad conditions.
+ *
+ * The faults are drawn from a pseudo-random generator with a fixed seed,
+ * so a run that performs the same operations in the same order injects
+ * the same faults.
+ * - A dropped write reports the bytes as written but doesn't send them.
+ * - A dropped read discards the received bytes and returns 0.
+ * - An expired blocking operation waits for its timeout and returns 0.
+ * - A disconnection closes the decorated interface and returns -1.
+ * @note The decorated interface must outlive the decorator. When several
+ * threads use the decorator, the order in which they draw the faults
+ * depends on the scheduling.
+ */
+class ComFaultInjector : public ComInterface
+{
+public:
+    /**
+     * @brief Fault injector constructor. It starts without faults.
+     * @param target Decorated interface.
+     * @param seed Seed of the pseudo-random generator.
+     */
+    explicit ComFaultInjector(ComInterface *target, unsigned int seed = 5489);
+
+    virtual ~ComFaultInjector();
+
+    virtual bool Open();
+
+    virtual bool Close();
+
+    virtual bool Opened();
+
+    virtual int ReadSome(void *buffer_in, size_t len);
+
+    virtual int WriteSome(const void *buffer_out, size_t len);
+
+    virtual int Read(void *buffer_in, size_t len);
+
+    virtual int Write(const void *buffer_out, size_t len);
+
+    /**
+     * @brief Abort the current operation on the decorated interface and the
+     * injected delays.
+     */
+    virtual void Abort();
+
+    virtual bool SetWriteTimeout(unsigned int write_timeout);
+
+    virtual unsigned int GetWriteTimeout();
+
+    virtual bool SetReadTimeout(unsigned int read_timeout);
+
+    virtual unsigned int GetReadTimeout();
+
+    virtual int GetNativeHandle();
+
+    virtual int GetReadinessHandle();
+
+    virtual bool SetReceiveBufferSize(size_t size);
+
+    virtual size_t GetReceiveBufferSize();
+
+    /**
+     * @brief Set the clock of the injected delays and timeouts, and of the
+     * decorated interface. The decorated interface keeps its clock if it
+     * doesn't support other clocks.
+     */
+    virtual bool SetClock(ComClock *clock);
+
+    /**
+     * @brief Set the faults injected in the reads.
+     * @param config Faults.
+     * @return true if the function executes correctly, false if a
+     * probability is out of range.
+     */
+    bool SetReadFaults(const ComFaultConfig& config);
+
+    /**
+     * @brief Set the faults injected in the writes.
+     * @param config Faults.
+     * @return true if the function executes correctly, false if a
+     * probability is out of range.
+     */
+    bool SetWriteFaults(const ComFaultConfig& config);
+
+    /**
+     * @brief Restart the pseudo-random generator, to repeat a sequence of faults.
+     * @param seed Seed of the pseudo-random generator.
+     */
+    void Reseed(unsigned int seed);
+
+    /**
+     * @brief Get the number of injected faults.
+     * @param stats Statistics.
+     */
+    void GetStats(ComFaultStats& stats);
+
+private:
+    /**
+     * @brief Faults drawn for an operation.
+     */
+    struct Plan
+    {
+        unsigned int delay;     ///< Delay in milliseconds.
+        size_t len;             ///< Number of bytes to transfer.
+        bool drop;              ///< The data is lost.
+        bool timeout;           ///< The operation expires.
+        bool disconnect;        ///< The interface is closed.
+        bool corrupt;           ///< The data can be corrupted.
+    };
+
+    ComInterface *m_target;             ///< Decorated interface.
+    ComFaultConfig m_read_faults;       ///< Faults of the reads.
+    ComFaultConfig m_write_faults;      ///< Faults of the writes.
+    boost::random::mt19937 m_random;    ///< Generator of the faults.
+    ComFaultStats m_stats;              ///< Number of injected faults.
+    unsigned int m_abort;               ///< Number of calls to Abort(), to interrupt the delays.
+    boost::mutex m_mutex;               ///< Mutex of the configuration, the generator and the statistics.
+    boost::condition_variable m_cond;   ///< Signals the aborts to the delays.
+    ComClock *m_clock;                  ///< Clock of the delays.
+
+    /**
+     * @brief Draw the faults of an operation.
+     * @param read The operation is a read.
+     * @param len Number of requested bytes.
+     * @return Faults of the operation.
+     */
+    Plan plan(bool read, size_t len);
+
+    /**
+     * @brief Flip a bit of some bytes.
+     * @param read The data has been read.
+     * @param data Data.
+     * @param len Number of bytes.
+     */
+    void corrupt(bool read, unsigned char *data, size_t len);
+
+    /**
+     * @brief Wait for a time, unless the operations are aborted.
+     * @param time Time in milliseconds.
+     * @return true if the time has elapsed, false if aborted.
+     */
+    bool wait(unsigned int time);
+
+    /**
+     * @brief Get a random number between 0 and 1. The mutex must be locked.
+     * @return Random number.
+     */
+    double uniform();
+
+    /**
+     * @brief Check if a configuration is valid.
+     * @param config Faults.
+     * @return true if the probabilities are between 0 and 1.
+     */
+    static bool valid(const ComFaultConfig& config);
+};
+
+#endif // _COMFAULTINJECTOR_HPP_
@@ -0,0 +1,274 @@
+/**
+ * @file    comfec.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Forward error correction over a communication interface.
+ */
+
+#ifndef _COMFEC_HPP_
+#define _COMFEC_HPP_
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "cominterface/cominterface.hpp"
+#include "cominterface/comclock.hpp"
+#include "cominterface/comevent.hpp"
+
+/**
+ * @brief Statistics of a ComFec.
+ */
+struct ComFecStats
+{
+    ComFecStats() : blocks_sent(0), frames_sent(0), blocks_received(0), blocks_recovered(0),
+                    blocks_lost(0), frames_received(0), bad_frames(0) {}
+
+    unsigned long long blocks_sent;         ///< Blocks written to the link.
+    unsigned long long frames_sent;         ///< Frames written to the link, data and parity.
+    unsigned long long blocks_received;     ///< Blocks delivered to the reader.
+    unsigned long long blocks_recovered;    ///< Blocks delivered with data rebuilt from the parity.
+    unsigned long long blocks_lost;         ///< Blocks discarded because too many frames were lost.
+    unsigned long long frames_received;     ///< Valid frames received.
+    unsigned long long bad_frames;          ///< Frames discarded by their CRC or their format.
+};
+
+/**
+ * @brief Forward error correction over a link where the data can't be
+ * retransmitted, e.g. a one-way radio modem. It exposes the link as a
+ * byte stream that survives the loss of some frames.
+ *
+ * Each write is split in blocks of up to data_shards frames of shard_size
+ * bytes, and parity_shards frames are added to each block with a
+ * systematic Reed-Solomon erasure code over GF(2^8) (a Cauchy matrix). A
+ * block is rebuilt from any data_shards of its frames, so up to
+ * parity_shards frames of each block can be lost or corrupted.
+ *
+ * The frames are delimited with HDLC byte stuffing and checked with a
+ * CRC-16, and each one is written with its own write of the link, so a
+ * link that loses packets loses whole frames. The frames describe their
+ * block, so the redundancy can be changed while the link is used and the
+ * receiver adapts to it.
+ *
+ * The products of GF(2^8) are computed with table lookups, 16 or 32 bytes
+ * at a time with SSSE3 or AVX2 shuffles when the processor supports them.
+ * @note The blocks that can't be rebuilt are discarded, so the stream has
+ * gaps at them. Both ends must use the same maximum shard size.
+ */
+class ComFec : public ComInterface
+{
+public:
+    static const size_t header_size = 11;   ///< Bytes of the header of a frame.
+    static const size_t max_shards = 256;   ///< Maximum number of frames of a block, data and parity.
+
+    /**
+     * @brief Forward error correction constructor.
+     * @param link Interface that carries the frames. It must outlive the decorator.
+     * @param data_shards Number of data frames of each block, from 1.
+     * @param parity_shards Number of parity frames of each block, 0 to
+     * disable the correction. The total must not exceed max_shards.
+     * @param shard_size Maximum number of bytes of data of each frame.
+     */
+    ComFec(ComInterface *link, size_t data_shards = 16, size_t parity_shards = 4,
+           size_t shard_size = 256);
+
+    virtual ~ComFec();
+
+    /**
+     * @brief Open the link, if it is not opened, and start receiving frames.
+     */
+    virtual bool Open();
+
+    /**
+     * @brief Stop receiving frames and close the link. The data of an
+     * incomplete block is discarded.
+     */
+    virtual bool Close();
+
+    virtual bool Opened();
+
+    virtual int ReadSome(void *buffer_in, size_t len);
+
+    /**
+     * @brief The data is always written in complete blocks, so it is the
+     * same as Write().
+     */
+    virtual int WriteSome(const void *buffer_out, size_t len);
+
+    virtual int Read(void *buffer_in, size_t len);
+
+    /**
+     * @brief Encode the data and write its blocks to the link. The last
+     * block is shortened, so the data is sent without waiting for more.
+     * @return Number of bytes of the blocks written completely, or -1 if
+     * the link fails before writing any block.
+     */
+    virtual int Write(const void *buffer_out, size_t len);
+
+    virtual void Abort();
+
+    virtual bool SetWriteTimeout(unsigned int write_timeout);
+
+    virtual unsigned int GetWriteTimeout();
+
+    virtual bool SetReadTimeout(unsigned int read_timeout);
+
+    virtual unsigned int GetReadTimeout();
+
+    /**
+     * @brief Get an event that is readable while there is received data or
+     * the link has failed, for the external event loops.
+     */
+    virtual int GetReadinessHandle();
+
+    /**
+     * @brief Set the clock of the timeouts of the reads, and of the link.
+     */
+    virtual bool SetClock(ComClock *clock);
+
+    /**
+     * @brief Set the redundancy of the next blocks.
+     * @param data_shards Number of data frames of each block, from 1.
+     * @param parity_shards Number of parity frames of each block. The
+     * total must not exceed max_shards.
+     * @return true if the function executes correctly, false if the
+     * numbers are not valid.
+     */
+    bool SetRedundancy(size_t data_shards, size_t parity_shards);
+
+    /**
+     * @brief Get the statistics of the correction.
+     * @param stats Statistics.
+     */
+    void GetStats(ComFecStats& stats);
+
+    /**
+     * @brief Get the implementation of the GF(2^8) products.
+     * @return "avx2", "ssse3" or "scalar".
+     */
+    static std::string GetKernel();
+
+    /**
+     * @brief Select the implementation of the GF(2^8) products, e.g. to
+     * compare them. By default, the fastest one supported by the processor
+     * is used. It is thread safe: the blocks being encoded or decoded by
+     * other threads may combine both implementations, with the same result.
+     * @param kernel "avx2", "ssse3" or "scalar".
+     * @return true if the function executes correctly, false if the
+     * implementation is unknown or not supported by the processor.
+     */
+    static bool SetKernel(const std::string& kernel);
+
+    /**
+     * @brief Compute the parity shards of a block. It is used by Write(),
+     * and it is public to measure the speed of the encoding.
+     * @param data Data shards, of size bytes each.
+     * @param data_shards Number of data shards.
+     * @param parity Buffer that will contain the parity shards, of size
+     * bytes each.
+     * @param parity_shards Number of parity shards.
+     * @param size Number of bytes of each shard.
+     */
+    static void Encode(const unsigned char *data, size_t data_shards,
+                       unsigned char *parity, size_t parity_shards, size_t size);
+
+private:
+    /**
+     * @brief Block being received.
+     */
+    struct Block
+    {
+        bool valid;                                 ///< A block is being received.
+        bool done;                                  ///< The block has been delivered.
+        boost::uint16_t number;                     ///< Number of the block.
+        size_t data_shards;                         ///< Number of data frames.
+        size_t parity_shards;                       ///< Number of parity frames.
+        size_t size;                                ///< Bytes of each shard.
+        size_t bytes;                               ///< Bytes of data of the block.
+        size_t count;                               ///< Number of frames received.
+        std::vector<unsigned char> shards;          ///< Shards, padded with zeros to size bytes.
+        std::vector<bool> present;                  ///< Received shards.
+    };
+
+    ComInterface *m_link;                           ///< Interface that carries the frames.
+    size_t m_data_shards;                           ///< Number of data frames of the next blocks.
+    size_t m_parity_shards;                         ///< Number of parity frames of the next blocks.
+    size_t m_shard_size;                            ///< Maximum number of bytes of data of a frame.
+
+    // Sender
+    boost::uint16_t m_next_block;                   ///< Number of the next block to send.
+    std::vector<unsigned char> m_encode;            ///< Data and parity shards of the block being sent.
+    std::vector<unsigned char> m_frame;             ///< Frame being sent, with its stuffing.
+    boost::mutex m_write_mutex;                     ///< Serializes the writes, so their blocks are not mixed.
+
+    // Receiver
+    std::deque<unsigned char> m_rx;                 ///< Received data pending to be read.
+    Block m_block;                                  ///< Block being received.
+    std::vector<unsigned char> m_parse;             ///< Frame being received, without stuffing.
+    bool m_escape;                                  ///< The previous byte was an escape.
+    bool m_overflow;                                ///< The frame being received is too large.
+
+    ComFecStats m_stats;                            ///< Statistics.
+    bool m_running;                                 ///< The frames are being received.
+    bool m_failed;                                  ///< The link has failed or it has been closed.
+    unsigned int m_abort;                           ///< Number of calls to Abort(), to interrupt the waits.
+    unsigned int m_read_timeout;                    ///< Timeout of the Read operations in milliseconds.
+    ComEvent m_readable;                            ///< Event set while there is received data or the link has failed.
+    ComClock *m_clock;                              ///< Clock of the timeouts.
+    boost::mutex m_mutex;                           ///< Mutex of the receiver and the configuration.
+    boost::condition_variable m_rx_cond;            ///< Signals the received data.
+
+    /**
+     * @brief Stop the streaming of the link.
+     */
+    void stop();
+
+    /**
+     * @brief Take received data. The mutex must be locked.
+     * @param buffer_in Buffer that will contain the received data.
+     * @param len Maximum number of bytes to take.
+     * @return Number of bytes taken.
+     */
+    size_t take(void *buffer_in, size_t len);
+
+    /**
+     * @brief Write a frame to the link, with its stuffing and CRC. The
+     * write mutex must be locked.
+     * @param header Header of the frame.
+     * @param payload Shard.
+     * @param len Number of bytes of the shard.
+     * @return true if the frame is written, false if the link fails.
+     */
+    bool send_frame(const unsigned char *header, const unsigned char *payload, size_t len);
+
+    /**
+     * @brief Remove the byte stuffing of the data received by the link and
+     * process the complete frames.
+     * @param buffer Received data.
+     */
+    void receive_handler(const ComBuffer& buffer);
+
+    /**
+     * @brief Mark the link as failed and wake up the reads.
+     */
+    void failure_handler();
+
+    /**
+     * @brief Process a received frame. The mutex must be locked.
+     * @param frame Frame without stuffing.
+     * @param len Number of bytes of the frame.
+     */
+    void process_frame(const unsigned char *frame, size_t len);
+
+    /**
+     * @brief Rebuild the lost data shards of the current block and deliver
+     * its data. The mutex must be locked.
+     */
+    void deliver();
+};
+
+#endif // _COMFEC_HPP_
@@ -8,8 +8,47 @@
 #ifndef _COMINTERFACE_HPP_
 #define _COMINTERFACE_HPP_
 
+#include <cstring>
 #include <string>
 
+#include <boost/function.hpp>
+#include <boost/static_assert.hpp>
+
+#include "cominterface/combuffer.hpp"
+#include "cominterface/comreceivetuner.hpp"
+
+class ComClock;
+class ComStreamer;
+template <typename Layout> class ComMessage;
+
+/**
+ * @brief Callbacks of the streaming mode of a ComInterface.
+ */
+struct ComStreamHandlers
+{
+    ComStreamHandlers() : buffer_size(4096), auto_tune(false) {}
+
+    boost::function<void (const ComBuffer&)> on_data;   ///< Called with each chunk of received data.
+    boost::function<void ()> on_error;                  ///< Called when a read fails. The streaming stops.
+    boost::function<void ()> on_closed;                 ///< Called when the interface or the connection is closed. The streaming stops.
+
+    /**
+     * @brief Optional executor where the callbacks are run. It receives the
+     * callback to run, bound to its arguments. If empty, the callbacks are
+     * run in the I/O thread of the interface.
+     */
+    boost::function<void (const boost::function<void ()>&)> executor;
+
+    size_t buffer_size;                                 ///< Maximum number of bytes of each chunk.
+
+    /**
+     * @brief Adapt the size of the reads, between 64 bytes and buffer_size,
+     * and the kernel receive buffer to the received traffic (see
+     * ComReceiveTuner). If false, all the reads request buffer_size bytes.
+     */
+    bool auto_tune;
+};
+
 /**
  * @brief   Base interface for various specific communication
  *          interfaces. It allows to use polymorphism.
@@ -17,11 +56,15 @@
 class ComInterface
 {
 public:
+    ComInterface() : m_streamer(NULL) {}
+
     /**
      * @brief Virtual destructor for the interface.
      * It is necessary for polymorphism.
+     * @note Derived classes must call StopStreaming() in their destructor,
+     * because the streaming thread uses their virtual functions.
      */
-    virtual ~ComInterface() {};
+    virtual ~ComInterface();
 
     /**
      * @brief Open the interface.
@@ -75,6 +118,166 @@ public:
      */
     virtual int Write(const void *buffer_out, size_t len) = 0;
 
+    /**
+     * @brief Non blocking read into a buffer taken from a pool.
+     * The received buffer can be shared later without copying the data.
+     * @param pool Pool from which the buffer is taken.
+     * @param len Number of bytes to read.
+     * @param buffer Buffer that will contain the received data. Its size
+     * is set to the number of bytes read.
+     * @return Number of bytes read or -1 in case of error.
+     */
+    int ReadSomeBuffer(ComBufferPool& pool, size_t len, ComBuffer& buffer)
+    {
+        buffer = pool.Allocate(len);
+
+        if (!buffer.Valid())
+            return -1;
+
+        int ret_code = ReadSome(buffer.Data(), len);
+
+        buffer.SetSize(ret_code > 0 ? ret_code : 0);
+
+        return ret_code;
+    }
+
+    /**
+     * @brief Non blocking write of a pooled buffer. The interface keeps a
+     * reference to the buffer while it needs the data.
+     * @param buffer Buffer that contains the data to be transmitted.
+     * @return Number of bytes written or -1 in case of error.
+     */
+    int WriteSomeBuffer(const ComBuffer& buffer)
+    {
+        return WriteSome(buffer.Data(), buffer.Size());
+    }
+
+    /**
+     * @brief Blocking read into a buffer taken from a pool. It waits until
+     * the indicated number of bytes are received or the timeout expires.
+     * The received buffer can be shared later without copying the data.
+     * @param pool Pool from which the buffer is taken.
+     * @param len Number of bytes to read.
+     * @param buffer Buffer that will contain the received data. Its size
+     * is set to the number of bytes read.
+     * @return Number of bytes read or -1 in case of error.
+     */
+    int ReadBuffer(ComBufferPool& pool, size_t len, ComBuffer& buffer)
+    {
+        buffer = pool.Allocate(len);
+
+        if (!buffer.Valid())
+            return -1;
+
+        int ret_code = Read(buffer.Data(), len);
+
+        buffer.SetSize(ret_code > 0 ? ret_code : 0);
+
+        return ret_code;
+    }
+
+    /**
+     * @brief Blocking write of a pooled buffer. It waits until the whole
+     * buffer is transmitted or the timeout expires. The interface keeps a
+     * reference to the buffer while it needs the data.
+     * @param buffer Buffer that contains the data to be transmitted.
+     * @return Number of bytes written or -1 in case of error.
+     */
+    int WriteBuffer(const ComBuffer& buffer)
+    {
+        return Write(buffer.Data(), buffer.Size());
+    }
+
+    /**
+     * @brief Blocking write of a message with a wire layout (see
+     * comlayout.hpp). It is written from its buffer, without copying it.
+     * @param message Message to be transmitted.
+     * @return Number of bytes written or -1 in case of error.
+     */
+    template <typename Layout>
+    int Send(const ComMessage<Layout>& message)
+    {
+        if (!message.Valid())
+            return -1;
+
+        return Write(message.Data(), message.Size());
+    }
+
+    /**
+     * @brief Blocking read of a message with a wire layout (see
+     * comlayout.hpp). It reads the fixed fields, and then the variable
+     * field of the size given by its length field into a pooled buffer,
+     * where the fields are accessed in place.
+     * @param pool Pool from which the buffer is taken.
+     * @param message Message that will contain the received data.
+     * @param max_size Maximum number of bytes of the message.
+     * @return Number of bytes of the message, 0 if the timeout expires
+     * before any byte is received, or -1 in case of error or if the message
+     * is incomplete or longer than max_size.
+     */
+    template <typename Layout>
+    int Receive(ComBufferPool& pool, ComMessage<Layout>& message, size_t max_size = 65536)
+    {
+        // The size of the message must be known from its fixed fields
+        BOOST_STATIC_ASSERT(Layout::Tail::sized);
+
+        // The fixed fields are read first to know the size of the buffer
+        unsigned char fixed[Layout::size];
+        int ret_code = Read(fixed, Layout::size);
+
+        if (ret_code <= 0)
+            return ret_code;
+
+        if (static_cast<size_t>(ret_code) != Layout::size)
+            return -1;
+
+        size_t size = Layout::size + Layout::Tail::Size(fixed, Layout::size);
+
+        if (size > max_size)
+            return -1;
+
+        ComBuffer buffer = pool.Allocate(size);
+
+        if (!buffer.Valid())
+            return -1;
+
+        std::memcpy(buffer.Data(), fixed, Layout::size);
+
+        if (size > Layout::size &&
+            Read(buffer.Data() + Layout::size, size - Layout::size) != static_cast<int>(size - Layout::size))
+            return -1;
+
+        buffer.SetSize(size);
+        message = ComMessage<Layout>(buffer);
+
+        return static_cast<int>(size);
+    }
+
+    /**
+     * @brief Blocking read of the available data. It waits until some bytes
+     * are received or the timeout expires, and returns the received bytes
+     * without waiting for the whole buffer to be filled. If the read
+     * coalescing is enabled, it waits for a batch of bytes.
+     * @param buffer_in Buffer that will contain the received data.
+     * @param len Maximum number of bytes to read.
+     * @return Number of bytes read or -1 in case of error.
+     */
+    virtual int ReadBatch(void *buffer_in, size_t len)
+    {
+        if (len == 0)
+            return 0;
+
+        // Wait for the first byte and take the rest of available bytes
+        int ret_code = Read(buffer_in, 1);
+
+        if (ret_code <= 0 || len == 1)
+            return ret_code;
+
+        int more = ReadSome(static_cast<char *>(buffer_in) + 1, len - 1);
+
+        return more < 0 ? -1 : ret_code + more;
+    }
+
     /**
      * @brief Abort the current operation on the interface.
      */
@@ -106,11 +309,167 @@ public:
      */
     virtual unsigned int GetReadTimeout() = 0;
 
+    /**
+     * @brief Set the wake-up coalescing of ReadBatch(...). When the data
+     * arrives in small bursts, ReadBatch(...) waits until a batch of bytes
+     * is available instead of returning each burst, bounding the added
+     * latency.
+     * @param min_batch Number of bytes that ends the wait. 1 disables
+     * the coalescing.
+     * @param max_latency Maximum time in milliseconds that the received
+     * data waits for the batch to be completed. 0 disables the coalescing.
+     * @return true if the function executes correctly, false otherwise.
+     */
+    virtual bool SetReadCoalescing(size_t min_batch, unsigned int max_latency)
+    {
+        return min_batch != 0 && (min_batch == 1 || max_latency == 0);
+    }
+
+    /**
+     * @brief Get the operating system descriptor of the interface.
+     * @return Descriptor, or -1 if the interface is closed or it has no
+     * descriptor that can be waited on (e.g. in Windows).
+     */
+    virtual int GetNativeHandle() { return -1; }
+
+    /**
+     * @brief Set the size of the kernel receive buffer (SO_RCVBUF).
+     * @param size Size in bytes.
+     * @return true if the function executes correctly, false if the
+     * interface doesn't have a kernel receive buffer.
+     */
+    virtual bool SetReceiveBufferSize(size_t /*size*/) { return false; }
+
+    /**
+     * @brief Get the size of the kernel receive buffer.
+     * @return Size in bytes, or 0 if it is not available.
+     */
+    virtual size_t GetReceiveBufferSize() { return 0; }
+
+    /**
+     * @brief Set the clock that measures the timeouts of the interface,
+     * e.g. a ComVirtualClock to test them without waiting.
+     * @param clock Clock, or NULL for the system clock. It must outlive
+     * the interface.
+     * @return true if the function executes correctly, false if the
+     * interface doesn't support other clocks.
+     * @note It must not be called while an operation is in progress.
+     */
+    virtual bool SetClock(ComClock * /*clock*/) { return false; }
+
+    /**
+     * @brief Get the sizes chosen by the auto-tuning of the receive buffers
+     * of the streaming or event loop mode (ComStreamHandlers::auto_tune).
+     * They are kept after the mode stops, until it starts again.
+     * @param stats Statistics.
+     * @return true if the function executes correctly, false if the
+     * auto-tuning has not been enabled.
+     */
+    bool GetReceiveStats(ComReceiveStats& stats);
+
+    /**
+     * @brief Start the streaming mode. An I/O thread keeps a read outstanding
+     * on the interface and calls the handlers as the data arrives, so it is
+     * not necessary to poll ReadSome(...).
+     * If the interface has a native handle, the thread sleeps on it and
+     * the interface is not locked while waiting, so it can still be written.
+     * Else, it waits with ReadBatch(...).
+     * @param handlers Callbacks for the received data and the events.
+     * @return true if the streaming has started, false otherwise.
+     * @note The received buffers belong to a pool of the interface, so
+     * they must be released before the interface is destroyed.
+     */
+    bool StartStreaming(const ComStreamHandlers& handlers);
+
+    /**
+     * @brief Stop the streaming mode and wait for the I/O thread to finish.
+     * If it is called from a callback, it only signals the I/O thread.
+     */
+    void StopStreaming();
+
+    /**
+     * @brief Check if the streaming mode is running.
+     * @return true if it is running, false otherwise.
+     */
+    bool Streaming();
+
+    /**
+     * @brief Get the descriptor that an external event loop must watch to
+     * know when the interface has data to read. It is the native handle,
+     * unless the interface keeps received data in its own buffers, that
+     * returns an event that is readable while there is buffered data.
+     * @return Descriptor, or -1 if it is not available.
+     */
+    virtual int GetReadinessHandle() { return GetNativeHandle(); }
+
+    /**
+     * @brief Let an external event loop (epoll, libuv, Qt...) drive the
+     * interface, without an I/O thread. The loop watches GetReadinessHandle()
+     * and calls OnReadable() when it is readable. While WantsWrite(), it also
+     * watches the native handle and calls OnWritable() when it is writable.
+     * @param handlers Callbacks for the received data and the events.
+     * They are called from OnReadable().
+     * @return true if OK, false if the interface is closed or streaming.
+     */
+    bool AttachEventLoop(const ComStreamHandlers& handlers);
+
+    /**
+     * @brief Stop delivering the received data to the handlers of
+     * AttachEventLoop(...).
+     */
+    void DetachEventLoop();
+
+    /**
+     * @brief Process the readable event of an external event loop. It reads
+     * all the available data with non blocking reads, so it is also valid
+     * for edge triggered loops, and passes it to on_data.
+     * @return Number of bytes read or -1 in case of error. On error, the
+     * interface is detached and on_closed or on_error is called.
+     */
+    int OnReadable();
+
+    /**
+     * @brief Process the writable event of an external event loop. It
+     * writes the data queued by WriteQueued(...) that the interface accepts.
+     * @return Number of bytes written or -1 in case of error.
+     */
+    int OnWritable();
+
+    /**
+     * @brief Non blocking write that never loses data. It writes what the
+     * interface accepts now and keeps a reference to the rest of the buffer,
+     * that is written by OnWritable().
+     * @param buffer Buffer that contains the data to be transmitted.
+     * @return Number of bytes accepted (the size of the buffer) or -1 in
+     * case of error.
+     */
+    int WriteQueued(const ComBuffer& buffer);
+
+    /**
+     * @brief Check if there is queued data waiting for the interface to be
+     * writable.
+     * @return true if the event loop must call OnWritable(), false otherwise.
+     */
+    bool WantsWrite();
+
+    /**
+     * @brief Get the number of bytes queued by WriteQueued(...).
+     * @return Number of bytes.
+     */
+    size_t GetQueuedBytes();
+
     /**
      * @brief Get the version of the library.
      * @return Version in format "X.X.X".
      */
     std::string GetVersion() { return std::string("0.1.0"); }
+
+private:
+    ComStreamer *m_streamer;    ///< State of the streaming and event loop modes, created on its first use.
+
+    // The interfaces can't be copied
+    ComInterface(const ComInterface&);
+    ComInterface& operator=(const ComInterface&);
 };
 
 #endif // _COMINTERFACE_HPP_
@@ -0,0 +1,368 @@
+/**
+ * @file    comlayout.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Wire layouts of messages, accessed in place.
+ */
+
+#ifndef _COMLAYOUT_HPP_
+#define _COMLAYOUT_HPP_
+
+#include <cstring>
+
+#include <boost/cstdint.hpp>
+#include <boost/endian/conversion.hpp>
+
+#include "cominterface/cominterface.hpp"
+
+/**
+ * @brief Byte order of a field.
+ */
+enum ComByteOrder
+{
+    com_big_endian,     ///< Most significant byte first (network order).
+    com_little_endian   ///< Least significant byte first.
+};
+
+/**
+ * @brief Unsigned integer of a number of bytes, to move the bits of the
+ * fields.
+ */
+template <size_t Size>
+struct ComWord;
+
+template <>
+struct ComWord<1>
+{
+    typedef boost::uint8_t type;
+};
+
+template <>
+struct ComWord<2>
+{
+    typedef boost::uint16_t type;
+};
+
+template <>
+struct ComWord<4>
+{
+    typedef boost::uint32_t type;
+};
+
+template <>
+struct ComWord<8>
+{
+    typedef boost::uint64_t type;
+};
+
+/**
+ * @brief Field of a fixed size: an integer or a floating point number.
+ *
+ * The fields of a layout are chained through their offsets, so the offset
+ * of a field is the end of the previous one:
+ * @code
+ * struct Telemetry
+ * {
+ *     typedef ComField<boost::uint16_t, 0> Id;
+ *     typedef ComField<boost::uint32_t, Id::end, com_little_endian> Time;
+ *     typedef ComField<float, Time::end> Value;
+ *     typedef ComField<boost::uint16_t, Value::end> Length;
+ *     typedef ComTail<Length::end, Length> Tail;
+ *
+ *     static const size_t size = Tail::offset;
+ * };
+ * @endcode
+ * @tparam T Type of the value. Its size must be 1, 2, 4 or 8 bytes.
+ * @tparam Offset Position of the field in the message.
+ * @tparam Order Byte order of the field.
+ */
+template <typename T, size_t Offset, ComByteOrder Order = com_big_endian>
+struct ComField
+{
+    typedef T value_type;
+
+    static const size_t offset = Offset;            ///< Position of the field.
+    static const size_t end = Offset + sizeof(T);   ///< Position after the field.
+
+    /**
+     * @brief Read the field of a message.
+     * @param message Start of the message.
+     * @return Value of the field.
+     */
+    static T Load(const unsigned char *message)
+    {
+        typename ComWord<sizeof(T)>::type word;
+        T value;
+
+        std::memcpy(&word, message + Offset, sizeof(word));
+
+        if (Order == com_big_endian)
+            boost::endian::big_to_native_inplace(word);
+        else
+            boost::endian::little_to_native_inplace(word);
+
+        std::memcpy(&value, &word, sizeof(value));
+
+        return value;
+    }
+
+    /**
+     * @brief Write the field of a message.
+     * @param message Start of the message.
+     * @param value Value of the field.
+     */
+    static void Store(unsigned char *message, T value)
+    {
+        typename ComWord<sizeof(T)>::type word;
+
+        std::memcpy(&word, &value, sizeof(word));
+
+        if (Order == com_big_endian)
+            boost::endian::native_to_big_inplace(word);
+        else
+            boost::endian::native_to_little_inplace(word);
+
+        std::memcpy(message + Offset, &word, sizeof(word));
+    }
+};
+
+/**
+ * @brief Field of a fixed number of bytes, e.g. a name or an address. It
+ * is read as a pointer to the message, without copying it.
+ * @tparam Size Number of bytes.
+ * @tparam Offset Position of the field in the message.
+ */
+template <size_t Size, size_t Offset>
+struct ComArray
+{
+    typedef const unsigned char *value_type;
+
+    static const size_t offset = Offset;            ///< Position of the field.
+    static const size_t end = Offset + Size;        ///< Position after the field.
+
+    /**
+     * @brief Get the bytes of the field of a message.
+     * @param message Start of the message.
+     * @return Pointer to the field, inside the message.
+     */
+    static const unsigned char *Load(const unsigned char *message)
+    {
+        return message + Offset;
+    }
+
+    /**
+     * @brief Copy the bytes of the field of a message.
+     * @param message Start of the message.
+     * @param value Size bytes.
+     */
+    static void Store(unsigned char *message, const unsigned char *value)
+    {
+        std::memcpy(message + Offset, value, Size);
+    }
+};
+
+/**
+ * @brief Variable field at the end of a layout, whose size is given by a
+ * length field of the layout.
+ * @tparam Offset Position of the field, the size of the fixed fields.
+ * @tparam Length Field with the number of bytes of the variable field, or
+ * void if the variable field takes the rest of the message (e.g. a datagram).
+ */
+template <size_t Offset, typename Length = void>
+struct ComTail
+{
+    static const size_t offset = Offset;    ///< Position of the field.
+    static const bool sized = true;         ///< The fixed fields give the size of the message.
+
+    /**
+     * @brief Get the number of bytes of the field of a message.
+     * @param message Start of the message, with its fixed fields.
+     * @return Number of bytes.
+     */
+    static size_t Size(const unsigned char *message, size_t /*available*/)
+    {
+        return static_cast<size_t>(Length::Load(message));
+    }
+
+    /**
+     * @brief Set the number of bytes of the field of a message.
+     * @param message Start of the message.
+     * @param size Number of bytes.
+     */
+    static void SetSize(unsigned char *message, size_t size)
+    {
+        Length::Store(message, static_cast<typename Length::value_type>(size));
+    }
+};
+
+template <size_t Offset>
+struct ComTail<Offset, void>
+{
+    static const size_t offset = Offset;
+    static const bool sized = false;
+
+    static size_t Size(const unsigned char * /*message*/, size_t available)
+    {
+        return available - Offset;
+    }
+
+    static void SetSize(unsigned char * /*message*/, size_t /*size*/) {}
+};
+
+/**
+ * @brief Variable field of a layout without it.
+ */
+struct ComNoTail
+{
+    static const bool sized = true;
+
+    static size_t Size(const unsigned char * /*message*/, size_t /*available*/) { return 0; }
+
+    static void SetSize(unsigned char * /*message*/, size_t /*size*/) {}
+};
+
+/**
+ * @brief Message with a wire layout, accessed in place in its buffer: the
+ * fields are read and written directly from and to the bytes that are
+ * sent or received, without copying the message to a structure.
+ *
+ * A layout is a structure with its fields as typedefs (see ComField), a
+ * typedef Tail with its variable field (a ComTail, or ComNoTail if it
+ * has none), and a static constant size with the number of bytes of its
+ * fixed fields.
+ * @tparam Layout Layout of the message.
+ */
+template <typename Layout>
+class ComMessage
+{
+public:
+    typedef typename Layout::Tail Tail;
+
+    /**
+     * @brief Build an empty message, without data.
+     */
+    ComMessage() : m_data(NULL), m_size(0) {}
+
+    /**
+     * @brief Build a message on a buffer, sharing it.
+     * @param buffer Buffer that contains the message.
+     */
+    explicit ComMessage(const ComBuffer& buffer) :
+        m_buffer(buffer), m_data(buffer.Data()), m_size(buffer.Size()) {}
+
+    /**
+     * @brief Build a message on memory that the caller owns.
+     * @param data Memory that contains the message. It must outlive the message.
+     * @param size Number of bytes of the memory.
+     */
+    ComMessage(unsigned char *data, size_t size) : m_data(data), m_size(size) {}
+
+    /**
+     * @brief Create a message in a buffer taken from a pool. The fields are
+     * set to 0, and the length field of the variable field is set.
+     * @param pool Pool from which the buffer is taken.
+     * @param tail_size Number of bytes of the variable field.
+     * @return Message, or an empty message if there is no memory.
+     */
+    static ComMessage Create(ComBufferPool& pool, size_t tail_size = 0)
+    {
+        ComBuffer buffer = pool.Allocate(Layout::size + tail_size);
+
+        if (!buffer.Valid())
+            return ComMessage();
+
+        buffer.SetSize(Layout::size + tail_size);
+        std::memset(buffer.Data(), 0, Layout::size);
+        Tail::SetSize(buffer.Data(), tail_size);
+
+        return ComMessage(buffer);
+    }
+
+    /**
+     * @brief Check if the data holds a whole message.
+     * @return true if the fixed fields and the variable field are inside
+     * the data, false otherwise.
+     */
+    bool Valid() const
+    {
+        return m_data && m_size >= Layout::size &&
+               Tail::Size(m_data, m_size) <= m_size - Layout::size;
+    }
+
+    /**
+     * @brief Get a field. The message must be valid.
+     * @tparam Field Field of the layout.
+     * @return Value of the field.
+     */
+    template <typename Field>
+    typename Field::value_type Get() const
+    {
+        return Field::Load(m_data);
+    }
+
+    /**
+     * @brief Set a field. The message must be valid, and its data must not
+     * be shared.
+     * @tparam Field Field of the layout.
+     * @param value Value of the field.
+     */
+    template <typename Field>
+    void Set(typename Field::value_type value)
+    {
+        Field::Store(m_data, value);
+    }
+
+    /**
+     * @brief Get the variable field. The message must be valid.
+     * @return Pointer to the field, inside the message.
+     */
+    unsigned char *GetTail() const
+    {
+        return m_data + Layout::size;
+    }
+
+    /**
+     * @brief Get the number of bytes of the variable field. The message
+     * must be valid.
+     * @return Number of bytes.
+     */
+    size_t GetTailSize() const
+    {
+        return Tail::Size(m_data, m_size);
+    }
+
+    /**
+     * @brief Get the data of the message.
+     * @return Pointer to the data, or NULL if the message is empty.
+     */
+    unsigned char *Data() const
+    {
+        return m_data;
+    }
+
+    /**
+     * @brief Get the number of bytes of the message, that could be less
+     * than the bytes of its data. The message must be valid.
+     * @return Number of bytes.
+     */
+    size_t Size() const
+    {
+        return Layout::size + GetTailSize();
+    }
+
+    /**
+     * @brief Get the buffer of the message.
+     * @return Buffer, empty if the message is on memory of the caller.
+     */
+    const ComBuffer& GetBuffer() const
+    {
+        return m_buffer;
+    }
+
+private:
+    ComBuffer m_buffer;         ///< Buffer that holds the data, if it is pooled.
+    unsigned char *m_data;      ///< Data of the message.
+    size_t m_size;              ///< Number of bytes of the data.
+};
+
+#endif // _COMLAYOUT_HPP_
@@ -0,0 +1,437 @@
+/**
+ * @file    commulticast.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Multicast UDP publisher and subscriber communication interfaces.
+ */
+
+#ifndef _COMMULTICAST_HPP_
+#define _COMMULTICAST_HPP_
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/function.hpp>
+#include <boost/system/error_code.hpp>
+
+#include "cominterface/comclock.hpp"
+#include "cominterface/cominterface.hpp"
+#include "cominterface/compimpl.hpp"
+
+/**
+ * @brief Statistics of a multicast publisher or subscriber.
+ */
+struct ComMulticastStats
+{
+    ComMulticastStats() : datagrams_sent(0), bytes_sent(0), datagrams_received(0),
+                          bytes_received(0), gaps(0), lost(0), late(0), bad(0), sources(0) {}
+
+    unsigned long long datagrams_sent;      ///< Datagrams sent to the group.
+    unsigned long long bytes_sent;          ///< Bytes of data sent, without the headers.
+    unsigned long long datagrams_received;  ///< Datagrams delivered to the reader.
+    unsigned long long bytes_received;      ///< Bytes of data delivered, without the headers.
+    unsigned long long gaps;                ///< Jumps of the sequence numbers.
+    unsigned long long lost;                ///< Datagrams missing in the jumps.
+    unsigned long long late;                ///< Datagrams discarded because they arrived after a later one, or twice.
+    unsigned long long bad;                 ///< Datagrams discarded because they are too short or too long.
+    unsigned long long sources;             ///< Publishers heard by the subscriber.
+};
+
+/**
+ * @brief Common part of the multicast UDP interfaces: the socket, its
+ * timeouts and the multicast options.
+ *
+ * Each datagram has a header with the identifier of its publisher and a
+ * sequence number, both 32 bit big endian, followed by its data.
+ * @note The state of the socket is kept in a private implementation, so
+ * this header doesn't include boost::asio.
+ */
+class ComMulticast : public ComInterface
+{
+public:
+    static const size_t header_size = 8;    ///< Bytes of the header of a datagram.
+    static const size_t batch_size = 64;    ///< Maximum number of datagrams sent or received in one system call.
+
+    virtual ~ComMulticast();
+
+    virtual bool Close();
+
+    virtual bool Opened();
+
+    virtual int GetNativeHandle();
+
+    /**
+     * @brief Set the size of the kernel receive buffer (SO_RCVBUF).
+     * The configuration is kept between Open calls.
+     */
+    virtual bool SetReceiveBufferSize(size_t size);
+
+    virtual size_t GetReceiveBufferSize();
+
+    virtual void Abort();
+
+    virtual bool SetWriteTimeout(unsigned int write_timeout);
+
+    virtual unsigned int GetWriteTimeout();
+
+    virtual bool SetReadTimeout(unsigned int read_timeout);
+
+    virtual unsigned int GetReadTimeout();
+
+    /**
+     * @brief Set the clock of the read and write timeouts.
+     */
+    virtual bool SetClock(ComClock *clock);
+
+    /**
+     * @brief Set the time to live of the sent datagrams, the number of
+     * routers that they can cross. The configuration is kept between Open
+     * calls.
+     * @param ttl Time to live, from 0 (this host) to 255. By default, 1
+     * (the local network).
+     * @return true if the function executes correctly, false otherwise.
+     */
+    bool SetTtl(unsigned int ttl);
+
+    /**
+     * @brief Get the time to live of the sent datagrams.
+     * @return Time to live.
+     */
+    unsigned int GetTtl();
+
+    /**
+     * @brief Set if the sent datagrams are delivered to the subscribers of
+     * this host. The configuration is kept between Open calls.
+     * @param loopback true to deliver them. By default, true.
+     * @return true if the function executes correctly, false otherwise.
+     * @note The datagrams sent through the loopback interface are always
+     * delivered to this host.
+     */
+    bool SetLoopback(bool loopback);
+
+    /**
+     * @brief Get if the sent datagrams are delivered to the subscribers of
+     * this host.
+     * @return true if they are delivered, false otherwise.
+     */
+    bool GetLoopback();
+
+    /**
+     * @brief Set the maximum number of bytes of data of each datagram. The
+     * publisher splits the writes in datagrams of this size, and the
+     * subscriber discards the longer datagrams, so it should be the same
+     * at both ends. The publisher applies it on the next write, and the
+     * subscriber on the next Open.
+     * @param payload_size Number of bytes, from 1 to 65507 - header_size.
+     * By default, 1400 - header_size, to fit in an Ethernet frame.
+     * @return true if the function executes correctly, false otherwise.
+     */
+    bool SetPayloadSize(size_t payload_size);
+
+    /**
+     * @brief Get the maximum number of bytes of data of each datagram.
+     * @return Number of bytes.
+     */
+    size_t GetPayloadSize();
+
+    /**
+     * @brief Get the statistics of the interface.
+     * @param stats Statistics.
+     */
+    void GetStats(ComMulticastStats& stats);
+
+protected:
+    /**
+     * @brief Multicast interface constructor.
+     * @param group IPv4 multicast address of the group. Example: "239.255.0.1".
+     * @param port UDP port of the group.
+     * @param interface_address IPv4 address of the network interface of the
+     * group, or "" for the interface chosen by the system.
+     * @param timeout Timeout in milliseconds for Read and Write.
+     */
+    ComMulticast(const std::string& group, unsigned int port,
+                 const std::string& interface_address, unsigned int timeout);
+
+    struct Impl;
+
+    /**
+     * @brief Bytes of the inline storage of the implementation. If it
+     * doesn't fit, as in other platforms, it is allocated in the heap.
+     */
+    static const size_t impl_size = 3072;
+
+    ComPimpl<Impl, impl_size> m_impl;   ///< Socket, timeouts, configuration and statistics.
+
+    /**
+     * @brief Open the socket and apply the configuration. The mutex must
+     * be locked.
+     * @return true if the function executes correctly, false otherwise.
+     */
+    bool open_socket();
+
+    /**
+     * @brief Wait until the socket is ready or the deadline expires. The
+     * mutex must be locked.
+     * @param write true to wait until it can be written, false to wait
+     * until it can be read.
+     * @param deadline Time at which the wait expires.
+     * @return 1 if the socket is ready, 0 if the deadline expired or -1
+     * in case of error.
+     */
+    int wait_ready(bool write, const ComClock::time_point& deadline);
+
+private:
+    /**
+     * @brief This function is executed when the socket is ready or the wait
+     * is canceled by the timeout timer.
+     * @param error Indicate if an error occurred during the asynchronous operation.
+     * If no error occurs, its value will be 0.
+     * @param ret_error Error code for the wait. It is set to the value of error.
+     */
+    void wait_handler(const boost::system::error_code& error,
+                      boost::system::error_code *ret_error);
+
+    /**
+     * @brief This function is executed when a timeout timer asynchronous operation
+     * is completed.
+     * @param error Indicate if an error occurred during the asynchronous operation.
+     * If no error occurs (the timeout timer has expired), its value will be 0.
+     */
+    void timeout_handler(const boost::system::error_code& error);
+};
+
+/**
+ * @brief Publisher of a multicast UDP group: the data written to it is
+ * delivered to all the subscribers of the group, without a connection per
+ * subscriber. It can't be read.
+ *
+ * The writes are split in datagrams of up to the payload size, which are
+ * numbered in sequence so the subscribers detect the lost ones. In Linux,
+ * the datagrams of a write are sent with one sendmmsg call per batch_size
+ * datagrams, and the data is gathered from the caller buffer.
+ * @note UDP doesn't retransmit the lost datagrams. The subscribers detect
+ * the gaps, and the protocol over the data must tolerate or repair them.
+ */
+class ComMulticastPublisher : public ComMulticast
+{
+public:
+    /**
+     * @brief Multicast publisher constructor.
+     * @param group IPv4 multicast address of the group. Example: "239.255.0.1".
+     * @param port UDP port of the group.
+     * @param interface_address IPv4 address of the network interface where
+     * the datagrams are sent, or "" for the interface chosen by the system.
+     * @param timeout Timeout in milliseconds for Write.
+     */
+    ComMulticastPublisher(const std::string& group = "239.255.0.1", unsigned int port = 3445,
+                          const std::string& interface_address = "", unsigned int timeout = 1000);
+
+    virtual ~ComMulticastPublisher();
+
+    virtual bool Open();
+
+    /**
+     * @brief The publisher can't be read.
+     * @return -1.
+     */
+    virtual int ReadSome(void *buffer_in, size_t len);
+
+    /**
+     * @brief The datagrams are always sent completely, so it is the same
+     * as Write().
+     */
+    virtual int WriteSome(const void *buffer_out, size_t len);
+
+    /**
+     * @brief The publisher can't be read.
+     * @return -1.
+     */
+    virtual int Read(void *buffer_in, size_t len);
+
+    /**
+     * @brief Send the data to the group, in datagrams of up to the payload
+     * size. It waits while the kernel send buffer is full, until the
+     * timeout expires.
+     * @return Number of bytes sent, or -1 in case of error.
+     */
+    virtual int Write(const void *buffer_out, size_t len);
+
+    /**
+     * @brief Send each message in its own datagram, keeping the boundaries
+     * of the messages for the subscribers that use
+     * ComMulticastSubscriber::ReceiveBatch(...).
+     * @param messages Messages, of up to the payload size each.
+     * @return Number of messages sent, or -1 if a message is too long or
+     * the socket fails before sending any message.
+     */
+    int WriteBatch(const std::vector<ComBuffer>& messages);
+
+    /**
+     * @brief Get the identifier of the publisher in the headers of its
+     * datagrams. It is random, so the subscribers distinguish the
+     * publishers of a group and their restarts.
+     * @return Identifier.
+     */
+    boost::uint32_t GetSource();
+
+private:
+    boost::uint32_t m_source;                           ///< Identifier of the publisher.
+    boost::uint32_t m_sequence;                         ///< Sequence number of the next datagram.
+
+    /**
+     * @brief Send datagrams, numbering them. The mutex must be locked.
+     * @param payloads Data of each datagram.
+     * @param sizes Number of bytes of the data of each datagram.
+     * @param count Number of datagrams, up to batch_size.
+     * @param deadline Time at which the wait for the send buffer expires.
+     * @return Number of datagrams sent, or -1 in case of error.
+     */
+    int send_datagrams(const unsigned char *const *payloads, const size_t *sizes, size_t count,
+                       const ComClock::time_point& deadline);
+};
+
+/**
+ * @brief Subscriber of multicast UDP groups. It receives the datagrams of
+ * the publishers of its groups, and it can't be written.
+ *
+ * The data of the datagrams can be read as a stream, with the ComInterface
+ * reads, or datagram by datagram in pooled buffers with ReceiveBatch(...).
+ * The sequence numbers of each publisher are checked: the gaps are counted
+ * in the statistics and reported to the gap handler, and the datagrams that
+ * arrive late or twice are discarded. In Linux, the datagrams are received
+ * with one recvmmsg call per batch_size datagrams.
+ * @note The readiness handle is the socket, so the event loops must read
+ * all the received data with ReadSome(...) when it is signaled.
+ */
+class ComMulticastSubscriber : public ComMulticast
+{
+public:
+    /**
+     * @brief Handler of the gaps of the sequence of a publisher. It is
+     * called in the thread that reads, and it must not use the subscriber.
+     * It receives the identifier of the publisher, the sequence number of
+     * the first lost datagram and the number of lost datagrams.
+     */
+    typedef boost::function<void (boost::uint32_t, boost::uint32_t, boost::uint32_t)> GapHandler;
+
+    /**
+     * @brief Multicast subscriber constructor.
+     * @param group IPv4 multicast address of the group. Example: "239.255.0.1".
+     * @param port UDP port of the group.
+     * @param interface_address IPv4 address of the network interface where
+     * the group is joined, or "" for the interface chosen by the system.
+     * @param timeout Timeout in milliseconds for Read.
+     */
+    ComMulticastSubscriber(const std::string& group = "239.255.0.1", unsigned int port = 3445,
+                           const std::string& interface_address = "", unsigned int timeout = 1000);
+
+    virtual ~ComMulticastSubscriber();
+
+    /**
+     * @brief Bind the socket to the port and join the groups.
+     */
+    virtual bool Open();
+
+    virtual int ReadSome(void *buffer_in, size_t len);
+
+    /**
+     * @brief The subscriber can't be written.
+     * @return -1.
+     */
+    virtual int WriteSome(const void *buffer_out, size_t len);
+
+    virtual int Read(void *buffer_in, size_t len);
+
+    /**
+     * @brief The subscriber can't be written.
+     * @return -1.
+     */
+    virtual int Write(const void *buffer_out, size_t len);
+
+    /**
+     * @brief Join another group on the same port. The groups are kept
+     * between Open calls.
+     * @param group IPv4 multicast address of the group.
+     * @return true if the function executes correctly, false otherwise.
+     */
+    bool JoinGroup(const std::string& group);
+
+    /**
+     * @brief Leave a group.
+     * @param group IPv4 multicast address of the group.
+     * @return true if the function executes correctly, false if the group
+     * is not joined.
+     */
+    bool LeaveGroup(const std::string& group);
+
+    /**
+     * @brief Blocking read of datagrams. It waits until some datagrams are
+     * received or the timeout expires, and returns the data of each one in
+     * its own buffer, up to max_messages.
+     * @param pool Pool from which the buffers are taken.
+     * @param messages Data of the received datagrams.
+     * @param max_messages Maximum number of datagrams.
+     * @return Number of datagrams, 0 if the timeout expires or -1 in case
+     * of error.
+     * @note The stream reads and this function must not be mixed, because
+     * the datagrams taken by a stream read are only returned as a stream.
+     */
+    int ReceiveBatch(ComBufferPool& pool, std::vector<ComBuffer>& messages,
+                     size_t max_messages = batch_size);
+
+    /**
+     * @brief Set the handler of the gaps of the sequences.
+     * @param handler Handler, or an empty function to remove it.
+     */
+    void SetGapHandler(const GapHandler& handler);
+
+private:
+    std::map<boost::uint32_t, boost::uint32_t> m_next;  ///< Next sequence number of each publisher.
+    GapHandler m_gap_handler;                           ///< Handler of the gaps of the sequences.
+    size_t m_datagram_size;                             ///< Payload size applied on the last Open.
+    std::vector<unsigned char> m_datagrams;             ///< Memory where the datagrams are received, batch_size of the payload size.
+    ComBufferPool m_pool;                               ///< Pool of the datagrams of the stream reads.
+    std::deque<ComBuffer> m_pending;                    ///< Data received and not read by the stream reads.
+    size_t m_pending_offset;                            ///< Bytes of the first pending buffer already read.
+    std::vector<ComBuffer> m_received;                  ///< Datagrams of the last receive of the stream reads.
+
+    /**
+     * @brief Non blocking receive of datagrams. The mutex must be locked.
+     * @param pool Pool from which the buffers are taken.
+     * @param max_messages Maximum number of datagrams, up to batch_size.
+     * @param messages Vector where the data of the valid datagrams is
+     * added, copied to buffers of the pool.
+     * @return Number of datagrams received, valid or not, 0 if there is no
+     * datagram available or -1 in case of error.
+     */
+    int receive_datagrams(ComBufferPool& pool, size_t max_messages, std::vector<ComBuffer>& messages);
+
+    /**
+     * @brief Check the header of a received datagram and its sequence
+     * number. The mutex must be locked.
+     * @param header Header of the datagram.
+     * @return true if the datagram is accepted, false if it is late.
+     */
+    bool accept(const unsigned char *header);
+
+    /**
+     * @brief Copy the pending data to a buffer. The mutex must be locked.
+     * @param buffer_in Buffer.
+     * @param len Number of bytes of the buffer.
+     * @return Number of bytes copied.
+     */
+    size_t take_pending(unsigned char *buffer_in, size_t len);
+
+    /**
+     * @brief Receive the available datagrams to the pending data. The mutex
+     * must be locked.
+     * @return Number of datagrams received, 0 if there is no datagram
+     * available or -1 in case of error.
+     */
+    int receive_pending();
+};
+
+#endif // _COMMULTICAST_HPP_
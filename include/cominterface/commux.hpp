@@ -0,0 +1,267 @@
+/**
+ * @file    commux.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Logical channels multiplexed over a communication interface.
+ */
+
+#ifndef _COMMUX_HPP_
+#define _COMMUX_HPP_
+
+#include <deque>
+#include <vector>
+
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "cominterface/cominterface.hpp"
+#include "cominterface/comclock.hpp"
+#include "cominterface/comevent.hpp"
+
+class ComMux;
+
+/**
+ * @brief Logical channel of a ComMux. It is used as any other
+ * communication interface, and its data is carried in frames over the
+ * link of the multiplexer.
+ * @note The channels are created and owned by their ComMux.
+ */
+class ComMuxChannel: public ComInterface
+{
+public:
+    virtual ~ComMuxChannel();
+
+    /**
+     * @brief Open the channel. The data received for a channel before it
+     * is opened is kept, up to the receive window.
+     */
+    virtual bool Open();
+
+    /**
+     * @brief Close the channel. The received data that has not been read
+     * is discarded, and returned as credit to the peer.
+     */
+    virtual bool Close();
+
+    virtual bool Opened();
+
+    virtual int ReadSome(void *buffer_in, size_t len);
+
+    /**
+     * @brief Non blocking write. The data is queued in the channel, up to
+     * the size of the window, and sent by the multiplexer when there is
+     * credit for it.
+     */
+    virtual int WriteSome(const void *buffer_out, size_t len);
+
+    virtual int Read(void *buffer_in, size_t len);
+
+    /**
+     * @brief Blocking write. It waits until all the data is queued in the
+     * channel or the timeout expires.
+     */
+    virtual int Write(const void *buffer_out, size_t len);
+
+    virtual void Abort();
+
+    virtual bool SetWriteTimeout(unsigned int write_timeout);
+
+    virtual unsigned int GetWriteTimeout();
+
+    virtual bool SetReadTimeout(unsigned int read_timeout);
+
+    virtual unsigned int GetReadTimeout();
+
+    /**
+     * @brief Get an event that is readable while the channel has received
+     * data or the link has failed, for the external event loops.
+     */
+    virtual int GetReadinessHandle();
+
+    /**
+     * @brief Set the clock of the timeouts. It is shared by all the
+     * channels of the multiplexer.
+     */
+    virtual bool SetClock(ComClock *clock);
+
+    /**
+     * @brief Get the identifier of the channel.
+     * @return Identifier, from 0 to ComMux::max_channels - 1.
+     */
+    unsigned int GetId();
+
+    /**
+     * @brief Get the number of bytes that can be sent before the peer
+     * returns more credit.
+     * @return Number of bytes.
+     */
+    size_t GetCredit();
+
+private:
+    friend class ComMux;
+
+    ComMuxChannel(ComMux& mux, unsigned int id);
+
+    ComMux& m_mux;                          ///< Multiplexer of the channel.
+    unsigned int m_id;                      ///< Identifier of the channel.
+    bool m_opened;                          ///< The channel is opened.
+    std::deque<unsigned char> m_rx;         ///< Received data pending to be read.
+    std::deque<unsigned char> m_tx;         ///< Data pending to be sent.
+    size_t m_credit;                        ///< Bytes that the peer can receive.
+    size_t m_grant;                         ///< Read bytes pending to be returned as credit to the peer.
+    unsigned int m_abort;                   ///< Number of calls to Abort(), to interrupt the waits.
+    unsigned int m_read_timeout;            ///< Timeout of the Read operations in milliseconds.
+    unsigned int m_write_timeout;           ///< Timeout of the Write operations in milliseconds.
+    ComEvent m_readable;                    ///< Event set while there is received data or the link has failed.
+
+    /**
+     * @brief Take received data. The mutex of the multiplexer must be locked.
+     * @param buffer_in Buffer that will contain the received data.
+     * @param len Maximum number of bytes to take.
+     * @return Number of bytes taken.
+     */
+    size_t take(void *buffer_in, size_t len);
+
+    /**
+     * @brief Queue data to be sent. The mutex of the multiplexer must be locked.
+     * @param buffer_out Buffer that contains the data to be transmitted.
+     * @param len Maximum number of bytes to queue.
+     * @return Number of bytes queued.
+     */
+    size_t queue(const void *buffer_out, size_t len);
+};
+
+/**
+ * @brief Multiplexer of logical channels over one communication interface
+ * (the link), e.g. an expensive serial link or TCP connection shared by
+ * independent producers and consumers.
+ *
+ * Each frame carries the channel identifier, the frame type and the length
+ * of the payload. The flow control is based on credits: a channel only
+ * sends the data that the peer has room for, and the peer returns credit
+ * as the data is read, so a slow consumer doesn't block the other channels.
+ * The channels with pending data are served in round robin, one frame
+ * each, so a channel with much data doesn't delay the others.
+ *
+ * The link is read in its streaming mode and written by a sender thread,
+ * that gathers the pending frames in one write.
+ * @note Both ends must use the same window size. Over a ComSocket, the
+ * Nagle algorithm should be disabled with ComSocket::SetNoDelay(...).
+ */
+class ComMux : private boost::noncopyable
+{
+public:
+    static const unsigned int max_channels = 256;   ///< Number of channels of a multiplexer.
+    static const size_t header_size = 4;            ///< Bytes of the header of a frame.
+    static const size_t batch_frames = 16;          ///< Maximum number of frames sent in one write of the link.
+
+    /**
+     * @brief Multiplexer constructor.
+     * @param link Interface that carries the channels. It must outlive
+     * the multiplexer.
+     * @param max_frame Maximum number of payload bytes of a frame (up to 65535).
+     * @param window Receive window of each channel in bytes.
+     */
+    ComMux(ComInterface *link, size_t max_frame = 1024, size_t window = 65536);
+
+    ~ComMux();
+
+    /**
+     * @brief Start the multiplexer. The link must be opened.
+     * @return true if it has started, false otherwise.
+     */
+    bool Start();
+
+    /**
+     * @brief Stop the multiplexer. The link is not closed.
+     */
+    void Stop();
+
+    /**
+     * @brief Check if the multiplexer is running and the link has no errors.
+     * @return true if it is running, false otherwise.
+     */
+    bool Running();
+
+    /**
+     * @brief Get a channel of the multiplexer. It is created on the first call.
+     * @param id Identifier of the channel, from 0 to max_channels - 1.
+     * @return Channel, or NULL if the identifier is not valid.
+     */
+    ComMuxChannel *GetChannel(unsigned int id);
+
+private:
+    friend class ComMuxChannel;
+
+    /**
+     * @brief Types of frame.
+     */
+    enum FrameType
+    {
+        frame_data = 0,     ///< Data of the channel.
+        frame_credit = 1    ///< Credit returned by the receiver (32 bits big endian).
+    };
+
+    ComInterface *m_link;                       ///< Interface that carries the channels.
+    size_t m_max_frame;                         ///< Maximum number of payload bytes of a frame.
+    size_t m_window;                            ///< Receive window of each channel.
+    ComMuxChannel *m_channels[max_channels];    ///< Channels, NULL if not created.
+    unsigned int m_next;                        ///< Next channel to send in the round robin.
+    std::vector<unsigned char> m_parse;         ///< Received bytes of incomplete frames.
+    std::vector<unsigned char> m_frames;        ///< Frames sent in the same write of the link.
+    boost::thread m_sender;                     ///< Sender thread.
+    bool m_running;                             ///< The multiplexer has been started.
+    bool m_stop;                                ///< The sender thread must finish.
+    bool m_failed;                              ///< The link has failed or it has been closed.
+    boost::mutex m_mutex;                       ///< Mutex of the multiplexer and its channels.
+    boost::condition_variable m_tx_cond;        ///< Signals the sender thread.
+    boost::condition_variable m_rx_cond;        ///< Signals the waits of the channels.
+    ComClock *m_clock;                          ///< Clock of the timeouts of the channels.
+
+    /**
+     * @brief Get a channel. The mutex must be locked.
+     * @param id Identifier of the channel.
+     * @return Channel.
+     */
+    ComMuxChannel *channel(unsigned int id);
+
+    /**
+     * @brief Process the data received by the link.
+     * @param buffer Received data.
+     */
+    void receive_handler(const ComBuffer& buffer);
+
+    /**
+     * @brief Mark the link as failed and wake up all the waits.
+     */
+    void failure_handler();
+
+    /**
+     * @brief Mark the link as failed and set the readiness events of the
+     * channels. The mutex must be locked.
+     */
+    void fail();
+
+    /**
+     * @brief Append the next frame to send to m_frames. The mutex must be locked.
+     * @return true if there is a frame, false if there is nothing to send.
+     */
+    bool next_frame();
+
+    /**
+     * @brief Body of the sender thread.
+     */
+    void sender();
+
+    /**
+     * @brief Get the deadline of a wait. The mutex must be locked.
+     * @param timeout Time in milliseconds.
+     * @return Deadline.
+     */
+    ComClock::time_point deadline(unsigned int timeout);
+};
+
+#endif // _COMMUX_HPP_
@@ -0,0 +1,93 @@
+/**
+ * @file    compimpl.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Storage of the private implementation of the interfaces.
+ */
+
+#ifndef _COMPIMPL_HPP_
+#define _COMPIMPL_HPP_
+
+#include <cstddef>
+#include <new>
+
+#include <boost/aligned_storage.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+
+/**
+ * @brief Owner of the private implementation of a class, whose type is only
+ * declared in its public header. It keeps the headers of the library used
+ * by the implementation out of the translation units of the users.
+ * @param T Type of the implementation. It must be default constructible.
+ * @param Size Bytes of the inline storage. If the implementation fits on
+ * it, it is constructed in place, without allocating memory in the heap.
+ * Else, or if Size is 0, it is allocated in the heap.
+ * @note The members of ComPimpl need the complete type of the implementation,
+ * so the constructor and the destructor of the owner must be defined in the
+ * translation unit that defines the implementation.
+ */
+template <typename T, std::size_t Size = 0>
+class ComPimpl : private boost::noncopyable
+{
+public:
+    ComPimpl()
+    {
+        // The alignment of the storage is the maximum of the fundamental types
+        BOOST_STATIC_ASSERT(Size == 0 || sizeof(T) > Size || boost::alignment_of<T>::value <=
+                            boost::alignment_of<boost::aligned_storage<storage_size> >::value);
+
+        if (inlined())
+            new (m_storage.address()) T();
+        else
+            *static_cast<T **>(m_storage.address()) = new T();
+    }
+
+    ~ComPimpl()
+    {
+        if (inlined())
+            get()->~T();
+        else
+            delete get();
+    }
+
+    T *operator->() { return get(); }
+
+    const T *operator->() const { return get(); }
+
+    T& operator*() { return *get(); }
+
+    const T& operator*() const { return *get(); }
+
+private:
+    // The storage holds the pointer to the implementation when it doesn't fit
+    static const std::size_t storage_size = Size < sizeof(T *) ? sizeof(T *) : Size;
+
+    boost::aligned_storage<storage_size> m_storage;     ///< Implementation or pointer to it.
+
+    /**
+     * @brief Check if the implementation is constructed in the inline storage.
+     * @return true if it is inline, false if it is allocated in the heap.
+     */
+    static bool inlined()
+    {
+        return Size != 0 && sizeof(T) <= Size;
+    }
+
+    /**
+     * @brief Get the implementation.
+     * @return Pointer to the implementation.
+     */
+    T *get() const
+    {
+        void *address = const_cast<void *>(m_storage.address());
+
+        if (inlined())
+            return static_cast<T *>(address);
+        else
+            return *static_cast<T **>(address);
+    }
+};
+
+#endif // _COMPIMPL_HPP_
@@ -0,0 +1,163 @@
+/**
+ * @file    compipe.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   In-memory link between two communication interfaces.
+ */
+
+#ifndef _COMPIPE_HPP_
+#define _COMPIPE_HPP_
+
+#include <deque>
+
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "cominterface/cominterface.hpp"
+#include "cominterface/comclock.hpp"
+#include "cominterface/comevent.hpp"
+
+class ComPipe;
+
+/**
+ * @brief End of a ComPipe. The data written in one end is read from the
+ * other one, as in a connection.
+ * @note The ends are created and owned by their ComPipe.
+ */
+class ComPipeEnd : public ComInterface
+{
+public:
+    virtual ~ComPipeEnd();
+
+    virtual bool Open();
+
+    /**
+     * @brief Close the end. The received data that has not been read is
+     * discarded, and the other end reads the pending data and then fails,
+     * as when a connection is closed.
+     */
+    virtual bool Close();
+
+    virtual bool Opened();
+
+    virtual int ReadSome(void *buffer_in, size_t len);
+
+    /**
+     * @brief Non blocking write. It fails if the other end is not opened.
+     */
+    virtual int WriteSome(const void *buffer_out, size_t len);
+
+    virtual int Read(void *buffer_in, size_t len);
+
+    virtual int Write(const void *buffer_out, size_t len);
+
+    virtual void Abort();
+
+    virtual bool SetWriteTimeout(unsigned int write_timeout);
+
+    virtual unsigned int GetWriteTimeout();
+
+    virtual bool SetReadTimeout(unsigned int read_timeout);
+
+    virtual unsigned int GetReadTimeout();
+
+    /**
+     * @brief Get an event that is readable while the end has received
+     * data or the other end has been closed, for the external event loops.
+     */
+    virtual int GetReadinessHandle();
+
+    /**
+     * @brief Set the clock of the timeouts. It is shared by both ends of the pipe.
+     */
+    virtual bool SetClock(ComClock *clock);
+
+private:
+    friend class ComPipe;
+
+    ComPipeEnd(ComPipe& pipe, unsigned int index);
+
+    ComPipe& m_pipe;                        ///< Pipe of the end.
+    unsigned int m_index;                   ///< Index of the end in the pipe.
+    bool m_opened;                          ///< The end is opened.
+    bool m_peer_closed;                     ///< The other end has been closed since this one was opened.
+    std::deque<unsigned char> m_rx;         ///< Received data pending to be read.
+    unsigned int m_abort;                   ///< Number of calls to Abort(), to interrupt the waits.
+    unsigned int m_read_timeout;            ///< Timeout of the Read operations in milliseconds.
+    unsigned int m_write_timeout;           ///< Timeout of the Write operations in milliseconds.
+    ComEvent m_readable;                    ///< Event set while there is received data or the peer is closed.
+
+    /**
+     * @brief Get the other end of the pipe.
+     * @return Other end.
+     */
+    ComPipeEnd& peer();
+
+    /**
+     * @brief Check if the reads must fail. The mutex of the pipe must be locked.
+     * @return true if there is no data and the other end has been closed.
+     */
+    bool eof();
+
+    /**
+     * @brief Take received data. The mutex of the pipe must be locked.
+     * @param buffer_in Buffer that will contain the received data.
+     * @param len Maximum number of bytes to take.
+     * @return Number of bytes taken.
+     */
+    size_t take(void *buffer_in, size_t len);
+
+    /**
+     * @brief Pass data to the other end, up to the capacity of the pipe.
+     * The mutex of the pipe must be locked.
+     * @param buffer_out Buffer that contains the data to be transmitted.
+     * @param len Maximum number of bytes to pass.
+     * @return Number of bytes passed.
+     */
+    size_t give(const void *buffer_out, size_t len);
+};
+
+/**
+ * @brief In-memory link with two ends, that behave as the two sides of a
+ * connection. It allows to test and benchmark protocols and decorators
+ * (e.g. ComFaultInjector) without serial ports or sockets.
+ */
+class ComPipe : private boost::noncopyable
+{
+public:
+    /**
+     * @brief Pipe constructor.
+     * @param capacity Maximum number of bytes pending to be read in each
+     * direction. The writes wait while it is full.
+     */
+    explicit ComPipe(size_t capacity = 65536);
+
+    ~ComPipe();
+
+    /**
+     * @brief Get an end of the pipe. The ends start closed.
+     * @param index Index of the end, 0 or 1.
+     * @return End, or NULL if the index is not valid.
+     */
+    ComPipeEnd *GetEnd(unsigned int index);
+
+private:
+    friend class ComPipeEnd;
+
+    ComPipeEnd *m_ends[2];              ///< Ends of the pipe.
+    size_t m_capacity;                  ///< Maximum number of bytes pending in each direction.
+    boost::mutex m_mutex;               ///< Mutex of the pipe and its ends.
+    boost::condition_variable m_cond;   ///< Signals data, room, closes and aborts.
+    ComClock *m_clock;                  ///< Clock of the timeouts of both ends.
+
+    /**
+     * @brief Get the deadline of an operation. The mutex must be locked.
+     * @param timeout Timeout in milliseconds.
+     * @return Time point at which the operation expires.
+     */
+    ComClock::time_point deadline(unsigned int timeout);
+};
+
+#endif // _COMPIPE_HPP_
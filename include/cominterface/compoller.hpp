@@ -0,0 +1,123 @@
+/**
+ * @file    compoller.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Multiplexed wait across a set of communication interfaces.
+ */
+
+#ifndef _COMPOLLER_HPP_
+#define _COMPOLLER_HPP_
+
+#include <map>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "cominterface/cominterface.hpp"
+
+/**
+ * @brief Interface of a wait and the events in which it is interested.
+ */
+struct ComPollItem
+{
+    ComPollItem(ComInterface *poll_com = NULL, unsigned int poll_events = 0) :
+        com(poll_com), events(poll_events), revents(0) {}
+
+    ComInterface *com;          ///< Interface to wait on.
+    unsigned int events;        ///< Requested events (ComPoller::readable, ComPoller::writable).
+    unsigned int revents;       ///< Events that are ready.
+};
+
+/**
+ * @brief Set of interfaces that are waited at the same time, with only
+ * one system call (epoll in Linux, poll in other systems) instead of a
+ * thread per interface.
+ * The interfaces are waited through their readiness handle, so they must
+ * be opened when they are added, and added again if they are reopened.
+ * It is the native handle, unless the interface keeps received data in its
+ * own buffers (e.g. ComPipeEnd, ComReliable or ComFec), whose event is
+ * readable while there is buffered data.
+ * @note The interfaces with no readiness handle (e.g. in Windows) can't be
+ * added. The event of an interface with its own buffers is always writable.
+ */
+class ComPoller : private boost::noncopyable
+{
+public:
+    static const unsigned int readable = 1;     ///< There is data to read or the connection has been closed.
+    static const unsigned int writable = 2;     ///< Data can be written without blocking.
+    static const unsigned int error = 4;        ///< The interface has an error or a hang up. It is always reported.
+
+    ComPoller();
+
+    ~ComPoller();
+
+    /**
+     * @brief Add an interface to the set.
+     * @param com Opened interface.
+     * @param events Requested events.
+     * @return true if the function executes correctly, false otherwise.
+     */
+    bool Add(ComInterface *com, unsigned int events);
+
+    /**
+     * @brief Change the requested events of an interface of the set.
+     * @param com Interface of the set.
+     * @param events Requested events.
+     * @return true if the function executes correctly, false otherwise.
+     */
+    bool Modify(ComInterface *com, unsigned int events);
+
+    /**
+     * @brief Remove an interface from the set. It must be removed before
+     * it is closed or destroyed.
+     * @param com Interface of the set.
+     * @return true if the function executes correctly, false otherwise.
+     */
+    bool Remove(ComInterface *com);
+
+    /**
+     * @brief Get the number of interfaces of the set.
+     * @return Number of interfaces.
+     */
+    size_t Size();
+
+    /**
+     * @brief Wait until any interface of the set is ready or the timeout
+     * expires.
+     * @param ready Interfaces that are ready, with their ready events.
+     * @param timeout Time in milliseconds.
+     * @return Number of ready interfaces, 0 if the timeout expired or -1
+     * in case of error.
+     */
+    int Wait(std::vector<ComPollItem>& ready, unsigned int timeout);
+
+    /**
+     * @brief Wait until any interface of a list is ready or the timeout
+     * expires, without building a set. It is suitable for sets that
+     * change on each call.
+     * @param items Interfaces and requested events. The ready events
+     * are returned in the revents field.
+     * @param timeout Time in milliseconds.
+     * @return Number of ready interfaces, 0 if the timeout expired or -1
+     * in case of error.
+     */
+    static int WaitAny(std::vector<ComPollItem>& items, unsigned int timeout);
+
+private:
+    /**
+     * @brief Interface of the set.
+     */
+    struct Entry
+    {
+        int handle;             ///< Native handle waited on.
+        unsigned int events;    ///< Requested events.
+    };
+
+    std::map<ComInterface *, Entry> m_entries;  ///< Interfaces of the set.
+    int m_epoll;                                ///< epoll instance, -1 if it is not available.
+    boost::mutex m_mutex;                       ///< Mutex to make the set thread safe.
+};
+
+#endif // _COMPOLLER_HPP_
@@ -0,0 +1,111 @@
+/**
+ * @file    comreceivetuner.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Adaptive size of the reads and of the kernel receive buffer.
+ */
+
+#ifndef _COMRECEIVETUNER_HPP_
+#define _COMRECEIVETUNER_HPP_
+
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <boost/thread/mutex.hpp>
+
+class ComInterface;
+
+/**
+ * @brief Sizes chosen by a ComReceiveTuner and the traffic that they are
+ * based on.
+ */
+struct ComReceiveStats
+{
+    ComReceiveStats() : read_size(0), kernel_buffer_size(0), reads(0), bytes(0),
+                        full_reads(0), grows(0), shrinks(0), throughput(0) {}
+
+    size_t read_size;               ///< Current number of bytes of each read.
+    size_t kernel_buffer_size;      ///< Current kernel receive buffer, 0 if the interface doesn't have it.
+    unsigned long long reads;       ///< Number of reads that returned data.
+    unsigned long long bytes;       ///< Number of bytes read.
+    unsigned long long full_reads;  ///< Number of reads that filled the buffer.
+    unsigned long long grows;       ///< Number of times that the read size has grown.
+    unsigned long long shrinks;     ///< Number of times that the read size has shrunk.
+    double throughput;              ///< Bytes per second in the last measure.
+};
+
+/**
+ * @brief Auto-tuning of the receive buffers of an interface. It chooses the
+ * size of each read from the observed bursts, and the kernel receive buffer
+ * (SO_RCVBUF) from the throughput:
+ * - When consecutive reads fill the buffer, the data is arriving faster
+ *   than it is read, so the read size grows to the next size class of
+ *   ComBufferPool (x4), reducing the number of system calls.
+ * - When the largest read of a measure period uses a quarter of the buffer
+ *   or less, the read size shrinks to the previous size class.
+ * - The kernel buffer is set to hold 20 ms of the measured throughput,
+ *   and at least 4 reads, so bulk streams don't fill it while the reader
+ *   is not scheduled and idle interfaces don't keep large buffers.
+ * @note In Linux, setting SO_RCVBUF disables the automatic tuning of the
+ * TCP receive window by the kernel, and the kernel doubles the value.
+ */
+class ComReceiveTuner : private boost::noncopyable
+{
+public:
+    /**
+     * @brief Receive tuner constructor.
+     * @param com Interface whose kernel receive buffer is tuned.
+     * @param min_read_size Minimum number of bytes of each read.
+     * @param max_read_size Maximum number of bytes of each read.
+     */
+    explicit ComReceiveTuner(ComInterface *com, size_t min_read_size = 64,
+                             size_t max_read_size = 65536);
+
+    /**
+     * @brief Get the number of bytes to request in the next read.
+     * @return Number of bytes.
+     */
+    size_t GetReadSize();
+
+    /**
+     * @brief Record the result of a read of GetReadSize() bytes and adapt
+     * the sizes.
+     * @param received Number of bytes read. The reads without data are ignored.
+     */
+    void Record(int received);
+
+    /**
+     * @brief Get the chosen sizes and the observed traffic.
+     * @param stats Statistics.
+     */
+    void GetStats(ComReceiveStats& stats);
+
+private:
+    ComInterface *m_com;                ///< Interface whose kernel buffer is tuned.
+    size_t m_min_read_size;             ///< Minimum number of bytes of each read.
+    size_t m_max_read_size;             ///< Maximum number of bytes of each read.
+    unsigned int m_full_streak;         ///< Consecutive reads that filled the buffer.
+    size_t m_requested_kernel_size;     ///< Last kernel buffer size requested, 0 if none.
+
+    // Measure period
+    boost::chrono::steady_clock::time_point m_period_start;  ///< Start of the period.
+    size_t m_period_reads;              ///< Reads with data in the period.
+    size_t m_period_bytes;              ///< Bytes read in the period.
+    size_t m_period_max;                ///< Largest read of the period.
+
+    ComReceiveStats m_stats;            ///< Chosen sizes and observed traffic.
+    boost::mutex m_mutex;               ///< Mutex to make the tuner thread safe.
+
+    /**
+     * @brief Start a new measure period. The mutex must be locked.
+     */
+    void restart_period();
+
+    /**
+     * @brief Adapt the sizes at the end of a measure period. The mutex must be locked.
+     * @param elapsed Duration of the period in seconds.
+     */
+    void end_period(double elapsed);
+};
+
+#endif // _COMRECEIVETUNER_HPP_
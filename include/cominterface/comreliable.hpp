@@ -0,0 +1,325 @@
+/**
+ * @file    comreliable.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Reliable ordered byte stream over an unreliable link.
+ */
+
+#ifndef _COMRELIABLE_HPP_
+#define _COMRELIABLE_HPP_
+
+#include <deque>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "cominterface/cominterface.hpp"
+#include "cominterface/comclock.hpp"
+#include "cominterface/comevent.hpp"
+
+/**
+ * @brief Statistics of a ComReliable.
+ */
+struct ComReliableStats
+{
+    ComReliableStats() : frames_sent(0), retransmissions(0), fast_retransmissions(0),
+                         timeouts(0), acks_sent(0), frames_received(0), duplicates(0),
+                         bad_frames(0), srtt(0), rto(0) {}
+
+    unsigned long long frames_sent;             ///< Data frames sent, including the retransmissions.
+    unsigned long long retransmissions;         ///< Data frames sent again.
+    unsigned long long fast_retransmissions;    ///< Retransmissions requested by the selective acknowledgements.
+    unsigned long long timeouts;                ///< Expirations of the retransmission timer.
+    unsigned long long acks_sent;               ///< Frames sent only to acknowledge data.
+    unsigned long long frames_received;         ///< Data frames received and accepted.
+    unsigned long long duplicates;              ///< Data frames received again or out of the window.
+    unsigned long long bad_frames;              ///< Frames discarded by their CRC or their format.
+    double srtt;                                ///< Smoothed round trip time in milliseconds, 0 before the first sample.
+    double rto;                                 ///< Current retransmission timeout in milliseconds.
+};
+
+/**
+ * @brief Reliable transport over a link that loses or corrupts data, e.g.
+ * a noisy serial link. It exposes a reliable ordered byte stream as a
+ * communication interface, so the protocols written for a ComSerial run
+ * over it without changes.
+ *
+ * The stream is carried in frames delimited with HDLC byte stuffing and
+ * checked with a CRC-16, so the receiver resynchronizes after corrupted
+ * or lost bytes. The transport is a sliding window protocol with selective
+ * repeat:
+ * - Up to window frames are sent without waiting for their acknowledgement.
+ * - Every frame carries the cumulative acknowledgement and a bitmap of the
+ *   32 frames received after it (selective acknowledgements), so only the
+ *   lost frames are sent again.
+ * - Each frame has a retransmission timer. The timeout follows the
+ *   measured round trip time (RFC 6298, with Karn's algorithm) and it
+ *   doubles on each expiration.
+ * - A frame is retransmitted before its timer when 3 later frames have
+ *   been acknowledged.
+ *
+ * The link is read in its streaming mode and written by a sender thread.
+ * Each Open() starts a new session, and the other end restarts its
+ * reception when it sees the new session.
+ * @note Both ends must use the same window and maximum payload. The
+ * received data that is not read is limited to the window, so a reader
+ * that doesn't keep up slows down the sender through the retransmissions.
+ */
+class ComReliable : public ComInterface
+{
+public:
+    static const size_t header_size = 17;       ///< Bytes of the header of a frame.
+    static const size_t max_window = 1024;      ///< Maximum number of frames in flight.
+    static const size_t batch_frames = 16;      ///< Maximum number of frames sent in one write of the link.
+
+    /**
+     * @brief Reliable transport constructor.
+     * @param link Unreliable interface that carries the frames. It must
+     * outlive the transport.
+     * @param window Number of frames that can be sent without being
+     * acknowledged, from 1 (stop-and-wait) to max_window.
+     * @param max_payload Maximum number of bytes of the stream in each frame.
+     */
+    ComReliable(ComInterface *link, size_t window = 32, size_t max_payload = 256);
+
+    virtual ~ComReliable();
+
+    /**
+     * @brief Open the link, if it is not opened, and start a new session.
+     */
+    virtual bool Open();
+
+    /**
+     * @brief Stop the transport and close the link. The data that has not
+     * been acknowledged is discarded.
+     */
+    virtual bool Close();
+
+    virtual bool Opened();
+
+    virtual int ReadSome(void *buffer_in, size_t len);
+
+    /**
+     * @brief Non blocking write. The data is queued, up to the size of the
+     * window, and sent by the sender thread.
+     */
+    virtual int WriteSome(const void *buffer_out, size_t len);
+
+    virtual int Read(void *buffer_in, size_t len);
+
+    /**
+     * @brief Blocking write. It waits until all the data is queued or the
+     * timeout expires. The data is delivered later, when it is acknowledged.
+     */
+    virtual int Write(const void *buffer_out, size_t len);
+
+    virtual void Abort();
+
+    virtual bool SetWriteTimeout(unsigned int write_timeout);
+
+    virtual unsigned int GetWriteTimeout();
+
+    virtual bool SetReadTimeout(unsigned int read_timeout);
+
+    virtual unsigned int GetReadTimeout();
+
+    /**
+     * @brief Get an event that is readable while there is received data or
+     * the link has failed, for the external event loops.
+     */
+    virtual int GetReadinessHandle();
+
+    /**
+     * @brief Set the clock of the timeouts and of the retransmission timers.
+     */
+    virtual bool SetClock(ComClock *clock);
+
+    /**
+     * @brief Set the limits of the retransmission timeout. The initial
+     * timeout is 1 s, bounded by these limits.
+     * @param min_rto Minimum timeout in milliseconds.
+     * @param max_rto Maximum timeout in milliseconds.
+     * @return true if the function executes correctly, false if the
+     * limits are not valid.
+     */
+    bool SetRetransmission(unsigned int min_rto, unsigned int max_rto);
+
+    /**
+     * @brief Get the number of written bytes that have not been acknowledged yet.
+     * @return Number of bytes.
+     */
+    size_t GetUnacknowledged();
+
+    /**
+     * @brief Get the statistics of the transport.
+     * @param stats Statistics.
+     */
+    void GetStats(ComReliableStats& stats);
+
+private:
+    /**
+     * @brief Types of frame.
+     */
+    enum FrameType
+    {
+        frame_data = 0,     ///< Data of the stream.
+        frame_ack = 1       ///< Acknowledgement without data.
+    };
+
+    /**
+     * @brief Frame sent and not acknowledged.
+     */
+    struct Segment
+    {
+        boost::uint16_t seq;                        ///< Sequence number.
+        std::vector<unsigned char> payload;         ///< Data of the stream.
+        ComClock::time_point sent;                  ///< Time of the last transmission.
+        ComClock::time_point deadline;              ///< Expiration of the retransmission timer.
+        unsigned int transmissions;                 ///< Number of transmissions.
+        bool sacked;                                ///< Selectively acknowledged.
+        bool retransmit;                            ///< Retransmission requested.
+        bool fast;                                  ///< Fast retransmission done since the last timeout.
+    };
+
+    ComInterface *m_link;                           ///< Interface that carries the frames.
+    size_t m_window;                                ///< Maximum number of frames in flight.
+    size_t m_max_payload;                           ///< Maximum number of bytes of the stream in a frame.
+
+    // Sender
+    std::deque<unsigned char> m_tx;                 ///< Data pending to be sent.
+    std::deque<Segment> m_unacked;                  ///< Frames in flight, from m_snd_una.
+    boost::uint16_t m_snd_una;                      ///< Oldest sequence number not acknowledged.
+    boost::uint16_t m_snd_nxt;                      ///< Next sequence number to send.
+    boost::uint16_t m_epoch;                        ///< Session of this end.
+    std::vector<unsigned char> m_frames;            ///< Frames sent in the same write of the link.
+
+    // Receiver
+    std::deque<unsigned char> m_rx;                 ///< Received data pending to be read.
+    std::deque<std::vector<unsigned char> > m_reorder; ///< Window of frames received out of order, from m_rcv_nxt (empty if missing).
+    boost::uint16_t m_rcv_nxt;                      ///< Next sequence number expected.
+    boost::uint16_t m_peer_epoch;                   ///< Session of the other end, 0 if unknown.
+    bool m_ack_pending;                             ///< An acknowledgement must be sent.
+    std::vector<unsigned char> m_parse;             ///< Frame being received, without stuffing.
+    bool m_escape;                                  ///< The previous byte was an escape.
+    bool m_overflow;                                ///< The frame being received is too large.
+
+    // Retransmission timer
+    double m_srtt;                                  ///< Smoothed round trip time in milliseconds, 0 without samples.
+    double m_rttvar;                                ///< Round trip time variation in milliseconds.
+    double m_rto;                                   ///< Retransmission timeout in milliseconds.
+    unsigned int m_min_rto;                         ///< Minimum retransmission timeout in milliseconds.
+    unsigned int m_max_rto;                         ///< Maximum retransmission timeout in milliseconds.
+
+    ComReliableStats m_stats;                       ///< Statistics.
+    boost::thread m_sender;                         ///< Sender thread.
+    bool m_running;                                 ///< The transport has been started.
+    bool m_stop;                                    ///< The sender thread must finish.
+    bool m_failed;                                  ///< The link has failed or it has been closed.
+    unsigned int m_abort;                           ///< Number of calls to Abort(), to interrupt the waits.
+    unsigned int m_read_timeout;                    ///< Timeout of the Read operations in milliseconds.
+    unsigned int m_write_timeout;                   ///< Timeout of the Write operations in milliseconds.
+    ComEvent m_readable;                            ///< Event set while there is received data or the link has failed.
+    ComClock *m_clock;                              ///< Clock of the timeouts and the timers.
+    boost::mutex m_mutex;                           ///< Mutex of the transport.
+    boost::condition_variable m_tx_cond;            ///< Signals the sender thread.
+    boost::condition_variable m_rx_cond;            ///< Signals the blocking reads and writes.
+
+    /**
+     * @brief Stop the sender thread and the streaming of the link.
+     */
+    void stop();
+
+    /**
+     * @brief Take received data. The mutex must be locked.
+     * @param buffer_in Buffer that will contain the received data.
+     * @param len Maximum number of bytes to take.
+     * @return Number of bytes taken.
+     */
+    size_t take(void *buffer_in, size_t len);
+
+    /**
+     * @brief Queue data to be sent. The mutex must be locked.
+     * @param buffer_out Buffer that contains the data to be transmitted.
+     * @param len Maximum number of bytes to queue.
+     * @return Number of bytes queued.
+     */
+    size_t queue(const void *buffer_out, size_t len);
+
+    /**
+     * @brief Remove the byte stuffing of the data received by the link and
+     * process the complete frames.
+     * @param buffer Received data.
+     */
+    void receive_handler(const ComBuffer& buffer);
+
+    /**
+     * @brief Mark the link as failed and wake up all the waits.
+     */
+    void failure_handler();
+
+    /**
+     * @brief Process a received frame. The mutex must be locked.
+     * @param frame Frame without stuffing.
+     * @param len Number of bytes of the frame.
+     */
+    void process_frame(const unsigned char *frame, size_t len);
+
+    /**
+     * @brief Process the acknowledgements of a received frame. The mutex must be locked.
+     * @param ack Next sequence number expected by the other end.
+     * @param sack Bitmap of the frames received after ack.
+     * @param now Current time.
+     */
+    void process_ack(boost::uint16_t ack, boost::uint32_t sack, const ComClock::time_point& now);
+
+    /**
+     * @brief Update the retransmission timeout with a round trip time sample.
+     * The mutex must be locked.
+     * @param rtt Round trip time in milliseconds.
+     */
+    void sample_rtt(double rtt);
+
+    /**
+     * @brief Append a frame to m_frames, with its stuffing and CRC. The
+     * mutex must be locked.
+     * @param type Type of the frame.
+     * @param seq Sequence number.
+     * @param payload Data of the stream, or NULL.
+     * @param len Number of bytes of data.
+     */
+    void append_frame(FrameType type, boost::uint16_t seq,
+                      const unsigned char *payload, size_t len);
+
+    /**
+     * @brief Get the bitmap of the frames received after the next expected
+     * one. The mutex must be locked.
+     * @return Bitmap, with bit i set if the frame m_rcv_nxt + 1 + i has been received.
+     */
+    boost::uint32_t sack_bitmap();
+
+    /**
+     * @brief Gather the frames to send now in m_frames: retransmissions,
+     * new data and acknowledgements. The mutex must be locked.
+     * @param now Current time.
+     * @return Deadline of the next retransmission timer, or
+     * ComClock::time_point::max() if there is none.
+     */
+    ComClock::time_point gather(const ComClock::time_point& now);
+
+    /**
+     * @brief Body of the sender thread.
+     */
+    void sender();
+
+    /**
+     * @brief Get the deadline of a wait. The mutex must be locked.
+     * @param timeout Time in milliseconds.
+     * @return Deadline.
+     */
+    ComClock::time_point deadline(unsigned int timeout);
+};
+
+#endif // _COMRELIABLE_HPP_
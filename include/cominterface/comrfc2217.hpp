@@ -0,0 +1,540 @@
+/**
+ * @file    comrfc2217.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Remote serial ports over Telnet (RFC 2217).
+ */
+
+#ifndef _COMRFC2217_HPP_
+#define _COMRFC2217_HPP_
+
+#include <deque>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "cominterface/cominterface.hpp"
+#include "cominterface/comclock.hpp"
+#include "cominterface/comevent.hpp"
+#include "cominterface/comserial.hpp"
+
+/**
+ * @brief Telnet protocol of a connection: the escaping of the data, and the
+ * negotiation of the options (RFC 854 and RFC 855). It is used by ComRfc2217
+ * and ComRfc2217Server, and it is not thread safe.
+ */
+class ComTelnet
+{
+public:
+    static const unsigned char iac = 255;       ///< Interpret As Command, the escape of the commands.
+
+    ComTelnet();
+
+    /**
+     * @brief Forget the state of the options and of the parsing, for a new
+     * connection. The supported options are kept.
+     */
+    void Reset();
+
+    /**
+     * @brief Set the options that are accepted when the other end requests them.
+     * @param option Option.
+     * @param local Accept to enable it in this end (DO).
+     * @param remote Accept to enable it in the other end (WILL).
+     */
+    void Support(unsigned char option, bool local, bool remote);
+
+    /**
+     * @brief Request to enable an option, if it is not enabled or requested.
+     * @param option Option.
+     * @param local Enable it in this end (WILL), or in the other end (DO).
+     * @param out Buffer where the request is appended.
+     */
+    void Request(unsigned char option, bool local, std::vector<unsigned char>& out);
+
+    /**
+     * @brief Check if an option is enabled.
+     * @param option Option.
+     * @param local Check this end, or the other end.
+     * @return true if the option is enabled.
+     */
+    bool Enabled(unsigned char option, bool local) const;
+
+    /**
+     * @brief Check if the other end has refused a requested option.
+     * @param option Option.
+     * @param local Check this end, or the other end.
+     * @return true if the option has been refused.
+     */
+    bool Refused(unsigned char option, bool local) const;
+
+    /**
+     * @brief Parse received bytes. The sequences split between calls are
+     * completed with the next bytes.
+     * @param bytes Received bytes.
+     * @param len Number of received bytes.
+     * @param data Buffer where the data is appended, without escaping.
+     * @param replies Buffer where the answers of the negotiations are appended.
+     * @param subnegotiations Buffer where the completed subnegotiations are
+     * appended, each one with its option followed by its parameters.
+     */
+    void Parse(const unsigned char *bytes, size_t len, std::vector<unsigned char>& data,
+               std::vector<unsigned char>& replies,
+               std::vector<std::vector<unsigned char> >& subnegotiations);
+
+    /**
+     * @brief Escape data, doubling its IAC bytes.
+     * @param data Data.
+     * @param len Number of bytes of data.
+     * @param out Buffer where the escaped data is appended.
+     */
+    static void Escape(const unsigned char *data, size_t len, std::vector<unsigned char>& out);
+
+    /**
+     * @brief Get the number of bytes of data of a prefix of escaped data,
+     * e.g. to know the data written by a short write.
+     * @param escaped Escaped data.
+     * @param len Number of bytes of the prefix.
+     * @return Number of bytes of data.
+     */
+    static size_t Unescaped(const unsigned char *escaped, size_t len);
+
+    /**
+     * @brief Append a subnegotiation.
+     * @param option Option.
+     * @param data Parameters, without escaping.
+     * @param len Number of bytes of the parameters.
+     * @param out Buffer where the subnegotiation is appended.
+     */
+    static void Subnegotiation(unsigned char option, const unsigned char *data, size_t len,
+                               std::vector<unsigned char>& out);
+
+private:
+    /**
+     * @brief State of the parsing.
+     */
+    enum State
+    {
+        state_data,                 ///< Data.
+        state_command,              ///< After an IAC.
+        state_option,               ///< After a negotiation command, waiting for its option.
+        state_subnegotiation,       ///< Parameters of a subnegotiation.
+        state_subnegotiation_iac    ///< After an IAC inside a subnegotiation.
+    };
+
+    State m_state;                              ///< State of the parsing.
+    unsigned char m_command;                    ///< Negotiation command being received.
+    std::vector<unsigned char> m_parameters;    ///< Subnegotiation being received.
+    unsigned char m_local[256];                 ///< State of the options in this end.
+    unsigned char m_remote[256];                ///< State of the options in the other end.
+
+    /**
+     * @brief Answer a negotiation command.
+     * @param command WILL, WONT, DO or DONT.
+     * @param option Option.
+     * @param replies Buffer where the answer is appended.
+     */
+    void negotiate(unsigned char command, unsigned char option, std::vector<unsigned char>& replies);
+};
+
+/**
+ * @brief Client of a remote serial port, through a terminal server that
+ * implements the Telnet Com Port Control Option (RFC 2217). It exposes the
+ * remote port with the API of a ComSerial.
+ *
+ * The link is usually a ComSocket connected to the terminal server. The
+ * configuration of the port is sent when the interface is opened, and the
+ * setters change it at once while it is opened, waiting for the
+ * acknowledgement of the server. The negotiations are gathered in a single
+ * write of the link, and so are the settings of Open().
+ *
+ * The data is written as it is unless it contains IAC bytes, that are
+ * escaped in a copy of it.
+ * @note The acknowledgements of the server are waited for with the read
+ * timeout.
+ */
+class ComRfc2217 : public ComInterface
+{
+public:
+    /**
+     * @brief RFC 2217 client constructor.
+     * @param link Interface connected to the terminal server. It must outlive the decorator.
+     * @param baud_rate Baudrate.
+     * @param data_bits Number of data bits.
+     * @param stop_bits Number of stop bits. Set this parameter to 3
+     * means 1.5 stop bits.
+     * @param parity Parity. It can be even 'e', odd 'o', mark 'm', space
+     * 's' or nothing 'n'.
+     * @param flow_control Flow control. It can be hardware 'h',
+     * software 's' or nothing 'n'.
+     */
+    ComRfc2217(ComInterface *link, unsigned int baud_rate = 38400, unsigned int data_bits = 8,
+               unsigned int stop_bits = 1, char parity = 'n', char flow_control = 'n');
+
+    virtual ~ComRfc2217();
+
+    /**
+     * @brief Open the link, if it is not opened, negotiate the options and
+     * configure the remote port.
+     * @return true if the server accepts the option and the configuration,
+     * false otherwise.
+     */
+    virtual bool Open();
+
+    virtual bool Close();
+
+    virtual bool Opened();
+
+    virtual int ReadSome(void *buffer_in, size_t len);
+
+    virtual int WriteSome(const void *buffer_out, size_t len);
+
+    virtual int Read(void *buffer_in, size_t len);
+
+    virtual int Write(const void *buffer_out, size_t len);
+
+    virtual void Abort();
+
+    virtual bool SetWriteTimeout(unsigned int write_timeout);
+
+    virtual unsigned int GetWriteTimeout();
+
+    virtual bool SetReadTimeout(unsigned int read_timeout);
+
+    virtual unsigned int GetReadTimeout();
+
+    /**
+     * @brief Get an event that is readable while there is received data or
+     * the link has failed, for the external event loops.
+     */
+    virtual int GetReadinessHandle();
+
+    /**
+     * @brief Set the clock of the timeouts, and of the link.
+     */
+    virtual bool SetClock(ComClock *clock);
+
+    /**
+     * @brief Set the baud rate of the remote port.
+     * @param baud_rate Baudrate.
+     * @return true if the function executes correctly, false if the value
+     * is not valid or the server doesn't accept it.
+     */
+    bool SetBaudRate(unsigned int baud_rate);
+
+    /**
+     * @brief Get the baud rate of the remote port.
+     * @return Baudrate.
+     */
+    unsigned int GetBaudRate();
+
+    /**
+     * @brief Set the number of data bits of the remote port.
+     * @param data_bits Number of data bits, from 5 to 8.
+     * @return true if the function executes correctly, false if the value
+     * is not valid or the server doesn't accept it.
+     */
+    bool SetDataBits(unsigned int data_bits);
+
+    /**
+     * @brief Get the number of data bits of the remote port.
+     * @return Number of data bits.
+     */
+    unsigned int GetDataBits();
+
+    /**
+     * @brief Set the number of stop bits of the remote port.
+     * @param stop_bits Number of stop bits. Set this parameter to 3
+     * means 1.5 stop bits.
+     * @return true if the function executes correctly, false if the value
+     * is not valid or the server doesn't accept it.
+     */
+    bool SetStopBits(unsigned int stop_bits);
+
+    /**
+     * @brief Get the number of stop bits of the remote port.
+     * @return Number of stop bits. If the returned value is 3, it means 1.5
+     * stop bits.
+     */
+    unsigned int GetStopBits();
+
+    /**
+     * @brief Set the parity of the remote port.
+     * @param parity Parity. It can be even 'e', odd 'o', mark 'm', space
+     * 's' or nothing 'n'.
+     * @return true if the function executes correctly, false if the value
+     * is not valid or the server doesn't accept it.
+     */
+    bool SetParity(char parity);
+
+    /**
+     * @brief Get the parity of the remote port.
+     * @return Parity. It can be even 'e', odd 'o', mark 'm', space 's' or
+     * nothing 'n'.
+     */
+    char GetParity();
+
+    /**
+     * @brief Set the flow control of the remote port.
+     * @param flow_control Flow control. It can be hardware 'h',
+     * software 's' or nothing 'n'.
+     * @return true if the function executes correctly, false if the value
+     * is not valid or the server doesn't accept it.
+     */
+    bool SetFlowControl(char flow_control);
+
+    /**
+     * @brief Get the flow control of the remote port.
+     * @return Flow control. It can be hardware 'h', software 's' or
+     * nothing 'n'.
+     */
+    char GetFlowControl();
+
+    /**
+     * @brief Discard the pending bytes in the buffers of the remote port.
+     * @return true if function succeeds, false if not.
+     */
+    bool Flush();
+
+    /**
+     * @brief Send a break sequence to the remote port.
+     * @return true if function succeeds, false if not.
+     */
+    bool SendBreak();
+
+    /**
+     * @brief Set the state of the DTR (Data Terminal Ready) line of the remote port.
+     * @param state true to activate the line, false to deactivate it.
+     * @return true if function succeeds, false if not.
+     */
+    bool SetDtr(bool state);
+
+    /**
+     * @brief Set the state of the RTS (Request To Send) line of the remote port.
+     * @param state true to activate the line, false to deactivate it.
+     * @return true if function succeeds, false if not.
+     */
+    bool SetRts(bool state);
+
+    /**
+     * @brief Get the state of the input modem lines of the remote port, as
+     * notified by the server.
+     * @return Mask of the active lines (ComSerial::modem_cts,
+     * ComSerial::modem_dsr, ComSerial::modem_ri and ComSerial::modem_cd),
+     * or -1 if the server has not notified it.
+     */
+    int GetModemStatus();
+
+private:
+    static const size_t num_commands = 13;          ///< Number of commands of the option.
+
+    ComInterface *m_link;                           ///< Interface connected to the server.
+    ComTelnet m_telnet;                             ///< Telnet protocol of the connection.
+    boost::uint32_t m_config[num_commands];         ///< Configuration of the port, indexed by command.
+    unsigned int m_acks[num_commands];              ///< Number of acknowledgements of each command.
+    boost::uint32_t m_ack_values[num_commands];     ///< Value of the last acknowledgement of each command.
+    int m_modem_status;                             ///< State of the modem lines, -1 if not notified.
+
+    // Sender
+    std::vector<unsigned char> m_escaped;           ///< Data being written, escaped.
+    boost::mutex m_write_mutex;                     ///< Serializes the writes to the link.
+    boost::mutex m_request_mutex;                   ///< Serializes the commands, so their acknowledgements are not mixed.
+
+    // Receiver
+    std::deque<unsigned char> m_rx;                 ///< Received data pending to be read.
+    std::vector<unsigned char> m_data;              ///< Data of the last received bytes.
+    std::vector<unsigned char> m_replies;           ///< Answers to the last received negotiations.
+    std::vector<std::vector<unsigned char> > m_subnegotiations; ///< Last received subnegotiations.
+
+    bool m_running;                                 ///< The link is being received.
+    bool m_failed;                                  ///< The link has failed or it has been closed.
+    unsigned int m_abort;                           ///< Number of calls to Abort(), to interrupt the waits.
+    unsigned int m_read_timeout;                    ///< Timeout of the Read operations in milliseconds.
+    ComEvent m_readable;                            ///< Event set while there is received data or the link has failed.
+    ComClock *m_clock;                              ///< Clock of the timeouts.
+    boost::mutex m_mutex;                           ///< Mutex of the receiver and the configuration.
+    boost::condition_variable m_rx_cond;            ///< Signals the received data and acknowledgements.
+
+    /**
+     * @brief Stop the streaming of the link.
+     */
+    void stop();
+
+    /**
+     * @brief Take received data. The mutex must be locked.
+     * @param buffer_in Buffer that will contain the received data.
+     * @param len Maximum number of bytes to take.
+     * @return Number of bytes taken.
+     */
+    size_t take(void *buffer_in, size_t len);
+
+    /**
+     * @brief Write bytes to the link.
+     * @param bytes Bytes.
+     * @return true if all the bytes are written, false otherwise.
+     */
+    bool send(const std::vector<unsigned char>& bytes);
+
+    /**
+     * @brief Send commands of the option in a single write and wait for
+     * their acknowledgements.
+     * @param commands Commands, all different.
+     * @param values Values of the commands.
+     * @param count Number of commands.
+     * @return true if all the commands are acknowledged, false otherwise.
+     */
+    bool request(const unsigned char *commands, const boost::uint32_t *values, size_t count);
+
+    /**
+     * @brief Change a setting of the port. It is stored if the link is not
+     * opened, and it is sent to the server otherwise.
+     * @param command Command of the setting.
+     * @param value Value.
+     * @return true if the server accepts the value, false otherwise.
+     */
+    bool configure(unsigned char command, boost::uint32_t value);
+
+    /**
+     * @brief Send a command that acts on the port.
+     * @param command Command.
+     * @param value Value.
+     * @return true if the server acknowledges the same value, false otherwise.
+     */
+    bool execute(unsigned char command, boost::uint32_t value);
+
+    /**
+     * @brief Parse the data received by the link.
+     * @param buffer Received data.
+     */
+    void receive_handler(const ComBuffer& buffer);
+
+    /**
+     * @brief Mark the link as failed and wake up the reads.
+     */
+    void failure_handler();
+};
+
+/**
+ * @brief Server of a local serial port over the Telnet Com Port Control
+ * Option (RFC 2217), for a ComRfc2217 or any other client.
+ *
+ * The data is relayed in both directions, and the commands of the client
+ * configure the port. The modem lines of the port are polled, and their
+ * changes are notified to the client.
+ * @note The link is usually a ComSocket in server mode, so Start() waits
+ * for a client. The break commands send a break sequence of the duration
+ * of ComSerial::SendBreak(), and the inbound flow control commands are
+ * answered without changing the port.
+ */
+class ComRfc2217Server : private boost::noncopyable
+{
+public:
+    static const unsigned int poll_interval = 100;  ///< Milliseconds between the polls of the modem lines.
+
+    /**
+     * @brief RFC 2217 server constructor.
+     * @param serial Serial port to expose. It must outlive the server.
+     * @param link Interface of the client. It must outlive the server.
+     */
+    ComRfc2217Server(ComSerial *serial, ComInterface *link);
+
+    ~ComRfc2217Server();
+
+    /**
+     * @brief Open the serial port and the link, if they are not opened, and
+     * start serving the client.
+     * @return true if the function executes correctly, false otherwise.
+     */
+    bool Start();
+
+    /**
+     * @brief Stop serving the client. The serial port and the link are not closed.
+     */
+    void Stop();
+
+    /**
+     * @brief Check if the client is being served.
+     * @return true if the server is started and the link has not failed.
+     */
+    bool Running();
+
+    /**
+     * @brief Get an event that is readable when the link or the port fails,
+     * for the external event loops that restart the server.
+     * @return Descriptor, or -1 if it is not available.
+     */
+    int GetReadinessHandle();
+
+private:
+    ComSerial *m_serial;                            ///< Exposed serial port.
+    ComInterface *m_link;                           ///< Interface of the client.
+    ComTelnet m_telnet;                             ///< Telnet protocol of the connection.
+    bool m_dtr;                                     ///< State of the DTR line.
+    bool m_rts;                                     ///< State of the RTS line.
+    unsigned char m_modem_mask;                     ///< Modem lines notified to the client.
+    int m_modem_status;                             ///< Last state of the modem lines notified.
+
+    std::vector<unsigned char> m_data;              ///< Data of the last bytes of the client.
+    std::vector<unsigned char> m_replies;           ///< Answers to the last bytes of the client.
+    std::vector<std::vector<unsigned char> > m_subnegotiations; ///< Last subnegotiations of the client.
+    std::vector<unsigned char> m_escaped;           ///< Data of the port being written, escaped.
+    boost::mutex m_write_mutex;                     ///< Serializes the writes to the link.
+
+    bool m_running;                                 ///< The client is being served.
+    bool m_failed;                                  ///< The link or the port has failed.
+    ComEvent m_readable;                            ///< Event set when the link or the port fails.
+    boost::thread m_poller;                         ///< Thread that polls the modem lines.
+    boost::mutex m_mutex;                           ///< Mutex of the state.
+    boost::condition_variable m_cond;               ///< Signals the stop to the poller.
+
+    /**
+     * @brief Write bytes to the link.
+     * @param bytes Bytes.
+     * @param len Number of bytes.
+     * @return true if all the bytes are written, false otherwise.
+     */
+    bool send(const unsigned char *bytes, size_t len);
+
+    /**
+     * @brief Execute a command of the client and append its answer.
+     * @param parameters Command followed by its value.
+     * @param replies Buffer where the answer is appended.
+     */
+    void execute(const std::vector<unsigned char>& parameters, std::vector<unsigned char>& replies);
+
+    /**
+     * @brief Append the notification of the state of the modem lines, if it
+     * has changed. The mutex must be locked.
+     * @param status State of the modem lines.
+     * @param replies Buffer where the notification is appended.
+     */
+    void notify_modem(int status, std::vector<unsigned char>& replies);
+
+    /**
+     * @brief Relay the data received by the serial port to the client.
+     * @param buffer Received data.
+     */
+    void serial_handler(const ComBuffer& buffer);
+
+    /**
+     * @brief Parse the data received from the client.
+     * @param buffer Received data.
+     */
+    void link_handler(const ComBuffer& buffer);
+
+    /**
+     * @brief Mark the server as failed.
+     */
+    void failure_handler();
+
+    /**
+     * @brief Poll the modem lines until the server is stopped.
+     */
+    void poll();
+};
+
+#endif // _COMRFC2217_HPP_
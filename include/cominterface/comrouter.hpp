@@ -0,0 +1,181 @@
+/**
+ * @file    comrouter.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Routing of frames to handlers by the fields of their header.
+ */
+
+#ifndef _COMROUTER_HPP_
+#define _COMROUTER_HPP_
+
+#include <map>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "cominterface/cominterface.hpp"
+
+/**
+ * @brief Match rule of a ComRouter. It is a pattern over the first bytes
+ * of the frame header: each byte is compared with a value under a mask, so
+ * a field can be matched exactly, partially or be ignored.
+ */
+class ComRouteRule
+{
+public:
+    /**
+     * @brief Add a byte to match. The bytes that are not added match any value.
+     * @param offset Offset of the byte in the frame.
+     * @param value Value of the byte.
+     * @param mask Bits of the byte that are compared.
+     * @return Reference to the rule, to chain calls.
+     */
+    ComRouteRule& Match(size_t offset, unsigned char value, unsigned char mask = 0xFF);
+
+    /**
+     * @brief Add a big endian field to match, e.g. a 16 bits message type.
+     * @param offset Offset of the field in the frame.
+     * @param size Size of the field in bytes, up to 4.
+     * @param value Value of the field.
+     * @return Reference to the rule, to chain calls.
+     */
+    ComRouteRule& MatchField(size_t offset, size_t size, unsigned int value);
+
+    /**
+     * @brief Get the length of the header that the rule needs.
+     * @return Number of bytes. Shorter frames don't match the rule.
+     */
+    size_t Size() const { return m_values.size(); }
+
+private:
+    friend class ComRouter;
+
+    std::vector<unsigned char> m_values;    ///< Value of each byte.
+    std::vector<unsigned char> m_masks;     ///< Mask of each byte, 0 to match any value.
+};
+
+/**
+ * @brief Router of the frames received from many interfaces to the handlers
+ * of the rules that match their header (e.g. device address, function code
+ * and message type).
+ *
+ * The rules are compiled into a deterministic automaton stored in a flat
+ * table with one row of 256 transitions per state, so a frame is routed
+ * with one table lookup per header byte, whatever the number of rules.
+ * The table is compiled after the rules change, by Compile() or by the
+ * next Route(...), and it is shared with the routing threads, so the rules
+ * can change while frames are routed.
+ * @note The size of the table grows with the number of different header
+ * prefixes of the rules, 1 KiB per prefix. Wildcards and partial masks
+ * combine the prefixes of the rules, so they can multiply the states.
+ */
+class ComRouter : private boost::noncopyable
+{
+public:
+    /**
+     * @brief Handler of the frames. It receives the interface from which the
+     * frame has been received and the frame.
+     */
+    typedef boost::function<void (ComInterface *, const ComBuffer&)> Handler;
+
+    /**
+     * @brief Router constructor.
+     */
+    ComRouter();
+
+    /**
+     * @brief Add a rule.
+     * @param rule Match rule.
+     * @param handler Handler called for the frames that match the rule.
+     * @return Identifier of the rule or -1 if the handler is empty.
+     */
+    int Add(const ComRouteRule& rule, const Handler& handler);
+
+    /**
+     * @brief Remove a rule.
+     * @param id Identifier returned by Add(...).
+     * @return true if the rule has been removed, false if it doesn't exist.
+     */
+    bool Remove(int id);
+
+    /**
+     * @brief Remove all the rules.
+     */
+    void Clear();
+
+    /**
+     * @brief Compile the rules into the lookup table, if they have changed.
+     * Calling it after the rules are registered avoids the compilation in
+     * the next Route(...).
+     * @return Number of states of the table.
+     */
+    size_t Compile();
+
+    /**
+     * @brief Call the handlers of the rules that match a frame, in the
+     * order in which the rules were added.
+     * @param source Interface from which the frame has been received.
+     * @param frame Frame.
+     * @return Number of handlers called.
+     */
+    size_t Route(ComInterface *source, const ComBuffer& frame);
+
+    /**
+     * @brief Call the handlers of the rules that match a frame.
+     * @param source Interface from which the frame has been received.
+     * @param data Frame data.
+     * @param size Frame size.
+     * @param frame Frame passed to the handlers.
+     * @return Number of handlers called.
+     */
+    size_t Route(ComInterface *source, const unsigned char *data, size_t size,
+                 const ComBuffer& frame);
+
+    /**
+     * @brief Get the number of rules.
+     * @return Number of rules.
+     */
+    size_t GetRules();
+
+private:
+    /**
+     * @brief Registered rule.
+     */
+    struct Entry
+    {
+        ComRouteRule rule;      ///< Match rule.
+        Handler handler;        ///< Handler of the frames.
+    };
+
+    /**
+     * @brief Compiled lookup table.
+     */
+    struct Table
+    {
+        size_t depth;                           ///< Number of header bytes examined.
+        std::vector<unsigned int> next;         ///< 256 transitions per state. State 0 matches nothing.
+        std::vector<unsigned int> first;        ///< First matched handler of each state, plus the end.
+        std::vector<unsigned int> matched;      ///< Handlers matched by the states.
+        std::vector<Handler> handlers;          ///< Handlers of the rules.
+    };
+
+    typedef boost::shared_ptr<const Table> TablePtr;
+
+    std::map<int, Entry> m_rules;   ///< Rules in the order in which they were added.
+    int m_next_id;                  ///< Identifier of the next rule.
+    TablePtr m_table;               ///< Table of the current rules, NULL if they have changed.
+    boost::mutex m_mutex;           ///< Mutex to make the router thread safe.
+
+    /**
+     * @brief Get the table of the current rules, compiling it if needed.
+     * The mutex must be locked.
+     * @return Table.
+     */
+    TablePtr table();
+};
+
+#endif // _COMROUTER_HPP_
@@ -0,0 +1,169 @@
+/**
+ * @file    comsamples.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Decoding of streams of binary samples.
+ */
+
+#ifndef _COMSAMPLES_HPP_
+#define _COMSAMPLES_HPP_
+
+#include <string>
+
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "cominterface/comlayout.hpp"
+
+/**
+ * @brief Decoder of the sample frames of a data acquisition stream: each
+ * frame has one signed integer sample of each channel, interleaved. The
+ * samples are byte-swapped if needed, sign-extended and deinterleaved to
+ * an array per channel, of 32 bit integers or of floats in [-1, 1).
+ *
+ * The samples are converted with SSSE3 or AVX2 shuffles when the processor
+ * supports them, and the frames of 2, 4 and 8 channels are deinterleaved
+ * with them too. The frames are decoded in place from the received
+ * data, e.g. from the buffers of the streaming mode:
+ * @code
+ * handlers.on_data = boost::bind(&Acquisition::OnData, this, _1);
+ *
+ * void Acquisition::OnData(const ComBuffer& buffer)
+ * {
+ *     size_t frames = m_decoder.Push(buffer.Data(), buffer.Size(), m_channels);
+ *     ...
+ * }
+ * @endcode
+ */
+class ComSampleDecoder : private boost::noncopyable
+{
+public:
+    static const size_t max_channels = 256;     ///< Maximum number of channels of a frame.
+
+    /**
+     * @brief Sample decoder constructor.
+     * @param bits Bits of each sample: 16, 24 or 32.
+     * @param order Byte order of the samples.
+     * @param channels Number of channels of each frame, from 1 to max_channels.
+     */
+    ComSampleDecoder(unsigned int bits, ComByteOrder order, size_t channels = 1);
+
+    /**
+     * @brief Get the number of bytes of each frame.
+     * @return Number of bytes.
+     */
+    size_t GetFrameSize() const;
+
+    /**
+     * @brief Get the number of channels of each frame.
+     * @return Number of channels.
+     */
+    size_t GetChannels() const;
+
+    /**
+     * @brief Decode whole frames to floats in [-1, 1).
+     * @param data Frames, of GetFrameSize() bytes each.
+     * @param frames Number of frames.
+     * @param channels Array per channel where the samples are stored, with
+     * room for the frames.
+     */
+    void Decode(const void *data, size_t frames, float *const *channels) const;
+
+    /**
+     * @brief Decode whole frames to sign-extended integers.
+     * @param data Frames, of GetFrameSize() bytes each.
+     * @param frames Number of frames.
+     * @param channels Array per channel where the samples are stored, with
+     * room for the frames.
+     */
+    void Decode(const void *data, size_t frames, boost::int32_t *const *channels) const;
+
+    /**
+     * @brief Get the number of frames that are completed by the next
+     * received data.
+     * @param len Number of bytes of the data.
+     * @return Number of frames.
+     */
+    size_t GetFrameCount(size_t len);
+
+    /**
+     * @brief Decode the frames of a chunk of a stream to floats in [-1, 1).
+     * The bytes of an incomplete frame at the end of the chunk are kept,
+     * and the frame is completed with the next chunk.
+     * @param data Received data.
+     * @param len Number of bytes of the data.
+     * @param channels Array per channel where the samples are stored, with
+     * room for GetFrameCount(len) frames.
+     * @return Number of decoded frames.
+     */
+    size_t Push(const void *data, size_t len, float *const *channels);
+
+    /**
+     * @brief Decode the frames of a chunk of a stream to sign-extended
+     * integers. The bytes of an incomplete frame at the end of the chunk are
+     * kept, and the frame is completed with the next chunk.
+     * @param data Received data.
+     * @param len Number of bytes of the data.
+     * @param channels Array per channel where the samples are stored, with
+     * room for GetFrameCount(len) frames.
+     * @return Number of decoded frames.
+     */
+    size_t Push(const void *data, size_t len, boost::int32_t *const *channels);
+
+    /**
+     * @brief Discard the bytes of an incomplete frame, e.g. when the
+     * stream is restarted.
+     */
+    void Reset();
+
+    /**
+     * @brief Get the implementation of the sample conversions.
+     * @return "avx2", "ssse3" or "scalar".
+     */
+    static std::string GetKernel();
+
+    /**
+     * @brief Select the implementation of the sample conversions, e.g. to
+     * compare them. By default, the fastest one supported by the processor
+     * is used. It is thread safe: the frames being decoded by other threads
+     * when it is called are completed with the previous implementation.
+     * @param kernel "avx2", "ssse3" or "scalar".
+     * @return true if the function executes correctly, false if the
+     * implementation is unknown or not supported by the processor.
+     */
+    static bool SetKernel(const std::string& kernel);
+
+private:
+    unsigned int m_bytes;                       ///< Bytes of each sample.
+    ComByteOrder m_order;                       ///< Byte order of the samples.
+    size_t m_channels;                          ///< Number of channels of each frame.
+    float m_scale;                              ///< Factor from the integer samples to [-1, 1).
+    unsigned char m_partial[4 * max_channels];  ///< Received bytes of an incomplete frame.
+    size_t m_partial_size;                      ///< Number of bytes of m_partial.
+    boost::mutex m_mutex;                       ///< Mutex of the incomplete frame.
+
+    /**
+     * @brief Decode whole frames to one of the output types.
+     * @param data Frames.
+     * @param frames Number of frames.
+     * @param ints Arrays of the integer samples, or NULL.
+     * @param floats Arrays of the float samples, or NULL.
+     * @param offset Index of the first frame in the arrays.
+     */
+    void decode(const unsigned char *data, size_t frames, boost::int32_t *const *ints,
+                float *const *floats, size_t offset) const;
+
+    /**
+     * @brief Decode the frames of a chunk of a stream. The mutex must be locked.
+     * @param data Received data.
+     * @param len Number of bytes of the data.
+     * @param ints Arrays of the integer samples, or NULL.
+     * @param floats Arrays of the float samples, or NULL.
+     * @return Number of decoded frames.
+     */
+    size_t push(const unsigned char *data, size_t len, boost::int32_t *const *ints,
+                float *const *floats);
+};
+
+#endif // _COMSAMPLES_HPP_
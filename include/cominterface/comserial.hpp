@@ -8,17 +8,40 @@
 #ifndef _COMSERIAL_HPP_
 #define _COMSERIAL_HPP_
 
-#include <boost/asio.hpp>
-#include <boost/thread.hpp>
+#include <vector>
 
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/system/error_code.hpp>
+
+#include "cominterface/comclock.hpp"
 #include "cominterface/cominterface.hpp"
+#include "cominterface/compimpl.hpp"
+
+/**
+ * @brief Chunk of data received by a timestamped read of the serial port.
+ */
+struct ComSerialChunk
+{
+    size_t offset;                                      ///< Position of the chunk in the read buffer.
+    size_t length;                                      ///< Number of bytes of the chunk.
+    boost::chrono::steady_clock::time_point arrival;    ///< Monotonic time at which the chunk was read from the device.
+};
 
 /**
  * @brief Serial Port communication interface.
+ * @note The configuration setters (baud rate, data bits, stop bits, parity
+ * and flow control) also reconfigure the port if it is opened.
+ * @note The state of the port is kept in a private implementation, so this
+ * header doesn't include boost::asio.
  */
 class ComSerial : public ComInterface
 {
 public:
+    static const int modem_cts = 0x10;  ///< Clear To Send line of GetModemStatus().
+    static const int modem_dsr = 0x20;  ///< Data Set Ready line of GetModemStatus().
+    static const int modem_ri = 0x40;   ///< Ring Indicator line of GetModemStatus().
+    static const int modem_cd = 0x80;   ///< Carrier Detect line of GetModemStatus().
+
     /**
      * @brief Serial port interface constructor.
      * @param device Name of the serial port. Windows example: "COM1".
@@ -48,6 +71,8 @@ public:
 
     virtual bool Opened();
 
+    virtual int GetNativeHandle();
+
     virtual int ReadSome(void *buffer_in, size_t len);
 
     virtual int WriteSome(const void *buffer_out, size_t len);
@@ -56,6 +81,8 @@ public:
 
     virtual int Write(const void *buffer_out, size_t len);
 
+    virtual int ReadBatch(void *buffer_in, size_t len);
+
     virtual void Abort();
 
     virtual bool SetWriteTimeout(unsigned int write_timeout);
@@ -66,6 +93,20 @@ public:
 
     virtual unsigned int GetReadTimeout();
 
+    /**
+     * @brief Set the wake-up coalescing of ReadBatch(...). Once the first
+     * bytes of a batch arrive, ReadBatch(...) sleeps the time that the
+     * rest of the batch needs to arrive at the current baud rate, bounded
+     * by the maximum latency, instead of waking up with each burst.
+     */
+    virtual bool SetReadCoalescing(size_t min_batch, unsigned int max_latency);
+
+    /**
+     * @brief Set the clock of the read and write timeouts and of the
+     * arrival timestamps of the chunks.
+     */
+    virtual bool SetClock(ComClock *clock);
+
     /**
      * @brief Set the device name of the serial port.
      * @param device Name of the serial port. Windows example: "COM1".
@@ -163,23 +204,68 @@ public:
      */
     bool SendBreak();
 
+    /**
+     * @brief Set the state of the DTR (Data Terminal Ready) line.
+     * @param state true to activate the line, false to deactivate it.
+     * @return true if function succeeds, false if not.
+     */
+    bool SetDtr(bool state);
+
+    /**
+     * @brief Set the state of the RTS (Request To Send) line. It is
+     * driven by the port when the flow control is hardware.
+     * @param state true to activate the line, false to deactivate it.
+     * @return true if function succeeds, false if not.
+     */
+    bool SetRts(bool state);
+
+    /**
+     * @brief Get the state of the input modem lines.
+     * @return Mask of the active lines (modem_cts, modem_dsr, modem_ri
+     * and modem_cd), or -1 in case of error.
+     */
+    int GetModemStatus();
+
+    /**
+     * @brief Blocking read that records the arrival time of each received
+     * chunk. It waits until the indicated number of bytes are received or
+     * the timeout expires. The timestamps are taken when the reactor
+     * completes the read of the chunk, before returning to the caller.
+     * @param buffer_in Buffer that will contain the received data.
+     * @param len Number of bytes to read.
+     * @param chunks Received chunks, in order. Reserve its capacity to
+     * avoid memory allocations during the read.
+     * @return Number of bytes read or -1 in case of error.
+     */
+    int ReadTimestamped(void *buffer_in, size_t len, std::vector<ComSerialChunk>& chunks);
+
+    /**
+     * @brief Get the time needed to transmit a character with the current
+     * configuration (start bit, data bits, parity and stop bits).
+     * @return Time in nanoseconds.
+     */
+    boost::chrono::nanoseconds GetCharacterTime();
+
+    /**
+     * @brief Estimate the arrival time of a byte of a received chunk. The
+     * last byte of the chunk arrived at its timestamp, and the previous ones
+     * are spaced by the character time of the current configuration.
+     * @param chunk Received chunk.
+     * @param index Position of the byte in the chunk.
+     * @return Estimated arrival time.
+     */
+    boost::chrono::steady_clock::time_point EstimateArrival(const ComSerialChunk& chunk, size_t index);
+
 private:
-    // Control de boost asio
-    boost::asio::io_service m_io_service;               ///< Service for access OS resources.
-    boost::asio::serial_port m_port;                    ///< Serial port handler.
-    boost::asio::deadline_timer m_timer;                ///< Timeout timer for the asynchronous operations.
-    boost::posix_time::time_duration m_write_timeout;   ///< Time in milliseconds for the transmission timeout timer.
-    boost::posix_time::time_duration m_read_timeout;    ///< Time in milliseconds for the reception timeout timer.
+    struct Impl;
 
-    // Configuracin del puerto serie
-    std::string m_device;                                       ///< Name of the serial port.
-    boost::asio::serial_port_base::baud_rate m_baud_rate;       ///< Baudrate.
-    boost::asio::serial_port_base::character_size m_data_bits;  ///< Number of data bits.
-    boost::asio::serial_port_base::stop_bits m_stop_bits;       ///< Number of stop bits.
-    boost::asio::serial_port_base::parity m_parity;             ///< Parity.
-    boost::asio::serial_port_base::flow_control m_flow_control; ///< Flow control.
+    /**
+     * @brief Bytes of the inline storage of the implementation. If it
+     * doesn't fit, as in other platforms, it is allocated in the heap.
+     */
+    static const size_t impl_size = 3072;
 
-    boost::mutex m_mutex;       ///< Mutex to make the interface thread safe.
+    ComPimpl<Impl, impl_size> m_impl;   ///< Port, configuration and timeouts.
 
     /**
      * @brief This function is executed when a read/write asynchronous operation
@@ -200,6 +286,51 @@ private:
      */
     void timeout_handler(const boost::system::error_code& error);
 
+    /**
+     * @brief This function is executed when a chunk of a timestamped read is
+     * completed. It takes the arrival timestamp before anything else.
+     * @param error Indicate if an error occurred during the asynchronous operation.
+     * If no error occurs, its value will be 0.
+     * @param bytes_transferred Number of bytes received in the asynchronous operation.
+     * @param ret_error Error code for the current asynchronous operation.
+     * @param ret_bytes Number of bytes for the current asynchronous operation.
+     * @param arrival Arrival timestamp for the current asynchronous operation.
+     */
+    void chunk_handler(const boost::system::error_code& error, size_t bytes_transferred,
+                       boost::system::error_code *ret_error, size_t *ret_bytes,
+                       boost::chrono::steady_clock::time_point *arrival);
+
+    /**
+     * @brief This function is executed when a wait asynchronous operation
+     * is completed.
+     * @param error Indicate if an error occurred during the asynchronous operation.
+     * If no error occurs, its value will be 0.
+     * @param ret_error Error code for the wait. It is set to the value of error.
+     */
+    void wait_handler(const boost::system::error_code& error,
+                      boost::system::error_code *ret_error);
+
+    /**
+     * @brief Wait until the serial port is ready to read or the deadline expires.
+     * @param deadline Time at which the wait expires.
+     * @return 1 if the serial port is ready, 0 if the deadline expired or -1
+     * in case of error.
+     */
+    int wait_readable(const ComClock::time_point& deadline);
+
+    /**
+     * @brief Sleep until the deadline expires or the operation is aborted.
+     * @param deadline Time at which the sleep finishes.
+     */
+    void wait_until(const ComClock::time_point& deadline);
+
+    /**
+     * @brief Get the time needed to transmit a character with the current
+     * configuration.
+     * @return Time in nanoseconds.
+     */
+    boost::chrono::nanoseconds character_time();
+
     /**
      * @brief Get the number of bytes in the kernel read buffer of the serial port.
      * @return Number of bytes. If an error occurs, it returns -1.
@@ -211,6 +342,13 @@ private:
      * @return Number of bytes. If an error occurs, it returns -1.
      */
     int pending_for_write();
+
+    /**
+     * @brief Apply the configuration to the serial port, if it is opened.
+     * The mutex must be locked.
+     * @return true if function succeeds, false if not.
+     */
+    bool reconfigure();
 };
 
 #endif // _COMSERIAL_HPP_
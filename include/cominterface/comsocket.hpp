@@ -8,18 +8,37 @@
 #ifndef _COMSOCKET_HPP_
 #define _COMSOCKET_HPP_
 
-#include <boost/asio.hpp>
-#include <boost/thread.hpp>
+#include <vector>
 
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/system/error_code.hpp>
+
+#include "cominterface/comclock.hpp"
 #include "cominterface/cominterface.hpp"
+#include "cominterface/compimpl.hpp"
+
+/**
+ * @brief Kernel timestamps of the data received by a read operation.
+ * A timestamp equal to the clock epoch means that it is not available.
+ */
+struct ComTimestamps
+{
+    boost::chrono::system_clock::time_point first_rx;   ///< Kernel reception time of the first received chunk.
+    boost::chrono::system_clock::time_point last_rx;    ///< Kernel reception time of the last received chunk.
+    boost::chrono::system_clock::time_point returned;   ///< Time at which the read operation returned.
+};
 
 /**
  * @brief TCP/IP Socket communication interface.
  * It can be used as a server or a client.
+ * @note The state of the socket is kept in a private implementation, so
+ * this header doesn't include boost::asio.
  */
 class ComSocket: public ComInterface
 {
 public:
+    static const size_t post_batch = 64;    ///< Maximum number of posted messages gathered in one write.
+
     /**
      * @brief TCP/IP socket interface constructor.
      * @param address IP address of the device to connect. Example: "192.168.1.100".
@@ -42,6 +61,21 @@ public:
 
     virtual bool Opened();
 
+    virtual int GetNativeHandle();
+
+    /**
+     * @brief Set the size of the kernel receive buffer (SO_RCVBUF).
+     * The configuration is kept between Open calls.
+     */
+    virtual bool SetReceiveBufferSize(size_t size);
+
+    virtual size_t GetReceiveBufferSize();
+
+    /**
+     * @brief Set the clock of the open, read and write timeouts.
+     */
+    virtual bool SetClock(ComClock *clock);
+
     virtual int ReadSome(void *buffer_in, size_t len);
 
     virtual int WriteSome(const void *buffer_out, size_t len);
@@ -50,6 +84,8 @@ public:
 
     virtual int Write(const void *buffer_out, size_t len);
 
+    virtual int ReadBatch(void *buffer_in, size_t len);
+
     virtual void Abort();
 
     virtual bool SetWriteTimeout(unsigned int write_timeout);
@@ -60,6 +96,14 @@ public:
 
     virtual unsigned int GetReadTimeout();
 
+    /**
+     * @brief Set the wake-up coalescing of ReadBatch(...). The socket receive
+     * low watermark (SO_RCVLOWAT) is set to the batch size once the first
+     * bytes of a batch arrive, so the reactor only wakes up when the batch
+     * is completed or the maximum latency expires.
+     */
+    virtual bool SetReadCoalescing(size_t min_batch, unsigned int max_latency);
+
     /**
      * @brief Set the timeout time of the Open operations.
      * @param open_timeout Time in milliseconds.
@@ -99,21 +143,94 @@ public:
      */
     unsigned int GetPort();
 
+    /**
+     * @brief Enable the kernel software timestamps (SO_TIMESTAMPING) of the
+     * socket. The configuration is kept between Open calls.
+     * @param rx Timestamp the reception of data. The timestamps are returned
+     * by ReadTimestamped(...) and ReadSomeTimestamped(...).
+     * @param tx_ack Timestamp the acknowledgement of the transmitted data by
+     * the peer. The timestamps are returned by ReadTxTimestamp(...).
+     * @return true if the function executes correctly, false otherwise.
+     * @note Only available in Linux.
+     */
+    bool SetTimestamping(bool rx, bool tx_ack = false);
+
+    /**
+     * @brief Disable the Nagle algorithm (TCP_NODELAY), so the small writes
+     * are sent without waiting for the acknowledgement of the previous ones.
+     * It is recommended for protocols with small frames, like ComMux.
+     * The configuration is kept between Open calls.
+     * @param no_delay true to disable the Nagle algorithm.
+     * @return true if the function executes correctly, false otherwise.
+     */
+    bool SetNoDelay(bool no_delay);
+
+    /**
+     * @brief Non blocking read that also returns the kernel timestamps of
+     * the received data.
+     * @param buffer_in Buffer that will contain the received data.
+     * @param len Number of bytes to read.
+     * @param timestamps Timestamps of the received data.
+     * @return Number of bytes read or -1 in case of error.
+     */
+    int ReadSomeTimestamped(void *buffer_in, size_t len, ComTimestamps& timestamps);
+
+    /**
+     * @brief Blocking read that also returns the kernel timestamps of the
+     * received data. It waits until the indicated number of bytes are
+     * received or the timeout expires.
+     * @param buffer_in Buffer that will contain the received data.
+     * @param len Number of bytes to read.
+     * @param timestamps Timestamps of the received data.
+     * @return Number of bytes read or -1 in case of error.
+     */
+    int ReadTimestamped(void *buffer_in, size_t len, ComTimestamps& timestamps);
+
+    /**
+     * @brief Get the next acknowledgement timestamp of the transmitted data.
+     * It doesn't block.
+     * @param byte_id Index of the last acknowledged byte, counted from the
+     * activation of the timestamps.
+     * @param acked Kernel time at which the acknowledgement was received.
+     * @return true if a timestamp has been read, false if there is none.
+     */
+    bool ReadTxTimestamp(unsigned int& byte_id,
+                         boost::chrono::system_clock::time_point& acked);
+
+    /**
+     * @brief Queue a message to be written, without locking, so many threads
+     * can write small messages to the socket without contending on it.
+     * The thread that finds the queue idle becomes its owner: it writes the
+     * queued messages, gathering up to post_batch of them in each vectored
+     * write, until the queue is empty. The other threads return at once.
+     * @param message Message. It must not be modified after the call.
+     * @return Number of bytes queued (the size of the message), or -1 if
+     * a write of the queue has failed since the last Open().
+     * @note The messages of each thread are written in order and they are
+     * never mixed. If a write fails or expires, the queued messages are
+     * discarded, as the connection can't be used any more.
+     */
+    int Post(const ComBuffer& message);
+
+    /**
+     * @brief Get the number of posted bytes that have not been written yet.
+     * @return Number of bytes.
+     */
+    size_t GetPostedBytes();
+
 private:
-    // Control de boost asio
-    boost::asio::io_service m_io_service;               ///< Service for access OS resources.
-    boost::asio::ip::tcp::socket m_socket;              ///< Socket handler.
-    boost::asio::deadline_timer m_timer;                ///< Timeout timer for the asynchronous operations.
-    boost::asio::ip::tcp::acceptor m_acceptor;          ///< Acceptor for incoming connections in server mode.
-    boost::posix_time::time_duration m_write_timeout;   ///< Time in milliseconds for the transmission timeout timer.
-    boost::posix_time::time_duration m_read_timeout;    ///< Time in milliseconds for the reception timeout timer.
-    boost::posix_time::time_duration m_open_timeout;    ///< Time in milliseconds for the open timeout timer.
+    struct Impl;
+    struct PostNode;
+    struct PostQueue;
+    struct LowWatermarkGuard;
 
-    // Configuracin de la conexin
-    boost::asio::ip::address m_address;                 ///< IP address.
-    unsigned int m_port;                                ///< TCP port.
+    /**
+     * @brief Bytes of the inline storage of the implementation. If it
+     * doesn't fit, as in other platforms, it is allocated in the heap.
+     */
+    static const size_t impl_size = 3072;
 
-    boost::mutex m_mutex;                               ///< Mutex to make the interface thread safe.
+    ComPimpl<Impl, impl_size> m_impl;   ///< Socket, acceptor, configuration and posted messages.
 
     /**
      * @brief This function is executed when a connect or accept asynchronous
@@ -149,6 +266,63 @@ private:
      * If no error occurs (the timeout timer has expired), its value will be 0.
      */
     void timeout_accept_handler(const boost::system::error_code& error);
+
+    /**
+     * @brief This function is executed when the socket is ready to read or
+     * the wait is canceled by the timeout timer.
+     * @param error Indicate if an error occurred during the asynchronous operation.
+     * If no error occurs, its value will be 0.
+     * @param ret_error Error code for the wait. It is set to the value of error.
+     */
+    void wait_handler(const boost::system::error_code& error,
+                      boost::system::error_code *ret_error);
+
+    /**
+     * @brief Apply the kernel timestamps configuration to the opened socket.
+     * @return true if the function executes correctly, false otherwise.
+     */
+    bool apply_timestamping();
+
+    /**
+     * @brief Non blocking read through recvmsg, which updates the kernel
+     * timestamps of the received data.
+     * @param buffer_in Buffer that will contain the received data.
+     * @param len Number of bytes to read.
+     * @param timestamps Timestamps to update.
+     * @return Number of bytes read, 0 if there is no data available or -1
+     * in case of error or if the connection has been closed.
+     */
+    int recv_timestamped(void *buffer_in, size_t len, ComTimestamps& timestamps);
+
+    /**
+     * @brief Wait until the socket is ready to read or the deadline expires.
+     * @param deadline Time at which the wait expires.
+     * @return 1 if the socket is ready, 0 if the deadline expired or -1
+     * in case of error.
+     */
+    int wait_readable(const ComClock::time_point& deadline);
+
+    /**
+     * @brief Set the receive low watermark of the socket, if it changes.
+     * @param low_watermark Number of bytes.
+     * @return true if the function executes correctly, false otherwise.
+     */
+    bool set_low_watermark(size_t low_watermark);
+
+    /**
+     * @brief Write the posted messages until the queue is empty. It is only
+     * called by the owner of the queue.
+     */
+    void drain_posted();
+
+    /**
+     * @brief Blocking vectored write, that gathers the messages of several
+     * posted nodes in each system call. The mutex must be locked.
+     * @param nodes Nodes that contain the messages to be transmitted.
+     * @param len Number of bytes of the messages.
+     * @return true if all the bytes have been written, false otherwise.
+     */
+    bool write_gather(const std::vector<PostNode *>& nodes, size_t len);
 };
 
 #endif // _COMSOCKET_HPP_
@@ -0,0 +1,111 @@
+/**
+ * @file    comtimer.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Timeout timer of the asynchronous operations, driven by a ComClock.
+ */
+
+#ifndef _COMTIMER_HPP_
+#define _COMTIMER_HPP_
+
+#include <boost/asio.hpp>
+#include <boost/asio/basic_waitable_timer.hpp>
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include "cominterface/comclock.hpp"
+
+/**
+ * @brief Timer of an I/O service, as boost::asio::deadline_timer, whose
+ * time is measured with a ComClock. With the system clock it is an asio
+ * timer. With other clocks (e.g. a ComVirtualClock), the clock keeps the
+ * waits and the handlers are executed in the I/O service when it expires them.
+ */
+class ComTimer : private boost::noncopyable
+{
+public:
+    /**
+     * @brief Timer constructor. It uses the system clock.
+     * @param io_service Service that executes the handlers.
+     */
+    explicit ComTimer(boost::asio::io_service& io_service);
+
+    ~ComTimer();
+
+    /**
+     * @brief Set the clock of the timer. There must be no pending waits.
+     * @param clock Clock, or NULL for the system clock.
+     */
+    void SetClock(ComClock *clock);
+
+    /**
+     * @brief Get the clock of the timer.
+     * @return Clock.
+     */
+    ComClock *GetClock();
+
+    /**
+     * @brief Get the current time of the clock of the timer.
+     * @return Current time.
+     */
+    ComClock::time_point Now();
+
+    /**
+     * @brief Set the expiry time. The pending waits are canceled.
+     * @param expiry Time at which the timer expires.
+     */
+    void ExpiresAt(const ComClock::time_point& expiry);
+
+    /**
+     * @brief Set the expiry time relative to now. The pending waits are canceled.
+     * @param time Time until the timer expires.
+     */
+    void ExpiresFromNow(const ComClock::duration& time);
+
+    /**
+     * @brief Start an asynchronous wait until the timer expires.
+     * @param handler Handler executed when the timer expires, or with
+     * boost::asio::error::operation_aborted if the wait is canceled.
+     */
+    template <typename WaitHandler>
+    void AsyncWait(const WaitHandler& handler)
+    {
+        if (m_clock == ComClock::GetSystemClock() ||
+            !m_clock->schedule(*this, m_expiry, ComTimerHandler(handler)))
+            m_timer.async_wait(handler);
+    }
+
+    /**
+     * @brief Cancel the pending waits. It can be called from any thread.
+     * @param ec Error of the cancellation.
+     * @return Number of canceled waits.
+     */
+    size_t Cancel(boost::system::error_code& ec);
+
+private:
+    friend class ComClock;
+
+    boost::asio::io_service& m_io_service;  ///< Service that executes the handlers.
+    boost::asio::basic_waitable_timer<boost::chrono::steady_clock> m_timer; ///< Timer of the system clock.
+    ComClock *m_clock;                      ///< Clock of the timer.
+    ComClock::time_point m_expiry;          ///< Time at which the timer expires.
+    size_t m_waits;                         ///< Waits kept by the clock.
+    boost::scoped_ptr<boost::asio::io_service::work> m_work;   ///< Keeps the service running while the clock has waits.
+
+    /**
+     * @brief Count a wait kept by the clock, so the I/O service doesn't run
+     * out of work while it is pending. The mutex of the clock must be locked.
+     */
+    void hold();
+
+    /**
+     * @brief Execute the handler of a wait kept by the clock in the I/O
+     * service. The mutex of the clock must be locked.
+     * @param handler Handler of the wait.
+     * @param error Result of the wait.
+     */
+    void complete(const ComTimerHandler& handler, const boost::system::error_code& error);
+};
+
+#endif // _COMTIMER_HPP_
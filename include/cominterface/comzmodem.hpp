@@ -0,0 +1,297 @@
+/**
+ * @file    comzmodem.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   ZMODEM file transfer over a communication interface.
+ */
+
+#ifndef _COMZMODEM_HPP_
+#define _COMZMODEM_HPP_
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "cominterface/cominterface.hpp"
+
+/**
+ * @brief Statistics of the last transfer of a ComZmodem.
+ */
+struct ComZmodemStats
+{
+    ComZmodemStats() : files(0), bytes(0), resumed(0), retransmitted(0), errors(0) {}
+
+    unsigned long long files;           ///< Files transferred completely.
+    unsigned long long bytes;           ///< Bytes of the files transferred, without the resumed ones.
+    unsigned long long resumed;         ///< Bytes of the files skipped because the receiver already had them.
+    unsigned long long retransmitted;   ///< Bytes of the files sent again after an error.
+    unsigned long long errors;          ///< Corrupted data, timeouts and repositions.
+};
+
+/**
+ * @brief File transfer with the ZMODEM protocol over a communication
+ * interface (usually a ComSerial), compatible with the usual
+ * implementations (e.g. lrzsz's sz and rz).
+ *
+ * The data of a file is streamed in subpackets checked with a CRC-32,
+ * without waiting for an acknowledgement of each one. The receiver asks
+ * for the data again from the first corrupted byte, and the sender waits
+ * for acknowledgements only when the window of unacknowledged bytes is
+ * full. A receiver that already has the start of a file (e.g. after a
+ * broken transfer) asks for the rest of it, so the transfer is resumed.
+ *
+ * The files are sent from a memory mapping, without copying them.
+ * @note The transfer uses the read timeout of the interface for the
+ * timeouts of the protocol, and restores it at the end. The interface
+ * must not be in the streaming mode.
+ */
+class ComZmodem : private boost::noncopyable
+{
+public:
+    static const size_t max_subpacket = 8192;   ///< Maximum number of bytes of a data subpacket.
+
+    /**
+     * @brief ZMODEM constructor.
+     * @param link Interface of the transfers. It must be opened before
+     * each transfer and it must outlive the object.
+     */
+    explicit ComZmodem(ComInterface *link);
+
+    ~ComZmodem();
+
+    /**
+     * @brief Send a file. It blocks until the receiver has it, skips it or
+     * the transfer fails.
+     * @param path Path of the file.
+     * @param name Name of the file for the receiver. If it is empty, the
+     * name of the path is used.
+     * @return true if the receiver has the file, false if the transfer
+     * fails, is canceled or the receiver skips the file.
+     */
+    bool SendFile(const std::string& path, const std::string& name = "");
+
+    /**
+     * @brief Receive the files of a session. It blocks until the sender
+     * ends the session or the transfer fails.
+     * @param directory Directory where the files are written. The paths
+     * sent by the sender are reduced to their names.
+     * @param files Paths of the received files.
+     * @return true if the session ends correctly, false if the transfer
+     * fails or is canceled.
+     */
+    bool ReceiveFiles(const std::string& directory, std::vector<std::string>& files);
+
+    /**
+     * @brief Set the size of the data subpackets sent.
+     * @param size Number of bytes, from 32 to max_subpacket. The standard
+     * size is 1024, larger ones need receivers that accept them.
+     * @return true if the function executes correctly, false if the size
+     * is not valid.
+     */
+    bool SetSubpacketSize(size_t size);
+
+    /**
+     * @brief Set the window of the sender.
+     * @param window Number of bytes sent without being acknowledged, or 0
+     * to stream the whole file without acknowledgements.
+     */
+    void SetWindow(size_t window);
+
+    /**
+     * @brief Enable the resuming of the files that the receiver already
+     * has partially. The sender requests it, and the receiver resumes the
+     * files if it is enabled in any of the ends. It is enabled by default.
+     * The receiver compares the CRC-32 of its partial file with the one of
+     * the start of the offered file, and receives the whole file again if
+     * they are different.
+     * @param resume true to resume the files, false to overwrite them.
+     */
+    void SetResume(bool resume);
+
+    /**
+     * @brief Set the timeout of the messages of the protocol.
+     * @param timeout Time in milliseconds.
+     * @return true if the function executes correctly, false if the
+     * timeout is 0.
+     */
+    bool SetTimeout(unsigned int timeout);
+
+    /**
+     * @brief Cancel the current transfer. It can be called from any thread.
+     */
+    void Abort();
+
+    /**
+     * @brief Get the statistics of the current or the last transfer.
+     * @param stats Statistics.
+     */
+    void GetStats(ComZmodemStats& stats);
+
+private:
+    /**
+     * @brief Header of a frame.
+     */
+    struct Header
+    {
+        int type;                   ///< Type of frame.
+        unsigned char data[4];      ///< Position or flags, from ZP0 to ZP3.
+        bool crc32;                 ///< The header and its subpackets use CRC-32.
+    };
+
+    ComInterface *m_link;                   ///< Interface of the transfers.
+    size_t m_subpacket;                     ///< Bytes of the data subpackets sent.
+    size_t m_window;                        ///< Bytes sent without acknowledgement, 0 for no limit.
+    bool m_resume;                          ///< Resume the partial files.
+    unsigned int m_timeout;                 ///< Timeout of the messages in milliseconds.
+    boost::atomic<bool> m_abort;            ///< The transfer must be canceled.
+    ComZmodemStats m_stats;                 ///< Statistics of the transfer.
+    boost::mutex m_mutex;                   ///< Mutex of the statistics.
+
+    std::vector<unsigned char> m_in;        ///< Received bytes.
+    size_t m_in_pos;                        ///< Next byte of m_in to process.
+    size_t m_in_len;                        ///< Number of valid bytes of m_in.
+    std::vector<unsigned char> m_out;       ///< Bytes pending to be written.
+    unsigned char m_last;                   ///< Last byte sent, for the escaping.
+    unsigned int m_cancels;                 ///< Consecutive cancel bytes received.
+
+    /**
+     * @brief Send a file. The read timeout of the link is already set.
+     * @param data Data of the file.
+     * @param size Number of bytes of the file.
+     * @param name Name of the file for the receiver.
+     * @return true if the receiver has the file, false otherwise.
+     */
+    bool send_session(const unsigned char *data, size_t size, const std::string& name);
+
+    /**
+     * @brief Send the data of a file, from the position requested by the receiver.
+     * @param data Data of the file.
+     * @param size Number of bytes of the file.
+     * @param crc32 Use CRC-32.
+     * @param window Bytes sent without acknowledgement, 0 for no limit.
+     * @param offset Position requested by the receiver.
+     * @return true if the receiver has the whole file, false otherwise.
+     */
+    bool send_data(const unsigned char *data, size_t size, bool crc32, size_t window, size_t offset);
+
+    /**
+     * @brief Receive the files of a session. The read timeout of the link is already set.
+     * @param directory Directory of the files.
+     * @param files Paths of the received files.
+     * @return true if the session ends correctly, false otherwise.
+     */
+    bool receive_session(const std::string& directory, std::vector<std::string>& files);
+
+    /**
+     * @brief Check that a partial file is the start of the offered one,
+     * asking the sender for the CRC-32 of its first bytes.
+     * @param partial Partial file.
+     * @param len Bytes of the partial file.
+     * @return 1 if it is the start of the offered file, 0 if it isn't or it
+     * can't be checked, or -1 if the session is broken.
+     */
+    int check_partial(std::ifstream& partial, size_t len);
+
+    /**
+     * @brief Receive the data of a file.
+     * @param path Path of the file.
+     * @param offset Bytes of the file that the receiver already has.
+     * @return true if the whole file is received, false otherwise.
+     */
+    bool receive_data(const std::string& path, size_t offset);
+
+    /**
+     * @brief Read a byte.
+     * @return Byte, or a negative error code.
+     */
+    int read_byte();
+
+    /**
+     * @brief Read a byte of a binary header or a subpacket, removing its escaping.
+     * @return Byte, a frame end ORed with 0x100, or a negative error code.
+     */
+    int read_escaped();
+
+    /**
+     * @brief Read a frame header, skipping the previous garbage.
+     * @param header Header.
+     * @return Type of frame, or a negative error code.
+     */
+    int read_header(Header& header);
+
+    /**
+     * @brief Read a data subpacket.
+     * @param data Data of the subpacket.
+     * @param crc32 The subpacket uses CRC-32.
+     * @return Frame end of the subpacket, or a negative error code.
+     */
+    int read_subpacket(std::vector<unsigned char>& data, bool crc32);
+
+    /**
+     * @brief Check if a header has started to arrive, without waiting. The
+     * bytes before it are discarded.
+     * @return true if there is a header to read.
+     */
+    bool pending();
+
+    /**
+     * @brief Append a byte to the output, escaping it if needed.
+     * @param byte Byte.
+     */
+    void put_escaped(unsigned char byte);
+
+    /**
+     * @brief Append a hexadecimal header to the output.
+     * @param type Type of frame.
+     * @param data Position or flags, from ZP0 to ZP3.
+     */
+    void put_hex_header(int type, const unsigned char *data);
+
+    /**
+     * @brief Append a binary header to the output.
+     * @param type Type of frame.
+     * @param data Position or flags, from ZP0 to ZP3.
+     * @param crc32 Use CRC-32.
+     */
+    void put_binary_header(int type, const unsigned char *data, bool crc32);
+
+    /**
+     * @brief Append a data subpacket to the output.
+     * @param data Data.
+     * @param len Number of bytes of data.
+     * @param end Frame end.
+     * @param crc32 Use CRC-32.
+     */
+    void put_subpacket(const unsigned char *data, size_t len, int end, bool crc32);
+
+    /**
+     * @brief Write the output to the link.
+     * @return true if the function executes correctly, false if the link fails.
+     */
+    bool flush();
+
+    /**
+     * @brief Send a hexadecimal header with a position and write it.
+     * @param type Type of frame.
+     * @param position Position.
+     * @return true if the function executes correctly, false if the link fails.
+     */
+    bool send_position(int type, size_t position);
+
+    /**
+     * @brief Send the cancel sequence to the other end.
+     */
+    void cancel();
+
+    /**
+     * @brief Count an error of the transfer.
+     */
+    void count_error();
+};
+
+#endif // _COMZMODEM_HPP_
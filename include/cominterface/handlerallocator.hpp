@@ -0,0 +1,120 @@
+/**
+ * @file    handlerallocator.hpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Recycling memory for the asynchronous operation handlers.
+ */
+
+#ifndef _HANDLERALLOCATOR_HPP_
+#define _HANDLERALLOCATOR_HPP_
+
+#include <cstddef>
+#include <new>
+
+#include <boost/aligned_storage.hpp>
+#include <boost/noncopyable.hpp>
+
+/**
+ * @brief Memory block that is reused by the handler of an asynchronous
+ * operation, so a blocking Read or Write doesn't need to allocate memory
+ * in the heap each time it is called.
+ * @note Only one asynchronous operation can use the block at the same time.
+ * If it is already in use, or the requested size doesn't fit on it, the
+ * memory is taken from the heap.
+ */
+class HandlerAllocator : private boost::noncopyable
+{
+public:
+    /**
+     * @brief Size in bytes of the recycled memory block.
+     */
+    static const std::size_t storage_size = 1024;
+
+    HandlerAllocator() : m_in_use(false) {}
+
+    /**
+     * @brief Get memory for a handler.
+     * @param size Number of bytes requested.
+     * @return Pointer to the memory.
+     */
+    void *allocate(std::size_t size)
+    {
+        if (!m_in_use && size <= storage_size)
+        {
+            m_in_use = true;
+            return m_storage.address();
+        }
+
+        return ::operator new(size);
+    }
+
+    /**
+     * @brief Release the memory of a handler.
+     * @param pointer Pointer returned by allocate(...).
+     */
+    void deallocate(void *pointer)
+    {
+        if (pointer == m_storage.address())
+            m_in_use = false;
+        else
+            ::operator delete(pointer);
+    }
+
+private:
+    boost::aligned_storage<storage_size> m_storage;     ///< Recycled memory block.
+    bool m_in_use;                                      ///< The memory block is being used by a handler.
+};
+
+/**
+ * @brief Wrapper for a completion handler that makes boost::asio take
+ * the memory of the operation from a HandlerAllocator.
+ */
+template <typename Handler>
+class AllocHandler
+{
+public:
+    AllocHandler(HandlerAllocator& allocator, const Handler& handler) :
+        m_allocator(allocator), m_handler(handler) {}
+
+    template <typename Arg1>
+    void operator()(const Arg1& arg1)
+    {
+        m_handler(arg1);
+    }
+
+    template <typename Arg1, typename Arg2>
+    void operator()(const Arg1& arg1, const Arg2& arg2)
+    {
+        m_handler(arg1, arg2);
+    }
+
+    // Custom memory allocation hooks used by boost::asio
+    friend void *asio_handler_allocate(std::size_t size, AllocHandler<Handler> *this_handler)
+    {
+        return this_handler->m_allocator.allocate(size);
+    }
+
+    friend void asio_handler_deallocate(void *pointer, std::size_t /*size*/,
+                                        AllocHandler<Handler> *this_handler)
+    {
+        this_handler->m_allocator.deallocate(pointer);
+    }
+
+private:
+    HandlerAllocator& m_allocator;  ///< Memory used by the asynchronous operation.
+    Handler m_handler;              ///< Wrapped completion handler.
+};
+
+/**
+ * @brief Wrap a completion handler to use the memory of a HandlerAllocator.
+ * @param allocator Memory used by the asynchronous operation.
+ * @param handler Completion handler.
+ * @return Wrapped handler.
+ */
+template <typename Handler>
+inline AllocHandler<Handler> make_alloc_handler(HandlerAllocator& allocator, const Handler& handler)
+{
+    return AllocHandler<Handler>(allocator, handler);
+}
+
+#endif // _HANDLERALLOCATOR_HPP_
@@ -0,0 +1,203 @@
+/**
+ * @file    combuffer.cpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Pooled and reference counted message buffers implementation.
+ */
+
+#include <new>
+
+#include <boost/container/pmr/global_resource.hpp>
+
+#include "cominterface/combuffer.hpp"
+
+///////////////
+// ComBuffer //
+///////////////
+
+ComBuffer::ComBuffer(const ComBuffer& other) : m_block(other.m_block)
+{
+    if (m_block)
+        ++m_block->refs;
+}
+
+ComBuffer& ComBuffer::operator=(const ComBuffer& other)
+{
+    ComBufferBlock *block = other.m_block;
+
+    // Take the new reference before dropping the old one, so the
+    // self assignment is safe
+    if (block)
+        ++block->refs;
+
+    Reset();
+    m_block = block;
+
+    return *this;
+}
+
+ComBuffer::~ComBuffer()
+{
+    Reset();
+}
+
+bool ComBuffer::SetSize(std::size_t size)
+{
+    if (!m_block || size > m_block->capacity)
+        return false;
+
+    m_block->size = size;
+
+    return true;
+}
+
+void ComBuffer::Reset()
+{
+    // The last reference returns the block to its pool
+    if (m_block && --m_block->refs == 0)
+        m_block->pool->release(m_block);
+
+    m_block = NULL;
+}
+
+///////////////////
+// ComBufferPool //
+///////////////////
+
+ComBufferPool::ComBufferPool(boost::container::pmr::memory_resource *upstream,
+                             std::size_t max_cached) :
+                                 m_upstream(upstream), m_max_cached(max_cached)
+{
+    if (!m_upstream)
+        m_upstream = boost::container::pmr::get_default_resource();
+
+    for (unsigned int i = 0; i < num_size_classes; ++i)
+    {
+        m_free[i] = NULL;
+        m_free_count[i] = 0;
+    }
+}
+
+ComBufferPool::~ComBufferPool()
+{
+    Trim();
+}
+
+ComBuffer ComBufferPool::Allocate(std::size_t capacity)
+{
+    unsigned int size_class = 0;
+
+    // Look for the smallest size class where the buffer fits
+    while (size_class < num_size_classes && class_capacity(size_class) < capacity)
+        ++size_class;
+
+    if (size_class < num_size_classes)
+    {
+        capacity = class_capacity(size_class);
+
+        // Reuse a free block of the class if there is one
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        ComBufferBlock *block = m_free[size_class];
+
+        if (block)
+        {
+            m_free[size_class] = block->next;
+            --m_free_count[size_class];
+
+            block->next = NULL;
+            block->size = 0;
+            ++block->refs;
+
+            return ComBuffer(block);
+        }
+    }
+
+    // There is no free block, take the memory from the upstream resource
+    void *memory;
+
+    try
+    {
+        memory = m_upstream->allocate(sizeof(ComBufferBlock) + capacity);
+    }
+    catch (std::bad_alloc&)
+    {
+        return ComBuffer();
+    }
+
+    return ComBuffer(new (memory) ComBufferBlock(this, capacity, size_class));
+}
+
+void ComBufferPool::Trim()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    for (unsigned int i = 0; i < num_size_classes; ++i)
+    {
+        while (m_free[i])
+        {
+            ComBufferBlock *block = m_free[i];
+
+            m_free[i] = block->next;
+            free_block(block);
+        }
+
+        m_free_count[i] = 0;
+    }
+}
+
+boost::container::pmr::memory_resource *ComBufferPool::GetUpstreamResource()
+{
+    return m_upstream;
+}
+
+std::size_t ComBufferPool::GetCachedBlocks()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    std::size_t count = 0;
+
+    for (unsigned int i = 0; i < num_size_classes; ++i)
+        count += m_free_count[i];
+
+    return count;
+}
+
+/////////////////////
+// Private Methods //
+/////////////////////
+
+std::size_t ComBufferPool::class_capacity(unsigned int size_class)
+{
+    return static_cast<std::size_t>(64) << (2 * size_class);
+}
+
+void ComBufferPool::release(ComBufferBlock *block)
+{
+    // Blocks out of the size classes are not cached
+    if (block->size_class < num_size_classes)
+    {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        if (m_free_count[block->size_class] < m_max_cached)
+        {
+            block->next = m_free[block->size_class];
+            m_free[block->size_class] = block;
+            ++m_free_count[block->size_class];
+
+            return;
+        }
+    }
+
+    free_block(block);
+}
+
+void ComBufferPool::free_block(ComBufferBlock *block)
+{
+    std::size_t bytes = sizeof(ComBufferBlock) + block->capacity;
+
+    block->~ComBufferBlock();
+    m_upstream->deallocate(block, bytes);
+}
@@ -0,0 +1,299 @@
+/**
+ * @file    comclock.cpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Source of time of the timeouts of the communication interfaces implementation.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "cominterface/comclock.hpp"
+#include "cominterface/comtimer.hpp"
+
+/**
+ * @brief Clock of the system. The timers wait on their I/O service.
+ */
+class SystemClock : public ComClock
+{
+public:
+    virtual time_point Now()
+    {
+        return boost::chrono::steady_clock::now();
+    }
+
+    virtual boost::cv_status WaitUntil(boost::condition_variable& cond,
+                                       boost::unique_lock<boost::mutex>& lock,
+                                       const time_point& deadline)
+    {
+        return cond.wait_until(lock, deadline);
+    }
+};
+
+//////////////
+// ComClock //
+//////////////
+
+ComClock::~ComClock()
+{
+
+}
+
+ComClock *ComClock::GetSystemClock()
+{
+    static SystemClock clock;
+
+    return &clock;
+}
+
+bool ComClock::schedule(ComTimer& /*timer*/, const time_point& /*expiry*/,
+                        const ComTimerHandler& /*handler*/)
+{
+    return false;
+}
+
+size_t ComClock::cancel(ComTimer& /*timer*/)
+{
+    return 0;
+}
+
+void ComClock::hold(ComTimer& timer)
+{
+    timer.hold();
+}
+
+void ComClock::complete(ComTimer& timer, const ComTimerHandler& handler,
+                        const boost::system::error_code& error)
+{
+    timer.complete(handler, error);
+}
+
+/////////////////////
+// ComVirtualClock //
+/////////////////////
+
+ComVirtualClock::ComVirtualClock() : m_now()
+{
+
+}
+
+ComVirtualClock::~ComVirtualClock()
+{
+
+}
+
+ComClock::time_point ComVirtualClock::Now()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_now;
+}
+
+boost::cv_status ComVirtualClock::WaitUntil(boost::condition_variable& cond,
+                                            boost::unique_lock<boost::mutex>& lock,
+                                            const time_point& deadline)
+{
+    Waiter waiter;
+
+    waiter.cond = &cond;
+    waiter.mutex = lock.mutex();
+    waiter.deadline = deadline;
+    waiter.busy = false;
+
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> clock_lock(m_mutex);
+
+        if (m_now >= deadline)
+            return boost::cv_status::timeout;
+
+        m_waiters.push_back(&waiter);
+        m_cond.notify_all();
+    }
+
+    // The clock locks the mutex of the condition before notifying it, so
+    // the wake up is not lost before the wait starts
+    cond.wait(lock);
+
+    boost::unique_lock<boost::mutex> clock_lock(m_mutex);
+
+    m_waiters.remove(&waiter);
+
+    // The waiter can't be destroyed while the clock is waking it up, and
+    // the clock needs the mutex of the condition to finish
+    if (waiter.busy)
+    {
+        lock.unlock();
+
+        while (waiter.busy)
+            m_cond.wait(clock_lock);
+
+        // The mutex of the condition is always locked before the one of the clock
+        clock_lock.unlock();
+        lock.lock();
+        clock_lock.lock();
+    }
+
+    return m_now >= deadline ? boost::cv_status::timeout : boost::cv_status::no_timeout;
+}
+
+void ComVirtualClock::Advance(unsigned int time)
+{
+    // Lock for thread safe
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+
+    set_time(lock, m_now + boost::chrono::milliseconds(time));
+}
+
+bool ComVirtualClock::AdvanceToNext()
+{
+    // Lock for thread safe
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+
+    if (m_waiters.empty() && m_timers.empty())
+        return false;
+
+    time_point next = time_point::max();
+
+    for (std::list<Waiter *>::iterator it = m_waiters.begin(); it != m_waiters.end(); ++it)
+        next = std::min(next, (*it)->deadline);
+
+    for (std::list<Timer>::iterator it = m_timers.begin(); it != m_timers.end(); ++it)
+        next = std::min(next, it->expiry);
+
+    set_time(lock, std::max(next, m_now));
+
+    return true;
+}
+
+size_t ComVirtualClock::GetPending()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_waiters.size() + m_timers.size();
+}
+
+bool ComVirtualClock::WaitPending(size_t count, unsigned int timeout)
+{
+    // The real time is used, the virtual one doesn't change by itself
+    boost::chrono::steady_clock::time_point deadline = boost::chrono::steady_clock::now() +
+                                                       boost::chrono::milliseconds(timeout);
+
+    // Lock for thread safe
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+
+    while (m_waiters.size() + m_timers.size() < count)
+    {
+        if (m_cond.wait_until(lock, deadline) == boost::cv_status::timeout)
+            return m_waiters.size() + m_timers.size() >= count;
+    }
+
+    return true;
+}
+
+bool ComVirtualClock::schedule(ComTimer& timer, const time_point& expiry,
+                               const ComTimerHandler& handler)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    hold(timer);
+
+    // An expired timer completes at once, as the asio timers
+    if (expiry <= m_now)
+    {
+        complete(timer, handler, boost::system::error_code());
+        return true;
+    }
+
+    Timer wait;
+
+    wait.timer = &timer;
+    wait.expiry = expiry;
+    wait.handler = handler;
+
+    m_timers.push_back(wait);
+    m_cond.notify_all();
+
+    return true;
+}
+
+size_t ComVirtualClock::cancel(ComTimer& timer)
+{
+    size_t count = 0;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    for (std::list<Timer>::iterator it = m_timers.begin(); it != m_timers.end(); )
+    {
+        if (it->timer != &timer)
+        {
+            ++it;
+            continue;
+        }
+
+        complete(timer, it->handler, boost::asio::error::operation_aborted);
+        it = m_timers.erase(it);
+        ++count;
+    }
+
+    return count;
+}
+
+/////////////////////
+// Private Methods //
+/////////////////////
+
+void ComVirtualClock::set_time(boost::unique_lock<boost::mutex>& lock, const time_point& now)
+{
+    std::vector<Waiter *> expired;
+
+    m_now = now;
+
+    // The handlers of the timers are executed by the I/O services, so
+    // they can be posted with the mutex locked
+    for (std::list<Timer>::iterator it = m_timers.begin(); it != m_timers.end(); )
+    {
+        if (it->expiry > m_now)
+        {
+            ++it;
+            continue;
+        }
+
+        complete(*it->timer, it->handler, boost::system::error_code());
+        it = m_timers.erase(it);
+    }
+
+    for (std::list<Waiter *>::iterator it = m_waiters.begin(); it != m_waiters.end(); ++it)
+    {
+        if ((*it)->deadline <= m_now && !(*it)->busy)
+        {
+            (*it)->busy = true;
+            expired.push_back(*it);
+        }
+    }
+
+    if (expired.empty())
+        return;
+
+    // The mutex of the clock is released before locking the ones of the
+    // conditions, that are locked first by the waiters
+    lock.unlock();
+
+    for (size_t i = 0; i < expired.size(); ++i)
+    {
+        boost::lock_guard<boost::mutex> cond_lock(*expired[i]->mutex);
+
+        expired[i]->cond->notify_all();
+    }
+
+    lock.lock();
+
+    for (size_t i = 0; i < expired.size(); ++i)
+        expired[i]->busy = false;
+
+    m_cond.notify_all();
+}
@@ -0,0 +1,134 @@
+/**
+ * @file    comconflater.cpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Send queue that keeps only the latest message of each key implementation.
+ */
+
+#include <stdexcept>
+
+#include "cominterface/comconflater.hpp"
+
+////////////////////
+// Public Methods //
+////////////////////
+
+ComConflater::ComConflater(ComInterface *sink) : m_sink(sink), m_offset(0), m_conflated(0)
+{
+    if (!m_sink)
+        throw std::invalid_argument("invalid sink");
+}
+
+bool ComConflater::Send(unsigned int key, const ComBuffer& message)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    std::map<unsigned int, ComBuffer>::iterator it = m_pending.find(key);
+
+    // Replace the unsent message of the key, keeping its position
+    if (it != m_pending.end())
+    {
+        it->second = message;
+        ++m_conflated;
+    }
+    else
+    {
+        m_pending[key] = message;
+        m_order.push_back(key);
+    }
+
+    return flush() >= 0;
+}
+
+int ComConflater::Flush()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return flush();
+}
+
+bool ComConflater::WantsWrite()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_current.Valid() || !m_order.empty();
+}
+
+size_t ComConflater::GetPending()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_pending.size() + (m_current.Valid() ? 1 : 0);
+}
+
+unsigned long long ComConflater::GetConflated()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_conflated;
+}
+
+void ComConflater::Clear()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_pending.clear();
+    m_order.clear();
+}
+
+/////////////////////
+// Private Methods //
+/////////////////////
+
+int ComConflater::flush()
+{
+    int total = 0;
+
+    while (true)
+    {
+        // Take the next message when the current one is completed
+        if (!m_current.Valid())
+        {
+            if (m_order.empty())
+                break;
+
+            std::map<unsigned int, ComBuffer>::iterator it = m_pending.find(m_order.front());
+
+            m_current = it->second;
+            m_offset = 0;
+            m_pending.erase(it);
+            m_order.pop_front();
+
+            if (m_current.Size() == 0)
+            {
+                m_current.Reset();
+                continue;
+            }
+        }
+
+        size_t pending = m_current.Size() - m_offset;
+        int ret_code = m_sink->WriteSome(m_current.Data() + m_offset, pending);
+
+        if (ret_code < 0)
+            return -1;
+
+        total += ret_code;
+
+        // The interface doesn't accept more data by now
+        if (static_cast<size_t>(ret_code) < pending)
+        {
+            m_offset += ret_code;
+            break;
+        }
+
+        m_current.Reset();
+    }
+
+    return total;
+}
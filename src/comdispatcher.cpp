@@ -0,0 +1,549 @@
+/**
+ * @file    comdispatcher.cpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Ordered parallel processing of the received frames implementation.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/lockfree/queue.hpp>
+#include <boost/lockfree/stack.hpp>
+
+#include "cominterface/comdispatcher.hpp"
+
+/**
+ * @brief Maximum number of frames of a strand processed before letting
+ * the worker take other strands.
+ */
+static const size_t strand_batch = 64;
+
+/**
+ * @brief Latency metrics of a stage, written by only one worker and read
+ * by GetStats(...) without locks.
+ */
+struct StageMetrics
+{
+    StageMetrics() : count(0), total_ns(0), max_ns(0) {}
+
+    boost::atomic<unsigned long long> count;        ///< Number of frames.
+    boost::atomic<unsigned long long> total_ns;     ///< Sum of the latencies in nanoseconds.
+    boost::atomic<unsigned long long> max_ns;       ///< Maximum latency in nanoseconds.
+
+    /**
+     * @brief Add a latency. Only called by the owner worker.
+     * @param ns Latency in nanoseconds.
+     */
+    void record(unsigned long long ns)
+    {
+        count.store(count.load(boost::memory_order_relaxed) + 1, boost::memory_order_relaxed);
+        total_ns.store(total_ns.load(boost::memory_order_relaxed) + ns, boost::memory_order_relaxed);
+
+        if (ns > max_ns.load(boost::memory_order_relaxed))
+            max_ns.store(ns, boost::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Add the metrics to a total.
+     * @param stats Total metrics.
+     */
+    void add_to(ComDispatchStageStats& stats) const
+    {
+        stats.count += count.load(boost::memory_order_relaxed);
+        stats.total_ns += total_ns.load(boost::memory_order_relaxed);
+        stats.max_ns = std::max(stats.max_ns, max_ns.load(boost::memory_order_relaxed));
+    }
+};
+
+/**
+ * @brief Element of the queue of a strand.
+ */
+struct ComDispatcher::Node
+{
+    Node() : key(0), next(NULL) {}
+
+    ComBuffer frame;                                    ///< Frame to process.
+    unsigned int key;                                   ///< Key of the frame.
+    boost::chrono::steady_clock::time_point queued;     ///< Time at which the frame was dispatched.
+    boost::atomic<Node *> next;                         ///< Next node of the queue.
+};
+
+/**
+ * @brief Frames of the keys that must be processed in order. The queue is
+ * an intrusive lock-free queue with multiple producers (the threads that
+ * call Dispatch) and one consumer (the worker that runs the strand). The
+ * counter of pending frames guarantees that a strand is scheduled in only
+ * one worker at a time.
+ */
+struct ComDispatcher::Strand
+{
+    Strand() : head(&stub), tail(&stub), count(0) {}
+
+    Node stub;                      ///< Node that keeps the queue not empty.
+    boost::atomic<Node *> head;     ///< Last node pushed.
+    Node *tail;                     ///< Next node to pop. Only used by the consumer.
+    boost::atomic<size_t> count;    ///< Number of frames pushed and not processed.
+
+    /**
+     * @brief Push a node. It is safe for multiple producers.
+     * @param node Node.
+     */
+    void push(Node *node)
+    {
+        node->next.store(NULL, boost::memory_order_relaxed);
+
+        Node *prev = head.exchange(node, boost::memory_order_acq_rel);
+
+        prev->next.store(node, boost::memory_order_release);
+    }
+
+    /**
+     * @brief Pop a node. It is only called by the worker running the strand.
+     * @return Node, or NULL if the queue is empty or a push is in progress.
+     */
+    Node *pop()
+    {
+        Node *first = tail;
+        Node *next = first->next.load(boost::memory_order_acquire);
+
+        // Skip the stub node
+        if (first == &stub)
+        {
+            if (!next)
+                return NULL;
+
+            tail = next;
+            first = next;
+            next = next->next.load(boost::memory_order_acquire);
+        }
+
+        if (next)
+        {
+            tail = next;
+            return first;
+        }
+
+        // The last node can only be taken when it is the head, after
+        // pushing the stub node behind it
+        if (first != head.load(boost::memory_order_acquire))
+            return NULL;
+
+        push(&stub);
+
+        next = first->next.load(boost::memory_order_acquire);
+
+        if (next)
+        {
+            tail = next;
+            return first;
+        }
+
+        return NULL;
+    }
+};
+
+/**
+ * @brief Strands scheduled from outside the workers.
+ */
+class ComDispatcher::StrandQueue : public boost::lockfree::queue<ComDispatcher::Strand *>
+{
+public:
+    explicit StrandQueue(size_t capacity) : boost::lockfree::queue<Strand *>(capacity) {}
+};
+
+/**
+ * @brief Recycled queue nodes.
+ */
+class ComDispatcher::NodePool : public boost::lockfree::stack<ComDispatcher::Node *>
+{
+public:
+    explicit NodePool(size_t capacity) : boost::lockfree::stack<Node *>(capacity) {}
+};
+
+/**
+ * @brief Worker thread with its work stealing queue of strands (a
+ * Chase-Lev deque): the owner pushes and pops at the bottom, and the
+ * other workers steal from the top.
+ */
+struct ComDispatcher::Worker
+{
+    explicit Worker(size_t strands) : top(0), bottom(0), steals(0)
+    {
+        // A strand is scheduled only once at a time, so the queue can't
+        // hold more strands than the dispatcher has
+        size_t capacity = 1;
+
+        while (capacity < strands)
+            capacity <<= 1;
+
+        mask = capacity - 1;
+        buffer = new boost::atomic<Strand *>[capacity];
+    }
+
+    ~Worker()
+    {
+        delete [] buffer;
+    }
+
+    boost::atomic<long> top;                ///< Index of the next strand to steal.
+    boost::atomic<long> bottom;             ///< Index of the next strand to push.
+    boost::atomic<Strand *> *buffer;        ///< Circular buffer of strands.
+    size_t mask;                            ///< Mask of the indexes in the buffer.
+
+    StageMetrics queue_stats;                   ///< Metrics of the queue stage.
+    StageMetrics handler_stats;                 ///< Metrics of the handler stage.
+    boost::atomic<unsigned long long> steals;   ///< Number of stolen strands.
+
+    /**
+     * @brief Push a strand. Only called by the owner.
+     * @param strand Strand.
+     */
+    void push(Strand *strand)
+    {
+        long b = bottom.load(boost::memory_order_relaxed);
+
+        buffer[b & mask].store(strand, boost::memory_order_relaxed);
+        boost::atomic_thread_fence(boost::memory_order_release);
+        bottom.store(b + 1, boost::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Pop the last pushed strand. Only called by the owner.
+     * @return Strand, or NULL if the queue is empty.
+     */
+    Strand *pop()
+    {
+        long b = bottom.load(boost::memory_order_relaxed) - 1;
+
+        bottom.store(b, boost::memory_order_relaxed);
+        boost::atomic_thread_fence(boost::memory_order_seq_cst);
+
+        long t = top.load(boost::memory_order_relaxed);
+
+        if (t > b)
+        {
+            bottom.store(b + 1, boost::memory_order_relaxed);
+            return NULL;
+        }
+
+        Strand *strand = buffer[b & mask].load(boost::memory_order_relaxed);
+
+        // The last strand can be stolen at the same time
+        if (t == b)
+        {
+            if (!top.compare_exchange_strong(t, t + 1, boost::memory_order_seq_cst,
+                                             boost::memory_order_relaxed))
+                strand = NULL;
+
+            bottom.store(b + 1, boost::memory_order_relaxed);
+        }
+
+        return strand;
+    }
+
+    /**
+     * @brief Steal the first pushed strand. Called by the other workers.
+     * @return Strand, or NULL if the queue is empty or other worker won.
+     */
+    Strand *steal()
+    {
+        long t = top.load(boost::memory_order_acquire);
+
+        boost::atomic_thread_fence(boost::memory_order_seq_cst);
+
+        long b = bottom.load(boost::memory_order_acquire);
+
+        if (t >= b)
+            return NULL;
+
+        Strand *strand = buffer[t & mask].load(boost::memory_order_relaxed);
+
+        if (!top.compare_exchange_strong(t, t + 1, boost::memory_order_seq_cst,
+                                         boost::memory_order_relaxed))
+            return NULL;
+
+        return strand;
+    }
+};
+
+////////////////////
+// Public Methods //
+////////////////////
+
+ComDispatcher::ComDispatcher(const Handler& handler, size_t workers, size_t strands) :
+    m_handler(handler), m_pending(0), m_stop(false), m_sleeping(0),
+    m_current(&ComDispatcher::keep_worker)
+{
+    if (!m_handler)
+        throw std::invalid_argument("invalid handler");
+
+    if (strands == 0 || strands > 65535)
+        throw std::invalid_argument("invalid number of strands");
+
+    if (workers == 0)
+        workers = std::max(1u, boost::thread::hardware_concurrency());
+
+    m_injected = new StrandQueue(strands);
+    m_nodes = new NodePool(strand_batch * strands);
+
+    for (size_t i = 0; i < strands; ++i)
+        m_strands.push_back(new Strand());
+
+    for (size_t i = 0; i < workers; ++i)
+        m_workers.push_back(new Worker(strands));
+
+    for (size_t i = 0; i < workers; ++i)
+        m_threads.create_thread(boost::bind(&ComDispatcher::worker, this, m_workers[i]));
+}
+
+ComDispatcher::~ComDispatcher()
+{
+    Stop();
+
+    Node *node;
+
+    while (m_nodes->pop(node))
+        delete node;
+
+    for (size_t i = 0; i < m_strands.size(); ++i)
+        delete m_strands[i];
+
+    for (size_t i = 0; i < m_workers.size(); ++i)
+        delete m_workers[i];
+
+    delete m_nodes;
+    delete m_injected;
+}
+
+bool ComDispatcher::Dispatch(unsigned int key, const ComBuffer& frame)
+{
+    // The frame is counted before checking the stop, so the workers don't
+    // finish while it is queued: either they see it pending or this call
+    // sees the stop
+    ++m_pending;
+
+    if (m_stop)
+    {
+        // Wake up the idle workers that wait for the pending frames to finish
+        if (--m_pending == 0)
+        {
+            boost::lock_guard<boost::mutex> lock(m_sleep_mutex);
+
+            m_sleep_cond.notify_all();
+        }
+
+        return false;
+    }
+
+    Node *node;
+
+    // Reuse a node, so the steady state doesn't allocate memory
+    if (!m_nodes->pop(node))
+        node = new Node();
+
+    node->frame = frame;
+    node->key = key;
+    node->queued = boost::chrono::steady_clock::now();
+
+    Strand *strand = m_strands[key % m_strands.size()];
+
+    strand->push(node);
+
+    // The first pending frame schedules the strand
+    if (strand->count.fetch_add(1, boost::memory_order_acq_rel) == 0)
+        schedule(strand);
+
+    return true;
+}
+
+bool ComDispatcher::Dispatch(ComInterface *source, const ComBuffer& frame)
+{
+    // The low bits of the address are the same for all the interfaces
+    size_t address = reinterpret_cast<size_t>(source);
+
+    return Dispatch(static_cast<unsigned int>(address ^ (address >> 16)) >> 4, frame);
+}
+
+void ComDispatcher::Stop()
+{
+    m_stop = true;
+
+    {
+        boost::lock_guard<boost::mutex> lock(m_sleep_mutex);
+
+        m_sleep_cond.notify_all();
+    }
+
+    m_threads.join_all();
+}
+
+size_t ComDispatcher::GetPending()
+{
+    return m_pending;
+}
+
+void ComDispatcher::GetStats(ComDispatchStats& stats)
+{
+    stats = ComDispatchStats();
+
+    for (size_t i = 0; i < m_workers.size(); ++i)
+    {
+        m_workers[i]->queue_stats.add_to(stats.queue);
+        m_workers[i]->handler_stats.add_to(stats.handler);
+        stats.steals += m_workers[i]->steals.load(boost::memory_order_relaxed);
+    }
+}
+
+/////////////////////
+// Private Methods //
+/////////////////////
+
+void ComDispatcher::keep_worker(Worker * /*worker*/)
+{
+    // The workers are owned by the dispatcher, not by the thread
+}
+
+void ComDispatcher::schedule(Strand *strand)
+{
+    Worker *self = m_current.get();
+
+    // A worker keeps the strands that it schedules, and the idle ones
+    // steal them. The rest of the threads use the shared queue
+    if (self)
+        self->push(strand);
+    else
+        m_injected->bounded_push(strand);
+
+    // Pairs with the idle workers, that look for work after announcing it
+    boost::atomic_thread_fence(boost::memory_order_seq_cst);
+
+    if (m_sleeping > 0)
+    {
+        boost::lock_guard<boost::mutex> lock(m_sleep_mutex);
+
+        m_sleep_cond.notify_one();
+    }
+}
+
+ComDispatcher::Strand *ComDispatcher::find_work(Worker& self)
+{
+    Strand *strand = self.pop();
+
+    if (strand || m_injected->pop(strand))
+        return strand;
+
+    // Steal from the other workers, starting after the own one
+    size_t index = std::find(m_workers.begin(), m_workers.end(), &self) - m_workers.begin();
+
+    for (size_t i = 1; i < m_workers.size(); ++i)
+    {
+        strand = m_workers[(index + i) % m_workers.size()]->steal();
+
+        if (strand)
+        {
+            self.steals.store(self.steals.load(boost::memory_order_relaxed) + 1,
+                              boost::memory_order_relaxed);
+            return strand;
+        }
+    }
+
+    return NULL;
+}
+
+void ComDispatcher::run_strand(Worker& self, Strand *strand)
+{
+    size_t count = std::min(strand->count.load(boost::memory_order_acquire), strand_batch);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        Node *node;
+
+        // The frame is counted before its push finishes
+        while (!(node = strand->pop()))
+            boost::this_thread::yield();
+
+        boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+
+        m_handler(node->key, node->frame);
+
+        boost::chrono::steady_clock::time_point end = boost::chrono::steady_clock::now();
+
+        self.queue_stats.record(boost::chrono::duration_cast<boost::chrono::nanoseconds>(start - node->queued).count());
+        self.handler_stats.record(boost::chrono::duration_cast<boost::chrono::nanoseconds>(end - start).count());
+
+        node->frame.Reset();
+
+        if (!m_nodes->bounded_push(node))
+            delete node;
+
+        // Wake up the idle workers to finish when the last frame is processed
+        if (--m_pending == 0 && m_stop)
+        {
+            boost::lock_guard<boost::mutex> lock(m_sleep_mutex);
+
+            m_sleep_cond.notify_all();
+        }
+    }
+
+    // If more frames have been dispatched, the strand goes to the end of
+    // the shared queue, so it doesn't delay the other strands
+    if (strand->count.fetch_sub(count, boost::memory_order_acq_rel) != count)
+    {
+        m_injected->bounded_push(strand);
+        boost::atomic_thread_fence(boost::memory_order_seq_cst);
+
+        if (m_sleeping > 0)
+        {
+            boost::lock_guard<boost::mutex> lock(m_sleep_mutex);
+
+            m_sleep_cond.notify_one();
+        }
+    }
+}
+
+void ComDispatcher::worker(Worker *self)
+{
+    m_current.reset(self);
+
+    while (true)
+    {
+        Strand *strand = find_work(*self);
+
+        if (strand)
+        {
+            run_strand(*self, strand);
+            continue;
+        }
+
+        boost::unique_lock<boost::mutex> lock(m_sleep_mutex);
+
+        ++m_sleeping;
+
+        // Look for work again, now that the schedulers know that there
+        // is an idle worker
+        strand = find_work(*self);
+
+        if (strand)
+        {
+            --m_sleeping;
+            lock.unlock();
+
+            run_strand(*self, strand);
+            continue;
+        }
+
+        if (m_stop && m_pending == 0)
+        {
+            --m_sleeping;
+            break;
+        }
+
+        m_sleep_cond.wait(lock);
+        --m_sleeping;
+    }
+
+    m_current.release();
+}
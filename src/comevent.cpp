@@ -0,0 +1,111 @@
+/**
+ * @file    comevent.cpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Event that can be waited through a file descriptor implementation.
+ */
+
+#include <boost/config.hpp>
+
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#endif
+
+#if !defined(BOOST_WINDOWS) && !defined(__CYGWIN__)
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
+#endif
+
+#include "cominterface/comevent.hpp"
+
+////////////////////
+// Public Methods //
+////////////////////
+
+ComEvent::ComEvent()
+{
+    m_handle[0] = -1;
+    m_handle[1] = -1;
+
+#if defined(__linux__)
+    m_handle[0] = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_handle[1] = m_handle[0];
+#elif !defined(BOOST_WINDOWS) && !defined(__CYGWIN__)
+    if (::pipe(m_handle) == 0)
+    {
+        for (int i = 0; i < 2; ++i)
+        {
+            ::fcntl(m_handle[i], F_SETFL, O_NONBLOCK);
+            ::fcntl(m_handle[i], F_SETFD, FD_CLOEXEC);
+        }
+    }
+    else
+    {
+        m_handle[0] = -1;
+        m_handle[1] = -1;
+    }
+#endif
+}
+
+ComEvent::~ComEvent()
+{
+#if !defined(BOOST_WINDOWS) && !defined(__CYGWIN__)
+    if (m_handle[0] >= 0)
+        ::close(m_handle[0]);
+
+    if (m_handle[1] >= 0 && m_handle[1] != m_handle[0])
+        ::close(m_handle[1]);
+#endif
+}
+
+int ComEvent::GetHandle() const
+{
+    return m_handle[0];
+}
+
+bool ComEvent::Set()
+{
+#if defined(BOOST_WINDOWS) || defined(__CYGWIN__)
+    return false;
+#else
+    if (m_handle[1] < 0)
+        return false;
+
+#if defined(__linux__)
+    uint64_t value = 1;
+#else
+    char value = 0;
+#endif
+
+    // If the counter or the pipe is full, the event is already set
+    if (::write(m_handle[1], &value, sizeof(value)) < 0 && errno != EAGAIN)
+        return false;
+
+    return true;
+#endif
+}
+
+void ComEvent::Clear()
+{
+#if !defined(BOOST_WINDOWS) && !defined(__CYGWIN__)
+    if (m_handle[0] < 0)
+        return;
+
+#if defined(__linux__)
+    uint64_t value;
+
+    // Reading an eventfd resets its counter
+    if (::read(m_handle[0], &value, sizeof(value)) < 0)
+    {
+        // The event was not set
+    }
+#else
+    char discard[64];
+
+    while (::read(m_handle[0], discard, sizeof(discard)) > 0)
+        ;
+#endif
+#endif
+}
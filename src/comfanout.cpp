@@ -0,0 +1,426 @@
+/**
+ * @file    comfanout.cpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Delivery of one input stream to many communication interfaces implementation.
+ */
+
+#include <boost/config.hpp>
+
+#if !defined(BOOST_WINDOWS) && !defined(__CYGWIN__)
+#include <poll.h>
+#endif
+
+#include <stdexcept>
+#include <vector>
+
+#include <boost/bind.hpp>
+
+#include "cominterface/comfanout.hpp"
+
+////////////////////
+// Public Methods //
+////////////////////
+
+ComFanout::ComFanout(ComInterface *source, size_t buffer_size) :
+    m_source(source), m_buffer_size(buffer_size), m_running(false), m_stop(false)
+{
+    if (m_buffer_size == 0)
+        throw std::invalid_argument("invalid buffer size");
+}
+
+ComFanout::~ComFanout()
+{
+    Stop();
+}
+
+bool ComFanout::Start()
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        if (m_running)
+            return false;
+
+        m_stop = false;
+
+        try
+        {
+            m_writer = boost::thread(boost::bind(&ComFanout::writer, this));
+        }
+        catch (boost::thread_resource_error&)
+        {
+            return false;
+        }
+
+        m_running = true;
+    }
+
+    if (m_source)
+    {
+        ComStreamHandlers handlers;
+
+        handlers.on_data = boost::bind(&ComFanout::Publish, this, _1);
+        handlers.buffer_size = m_buffer_size;
+
+        if (!m_source->StartStreaming(handlers))
+        {
+            Stop();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void ComFanout::Stop()
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        if (!m_running)
+            return;
+
+        // Release the sources blocked by a full queue before waiting for them
+        m_stop = true;
+        m_work_cond.notify_all();
+        m_room_cond.notify_all();
+        m_wake.Set();
+    }
+
+    if (m_source)
+        m_source->StopStreaming();
+
+    m_writer.join();
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_running = false;
+}
+
+bool ComFanout::Subscribe(ComInterface *sink, size_t max_queued, SlowPolicy policy)
+{
+    if (!sink)
+        return false;
+
+    SubscriberPtr subscriber(new Subscriber());
+
+    subscriber->sink = sink;
+    subscriber->handle = sink->GetNativeHandle();
+    subscriber->max_queued = max_queued;
+    subscriber->policy = policy;
+    subscriber->offset = 0;
+    subscriber->writing = false;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_subscribers.insert(std::make_pair(sink, subscriber)).second;
+}
+
+bool ComFanout::Unsubscribe(ComInterface *sink)
+{
+    // Lock for thread safe
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+
+    SubscriberMap::iterator it = m_subscribers.find(sink);
+
+    if (it == m_subscribers.end())
+        return false;
+
+    SubscriberPtr subscriber = it->second;
+
+    // Wait for the blocking write of the writer thread on the sink
+    while (subscriber->writing)
+        m_room_cond.wait(lock);
+
+    m_subscribers.erase(sink);
+    subscriber->queue.clear();
+
+    // The sources blocked on the subscriber can continue
+    m_room_cond.notify_all();
+
+    return true;
+}
+
+size_t ComFanout::GetSubscribers()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_subscribers.size();
+}
+
+bool ComFanout::GetStats(ComInterface *sink, ComFanoutStats& stats)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    SubscriberMap::iterator it = m_subscribers.find(sink);
+
+    if (it == m_subscribers.end())
+        return false;
+
+    stats = it->second->stats;
+
+    return true;
+}
+
+void ComFanout::Publish(const ComBuffer& buffer)
+{
+    ComInterface *key = NULL;
+    size_t size = buffer.Size();
+    bool queued = false;
+
+    if (size == 0)
+        return;
+
+    // Lock for thread safe
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+
+    // The subscribers are iterated by key, because the map can change
+    // while waiting for room in a queue
+    for (SubscriberMap::iterator it = m_subscribers.begin(); it != m_subscribers.end();
+         it = m_subscribers.upper_bound(key))
+    {
+        SubscriberPtr subscriber = it->second;
+        Subscriber& target = *subscriber;
+        size_t written = 0;
+
+        key = it->first;
+
+        if (target.stats.disconnected)
+            continue;
+
+        // A subscriber that is keeping up is written directly
+        if (target.queue.empty() && !target.writing)
+        {
+            int ret_code = target.sink->WriteSome(buffer.Data(), size);
+
+            if (ret_code < 0)
+            {
+                disconnect(target);
+                continue;
+            }
+
+            written = ret_code;
+            target.stats.sent_bytes += written;
+
+            if (written == size)
+                continue;
+        }
+
+        // A partially written buffer is always queued, to not break the stream
+        if (written == 0 && target.stats.queued_bytes + size > target.max_queued)
+        {
+            if (target.policy == policy_drop)
+            {
+                ++target.stats.dropped_buffers;
+                continue;
+            }
+
+            if (target.policy == policy_disconnect)
+            {
+                disconnect(target);
+                continue;
+            }
+
+            // Wait until the writer thread makes room in the queue
+            while (m_running && !m_stop && !target.stats.disconnected &&
+                   target.stats.queued_bytes > 0 &&
+                   target.stats.queued_bytes + size > target.max_queued)
+                m_room_cond.wait(lock);
+
+            // Skip the subscriber if it has been removed during the wait
+            it = m_subscribers.find(key);
+
+            if (it == m_subscribers.end() || it->second != subscriber || target.stats.disconnected)
+                continue;
+
+            if (target.stats.queued_bytes + size > target.max_queued && target.stats.queued_bytes > 0)
+            {
+                // The fan-out has been stopped
+                ++target.stats.dropped_buffers;
+                continue;
+            }
+        }
+
+        if (target.queue.empty())
+            target.offset = written;
+
+        target.queue.push_back(buffer);
+        target.stats.queued_bytes += size - written;
+        queued = true;
+    }
+
+    if (queued)
+    {
+        m_work_cond.notify_one();
+        m_wake.Set();
+    }
+}
+
+/////////////////////
+// Private Methods //
+/////////////////////
+
+void ComFanout::flush(Subscriber& subscriber)
+{
+    while (!subscriber.queue.empty())
+    {
+        const ComBuffer& buffer = subscriber.queue.front();
+        size_t pending = buffer.Size() - subscriber.offset;
+        int ret_code = subscriber.sink->WriteSome(buffer.Data() + subscriber.offset, pending);
+
+        if (ret_code < 0)
+        {
+            disconnect(subscriber);
+            return;
+        }
+
+        subscriber.stats.sent_bytes += ret_code;
+        subscriber.stats.queued_bytes -= ret_code;
+
+        // The subscriber doesn't accept more data by now
+        if (static_cast<size_t>(ret_code) < pending)
+        {
+            subscriber.offset += ret_code;
+            break;
+        }
+
+        subscriber.queue.pop_front();
+        subscriber.offset = 0;
+    }
+
+    m_room_cond.notify_all();
+}
+
+void ComFanout::disconnect(Subscriber& subscriber)
+{
+    subscriber.queue.clear();
+    subscriber.offset = 0;
+    subscriber.stats.queued_bytes = 0;
+    subscriber.stats.disconnected = true;
+
+    m_room_cond.notify_all();
+}
+
+void ComFanout::writer()
+{
+    std::vector<SubscriberPtr> waiting;
+    std::vector<SubscriberPtr> blocking;
+
+#if !defined(BOOST_WINDOWS) && !defined(__CYGWIN__)
+    std::vector<struct pollfd> fds;
+#endif
+
+    // Lock for thread safe
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+
+    while (!m_stop)
+    {
+        waiting.clear();
+        blocking.clear();
+
+        // The subscribers with a native handle are waited until they are
+        // writable, the rest are written with blocking writes
+        for (SubscriberMap::iterator it = m_subscribers.begin(); it != m_subscribers.end(); ++it)
+        {
+            if (it->second->queue.empty())
+                continue;
+
+#if !defined(BOOST_WINDOWS) && !defined(__CYGWIN__)
+            if (it->second->handle >= 0)
+            {
+                waiting.push_back(it->second);
+                continue;
+            }
+#endif
+
+            blocking.push_back(it->second);
+        }
+
+        if (waiting.empty() && blocking.empty())
+        {
+            m_work_cond.wait(lock);
+            continue;
+        }
+
+#if !defined(BOOST_WINDOWS) && !defined(__CYGWIN__)
+        if (!waiting.empty())
+        {
+            fds.resize(waiting.size() + 1);
+
+            for (size_t i = 0; i < waiting.size(); ++i)
+            {
+                fds[i].fd = waiting[i]->handle;
+                fds[i].events = POLLOUT;
+                fds[i].revents = 0;
+            }
+
+            // The wake up event interrupts the wait when new data is queued
+            fds[waiting.size()].fd = m_wake.GetHandle();
+            fds[waiting.size()].events = POLLIN;
+            fds[waiting.size()].revents = 0;
+
+            m_wake.Clear();
+            lock.unlock();
+
+            int ret_code = ::poll(&fds[0], fds.size(), blocking.empty() ? -1 : 0);
+
+            lock.lock();
+
+            for (size_t i = 0; ret_code > 0 && i < waiting.size(); ++i)
+            {
+                SubscriberMap::iterator it = m_subscribers.find(waiting[i]->sink);
+
+                // Skip the subscribers removed during the wait
+                if (fds[i].revents && it != m_subscribers.end() && it->second == waiting[i])
+                    flush(*waiting[i]);
+            }
+        }
+#endif
+
+        for (size_t i = 0; i < blocking.size() && !m_stop; ++i)
+        {
+            Subscriber& target = *blocking[i];
+            SubscriberMap::iterator it = m_subscribers.find(target.sink);
+
+            if (it == m_subscribers.end() || it->second != blocking[i] || target.queue.empty())
+                continue;
+
+            // The sink is written without locking the fan-out
+            ComBuffer buffer = target.queue.front();
+            size_t offset = target.offset;
+
+            target.writing = true;
+            lock.unlock();
+
+            int ret_code = target.sink->Write(buffer.Data() + offset, buffer.Size() - offset);
+
+            lock.lock();
+            target.writing = false;
+
+            if (ret_code < 0)
+                disconnect(target);
+            else if (!target.stats.disconnected)
+            {
+                target.stats.sent_bytes += ret_code;
+                target.stats.queued_bytes -= ret_code;
+
+                if (static_cast<size_t>(ret_code) == buffer.Size() - offset)
+                {
+                    target.queue.pop_front();
+                    target.offset = 0;
+                }
+                else
+                    target.offset += ret_code;
+            }
+
+            m_room_cond.notify_all();
+        }
+    }
+}
@@ -0,0 +1,434 @@
+/**
+ * @file    comfaultinjector.cpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Communication interface decorator that injects faults implementation.
+ */
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "cominterface/comfaultinjector.hpp"
+
+////////////////////
+// Public Methods //
+////////////////////
+
+ComFaultInjector::ComFaultInjector(ComInterface *target, unsigned int seed) :
+    m_target(target), m_random(seed), m_abort(0), m_clock(ComClock::GetSystemClock())
+{
+    if (!m_target)
+        throw std::invalid_argument("invalid target");
+}
+
+ComFaultInjector::~ComFaultInjector()
+{
+    // The streaming thread uses the virtual functions of the interface
+    StopStreaming();
+}
+
+bool ComFaultInjector::Open()
+{
+    return m_target->Open();
+}
+
+bool ComFaultInjector::Close()
+{
+    return m_target->Close();
+}
+
+bool ComFaultInjector::Opened()
+{
+    return m_target->Opened();
+}
+
+int ComFaultInjector::ReadSome(void *buffer_in, size_t len)
+{
+    Plan faults = plan(true, len);
+
+    if (faults.disconnect)
+    {
+        m_target->Close();
+        return -1;
+    }
+
+    // A non blocking read expires without waiting
+    if (faults.timeout || (faults.delay > 0 && !wait(faults.delay)))
+        return 0;
+
+    int ret_code = m_target->ReadSome(buffer_in, faults.len);
+
+    if (ret_code <= 0)
+        return ret_code;
+
+    if (faults.drop)
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        ++m_stats.drops;
+
+        return 0;
+    }
+
+    corrupt(true, static_cast<unsigned char *>(buffer_in), ret_code);
+
+    return ret_code;
+}
+
+int ComFaultInjector::WriteSome(const void *buffer_out, size_t len)
+{
+    Plan faults = plan(false, len);
+
+    if (faults.disconnect)
+    {
+        m_target->Close();
+        return -1;
+    }
+
+    if (faults.timeout || (faults.delay > 0 && !wait(faults.delay)))
+        return 0;
+
+    // The lost data is reported as written
+    if (faults.drop)
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        ++m_stats.drops;
+
+        return static_cast<int>(faults.len);
+    }
+
+    if (!faults.corrupt)
+        return m_target->WriteSome(buffer_out, faults.len);
+
+    // The data of the caller is not modified
+    std::vector<unsigned char> data(static_cast<const unsigned char *>(buffer_out),
+                                    static_cast<const unsigned char *>(buffer_out) + faults.len);
+
+    corrupt(false, &data[0], data.size());
+
+    return m_target->WriteSome(&data[0], data.size());
+}
+
+int ComFaultInjector::Read(void *buffer_in, size_t len)
+{
+    Plan faults = plan(true, len);
+
+    if (faults.disconnect)
+    {
+        m_target->Close();
+        return -1;
+    }
+
+    if (faults.timeout)
+    {
+        wait(m_target->GetReadTimeout());
+        return 0;
+    }
+
+    if (faults.delay > 0 && !wait(faults.delay))
+        return 0;
+
+    int ret_code = m_target->Read(buffer_in, faults.len);
+
+    if (ret_code <= 0)
+        return ret_code;
+
+    if (faults.drop)
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        ++m_stats.drops;
+
+        return 0;
+    }
+
+    corrupt(true, static_cast<unsigned char *>(buffer_in), ret_code);
+
+    return ret_code;
+}
+
+int ComFaultInjector::Write(const void *buffer_out, size_t len)
+{
+    Plan faults = plan(false, len);
+
+    if (faults.disconnect)
+    {
+        m_target->Close();
+        return -1;
+    }
+
+    if (faults.timeout)
+    {
+        wait(m_target->GetWriteTimeout());
+        return 0;
+    }
+
+    if (faults.delay > 0 && !wait(faults.delay))
+        return 0;
+
+    if (faults.drop)
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        ++m_stats.drops;
+
+        return static_cast<int>(faults.len);
+    }
+
+    if (!faults.corrupt)
+        return m_target->Write(buffer_out, faults.len);
+
+    // The data of the caller is not modified
+    std::vector<unsigned char> data(static_cast<const unsigned char *>(buffer_out),
+                                    static_cast<const unsigned char *>(buffer_out) + faults.len);
+
+    corrupt(false, &data[0], data.size());
+
+    return m_target->Write(&data[0], data.size());
+}
+
+void ComFaultInjector::Abort()
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        ++m_abort;
+        m_cond.notify_all();
+    }
+
+    m_target->Abort();
+}
+
+bool ComFaultInjector::SetWriteTimeout(unsigned int write_timeout)
+{
+    return m_target->SetWriteTimeout(write_timeout);
+}
+
+unsigned int ComFaultInjector::GetWriteTimeout()
+{
+    return m_target->GetWriteTimeout();
+}
+
+bool ComFaultInjector::SetReadTimeout(unsigned int read_timeout)
+{
+    return m_target->SetReadTimeout(read_timeout);
+}
+
+unsigned int ComFaultInjector::GetReadTimeout()
+{
+    return m_target->GetReadTimeout();
+}
+
+int ComFaultInjector::GetNativeHandle()
+{
+    return m_target->GetNativeHandle();
+}
+
+int ComFaultInjector::GetReadinessHandle()
+{
+    return m_target->GetReadinessHandle();
+}
+
+bool ComFaultInjector::SetReceiveBufferSize(size_t size)
+{
+    return m_target->SetReceiveBufferSize(size);
+}
+
+size_t ComFaultInjector::GetReceiveBufferSize()
+{
+    return m_target->GetReceiveBufferSize();
+}
+
+bool ComFaultInjector::SetClock(ComClock *clock)
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        m_clock = clock ? clock : ComClock::GetSystemClock();
+    }
+
+    m_target->SetClock(clock);
+
+    return true;
+}
+
+bool ComFaultInjector::SetReadFaults(const ComFaultConfig& config)
+{
+    if (!valid(config))
+        return false;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_read_faults = config;
+
+    return true;
+}
+
+bool ComFaultInjector::SetWriteFaults(const ComFaultConfig& config)
+{
+    if (!valid(config))
+        return false;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_write_faults = config;
+
+    return true;
+}
+
+void ComFaultInjector::Reseed(unsigned int seed)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_random.seed(seed);
+}
+
+void ComFaultInjector::GetStats(ComFaultStats& stats)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    stats = m_stats;
+}
+
+/////////////////////
+// Private Methods //
+/////////////////////
+
+ComFaultInjector::Plan ComFaultInjector::plan(bool read, size_t len)
+{
+    Plan faults;
+
+    faults.delay = 0;
+    faults.len = len;
+    faults.drop = false;
+    faults.timeout = false;
+    faults.disconnect = false;
+    faults.corrupt = false;
+
+    if (len == 0)
+        return faults;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    const ComFaultConfig& config = read ? m_read_faults : m_write_faults;
+
+    // Only the enabled faults draw numbers, so the sequence of faults only
+    // depends on the configuration, the seed and the operations
+    if (config.disconnect_rate > 0 && uniform() < config.disconnect_rate)
+    {
+        ++m_stats.disconnects;
+        faults.disconnect = true;
+        return faults;
+    }
+
+    if (config.timeout_rate > 0 && uniform() < config.timeout_rate)
+    {
+        ++m_stats.timeouts;
+        faults.timeout = true;
+        return faults;
+    }
+
+    faults.delay = config.latency;
+
+    if (config.jitter > 0)
+        faults.delay += m_random() % (config.jitter + 1);
+
+    if (faults.delay > 0)
+        ++m_stats.delays;
+
+    if (len > 1 && config.short_rate > 0 && uniform() < config.short_rate)
+    {
+        ++m_stats.shorts;
+        faults.len = 1 + m_random() % (len - 1);
+    }
+
+    faults.drop = config.drop_rate > 0 && uniform() < config.drop_rate;
+    faults.corrupt = config.corrupt_rate > 0;
+
+    return faults;
+}
+
+void ComFaultInjector::corrupt(bool read, unsigned char *data, size_t len)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    double rate = read ? m_read_faults.corrupt_rate : m_write_faults.corrupt_rate;
+
+    if (rate <= 0)
+        return;
+
+    // The distance between the corrupted bytes follows a geometric
+    // distribution, so the bytes that are not corrupted don't draw numbers
+    double scale = rate < 1 ? 1 / std::log(1 - rate) : 0;
+    size_t index = 0;
+
+    while (true)
+    {
+        if (scale != 0)
+        {
+            double gap = std::floor(std::log(1 - uniform()) * scale);
+
+            if (gap >= static_cast<double>(len - index))
+                break;
+
+            index += static_cast<size_t>(gap);
+        }
+
+        if (index >= len)
+            break;
+
+        data[index] ^= static_cast<unsigned char>(1 << (m_random() % 8));
+        ++m_stats.corrupted_bytes;
+        ++index;
+    }
+}
+
+bool ComFaultInjector::wait(unsigned int time)
+{
+    // Lock for thread safe
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+
+    ComClock::time_point deadline = m_clock->Now() + boost::chrono::milliseconds(time);
+    unsigned int abort = m_abort;
+
+    while (abort == m_abort)
+    {
+        if (m_clock->WaitUntil(m_cond, lock, deadline) == boost::cv_status::timeout)
+            return true;
+    }
+
+    return false;
+}
+
+double ComFaultInjector::uniform()
+{
+    return m_random() / 4294967296.0;
+}
+
+bool ComFaultInjector::valid(const ComFaultConfig& config)
+{
+    const double rates[] = {config.short_rate, config.corrupt_rate, config.drop_rate,
+                            config.timeout_rate, config.disconnect_rate};
+
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); ++i)
+    {
+        if (!(rates[i] >= 0 && rates[i] <= 1))
+            return false;
+    }
+
+    return true;
+}
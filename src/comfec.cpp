@@ -0,0 +1,908 @@
+/**
+ * @file    comfec.cpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Forward error correction over a communication interface implementation.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/crc.hpp>
+
+#include "cominterface/comfec.hpp"
+
+// The SIMD kernels are compiled for their instruction sets with function
+// attributes, and selected at run time
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COMFEC_X86
+#include <immintrin.h>
+#endif
+
+const size_t ComFec::header_size;
+const size_t ComFec::max_shards;
+
+// Delimiter of the frames
+static const unsigned char frame_flag = 0x7E;
+
+// Escape of the flag and escape bytes inside a frame
+static const unsigned char frame_escape = 0x7D;
+
+/**
+ * @brief Arithmetic of GF(2^8), with the polynomial x^8 + x^4 + x^3 + x^2 + 1.
+ */
+struct GaloisField
+{
+    unsigned char exp[512];         ///< Powers of the generator, twice to not reduce the sums of logarithms.
+    unsigned char log[256];         ///< Logarithms of the non-zero elements.
+    unsigned char mul[256][256];    ///< Products of all the elements.
+    unsigned char low[256][16];     ///< Products of each element by the values of a low nibble.
+    unsigned char high[256][16];    ///< Products of each element by the values of a high nibble.
+
+    GaloisField()
+    {
+        unsigned int value = 1;
+
+        for (unsigned int i = 0; i < 255; ++i)
+        {
+            exp[i] = exp[i + 255] = static_cast<unsigned char>(value);
+            log[value] = static_cast<unsigned char>(i);
+
+            value <<= 1;
+
+            if (value & 0x100)
+                value ^= 0x11D;
+        }
+
+        exp[510] = exp[511] = exp[0];
+        log[0] = 0;
+
+        for (unsigned int a = 0; a < 256; ++a)
+        {
+            for (unsigned int b = 0; b < 256; ++b)
+                mul[a][b] = (a == 0 || b == 0) ? 0 : exp[log[a] + log[b]];
+
+            for (unsigned int n = 0; n < 16; ++n)
+            {
+                low[a][n] = mul[a][n];
+                high[a][n] = mul[a][n << 4];
+            }
+        }
+    }
+
+    unsigned char inverse(unsigned char a) const
+    {
+        return exp[255 - log[a]];
+    }
+
+    // Coefficient of a data shard in a parity shard: a Cauchy matrix, so
+    // any square submatrix can be inverted
+    unsigned char coefficient(size_t parity, size_t data) const
+    {
+        return inverse(static_cast<unsigned char>(parity ^ (ComFec::max_shards - 1 - data)));
+    }
+};
+
+static const GaloisField gf;
+
+// Add the product of a shard by a constant to another shard
+typedef void (*MulAddKernel)(unsigned char *dst, const unsigned char *src,
+                             unsigned char c, size_t len);
+
+static void mul_add_scalar(unsigned char *dst, const unsigned char *src,
+                           unsigned char c, size_t len)
+{
+    const unsigned char *row = gf.mul[c];
+
+    for (size_t i = 0; i < len; ++i)
+        dst[i] ^= row[src[i]];
+}
+
+#ifdef COMFEC_X86
+
+// The products of the two nibbles of 16 bytes are looked up at once with shuffles
+__attribute__((target("ssse3")))
+static void mul_add_ssse3(unsigned char *dst, const unsigned char *src,
+                          unsigned char c, size_t len)
+{
+    const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(gf.low[c]));
+    const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(gf.high[c]));
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    size_t i = 0;
+
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i product = _mm_xor_si128(_mm_shuffle_epi8(low, _mm_and_si128(x, mask)),
+                                        _mm_shuffle_epi8(high, _mm_and_si128(_mm_srli_epi64(x, 4), mask)));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_xor_si128(y, product));
+    }
+
+    mul_add_scalar(dst + i, src + i, c, len - i);
+}
+
+__attribute__((target("avx2")))
+static void mul_add_avx2(unsigned char *dst, const unsigned char *src,
+                         unsigned char c, size_t len)
+{
+    const __m256i low = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(gf.low[c])));
+    const __m256i high = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(gf.high[c])));
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+    size_t i = 0;
+
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        __m256i product = _mm256_xor_si256(_mm256_shuffle_epi8(low, _mm256_and_si256(x, mask)),
+                                           _mm256_shuffle_epi8(high, _mm256_and_si256(_mm256_srli_epi64(x, 4), mask)));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_xor_si256(y, product));
+    }
+
+    mul_add_scalar(dst + i, src + i, c, len - i);
+}
+
+#endif
+
+// Check if the processor supports a kernel
+static bool supported(const std::string& kernel)
+{
+    if (kernel == "scalar")
+        return true;
+
+#ifdef COMFEC_X86
+    __builtin_cpu_init();
+
+    if (kernel == "ssse3")
+        return __builtin_cpu_supports("ssse3");
+
+    if (kernel == "avx2")
+        return __builtin_cpu_supports("avx2");
+#endif
+
+    return false;
+}
+
+/**
+ * @brief Implementation of the GF(2^8) products.
+ */
+struct FecKernel
+{
+    const char *name;       ///< Name of the kernel.
+    MulAddKernel mul_add;   ///< Function that adds the product of a shard by a constant.
+};
+
+// Kernels, from the slowest to the fastest
+static const FecKernel kernels[] =
+{
+    {"scalar", mul_add_scalar},
+#ifdef COMFEC_X86
+    {"ssse3", mul_add_ssse3},
+    {"avx2", mul_add_avx2},
+#endif
+};
+
+static const size_t num_kernels = sizeof(kernels) / sizeof(kernels[0]);
+
+// Kernel in use. It is atomic, so it can be changed while other threads
+// encode or decode
+static boost::atomic<const FecKernel *> kernel(&kernels[0]);
+
+// Find a kernel by its name
+static const FecKernel *find_kernel(const std::string& name)
+{
+    for (size_t i = 0; i < num_kernels; ++i)
+    {
+        if (name == kernels[i].name)
+            return &kernels[i];
+    }
+
+    return NULL;
+}
+
+// The fastest kernel supported by the processor is selected before the
+// first ComFec is created
+static struct FecKernelSelector
+{
+    FecKernelSelector()
+    {
+        for (size_t i = num_kernels; i-- > 0; )
+        {
+            if (supported(kernels[i].name))
+            {
+                kernel.store(&kernels[i], boost::memory_order_release);
+                break;
+            }
+        }
+    }
+} kernel_selector;
+
+// Add the product of a shard by a constant to another shard
+static void mul_add(unsigned char *dst, const unsigned char *src, unsigned char c, size_t len)
+{
+    if (c == 0)
+        return;
+
+    if (c == 1)
+    {
+        for (size_t i = 0; i < len; ++i)
+            dst[i] ^= src[i];
+
+        return;
+    }
+
+    kernel.load(boost::memory_order_acquire)->mul_add(dst, src, c, len);
+}
+
+// Invert a square matrix in place with Gauss-Jordan elimination
+static bool invert(std::vector<unsigned char>& matrix, size_t n)
+{
+    std::vector<unsigned char> inverse(n * n, 0);
+
+    for (size_t i = 0; i < n; ++i)
+        inverse[i * n + i] = 1;
+
+    for (size_t col = 0; col < n; ++col)
+    {
+        size_t pivot = col;
+
+        while (pivot < n && matrix[pivot * n + col] == 0)
+            ++pivot;
+
+        if (pivot == n)
+            return false;
+
+        for (size_t k = 0; k < n; ++k)
+        {
+            std::swap(matrix[pivot * n + k], matrix[col * n + k]);
+            std::swap(inverse[pivot * n + k], inverse[col * n + k]);
+        }
+
+        unsigned char scale = gf.inverse(matrix[col * n + col]);
+
+        for (size_t k = 0; k < n; ++k)
+        {
+            matrix[col * n + k] = gf.mul[scale][matrix[col * n + k]];
+            inverse[col * n + k] = gf.mul[scale][inverse[col * n + k]];
+        }
+
+        for (size_t row = 0; row < n; ++row)
+        {
+            unsigned char factor = matrix[row * n + col];
+
+            if (row == col || factor == 0)
+                continue;
+
+            for (size_t k = 0; k < n; ++k)
+            {
+                matrix[row * n + k] ^= gf.mul[factor][matrix[col * n + k]];
+                inverse[row * n + k] ^= gf.mul[factor][inverse[col * n + k]];
+            }
+        }
+    }
+
+    matrix.swap(inverse);
+
+    return true;
+}
+
+// Append a byte to a frame, escaping it if needed
+static void stuff(std::vector<unsigned char>& frame, unsigned char byte)
+{
+    if (byte == frame_flag || byte == frame_escape)
+    {
+        frame.push_back(frame_escape);
+        frame.push_back(static_cast<unsigned char>(byte ^ 0x20));
+    }
+    else
+    {
+        frame.push_back(byte);
+    }
+}
+
+// Bytes of data of a shard of a block
+static size_t shard_length(size_t index, size_t data_shards, size_t size, size_t bytes)
+{
+    if (index >= data_shards)
+        return size;
+
+    return std::min(size, bytes - index * size);
+}
+
+////////////////////
+// Public Methods //
+////////////////////
+
+ComFec::ComFec(ComInterface *link, size_t data_shards, size_t parity_shards, size_t shard_size) :
+    m_link(link), m_data_shards(data_shards), m_parity_shards(parity_shards),
+    m_shard_size(shard_size), m_next_block(0), m_escape(false), m_overflow(false),
+    m_running(false), m_failed(false), m_abort(0), m_read_timeout(1000),
+    m_clock(ComClock::GetSystemClock())
+{
+    if (!m_link)
+        throw std::invalid_argument("invalid link");
+
+    if (m_data_shards == 0 || m_data_shards > 255 || m_data_shards + m_parity_shards > max_shards)
+        throw std::invalid_argument("invalid number of shards");
+
+    if (m_shard_size == 0 || m_shard_size > 0xFFFF - header_size - 2)
+        throw std::invalid_argument("invalid shard size");
+
+    m_block.valid = false;
+    m_parse.reserve(header_size + m_shard_size + 2);
+}
+
+ComFec::~ComFec()
+{
+    // The streaming thread uses the virtual functions of the interface
+    StopStreaming();
+
+    stop();
+}
+
+bool ComFec::Open()
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        if (m_running && !m_failed)
+            return true;
+    }
+
+    // A failed link is stopped before starting again
+    stop();
+
+    if (!m_link->Opened() && !m_link->Open())
+        return false;
+
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        m_rx.clear();
+        m_block.valid = false;
+        m_parse.clear();
+        m_escape = false;
+        m_overflow = false;
+        m_failed = false;
+        m_readable.Clear();
+    }
+
+    ComStreamHandlers handlers;
+
+    handlers.on_data = boost::bind(&ComFec::receive_handler, this, _1);
+    handlers.on_error = boost::bind(&ComFec::failure_handler, this);
+    handlers.on_closed = boost::bind(&ComFec::failure_handler, this);
+
+    if (!m_link->StartStreaming(handlers))
+        return false;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_running = true;
+
+    return true;
+}
+
+bool ComFec::Close()
+{
+    stop();
+
+    return m_link->Close();
+}
+
+bool ComFec::Opened()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_running && !m_failed;
+}
+
+int ComFec::ReadSome(void *buffer_in, size_t len)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    size_t received = take(buffer_in, len);
+
+    // Without data, report the failure of the link
+    if (received == 0 && (m_failed || !m_running))
+        return -1;
+
+    return static_cast<int>(received);
+}
+
+int ComFec::WriteSome(const void *buffer_out, size_t len)
+{
+    return Write(buffer_out, len);
+}
+
+int ComFec::Read(void *buffer_in, size_t len)
+{
+    size_t received = 0;
+
+    // Lock for thread safe
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+
+    ComClock::time_point deadline = m_clock->Now() + boost::chrono::milliseconds(m_read_timeout);
+    unsigned int abort = m_abort;
+
+    // Wait until all the data is received, the timeout expires or the
+    // operation is aborted
+    while (true)
+    {
+        received += take(static_cast<unsigned char *>(buffer_in) + received, len - received);
+
+        if (received == len || abort != m_abort)
+            break;
+
+        if (m_failed || !m_running)
+        {
+            if (received == 0)
+                return -1;
+
+            break;
+        }
+
+        if (m_clock->WaitUntil(m_rx_cond, lock, deadline) == boost::cv_status::timeout)
+        {
+            received += take(static_cast<unsigned char *>(buffer_in) + received, len - received);
+            break;
+        }
+    }
+
+    return static_cast<int>(received);
+}
+
+int ComFec::Write(const void *buffer_out, size_t len)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> write_lock(m_write_mutex);
+
+    size_t data_shards;
+    size_t parity_shards;
+
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        data_shards = m_data_shards;
+        parity_shards = m_parity_shards;
+    }
+
+    const unsigned char *data = static_cast<const unsigned char *>(buffer_out);
+    size_t written = 0;
+
+    while (written < len)
+    {
+        size_t bytes = std::min(len - written, data_shards * m_shard_size);
+        size_t shards = (bytes + m_shard_size - 1) / m_shard_size;
+
+        // The data of a short block is spread over its shards, to shorten the parity
+        size_t size = (bytes + shards - 1) / shards;
+        unsigned char header[header_size];
+
+        m_encode.assign((shards + parity_shards) * size, 0);
+        std::copy(data + written, data + written + bytes, m_encode.begin());
+
+        Encode(&m_encode[0], shards, &m_encode[shards * size], parity_shards, size);
+
+        header[0] = static_cast<unsigned char>(m_next_block >> 8);
+        header[1] = static_cast<unsigned char>(m_next_block);
+        header[3] = static_cast<unsigned char>(shards);
+        header[4] = static_cast<unsigned char>(parity_shards);
+        header[5] = static_cast<unsigned char>(size >> 8);
+        header[6] = static_cast<unsigned char>(size);
+        header[7] = static_cast<unsigned char>(bytes >> 24);
+        header[8] = static_cast<unsigned char>(bytes >> 16);
+        header[9] = static_cast<unsigned char>(bytes >> 8);
+        header[10] = static_cast<unsigned char>(bytes);
+
+        for (size_t i = 0; i < shards + parity_shards; ++i)
+        {
+            header[2] = static_cast<unsigned char>(i);
+
+            if (!send_frame(header, &m_encode[i * size], shard_length(i, shards, size, bytes)))
+                return written > 0 ? static_cast<int>(written) : -1;
+        }
+
+        ++m_next_block;
+        written += bytes;
+
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        ++m_stats.blocks_sent;
+        m_stats.frames_sent += shards + parity_shards;
+    }
+
+    return static_cast<int>(written);
+}
+
+void ComFec::Abort()
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        ++m_abort;
+        m_rx_cond.notify_all();
+    }
+
+    // The writes wait in the link
+    m_link->Abort();
+}
+
+bool ComFec::SetWriteTimeout(unsigned int write_timeout)
+{
+    return m_link->SetWriteTimeout(write_timeout);
+}
+
+unsigned int ComFec::GetWriteTimeout()
+{
+    return m_link->GetWriteTimeout();
+}
+
+bool ComFec::SetReadTimeout(unsigned int read_timeout)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_read_timeout = read_timeout;
+
+    return true;
+}
+
+unsigned int ComFec::GetReadTimeout()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_read_timeout;
+}
+
+int ComFec::GetReadinessHandle()
+{
+    return m_readable.GetHandle();
+}
+
+bool ComFec::SetClock(ComClock *clock)
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        m_clock = clock ? clock : ComClock::GetSystemClock();
+    }
+
+    m_link->SetClock(clock);
+
+    return true;
+}
+
+bool ComFec::SetRedundancy(size_t data_shards, size_t parity_shards)
+{
+    if (data_shards == 0 || data_shards > 255 || data_shards + parity_shards > max_shards)
+        return false;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_data_shards = data_shards;
+    m_parity_shards = parity_shards;
+
+    return true;
+}
+
+void ComFec::GetStats(ComFecStats& stats)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    stats = m_stats;
+}
+
+std::string ComFec::GetKernel()
+{
+    return kernel.load(boost::memory_order_acquire)->name;
+}
+
+bool ComFec::SetKernel(const std::string& name)
+{
+    const FecKernel *selected = find_kernel(name);
+
+    if (!selected || !supported(name))
+        return false;
+
+    kernel.store(selected, boost::memory_order_release);
+
+    return true;
+}
+
+void ComFec::Encode(const unsigned char *data, size_t data_shards,
+                    unsigned char *parity, size_t parity_shards, size_t size)
+{
+    for (size_t i = 0; i < parity_shards; ++i)
+    {
+        unsigned char *shard = parity + i * size;
+
+        std::memset(shard, 0, size);
+
+        for (size_t j = 0; j < data_shards; ++j)
+            mul_add(shard, data + j * size, gf.coefficient(i, j), size);
+    }
+}
+
+/////////////////////
+// Private Methods //
+/////////////////////
+
+void ComFec::stop()
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        if (!m_running)
+            return;
+    }
+
+    m_link->StopStreaming();
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_running = false;
+    m_rx_cond.notify_all();
+}
+
+size_t ComFec::take(void *buffer_in, size_t len)
+{
+    size_t count = std::min(len, m_rx.size());
+
+    if (count == 0)
+        return 0;
+
+    std::copy(m_rx.begin(), m_rx.begin() + count, static_cast<unsigned char *>(buffer_in));
+    m_rx.erase(m_rx.begin(), m_rx.begin() + count);
+
+    // A failed link stays readable, so that its closure is seen
+    if (m_rx.empty() && !m_failed)
+        m_readable.Clear();
+
+    return count;
+}
+
+bool ComFec::send_frame(const unsigned char *header, const unsigned char *payload, size_t len)
+{
+    boost::crc_ccitt_type crc;
+
+    crc.process_bytes(header, header_size);
+    crc.process_bytes(payload, len);
+
+    unsigned short checksum = crc.checksum();
+
+    m_frame.clear();
+    m_frame.push_back(frame_flag);
+
+    for (size_t i = 0; i < header_size; ++i)
+        stuff(m_frame, header[i]);
+
+    for (size_t i = 0; i < len; ++i)
+        stuff(m_frame, payload[i]);
+
+    stuff(m_frame, static_cast<unsigned char>(checksum >> 8));
+    stuff(m_frame, static_cast<unsigned char>(checksum));
+
+    m_frame.push_back(frame_flag);
+
+    // A short write only corrupts the frame, the receiver discards it
+    return m_link->Write(&m_frame[0], m_frame.size()) >= 0;
+}
+
+void ComFec::receive_handler(const ComBuffer& buffer)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    const unsigned char *data = buffer.Data();
+    size_t max_frame = header_size + m_shard_size + 2;
+
+    for (size_t i = 0; i < buffer.Size(); ++i)
+    {
+        unsigned char byte = data[i];
+
+        if (byte == frame_flag)
+        {
+            // Consecutive flags delimit empty frames, that are ignored
+            if (m_overflow || m_escape)
+                ++m_stats.bad_frames;
+            else if (!m_parse.empty())
+                process_frame(&m_parse[0], m_parse.size());
+
+            m_parse.clear();
+            m_escape = false;
+            m_overflow = false;
+        }
+        else if (m_overflow)
+        {
+            continue;
+        }
+        else if (byte == frame_escape)
+        {
+            m_escape = true;
+        }
+        else if (m_parse.size() == max_frame)
+        {
+            // The rest of the frame is discarded until the next flag
+            m_overflow = true;
+        }
+        else
+        {
+            m_parse.push_back(m_escape ? static_cast<unsigned char>(byte ^ 0x20) : byte);
+            m_escape = false;
+        }
+    }
+}
+
+void ComFec::failure_handler()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_failed = true;
+    m_readable.Set();
+
+    m_rx_cond.notify_all();
+}
+
+void ComFec::process_frame(const unsigned char *frame, size_t len)
+{
+    if (len < header_size + 2)
+    {
+        ++m_stats.bad_frames;
+        return;
+    }
+
+    boost::crc_ccitt_type crc;
+
+    crc.process_bytes(frame, len - 2);
+
+    boost::uint16_t number = static_cast<boost::uint16_t>((frame[0] << 8) | frame[1]);
+    size_t index = frame[2];
+    size_t data_shards = frame[3];
+    size_t parity_shards = frame[4];
+    size_t size = (static_cast<size_t>(frame[5]) << 8) | frame[6];
+    size_t bytes = (static_cast<size_t>(frame[7]) << 24) | (static_cast<size_t>(frame[8]) << 16) |
+                   (static_cast<size_t>(frame[9]) << 8) | frame[10];
+
+    if (crc.checksum() != ((frame[len - 2] << 8) | frame[len - 1]) ||
+        data_shards == 0 || data_shards + parity_shards > max_shards ||
+        index >= data_shards + parity_shards || size == 0 || size > m_shard_size ||
+        bytes > data_shards * size || bytes <= (data_shards - 1) * size ||
+        len - header_size - 2 != shard_length(index, data_shards, size, bytes))
+    {
+        ++m_stats.bad_frames;
+        return;
+    }
+
+    ++m_stats.frames_received;
+
+    // A frame of another block finishes the current one
+    if (!m_block.valid || number != m_block.number)
+    {
+        if (m_block.valid && !m_block.done)
+            ++m_stats.blocks_lost;
+
+        m_block.valid = true;
+        m_block.done = false;
+        m_block.number = number;
+        m_block.data_shards = data_shards;
+        m_block.parity_shards = parity_shards;
+        m_block.size = size;
+        m_block.bytes = bytes;
+        m_block.count = 0;
+        m_block.shards.assign((data_shards + parity_shards) * size, 0);
+        m_block.present.assign(data_shards + parity_shards, false);
+    }
+    else if (data_shards != m_block.data_shards || parity_shards != m_block.parity_shards ||
+             size != m_block.size || bytes != m_block.bytes)
+    {
+        ++m_stats.bad_frames;
+        return;
+    }
+
+    if (m_block.done || m_block.present[index])
+        return;
+
+    std::copy(frame + header_size, frame + len - 2, m_block.shards.begin() + index * size);
+    m_block.present[index] = true;
+
+    // Any data_shards frames rebuild the block
+    if (++m_block.count == m_block.data_shards)
+        deliver();
+}
+
+void ComFec::deliver()
+{
+    size_t size = m_block.size;
+    std::vector<size_t> missing;
+    std::vector<size_t> parity;
+
+    for (size_t i = 0; i < m_block.data_shards; ++i)
+    {
+        if (!m_block.present[i])
+            missing.push_back(i);
+    }
+
+    for (size_t i = m_block.data_shards; i < m_block.present.size() && parity.size() < missing.size(); ++i)
+    {
+        if (m_block.present[i])
+            parity.push_back(i - m_block.data_shards);
+    }
+
+    if (!missing.empty())
+    {
+        size_t count = missing.size();
+        std::vector<unsigned char> syndromes(count * size);
+        std::vector<unsigned char> matrix(count * count);
+
+        // Remove the received data from the parity, that leaves the
+        // contribution of the lost shards
+        for (size_t i = 0; i < count; ++i)
+        {
+            unsigned char *syndrome = &syndromes[i * size];
+            const unsigned char *shard = &m_block.shards[(m_block.data_shards + parity[i]) * size];
+
+            std::copy(shard, shard + size, syndrome);
+
+            for (size_t j = 0; j < m_block.data_shards; ++j)
+            {
+                if (m_block.present[j])
+                    mul_add(syndrome, &m_block.shards[j * size], gf.coefficient(parity[i], j), size);
+            }
+
+            for (size_t j = 0; j < count; ++j)
+                matrix[i * count + j] = gf.coefficient(parity[i], missing[j]);
+        }
+
+        if (!invert(matrix, count))
+        {
+            ++m_stats.blocks_lost;
+            m_block.done = true;
+            return;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            unsigned char *shard = &m_block.shards[missing[i] * size];
+
+            std::memset(shard, 0, size);
+
+            for (size_t j = 0; j < count; ++j)
+                mul_add(shard, &syndromes[j * size], matrix[i * count + j], size);
+        }
+
+        ++m_stats.blocks_recovered;
+    }
+
+    // The data shards are consecutive, and the last one is padded
+    m_rx.insert(m_rx.end(), m_block.shards.begin(), m_block.shards.begin() + m_block.bytes);
+
+    m_block.done = true;
+    ++m_stats.blocks_received;
+
+    m_readable.Set();
+    m_rx_cond.notify_all();
+}
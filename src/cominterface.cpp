@@ -0,0 +1,518 @@
+/**
+ * @file    cominterface.cpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Base communication interface implementation.
+ */
+
+#include <boost/config.hpp>
+
+#if !defined(BOOST_WINDOWS) && !defined(__CYGWIN__)
+#include <errno.h>
+#include <poll.h>
+#endif
+
+#include <algorithm>
+#include <climits>
+#include <deque>
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include "cominterface/cominterface.hpp"
+#include "cominterface/comevent.hpp"
+
+// Milliseconds between the checks of the descriptor of a streaming
+// interface, in case it has been closed and opened again without events
+static const int handle_check_interval = 1000;
+
+/**
+ * @brief Check if the peer of a descriptor has closed the connection.
+ * @param handle Descriptor.
+ * @return true if there is a hang up, false otherwise.
+ */
+static bool hung_up(int handle)
+{
+#if defined(BOOST_WINDOWS) || defined(__CYGWIN__)
+    return false;
+#else
+    struct pollfd fd;
+    short hang_up = POLLHUP | POLLNVAL;
+
+#if defined(POLLRDHUP)
+    hang_up |= POLLRDHUP;
+#endif
+
+    fd.fd = handle;
+    fd.events = hang_up;
+    fd.revents = 0;
+
+    return handle >= 0 && ::poll(&fd, 1, 0) > 0 && (fd.revents & hang_up);
+#endif
+}
+
+/**
+ * @brief State of the streaming and the event loop modes of a ComInterface.
+ */
+class ComStreamer
+{
+public:
+    ComStreamer() : m_stop(false), m_running(false), m_waiting_batch(false),
+                    m_attached(false), m_write_offset(0), m_queued_bytes(0) {}
+
+    ComStreamHandlers m_handlers;           ///< Callbacks of the streaming mode.
+    ComBufferPool m_pool;                   ///< Pool of the buffers passed to on_data.
+    boost::thread m_thread;                 ///< I/O thread.
+    boost::atomic<bool> m_stop;             ///< The I/O thread must finish.
+    boost::atomic<bool> m_running;          ///< The I/O thread is running.
+    boost::atomic<bool> m_waiting_batch;    ///< The I/O thread is waiting in ReadBatch(...).
+    ComEvent m_wake;                        ///< Event that wakes up the I/O thread.
+    boost::atomic<bool> m_attached;         ///< The interface is driven by an external event loop.
+    std::deque<ComBuffer> m_write_queue;    ///< Buffers pending to be written by OnWritable().
+    size_t m_write_offset;                  ///< Bytes already written of the first queued buffer.
+    size_t m_queued_bytes;                  ///< Bytes pending to be written.
+    boost::mutex m_write_mutex;             ///< Mutex of the write queue.
+    boost::scoped_ptr<ComReceiveTuner> m_tuner; ///< Auto-tuning of the receive buffers, NULL if disabled.
+
+    /**
+     * @brief Set the handlers of the streaming or the event loop mode.
+     * @param com Interface of the mode.
+     * @param handlers Callbacks for the received data and the events.
+     */
+    void configure(ComInterface *com, const ComStreamHandlers& handlers)
+    {
+        m_handlers = handlers;
+        m_tuner.reset(handlers.auto_tune ?
+                      new ComReceiveTuner(com, std::min(handlers.buffer_size, static_cast<size_t>(64)),
+                                          handlers.buffer_size) : NULL);
+    }
+
+    /**
+     * @brief Get the number of bytes to request in the next read.
+     * @return Number of bytes.
+     */
+    size_t read_size()
+    {
+        return m_tuner ? m_tuner->GetReadSize() : m_handlers.buffer_size;
+    }
+
+    /**
+     * @brief Pass the result of a read to the auto-tuning.
+     * @param received Number of bytes read.
+     */
+    void record(int received)
+    {
+        if (m_tuner)
+            m_tuner->Record(received);
+    }
+
+    /**
+     * @brief Check if the I/O thread is active and has not been stopped.
+     * If it has been stopped from a callback, wait for it to finish.
+     * @return true if it is active, false otherwise.
+     */
+    bool busy()
+    {
+        if (m_thread.joinable())
+        {
+            if (m_running && !m_stop)
+                return true;
+
+            m_thread.join();
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Wake up the I/O thread.
+     * @param com Interface of the streaming.
+     */
+    void wake(ComInterface *com)
+    {
+        m_wake.Set();
+
+        // The wait of ReadBatch can only be interrupted aborting it
+        if (m_waiting_batch)
+            com->Abort();
+    }
+
+    /**
+     * @brief Run a callback, in the executor if there is one.
+     * @param callback Callback bound to its arguments.
+     */
+    void deliver(const boost::function<void ()>& callback)
+    {
+        if (m_handlers.executor)
+            m_handlers.executor(callback);
+        else
+            callback();
+    }
+
+    /**
+     * @brief Pass a chunk of received data to the on_data callback.
+     * @param buffer Received data.
+     */
+    void deliver_data(const ComBuffer& buffer)
+    {
+        if (!m_handlers.on_data)
+            return;
+
+        if (m_handlers.executor)
+            m_handlers.executor(boost::bind(m_handlers.on_data, buffer));
+        else
+            m_handlers.on_data(buffer);
+    }
+
+    /**
+     * @brief Body of the I/O thread.
+     * @param com Interface of the streaming.
+     */
+    void run(ComInterface *com)
+    {
+        bool closed = false;
+        bool failed = false;
+        int handle = com->GetNativeHandle();
+
+        while (!m_stop)
+        {
+#if !defined(BOOST_WINDOWS) && !defined(__CYGWIN__)
+            // Sleep on the descriptor of the interface without locking it
+            if (handle >= 0)
+            {
+                struct pollfd fds[2];
+                short hang_up = POLLHUP | POLLNVAL;
+
+#if defined(POLLRDHUP)
+                hang_up |= POLLRDHUP;
+#endif
+
+                fds[0].fd = handle;
+                fds[0].events = POLLIN | hang_up;
+                fds[0].revents = 0;
+                fds[1].fd = m_wake.GetHandle();
+                fds[1].events = POLLIN;
+                fds[1].revents = 0;
+
+                if (::poll(fds, 2, handle_check_interval) < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+
+                    failed = true;
+                    break;
+                }
+
+                // Stop requested
+                if (fds[1].revents)
+                    break;
+
+                // The interface may have been closed or opened again since
+                // the descriptor was taken: poll its current one
+                int current = com->GetNativeHandle();
+
+                if (current != handle)
+                {
+                    handle = current;
+                    continue;
+                }
+
+                if (!fds[0].revents)
+                    continue;
+
+                ComBuffer buffer;
+                int received = com->ReadSomeBuffer(m_pool, read_size(), buffer);
+
+                record(received);
+
+                // An error without data would wake up the poll again at once
+                if (received > 0)
+                    deliver_data(buffer);
+                else if (received < 0 || (fds[0].revents & (hang_up | POLLERR)))
+                {
+                    closed = (fds[0].revents & hang_up) || !com->Opened();
+                    failed = !closed;
+                    break;
+                }
+
+                continue;
+            }
+#endif
+
+            // Without descriptor, wait with ReadBatch
+            size_t size = read_size();
+            ComBuffer buffer = m_pool.Allocate(size);
+
+            if (!buffer.Valid())
+            {
+                failed = true;
+                break;
+            }
+
+            m_waiting_batch = true;
+
+            int received = m_stop ? 0 : com->ReadBatch(buffer.Data(), size);
+
+            m_waiting_batch = false;
+            record(received);
+
+            if (received > 0)
+            {
+                buffer.SetSize(received);
+                deliver_data(buffer);
+            }
+            else if (received < 0 && !m_stop)
+            {
+                closed = !com->Opened();
+                failed = !closed;
+                break;
+            }
+        }
+
+        m_running = false;
+
+        if (closed && m_handlers.on_closed)
+            deliver(m_handlers.on_closed);
+        else if (failed && m_handlers.on_error)
+            deliver(m_handlers.on_error);
+    }
+};
+
+////////////////////
+// Public Methods //
+////////////////////
+
+ComInterface::~ComInterface()
+{
+    StopStreaming();
+
+    delete m_streamer;
+}
+
+bool ComInterface::GetReceiveStats(ComReceiveStats& stats)
+{
+    if (!m_streamer || !m_streamer->m_tuner)
+        return false;
+
+    m_streamer->m_tuner->GetStats(stats);
+
+    return true;
+}
+
+bool ComInterface::StartStreaming(const ComStreamHandlers& handlers)
+{
+    if (handlers.buffer_size == 0 || handlers.buffer_size > static_cast<size_t>(INT_MAX))
+        return false;
+
+    if (!m_streamer)
+        m_streamer = new ComStreamer();
+
+    // Only one streaming can run at the same time, and not while an
+    // event loop drives the interface
+    if (m_streamer->busy() || m_streamer->m_attached || !Opened())
+        return false;
+
+#if !defined(BOOST_WINDOWS) && !defined(__CYGWIN__)
+    if (m_streamer->m_wake.GetHandle() < 0)
+        return false;
+#endif
+
+    m_streamer->m_wake.Clear();
+
+    m_streamer->configure(this, handlers);
+    m_streamer->m_stop = false;
+    m_streamer->m_running = true;
+
+    try
+    {
+        m_streamer->m_thread = boost::thread(boost::bind(&ComStreamer::run, m_streamer, this));
+    }
+    catch (boost::thread_resource_error&)
+    {
+        m_streamer->m_running = false;
+        return false;
+    }
+
+    return true;
+}
+
+void ComInterface::StopStreaming()
+{
+    if (!m_streamer || !m_streamer->m_thread.joinable())
+        return;
+
+    m_streamer->m_stop = true;
+    m_streamer->wake(this);
+
+    // From a callback, the I/O thread finishes after returning from it
+    if (m_streamer->m_thread.get_id() == boost::this_thread::get_id())
+        return;
+
+    m_streamer->m_thread.join();
+}
+
+bool ComInterface::Streaming()
+{
+    return m_streamer && m_streamer->m_running && !m_streamer->m_stop;
+}
+
+bool ComInterface::AttachEventLoop(const ComStreamHandlers& handlers)
+{
+    if (handlers.buffer_size == 0 || handlers.buffer_size > static_cast<size_t>(INT_MAX))
+        return false;
+
+    if (!m_streamer)
+        m_streamer = new ComStreamer();
+
+    if (m_streamer->busy() || m_streamer->m_attached || !Opened())
+        return false;
+
+    m_streamer->configure(this, handlers);
+    m_streamer->m_attached = true;
+
+    return true;
+}
+
+void ComInterface::DetachEventLoop()
+{
+    if (m_streamer)
+        m_streamer->m_attached = false;
+}
+
+int ComInterface::OnReadable()
+{
+    if (!m_streamer || !m_streamer->m_attached)
+        return -1;
+
+    ComStreamer& streamer = *m_streamer;
+    int total = 0;
+
+    // Read until the interface is drained, so edge triggered loops don't
+    // miss the data that remains after a full buffer
+    while (true)
+    {
+        ComBuffer buffer;
+        size_t size = streamer.read_size();
+        int received = ReadSomeBuffer(streamer.m_pool, size, buffer);
+
+        streamer.record(received);
+
+        if (received < 0)
+        {
+            // Detach before the callback, so it can attach the interface again
+            bool closed = !Opened() || hung_up(GetNativeHandle());
+            boost::function<void ()> callback = closed ? streamer.m_handlers.on_closed :
+                                                         streamer.m_handlers.on_error;
+
+            streamer.m_attached = false;
+
+            if (callback)
+                streamer.deliver(callback);
+
+            return -1;
+        }
+
+        if (received == 0)
+            break;
+
+        total += received;
+        streamer.deliver_data(buffer);
+
+        if (static_cast<size_t>(received) < size || !streamer.m_attached)
+            break;
+    }
+
+    return total;
+}
+
+int ComInterface::OnWritable()
+{
+    if (!m_streamer)
+        return 0;
+
+    ComStreamer& streamer = *m_streamer;
+    int total = 0;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(streamer.m_write_mutex);
+
+    while (!streamer.m_write_queue.empty())
+    {
+        const ComBuffer& buffer = streamer.m_write_queue.front();
+        size_t pending = buffer.Size() - streamer.m_write_offset;
+        int written = WriteSome(buffer.Data() + streamer.m_write_offset, pending);
+
+        if (written < 0)
+            return -1;
+
+        total += written;
+        streamer.m_queued_bytes -= written;
+
+        // The interface doesn't accept more data by now
+        if (static_cast<size_t>(written) < pending)
+        {
+            streamer.m_write_offset += written;
+            break;
+        }
+
+        streamer.m_write_queue.pop_front();
+        streamer.m_write_offset = 0;
+    }
+
+    return total;
+}
+
+int ComInterface::WriteQueued(const ComBuffer& buffer)
+{
+    if (buffer.Size() > static_cast<size_t>(INT_MAX))
+        return -1;
+
+    if (!m_streamer)
+        m_streamer = new ComStreamer();
+
+    ComStreamer& streamer = *m_streamer;
+    size_t written = 0;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(streamer.m_write_mutex);
+
+    // Write directly if there is nothing queued, to keep the order
+    if (streamer.m_write_queue.empty())
+    {
+        int ret_code = WriteSome(buffer.Data(), buffer.Size());
+
+        if (ret_code < 0)
+            return -1;
+
+        written = ret_code;
+    }
+
+    if (written < buffer.Size())
+    {
+        if (streamer.m_write_queue.empty())
+            streamer.m_write_offset = written;
+
+        streamer.m_write_queue.push_back(buffer);
+        streamer.m_queued_bytes += buffer.Size() - written;
+    }
+
+    return static_cast<int>(buffer.Size());
+}
+
+bool ComInterface::WantsWrite()
+{
+    return GetQueuedBytes() > 0;
+}
+
+size_t ComInterface::GetQueuedBytes()
+{
+    if (!m_streamer)
+        return 0;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_streamer->m_write_mutex);
+
+    return m_streamer->m_queued_bytes;
+}
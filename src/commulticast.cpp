@@ -0,0 +1,1126 @@
+/**
+ * @file    commulticast.cpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Multicast UDP publisher and subscriber communication interfaces implementation.
+ */
+
+// Under Windows XP, Windows Server 2003 or older, this class
+// must be compiled with the flag BOOST_ASIO_ENABLE_CANCELIO.
+// This allows to cancel the asynchronous operations.
+#define BOOST_ASIO_ENABLE_CANCELIO
+
+#if defined(__linux__)
+#include <errno.h>
+#include <sys/socket.h>
+#endif
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+
+#include <boost/array.hpp>
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "cominterface/comlayout.hpp"
+#include "cominterface/commulticast.hpp"
+#include "cominterface/comtimer.hpp"
+#include "cominterface/handlerallocator.hpp"
+
+const size_t ComMulticast::header_size;
+const size_t ComMulticast::batch_size;
+const size_t ComMulticast::impl_size;
+
+/**
+ * @brief Private implementation of the multicast interfaces: the socket,
+ * its timeouts and the configuration of the group.
+ */
+struct ComMulticast::Impl
+{
+    Impl() : m_io_service(), m_socket(m_io_service), m_timer(m_io_service), m_port(0),
+             m_ttl(1), m_loopback(true), m_payload_size(1400 - header_size),
+             m_receive_buffer_size(0) {}
+
+    // Boost asio objects
+    boost::asio::io_service m_io_service;               ///< Service for access OS resources.
+    boost::asio::ip::udp::socket m_socket;              ///< Socket handler.
+    ComTimer m_timer;                                   ///< Timeout timer for the asynchronous operations.
+    boost::chrono::milliseconds m_write_timeout;        ///< Time in milliseconds for the transmission timeout timer.
+    boost::chrono::milliseconds m_read_timeout;         ///< Time in milliseconds for the reception timeout timer.
+
+    // Configuration of the group
+    boost::asio::ip::address m_group;                   ///< Multicast address of the group.
+    unsigned int m_port;                                ///< UDP port of the group.
+    boost::asio::ip::address m_interface;               ///< Address of the network interface, unspecified for the default one.
+    unsigned int m_ttl;                                 ///< Time to live of the sent datagrams.
+    bool m_loopback;                                    ///< The sent datagrams are delivered to this host.
+    size_t m_payload_size;                              ///< Maximum number of bytes of data of each datagram.
+    size_t m_receive_buffer_size;                       ///< Kernel receive buffer size, 0 for the system default.
+    std::vector<boost::asio::ip::address> m_groups;     ///< Groups joined by a subscriber.
+
+    boost::mutex m_mutex;                               ///< Mutex to make the interface thread safe.
+    ComMulticastStats m_stats;                          ///< Statistics.
+
+    // Handlers memory
+    HandlerAllocator m_wait_allocator;                  ///< Recycled memory for the wait handlers.
+    HandlerAllocator m_timer_allocator;                 ///< Recycled memory for the timeout timer handlers.
+};
+
+// Fields of the header of the datagrams
+typedef ComField<boost::uint32_t, 0> HeaderSource;
+typedef ComField<boost::uint32_t, HeaderSource::end> HeaderSequence;
+
+// Maximum number of bytes of a UDP datagram over IPv4, without the IP and UDP headers
+static const size_t max_datagram = 65507;
+
+// Parse the address of a multicast IPv4 group
+static bool parse_group(const std::string& group, boost::asio::ip::address& address)
+{
+    boost::system::error_code ec;
+
+    address = boost::asio::ip::address::from_string(group, ec);
+
+    return !ec && address.is_v4() && address.is_multicast();
+}
+
+// Parse the IPv4 address of a network interface, "" for the default one
+static bool parse_interface(const std::string& interface_address, boost::asio::ip::address& address)
+{
+    boost::system::error_code ec;
+
+    if (interface_address.empty())
+    {
+        address = boost::asio::ip::address_v4::any();
+        return true;
+    }
+
+    address = boost::asio::ip::address::from_string(interface_address, ec);
+
+    return !ec && address.is_v4();
+}
+
+//////////////////
+// ComMulticast //
+//////////////////
+
+ComMulticast::ComMulticast(const std::string& group, unsigned int port,
+                           const std::string& interface_address, unsigned int timeout) :
+    m_impl()
+{
+    if (!parse_group(group, m_impl->m_group))
+        throw std::invalid_argument("invalid multicast group");
+
+    if (port == 0 || port > 65535)
+        throw std::invalid_argument("invalid UDP port");
+
+    m_impl->m_port = port;
+
+    if (!parse_interface(interface_address, m_impl->m_interface))
+        throw std::invalid_argument("invalid interface address");
+
+    if (!SetWriteTimeout(timeout) ||
+        !SetReadTimeout(timeout))
+        throw std::invalid_argument("invalid timeout value");
+}
+
+ComMulticast::~ComMulticast()
+{
+}
+
+bool ComMulticast::Close()
+{
+    boost::system::error_code ec;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    // If the socket is opened, close it
+    if (m_impl->m_socket.is_open())
+        m_impl->m_socket.close(ec);
+
+    return !ec;
+}
+
+bool ComMulticast::Opened()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    return m_impl->m_socket.is_open();
+}
+
+int ComMulticast::GetNativeHandle()
+{
+#if defined(BOOST_WINDOWS) || defined(__CYGWIN__)
+    return -1;
+#else
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    if (!m_impl->m_socket.is_open())
+        return -1;
+
+    return m_impl->m_socket.native_handle();
+#endif
+}
+
+bool ComMulticast::SetReceiveBufferSize(size_t size)
+{
+    boost::system::error_code ec;
+
+    if (size == 0 || size > static_cast<size_t>(INT_MAX))
+        return false;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    m_impl->m_receive_buffer_size = size;
+
+    // If the socket is already opened, apply the new configuration.
+    // Else, it will be applied on Open
+    if (m_impl->m_socket.is_open())
+        m_impl->m_socket.set_option(boost::asio::socket_base::receive_buffer_size(static_cast<int>(size)), ec);
+
+    return !ec;
+}
+
+size_t ComMulticast::GetReceiveBufferSize()
+{
+    boost::system::error_code ec;
+    boost::asio::socket_base::receive_buffer_size option;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    if (!m_impl->m_socket.is_open())
+        return m_impl->m_receive_buffer_size;
+
+    m_impl->m_socket.get_option(option, ec);
+
+    return ec ? 0 : static_cast<size_t>(option.value());
+}
+
+void ComMulticast::Abort()
+{
+    boost::system::error_code ec;
+
+    // Cancel the timeout timer asynchronous operations
+    m_impl->m_timer.Cancel(ec);
+
+    // Cancel the socket asynchronous operations
+    m_impl->m_socket.cancel(ec);
+
+    // In Windows Server 2003, Windows XP and older, cancel don't work
+    // if it is called from a thread different from the thread that calls
+    // the asynchronous operation
+    if (ec == boost::asio::error::operation_not_supported)
+        m_impl->m_socket.close(ec);
+}
+
+bool ComMulticast::SetWriteTimeout(unsigned int write_timeout)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    if (write_timeout == 0)
+        return false;
+
+    m_impl->m_write_timeout = boost::chrono::milliseconds(write_timeout);
+
+    return true;
+}
+
+unsigned int ComMulticast::GetWriteTimeout()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    return m_impl->m_write_timeout.count();
+}
+
+bool ComMulticast::SetReadTimeout(unsigned int read_timeout)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    if (read_timeout == 0)
+        return false;
+
+    m_impl->m_read_timeout = boost::chrono::milliseconds(read_timeout);
+
+    return true;
+}
+
+unsigned int ComMulticast::GetReadTimeout()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    return m_impl->m_read_timeout.count();
+}
+
+bool ComMulticast::SetClock(ComClock *clock)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    m_impl->m_timer.SetClock(clock);
+
+    return true;
+}
+
+bool ComMulticast::SetTtl(unsigned int ttl)
+{
+    boost::system::error_code ec;
+
+    if (ttl > 255)
+        return false;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    m_impl->m_ttl = ttl;
+
+    // If the socket is already opened, apply the new configuration.
+    // Else, it will be applied on Open
+    if (m_impl->m_socket.is_open())
+        m_impl->m_socket.set_option(boost::asio::ip::multicast::hops(static_cast<int>(ttl)), ec);
+
+    return !ec;
+}
+
+unsigned int ComMulticast::GetTtl()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    return m_impl->m_ttl;
+}
+
+bool ComMulticast::SetLoopback(bool loopback)
+{
+    boost::system::error_code ec;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    m_impl->m_loopback = loopback;
+
+    // If the socket is already opened, apply the new configuration.
+    // Else, it will be applied on Open
+    if (m_impl->m_socket.is_open())
+        m_impl->m_socket.set_option(boost::asio::ip::multicast::enable_loopback(loopback), ec);
+
+    return !ec;
+}
+
+bool ComMulticast::GetLoopback()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    return m_impl->m_loopback;
+}
+
+bool ComMulticast::SetPayloadSize(size_t payload_size)
+{
+    if (payload_size == 0 || payload_size > max_datagram - header_size)
+        return false;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    m_impl->m_payload_size = payload_size;
+
+    return true;
+}
+
+size_t ComMulticast::GetPayloadSize()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    return m_impl->m_payload_size;
+}
+
+void ComMulticast::GetStats(ComMulticastStats& stats)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    stats = m_impl->m_stats;
+}
+
+///////////////////////////
+// ComMulticastPublisher //
+///////////////////////////
+
+ComMulticastPublisher::ComMulticastPublisher(const std::string& group, unsigned int port,
+                                             const std::string& interface_address,
+                                             unsigned int timeout) :
+    ComMulticast(group, port, interface_address, timeout), m_sequence(0)
+{
+    // The identifier is taken from the time and the address of the
+    // publisher, mixed so close values give different identifiers
+    boost::uint64_t seed = static_cast<boost::uint64_t>(
+                               boost::chrono::system_clock::now().time_since_epoch().count()) ^
+                           reinterpret_cast<size_t>(this);
+
+    seed *= 0x9E3779B97F4A7C15ULL;
+
+    m_source = static_cast<boost::uint32_t>(seed >> 32);
+}
+
+ComMulticastPublisher::~ComMulticastPublisher()
+{
+    // The streaming thread uses the virtual functions of the interface
+    StopStreaming();
+}
+
+bool ComMulticastPublisher::Open()
+{
+    boost::system::error_code ec;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    if (!open_socket())
+        return false;
+
+    // Send the datagrams through the chosen interface
+    if (!m_impl->m_interface.is_unspecified())
+        m_impl->m_socket.set_option(boost::asio::ip::multicast::outbound_interface(m_impl->m_interface.to_v4()), ec);
+
+    // The socket is connected to the group, so the datagrams are sent
+    // without their destination
+    if (!ec)
+        m_impl->m_socket.connect(boost::asio::ip::udp::endpoint(m_impl->m_group, m_impl->m_port), ec);
+
+    if (ec)
+    {
+        m_impl->m_socket.close(ec);
+        return false;
+    }
+
+    return true;
+}
+
+int ComMulticastPublisher::ReadSome(void * /*buffer_in*/, size_t /*len*/)
+{
+    return -1;
+}
+
+int ComMulticastPublisher::WriteSome(const void *buffer_out, size_t len)
+{
+    return Write(buffer_out, len);
+}
+
+int ComMulticastPublisher::Read(void * /*buffer_in*/, size_t /*len*/)
+{
+    return -1;
+}
+
+int ComMulticastPublisher::Write(const void *buffer_out, size_t len)
+{
+    const unsigned char *data = static_cast<const unsigned char *>(buffer_out);
+    const unsigned char *payloads[batch_size];
+    size_t sizes[batch_size];
+    size_t sent = 0;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    if (!m_impl->m_socket.is_open())
+        return -1;
+
+    ComClock::time_point deadline = m_impl->m_timer.Now() + m_impl->m_write_timeout;
+
+    while (sent < len)
+    {
+        size_t count = 0;
+        size_t batch_len = 0;
+
+        // Split the data of a batch in datagrams
+        for (; count < batch_size && sent + batch_len < len; ++count)
+        {
+            size_t size = std::min(m_impl->m_payload_size, len - sent - batch_len);
+
+            payloads[count] = data + sent + batch_len;
+            sizes[count] = size;
+            batch_len += size;
+        }
+
+        int ret_code = send_datagrams(payloads, sizes, count, deadline);
+
+        if (ret_code < 0)
+            return sent > 0 ? static_cast<int>(sent) : -1;
+
+        for (int i = 0; i < ret_code; ++i)
+            sent += sizes[i];
+
+        // The timeout has expired
+        if (static_cast<size_t>(ret_code) < count)
+            break;
+    }
+
+    return static_cast<int>(sent);
+}
+
+int ComMulticastPublisher::WriteBatch(const std::vector<ComBuffer>& messages)
+{
+    const unsigned char *payloads[batch_size];
+    size_t sizes[batch_size];
+    size_t sent = 0;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    if (!m_impl->m_socket.is_open())
+        return -1;
+
+    for (size_t i = 0; i < messages.size(); ++i)
+    {
+        if (messages[i].Size() > m_impl->m_payload_size)
+            return -1;
+    }
+
+    ComClock::time_point deadline = m_impl->m_timer.Now() + m_impl->m_write_timeout;
+
+    while (sent < messages.size())
+    {
+        size_t count = std::min(batch_size, messages.size() - sent);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            payloads[i] = messages[sent + i].Data();
+            sizes[i] = messages[sent + i].Size();
+        }
+
+        int ret_code = send_datagrams(payloads, sizes, count, deadline);
+
+        if (ret_code < 0)
+            return sent > 0 ? static_cast<int>(sent) : -1;
+
+        sent += ret_code;
+
+        // The timeout has expired
+        if (static_cast<size_t>(ret_code) < count)
+            break;
+    }
+
+    return static_cast<int>(sent);
+}
+
+boost::uint32_t ComMulticastPublisher::GetSource()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    return m_source;
+}
+
+////////////////////////////
+// ComMulticastSubscriber //
+////////////////////////////
+
+ComMulticastSubscriber::ComMulticastSubscriber(const std::string& group, unsigned int port,
+                                               const std::string& interface_address,
+                                               unsigned int timeout) :
+    ComMulticast(group, port, interface_address, timeout), m_datagram_size(0), m_pending_offset(0)
+{
+    m_impl->m_groups.push_back(m_impl->m_group);
+}
+
+ComMulticastSubscriber::~ComMulticastSubscriber()
+{
+    // The streaming thread uses the virtual functions of the interface
+    StopStreaming();
+}
+
+bool ComMulticastSubscriber::Open()
+{
+    boost::system::error_code ec;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    if (!open_socket())
+        return false;
+
+    // Other subscribers of the host can bind the same port. The socket is
+    // bound to any address, so it receives all the joined groups
+    m_impl->m_socket.set_option(boost::asio::ip::udp::socket::reuse_address(true), ec);
+
+    if (!ec)
+        m_impl->m_socket.bind(boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::any(), m_impl->m_port), ec);
+
+    for (size_t i = 0; i < m_impl->m_groups.size() && !ec; ++i)
+        m_impl->m_socket.set_option(boost::asio::ip::multicast::join_group(
+                                        m_impl->m_groups[i].to_v4(), m_impl->m_interface.to_v4()), ec);
+
+    if (ec)
+    {
+        m_impl->m_socket.close(ec);
+        return false;
+    }
+
+    // The data and the sequences of the previous session are discarded. The
+    // payload size is kept until the next Open, as the memory is sized for it
+    m_datagram_size = m_impl->m_payload_size;
+    m_datagrams.resize(batch_size * m_datagram_size);
+    m_pending.clear();
+    m_pending_offset = 0;
+    m_next.clear();
+
+    return true;
+}
+
+int ComMulticastSubscriber::ReadSome(void *buffer_in, size_t len)
+{
+    unsigned char *data = static_cast<unsigned char *>(buffer_in);
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    if (!m_impl->m_socket.is_open())
+        return -1;
+
+    size_t received = take_pending(data, len);
+
+    if (received < len)
+    {
+        if (receive_pending() < 0)
+            return received > 0 ? static_cast<int>(received) : -1;
+
+        received += take_pending(data + received, len - received);
+    }
+
+    return static_cast<int>(received);
+}
+
+int ComMulticastSubscriber::WriteSome(const void * /*buffer_out*/, size_t /*len*/)
+{
+    return -1;
+}
+
+int ComMulticastSubscriber::Read(void *buffer_in, size_t len)
+{
+    unsigned char *data = static_cast<unsigned char *>(buffer_in);
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    if (!m_impl->m_socket.is_open())
+        return -1;
+
+    ComClock::time_point deadline = m_impl->m_timer.Now() + m_impl->m_read_timeout;
+    size_t received = take_pending(data, len);
+
+    // Wait until all the data is received or the timeout expires
+    while (received < len)
+    {
+        int ret_code = receive_pending();
+
+        if (ret_code < 0)
+            return -1;
+
+        if (ret_code == 0)
+        {
+            ret_code = wait_ready(false, deadline);
+
+            if (ret_code < 0)
+                return -1;
+
+            if (ret_code == 0)
+                break;
+
+            continue;
+        }
+
+        received += take_pending(data + received, len - received);
+    }
+
+    return static_cast<int>(received);
+}
+
+int ComMulticastSubscriber::Write(const void * /*buffer_out*/, size_t /*len*/)
+{
+    return -1;
+}
+
+bool ComMulticastSubscriber::JoinGroup(const std::string& group)
+{
+    boost::system::error_code ec;
+    boost::asio::ip::address address;
+
+    if (!parse_group(group, address))
+        return false;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    if (std::find(m_impl->m_groups.begin(), m_impl->m_groups.end(), address) != m_impl->m_groups.end())
+        return true;
+
+    // If the socket is already opened, join the group.
+    // Else, it will be joined on Open
+    if (m_impl->m_socket.is_open())
+        m_impl->m_socket.set_option(boost::asio::ip::multicast::join_group(
+                                        address.to_v4(), m_impl->m_interface.to_v4()), ec);
+
+    if (ec)
+        return false;
+
+    m_impl->m_groups.push_back(address);
+
+    return true;
+}
+
+bool ComMulticastSubscriber::LeaveGroup(const std::string& group)
+{
+    boost::system::error_code ec;
+    boost::asio::ip::address address;
+
+    if (!parse_group(group, address))
+        return false;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    std::vector<boost::asio::ip::address>& groups = m_impl->m_groups;
+    std::vector<boost::asio::ip::address>::iterator it = std::find(groups.begin(), groups.end(), address);
+
+    if (it == m_impl->m_groups.end())
+        return false;
+
+    if (m_impl->m_socket.is_open())
+        m_impl->m_socket.set_option(boost::asio::ip::multicast::leave_group(
+                                        address.to_v4(), m_impl->m_interface.to_v4()), ec);
+
+    groups.erase(it);
+
+    return !ec;
+}
+
+int ComMulticastSubscriber::ReceiveBatch(ComBufferPool& pool, std::vector<ComBuffer>& messages,
+                                         size_t max_messages)
+{
+    messages.clear();
+
+    if (max_messages == 0)
+        return 0;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    if (!m_impl->m_socket.is_open())
+        return -1;
+
+    ComClock::time_point deadline = m_impl->m_timer.Now() + m_impl->m_read_timeout;
+
+    // Wait until a valid datagram is received or the timeout expires
+    while (messages.empty())
+    {
+        int ret_code = receive_datagrams(pool, std::min(max_messages, batch_size), messages);
+
+        if (ret_code < 0)
+            return -1;
+
+        if (ret_code == 0)
+        {
+            ret_code = wait_ready(false, deadline);
+
+            if (ret_code < 0)
+                return -1;
+
+            if (ret_code == 0)
+                break;
+        }
+    }
+
+    return static_cast<int>(messages.size());
+}
+
+void ComMulticastSubscriber::SetGapHandler(const GapHandler& handler)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    m_gap_handler = handler;
+}
+
+/////////////////////
+// Private Methods //
+/////////////////////
+
+bool ComMulticast::open_socket()
+{
+    boost::system::error_code ec;
+
+    // Due to previous cancellation of operations on io_service, it is
+    // necessary to reset it
+    m_impl->m_socket.get_io_service().reset();
+
+    // If the socket is already opened, close it
+    if (m_impl->m_socket.is_open())
+        m_impl->m_socket.close(ec);
+
+    m_impl->m_socket.open(boost::asio::ip::udp::v4(), ec);
+
+    if (!ec)
+        m_impl->m_socket.set_option(boost::asio::ip::multicast::hops(static_cast<int>(m_impl->m_ttl)), ec);
+
+    if (!ec)
+        m_impl->m_socket.set_option(boost::asio::ip::multicast::enable_loopback(m_impl->m_loopback), ec);
+
+    // Set the kernel receive buffer if it has been configured
+    if (!ec && m_impl->m_receive_buffer_size > 0)
+        m_impl->m_socket.set_option(boost::asio::socket_base::receive_buffer_size(
+                                static_cast<int>(m_impl->m_receive_buffer_size)), ec);
+
+    // Set the socket synchronous operations to non blocking mode
+    if (!ec)
+        m_impl->m_socket.non_blocking(true, ec);
+
+    if (ec)
+    {
+        m_impl->m_socket.close(ec);
+        return false;
+    }
+
+    return true;
+}
+
+int ComMulticast::wait_ready(bool write, const ComClock::time_point& deadline)
+{
+    boost::system::error_code ec;
+    boost::system::error_code wait_error = boost::asio::error::would_block;
+
+    // Set the timeout for the asynchronous operations
+    m_impl->m_timer.ExpiresAt(deadline);
+    m_impl->m_timer.AsyncWait(make_alloc_handler(m_impl->m_timer_allocator,
+                                                 boost::bind(&ComMulticast::timeout_handler, this,
+                                                             boost::asio::placeholders::error)));
+
+    // Start the asynchronous operation (wait until ready)
+    if (write)
+        m_impl->m_socket.async_send(boost::asio::null_buffers(),
+                                    make_alloc_handler(m_impl->m_wait_allocator,
+                                                       boost::bind(&ComMulticast::wait_handler, this,
+                                                                   _1, &wait_error)));
+    else
+        m_impl->m_socket.async_receive(boost::asio::null_buffers(),
+                                       make_alloc_handler(m_impl->m_wait_allocator,
+                                                          boost::bind(&ComMulticast::wait_handler, this,
+                                                                      _1, &wait_error)));
+
+    while (wait_error == boost::asio::error::would_block &&
+           m_impl->m_socket.get_io_service().run_one(ec))
+        ;
+
+    // Cancel the timeout timer and wait for its handler
+    m_impl->m_timer.Cancel(ec);
+    m_impl->m_socket.get_io_service().run(ec);
+    m_impl->m_socket.get_io_service().reset();
+
+    // If the wait has been canceled, the deadline expired
+    if (!wait_error)
+        return 1;
+    else if (wait_error == boost::asio::error::operation_aborted)
+        return 0;
+    else
+        return -1;
+}
+
+void ComMulticast::wait_handler(const boost::system::error_code& error,
+                                boost::system::error_code *ret_error)
+{
+    *ret_error = error;
+}
+
+void ComMulticast::timeout_handler(const boost::system::error_code& error)
+{
+    boost::system::error_code ec;
+
+    // If the timeout timer has been canceled, the operation
+    // finished correctly
+    if (error == boost::asio::error::operation_aborted)
+        return;
+
+    // If the timeout timer expired, cancel the socket operation
+    m_impl->m_socket.cancel(ec);
+}
+
+int ComMulticastPublisher::send_datagrams(const unsigned char *const *payloads, const size_t *sizes,
+                                          size_t count, const ComClock::time_point& deadline)
+{
+    unsigned char headers[batch_size][header_size];
+    size_t sent = 0;
+    bool failed = false;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        HeaderSource::Store(headers[i], m_source);
+        HeaderSequence::Store(headers[i], m_sequence + static_cast<boost::uint32_t>(i));
+    }
+
+    while (sent < count)
+    {
+        int ret_code;
+
+#if defined(__linux__)
+        struct mmsghdr messages[batch_size];
+        struct iovec vectors[batch_size][2];
+
+        // Each datagram gathers its header and its data
+        std::memset(messages, 0, sizeof(messages[0]) * (count - sent));
+
+        for (size_t i = 0; i < count - sent; ++i)
+        {
+            vectors[i][0].iov_base = headers[sent + i];
+            vectors[i][0].iov_len = header_size;
+            vectors[i][1].iov_base = const_cast<unsigned char *>(payloads[sent + i]);
+            vectors[i][1].iov_len = sizes[sent + i];
+            messages[i].msg_hdr.msg_iov = vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 2;
+        }
+
+        do
+        {
+            ret_code = ::sendmmsg(m_impl->m_socket.native_handle(), messages,
+                                  static_cast<unsigned int>(count - sent), 0);
+        }
+        while (ret_code < 0 && errno == EINTR);
+
+        // If the send buffer is full, wait for room. Else, an unexpected
+        // error occurs
+        if (ret_code < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                failed = true;
+                break;
+            }
+
+            ret_code = 0;
+        }
+#else
+        boost::system::error_code ec;
+        boost::array<boost::asio::const_buffer, 2> buffers =
+        {{
+            boost::asio::buffer(headers[sent], header_size),
+            boost::asio::buffer(payloads[sent], sizes[sent])
+        }};
+
+        m_impl->m_socket.send(buffers, 0, ec);
+
+        if (ec && ec != boost::asio::error::would_block)
+        {
+            failed = true;
+            break;
+        }
+
+        ret_code = ec ? 0 : 1;
+#endif
+
+        for (int i = 0; i < ret_code; ++i)
+        {
+            ++m_impl->m_stats.datagrams_sent;
+            m_impl->m_stats.bytes_sent += sizes[sent + i];
+        }
+
+        sent += ret_code;
+
+        if (ret_code == 0)
+        {
+            int wait = wait_ready(true, deadline);
+
+            if (wait < 0)
+                failed = true;
+
+            if (wait <= 0)
+                break;
+        }
+    }
+
+    // The numbers of the datagrams that have not been sent are used again
+    m_sequence += static_cast<boost::uint32_t>(sent);
+
+    if (failed && sent == 0)
+        return -1;
+
+    return static_cast<int>(sent);
+}
+
+int ComMulticastSubscriber::receive_datagrams(ComBufferPool& pool, size_t max_messages,
+                                              std::vector<ComBuffer>& messages)
+{
+    unsigned char headers[batch_size][header_size];
+    size_t sizes[batch_size];
+    bool truncated[batch_size];
+    int ret_code;
+
+#if defined(__linux__)
+    struct mmsghdr datagrams[batch_size];
+    struct iovec vectors[batch_size][2];
+
+    // Each datagram is scattered to its header and its data
+    std::memset(datagrams, 0, sizeof(datagrams[0]) * max_messages);
+
+    for (size_t i = 0; i < max_messages; ++i)
+    {
+        vectors[i][0].iov_base = headers[i];
+        vectors[i][0].iov_len = header_size;
+        vectors[i][1].iov_base = &m_datagrams[i * m_datagram_size];
+        vectors[i][1].iov_len = m_datagram_size;
+        datagrams[i].msg_hdr.msg_iov = vectors[i];
+        datagrams[i].msg_hdr.msg_iovlen = 2;
+    }
+
+    do
+    {
+        ret_code = ::recvmmsg(m_impl->m_socket.native_handle(), datagrams,
+                              static_cast<unsigned int>(max_messages), MSG_DONTWAIT, NULL);
+    }
+    while (ret_code < 0 && errno == EINTR);
+
+    // If there is no datagram, return 0. Else, an unexpected error occurs
+    if (ret_code < 0)
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+
+    for (int i = 0; i < ret_code; ++i)
+    {
+        sizes[i] = datagrams[i].msg_len;
+        truncated[i] = (datagrams[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+    }
+#else
+    for (ret_code = 0; static_cast<size_t>(ret_code) < max_messages; ++ret_code)
+    {
+        boost::system::error_code ec;
+        boost::array<boost::asio::mutable_buffer, 2> buffers =
+        {{
+            boost::asio::buffer(headers[ret_code], header_size),
+            boost::asio::buffer(&m_datagrams[ret_code * m_datagram_size], m_datagram_size)
+        }};
+
+        sizes[ret_code] = m_impl->m_socket.receive(buffers, 0, ec);
+        truncated[ret_code] = ec == boost::asio::error::message_size;
+
+        if (ec == boost::asio::error::would_block)
+            break;
+
+        if (ec && !truncated[ret_code])
+        {
+            if (ret_code == 0)
+                return -1;
+
+            break;
+        }
+    }
+#endif
+
+    for (int i = 0; i < ret_code; ++i)
+    {
+        if (sizes[i] < header_size || truncated[i])
+        {
+            ++m_impl->m_stats.bad;
+            continue;
+        }
+
+        if (!accept(headers[i]))
+            continue;
+
+        // The data is copied to a buffer of its size
+        size_t size = sizes[i] - header_size;
+        ComBuffer buffer = pool.Allocate(size);
+
+        if (!buffer.Valid())
+            return -1;
+
+        std::memcpy(buffer.Data(), &m_datagrams[i * m_datagram_size], size);
+        buffer.SetSize(size);
+        messages.push_back(buffer);
+
+        ++m_impl->m_stats.datagrams_received;
+        m_impl->m_stats.bytes_received += size;
+    }
+
+    return ret_code;
+}
+
+bool ComMulticastSubscriber::accept(const unsigned char *header)
+{
+    boost::uint32_t source = HeaderSource::Load(header);
+    boost::uint32_t sequence = HeaderSequence::Load(header);
+    std::map<boost::uint32_t, boost::uint32_t>::iterator it = m_next.find(source);
+
+    // The sequence of a new publisher starts at its first datagram
+    if (it == m_next.end())
+    {
+        m_next[source] = sequence + 1;
+        ++m_impl->m_stats.sources;
+
+        return true;
+    }
+
+    // The difference is signed, so the sequence numbers can wrap around
+    boost::int32_t ahead = static_cast<boost::int32_t>(sequence - it->second);
+
+    if (ahead < 0)
+    {
+        ++m_impl->m_stats.late;
+        return false;
+    }
+
+    if (ahead > 0)
+    {
+        ++m_impl->m_stats.gaps;
+        m_impl->m_stats.lost += ahead;
+
+        if (m_gap_handler)
+            m_gap_handler(source, it->second, static_cast<boost::uint32_t>(ahead));
+    }
+
+    it->second = sequence + 1;
+
+    return true;
+}
+
+size_t ComMulticastSubscriber::take_pending(unsigned char *buffer_in, size_t len)
+{
+    size_t taken = 0;
+
+    while (taken < len && !m_pending.empty())
+    {
+        const ComBuffer& buffer = m_pending.front();
+        size_t size = std::min(len - taken, buffer.Size() - m_pending_offset);
+
+        std::memcpy(buffer_in + taken, buffer.Data() + m_pending_offset, size);
+        taken += size;
+        m_pending_offset += size;
+
+        if (m_pending_offset == buffer.Size())
+        {
+            m_pending.pop_front();
+            m_pending_offset = 0;
+        }
+    }
+
+    return taken;
+}
+
+int ComMulticastSubscriber::receive_pending()
+{
+    m_received.clear();
+
+    int ret_code = receive_datagrams(m_pool, batch_size, m_received);
+
+    m_pending.insert(m_pending.end(), m_received.begin(), m_received.end());
+    m_received.clear();
+
+    return ret_code;
+}
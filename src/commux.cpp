@@ -0,0 +1,593 @@
+/**
+ * @file    commux.cpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Logical channels multiplexed over a communication interface implementation.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+#include "cominterface/commux.hpp"
+
+const unsigned int ComMux::max_channels;
+const size_t ComMux::header_size;
+const size_t ComMux::batch_frames;
+
+///////////////////
+// ComMuxChannel //
+///////////////////
+
+ComMuxChannel::ComMuxChannel(ComMux& mux, unsigned int id) :
+    m_mux(mux), m_id(id), m_opened(false), m_credit(mux.m_window), m_grant(0),
+    m_abort(0), m_read_timeout(1000), m_write_timeout(1000)
+{
+
+}
+
+ComMuxChannel::~ComMuxChannel()
+{
+    // The streaming thread uses the virtual functions of the interface
+    StopStreaming();
+}
+
+bool ComMuxChannel::Open()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mux.m_mutex);
+
+    m_opened = true;
+
+    return true;
+}
+
+bool ComMuxChannel::Close()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mux.m_mutex);
+
+    if (!m_opened)
+        return true;
+
+    // The discarded data frees room in the window of the peer
+    m_grant += m_rx.size();
+    m_rx.clear();
+    m_tx.clear();
+    m_readable.Clear();
+    m_opened = false;
+
+    m_mux.m_tx_cond.notify_one();
+    m_mux.m_rx_cond.notify_all();
+
+    return true;
+}
+
+bool ComMuxChannel::Opened()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mux.m_mutex);
+
+    return m_opened;
+}
+
+int ComMuxChannel::ReadSome(void *buffer_in, size_t len)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mux.m_mutex);
+
+    if (!m_opened)
+        return -1;
+
+    size_t received = take(buffer_in, len);
+
+    // Without data, report the failure of the link
+    if (received == 0 && (m_mux.m_failed || !m_mux.m_running))
+        return -1;
+
+    return static_cast<int>(received);
+}
+
+int ComMuxChannel::WriteSome(const void *buffer_out, size_t len)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mux.m_mutex);
+
+    if (!m_opened || m_mux.m_failed || !m_mux.m_running)
+        return -1;
+
+    return static_cast<int>(queue(buffer_out, len));
+}
+
+int ComMuxChannel::Read(void *buffer_in, size_t len)
+{
+    size_t received = 0;
+
+    // Lock for thread safe
+    boost::unique_lock<boost::mutex> lock(m_mux.m_mutex);
+
+    if (!m_opened)
+        return -1;
+
+    ComClock::time_point deadline = m_mux.deadline(m_read_timeout);
+    unsigned int abort = m_abort;
+
+    // Wait until all the data is received, the timeout expires or the
+    // operation is aborted
+    while (true)
+    {
+        received += take(static_cast<unsigned char *>(buffer_in) + received, len - received);
+
+        if (received == len || abort != m_abort || !m_opened)
+            break;
+
+        if (m_mux.m_failed || !m_mux.m_running)
+        {
+            if (received == 0)
+                return -1;
+
+            break;
+        }
+
+        if (m_mux.m_clock->WaitUntil(m_mux.m_rx_cond, lock, deadline) == boost::cv_status::timeout)
+        {
+            received += take(static_cast<unsigned char *>(buffer_in) + received, len - received);
+            break;
+        }
+    }
+
+    return static_cast<int>(received);
+}
+
+int ComMuxChannel::Write(const void *buffer_out, size_t len)
+{
+    size_t written = 0;
+
+    // Lock for thread safe
+    boost::unique_lock<boost::mutex> lock(m_mux.m_mutex);
+
+    if (!m_opened || m_mux.m_failed || !m_mux.m_running)
+        return -1;
+
+    ComClock::time_point deadline = m_mux.deadline(m_write_timeout);
+    unsigned int abort = m_abort;
+
+    // Wait until all the data is queued, the timeout expires or the
+    // operation is aborted
+    while (true)
+    {
+        written += queue(static_cast<const unsigned char *>(buffer_out) + written, len - written);
+
+        if (written == len || abort != m_abort || !m_opened || m_mux.m_failed || !m_mux.m_running)
+            break;
+
+        if (m_mux.m_clock->WaitUntil(m_mux.m_rx_cond, lock, deadline) == boost::cv_status::timeout)
+        {
+            written += queue(static_cast<const unsigned char *>(buffer_out) + written, len - written);
+            break;
+        }
+    }
+
+    return static_cast<int>(written);
+}
+
+void ComMuxChannel::Abort()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mux.m_mutex);
+
+    ++m_abort;
+    m_mux.m_rx_cond.notify_all();
+}
+
+bool ComMuxChannel::SetWriteTimeout(unsigned int write_timeout)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mux.m_mutex);
+
+    m_write_timeout = write_timeout;
+
+    return true;
+}
+
+unsigned int ComMuxChannel::GetWriteTimeout()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mux.m_mutex);
+
+    return m_write_timeout;
+}
+
+bool ComMuxChannel::SetReadTimeout(unsigned int read_timeout)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mux.m_mutex);
+
+    m_read_timeout = read_timeout;
+
+    return true;
+}
+
+unsigned int ComMuxChannel::GetReadTimeout()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mux.m_mutex);
+
+    return m_read_timeout;
+}
+
+int ComMuxChannel::GetReadinessHandle()
+{
+    return m_readable.GetHandle();
+}
+
+bool ComMuxChannel::SetClock(ComClock *clock)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mux.m_mutex);
+
+    m_mux.m_clock = clock ? clock : ComClock::GetSystemClock();
+
+    return true;
+}
+
+unsigned int ComMuxChannel::GetId()
+{
+    return m_id;
+}
+
+size_t ComMuxChannel::GetCredit()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mux.m_mutex);
+
+    return m_credit;
+}
+
+size_t ComMuxChannel::take(void *buffer_in, size_t len)
+{
+    size_t count = std::min(len, m_rx.size());
+
+    if (count == 0)
+        return 0;
+
+    std::copy(m_rx.begin(), m_rx.begin() + count, static_cast<unsigned char *>(buffer_in));
+    m_rx.erase(m_rx.begin(), m_rx.begin() + count);
+
+    // The channels of a failed link stay readable, so that its failure is seen
+    if (m_rx.empty() && !m_mux.m_failed)
+        m_readable.Clear();
+
+    // Return the credit in blocks of half window, to not send a frame
+    // for each read
+    m_grant += count;
+
+    if (m_grant >= m_mux.m_window / 2)
+        m_mux.m_tx_cond.notify_one();
+
+    return count;
+}
+
+size_t ComMuxChannel::queue(const void *buffer_out, size_t len)
+{
+    size_t count = 0;
+
+    // The data queued in the channel is limited to a window
+    if (m_tx.size() < m_mux.m_window)
+        count = std::min(len, m_mux.m_window - m_tx.size());
+
+    if (count == 0)
+        return 0;
+
+    const unsigned char *data = static_cast<const unsigned char *>(buffer_out);
+
+    m_tx.insert(m_tx.end(), data, data + count);
+
+    if (m_credit > 0)
+        m_mux.m_tx_cond.notify_one();
+
+    return count;
+}
+
+////////////
+// ComMux //
+////////////
+
+ComMux::ComMux(ComInterface *link, size_t max_frame, size_t window) :
+    m_link(link), m_max_frame(max_frame), m_window(window), m_next(0),
+    m_running(false), m_stop(false), m_failed(false), m_clock(ComClock::GetSystemClock())
+{
+    if (!m_link)
+        throw std::invalid_argument("invalid link");
+
+    if (m_max_frame == 0 || m_max_frame > 0xFFFF)
+        throw std::invalid_argument("invalid maximum frame size");
+
+    if (m_window < 2)
+        throw std::invalid_argument("invalid window size");
+
+    for (unsigned int i = 0; i < max_channels; ++i)
+        m_channels[i] = NULL;
+
+    m_frames.reserve(batch_frames * (header_size + m_max_frame));
+}
+
+ComMux::~ComMux()
+{
+    Stop();
+
+    for (unsigned int i = 0; i < max_channels; ++i)
+        delete m_channels[i];
+}
+
+bool ComMux::Start()
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        if (m_running)
+            return false;
+
+        m_stop = false;
+        m_failed = false;
+        m_parse.clear();
+
+        // The failure of the previous link is not signalled anymore
+        for (unsigned int i = 0; i < max_channels; ++i)
+        {
+            if (m_channels[i] && m_channels[i]->m_rx.empty())
+                m_channels[i]->m_readable.Clear();
+        }
+    }
+
+    ComStreamHandlers handlers;
+
+    handlers.on_data = boost::bind(&ComMux::receive_handler, this, _1);
+    handlers.on_error = boost::bind(&ComMux::failure_handler, this);
+    handlers.on_closed = boost::bind(&ComMux::failure_handler, this);
+
+    if (!m_link->StartStreaming(handlers))
+        return false;
+
+    try
+    {
+        m_sender = boost::thread(boost::bind(&ComMux::sender, this));
+    }
+    catch (boost::thread_resource_error&)
+    {
+        m_link->StopStreaming();
+        return false;
+    }
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_running = true;
+
+    return true;
+}
+
+void ComMux::Stop()
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        if (!m_running)
+            return;
+
+        m_stop = true;
+        m_tx_cond.notify_one();
+    }
+
+    m_sender.join();
+    m_link->StopStreaming();
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_running = false;
+    m_rx_cond.notify_all();
+}
+
+bool ComMux::Running()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_running && !m_failed;
+}
+
+ComMuxChannel *ComMux::GetChannel(unsigned int id)
+{
+    if (id >= max_channels)
+        return NULL;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return channel(id);
+}
+
+/////////////////////
+// Private Methods //
+/////////////////////
+
+ComMuxChannel *ComMux::channel(unsigned int id)
+{
+    if (!m_channels[id])
+    {
+        m_channels[id] = new ComMuxChannel(*this, id);
+
+        if (m_failed)
+            m_channels[id]->m_readable.Set();
+    }
+
+    return m_channels[id];
+}
+
+void ComMux::receive_handler(const ComBuffer& buffer)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_parse.insert(m_parse.end(), buffer.Data(), buffer.Data() + buffer.Size());
+
+    size_t offset = 0;
+
+    // Process the complete frames
+    while (m_parse.size() - offset >= header_size)
+    {
+        const unsigned char *header = &m_parse[offset];
+        size_t length = (static_cast<size_t>(header[2]) << 8) | header[3];
+
+        if (m_parse.size() - offset < header_size + length)
+            break;
+
+        ComMuxChannel *target = channel(header[0]);
+        const unsigned char *payload = header + header_size;
+
+        if (header[1] == frame_data)
+        {
+            if (length > 0)
+            {
+                target->m_rx.insert(target->m_rx.end(), payload, payload + length);
+                target->m_readable.Set();
+            }
+        }
+        else if (header[1] == frame_credit && length == 4)
+        {
+            target->m_credit += (static_cast<size_t>(payload[0]) << 24) |
+                                (static_cast<size_t>(payload[1]) << 16) |
+                                (static_cast<size_t>(payload[2]) << 8) |
+                                payload[3];
+        }
+
+        offset += header_size + length;
+    }
+
+    m_parse.erase(m_parse.begin(), m_parse.begin() + offset);
+
+    m_rx_cond.notify_all();
+    m_tx_cond.notify_one();
+}
+
+void ComMux::failure_handler()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    fail();
+
+    m_tx_cond.notify_one();
+}
+
+void ComMux::fail()
+{
+    m_failed = true;
+
+    // The readiness events of the channels signal the failure to the
+    // external event loops
+    for (unsigned int i = 0; i < max_channels; ++i)
+    {
+        if (m_channels[i])
+            m_channels[i]->m_readable.Set();
+    }
+
+    m_rx_cond.notify_all();
+}
+
+bool ComMux::next_frame()
+{
+    // The credit is sent first, because it unblocks the peer
+    for (unsigned int i = 0; i < max_channels; ++i)
+    {
+        ComMuxChannel *target = m_channels[i];
+
+        if (!target || target->m_grant < m_window / 2)
+            continue;
+
+        unsigned long grant = static_cast<unsigned long>(std::min<size_t>(target->m_grant, 0xFFFFFFFFUL));
+
+        target->m_grant -= grant;
+
+        m_frames.push_back(static_cast<unsigned char>(i));
+        m_frames.push_back(frame_credit);
+        m_frames.push_back(0);
+        m_frames.push_back(4);
+        m_frames.push_back(static_cast<unsigned char>(grant >> 24));
+        m_frames.push_back(static_cast<unsigned char>(grant >> 16));
+        m_frames.push_back(static_cast<unsigned char>(grant >> 8));
+        m_frames.push_back(static_cast<unsigned char>(grant));
+
+        return true;
+    }
+
+    // One data frame of the next channel with data and credit
+    for (unsigned int i = 0; i < max_channels; ++i)
+    {
+        unsigned int id = (m_next + i) % max_channels;
+        ComMuxChannel *target = m_channels[id];
+
+        if (!target || target->m_tx.empty() || target->m_credit == 0)
+            continue;
+
+        size_t length = std::min(std::min(target->m_tx.size(), target->m_credit), m_max_frame);
+
+        m_frames.push_back(static_cast<unsigned char>(id));
+        m_frames.push_back(frame_data);
+        m_frames.push_back(static_cast<unsigned char>(length >> 8));
+        m_frames.push_back(static_cast<unsigned char>(length));
+        m_frames.insert(m_frames.end(), target->m_tx.begin(), target->m_tx.begin() + length);
+
+        target->m_tx.erase(target->m_tx.begin(), target->m_tx.begin() + length);
+        target->m_credit -= length;
+        m_next = id + 1;
+
+        // There is room for the blocked writes
+        m_rx_cond.notify_all();
+
+        return true;
+    }
+
+    return false;
+}
+
+void ComMux::sender()
+{
+    // Lock for thread safe
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+
+    while (!m_stop && !m_failed)
+    {
+        m_frames.clear();
+
+        // Gather the pending frames, to write them with one call
+        for (size_t i = 0; i < batch_frames && next_frame(); ++i)
+            ;
+
+        if (m_frames.empty())
+        {
+            m_tx_cond.wait(lock);
+            continue;
+        }
+
+        // The link is written without locking the channels
+        lock.unlock();
+
+        int ret_code = m_link->Write(&m_frames[0], m_frames.size());
+
+        lock.lock();
+
+        // A partial frame breaks the framing of the link
+        if (ret_code != static_cast<int>(m_frames.size()))
+            fail();
+    }
+}
+
+ComClock::time_point ComMux::deadline(unsigned int timeout)
+{
+    return m_clock->Now() + boost::chrono::milliseconds(timeout);
+}
@@ -0,0 +1,326 @@
+/**
+ * @file    compipe.cpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   In-memory link between two communication interfaces implementation.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "cominterface/compipe.hpp"
+
+////////////////
+// ComPipeEnd //
+////////////////
+
+ComPipeEnd::ComPipeEnd(ComPipe& pipe, unsigned int index) :
+    m_pipe(pipe), m_index(index), m_opened(false), m_peer_closed(false),
+    m_abort(0), m_read_timeout(1000), m_write_timeout(1000)
+{
+
+}
+
+ComPipeEnd::~ComPipeEnd()
+{
+    // The streaming thread uses the virtual functions of the interface
+    StopStreaming();
+}
+
+bool ComPipeEnd::Open()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_pipe.m_mutex);
+
+    if (m_opened)
+        return true;
+
+    m_opened = true;
+    m_peer_closed = false;
+    m_rx.clear();
+    m_readable.Clear();
+
+    return true;
+}
+
+bool ComPipeEnd::Close()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_pipe.m_mutex);
+
+    if (!m_opened)
+        return true;
+
+    m_opened = false;
+    m_rx.clear();
+    m_readable.Clear();
+
+    // The other end reads the pending data and then fails
+    if (peer().m_opened)
+    {
+        peer().m_peer_closed = true;
+        peer().m_readable.Set();
+    }
+
+    m_pipe.m_cond.notify_all();
+
+    return true;
+}
+
+bool ComPipeEnd::Opened()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_pipe.m_mutex);
+
+    return m_opened;
+}
+
+int ComPipeEnd::ReadSome(void *buffer_in, size_t len)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_pipe.m_mutex);
+
+    if (!m_opened || eof())
+        return -1;
+
+    return static_cast<int>(take(buffer_in, len));
+}
+
+int ComPipeEnd::WriteSome(const void *buffer_out, size_t len)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_pipe.m_mutex);
+
+    if (!m_opened || m_peer_closed || !peer().m_opened)
+        return -1;
+
+    return static_cast<int>(give(buffer_out, len));
+}
+
+int ComPipeEnd::Read(void *buffer_in, size_t len)
+{
+    size_t received = 0;
+
+    // Lock for thread safe
+    boost::unique_lock<boost::mutex> lock(m_pipe.m_mutex);
+
+    if (!m_opened)
+        return -1;
+
+    ComClock::time_point deadline = m_pipe.deadline(m_read_timeout);
+    unsigned int abort = m_abort;
+
+    // Wait until all the data is received, the timeout expires or the
+    // operation is aborted
+    while (true)
+    {
+        received += take(static_cast<unsigned char *>(buffer_in) + received, len - received);
+
+        if (received == len || abort != m_abort || !m_opened)
+            break;
+
+        if (eof())
+        {
+            if (received == 0)
+                return -1;
+
+            break;
+        }
+
+        if (m_pipe.m_clock->WaitUntil(m_pipe.m_cond, lock, deadline) == boost::cv_status::timeout)
+        {
+            received += take(static_cast<unsigned char *>(buffer_in) + received, len - received);
+            break;
+        }
+    }
+
+    return static_cast<int>(received);
+}
+
+int ComPipeEnd::Write(const void *buffer_out, size_t len)
+{
+    size_t written = 0;
+
+    // Lock for thread safe
+    boost::unique_lock<boost::mutex> lock(m_pipe.m_mutex);
+
+    if (!m_opened || m_peer_closed || !peer().m_opened)
+        return -1;
+
+    ComClock::time_point deadline = m_pipe.deadline(m_write_timeout);
+    unsigned int abort = m_abort;
+
+    // Wait until all the data is passed, the timeout expires or the
+    // operation is aborted
+    while (true)
+    {
+        written += give(static_cast<const unsigned char *>(buffer_out) + written, len - written);
+
+        if (written == len || abort != m_abort || !m_opened)
+            break;
+
+        if (m_peer_closed || !peer().m_opened)
+        {
+            if (written == 0)
+                return -1;
+
+            break;
+        }
+
+        if (m_pipe.m_clock->WaitUntil(m_pipe.m_cond, lock, deadline) == boost::cv_status::timeout)
+        {
+            written += give(static_cast<const unsigned char *>(buffer_out) + written, len - written);
+            break;
+        }
+    }
+
+    return static_cast<int>(written);
+}
+
+void ComPipeEnd::Abort()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_pipe.m_mutex);
+
+    ++m_abort;
+    m_pipe.m_cond.notify_all();
+}
+
+bool ComPipeEnd::SetWriteTimeout(unsigned int write_timeout)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_pipe.m_mutex);
+
+    m_write_timeout = write_timeout;
+
+    return true;
+}
+
+unsigned int ComPipeEnd::GetWriteTimeout()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_pipe.m_mutex);
+
+    return m_write_timeout;
+}
+
+bool ComPipeEnd::SetReadTimeout(unsigned int read_timeout)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_pipe.m_mutex);
+
+    m_read_timeout = read_timeout;
+
+    return true;
+}
+
+unsigned int ComPipeEnd::GetReadTimeout()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_pipe.m_mutex);
+
+    return m_read_timeout;
+}
+
+int ComPipeEnd::GetReadinessHandle()
+{
+    return m_readable.GetHandle();
+}
+
+bool ComPipeEnd::SetClock(ComClock *clock)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_pipe.m_mutex);
+
+    m_pipe.m_clock = clock ? clock : ComClock::GetSystemClock();
+
+    return true;
+}
+
+ComPipeEnd& ComPipeEnd::peer()
+{
+    return *m_pipe.m_ends[1 - m_index];
+}
+
+bool ComPipeEnd::eof()
+{
+    return m_rx.empty() && m_peer_closed;
+}
+
+size_t ComPipeEnd::take(void *buffer_in, size_t len)
+{
+    size_t count = std::min(len, m_rx.size());
+
+    if (count == 0)
+        return 0;
+
+    std::copy(m_rx.begin(), m_rx.begin() + count, static_cast<unsigned char *>(buffer_in));
+    m_rx.erase(m_rx.begin(), m_rx.begin() + count);
+
+    // The event stays set after a close, so the loops read the failure
+    if (m_rx.empty() && !m_peer_closed)
+        m_readable.Clear();
+
+    // There is room for the writer
+    m_pipe.m_cond.notify_all();
+
+    return count;
+}
+
+size_t ComPipeEnd::give(const void *buffer_out, size_t len)
+{
+    ComPipeEnd& target = peer();
+    size_t count = 0;
+
+    if (target.m_rx.size() < m_pipe.m_capacity)
+        count = std::min(len, m_pipe.m_capacity - target.m_rx.size());
+
+    if (count == 0)
+        return 0;
+
+    const unsigned char *data = static_cast<const unsigned char *>(buffer_out);
+
+    target.m_rx.insert(target.m_rx.end(), data, data + count);
+    target.m_readable.Set();
+
+    m_pipe.m_cond.notify_all();
+
+    return count;
+}
+
+/////////////
+// ComPipe //
+/////////////
+
+ComPipe::ComPipe(size_t capacity) : m_capacity(capacity), m_clock(ComClock::GetSystemClock())
+{
+    if (m_capacity == 0)
+        throw std::invalid_argument("invalid capacity");
+
+    m_ends[0] = new ComPipeEnd(*this, 0);
+    m_ends[1] = new ComPipeEnd(*this, 1);
+}
+
+ComPipe::~ComPipe()
+{
+    // An end can't be destroyed while the other one is in use
+    m_ends[0]->StopStreaming();
+    m_ends[1]->StopStreaming();
+
+    delete m_ends[0];
+    delete m_ends[1];
+}
+
+ComPipeEnd *ComPipe::GetEnd(unsigned int index)
+{
+    return index < 2 ? m_ends[index] : NULL;
+}
+
+/////////////////////
+// Private Methods //
+/////////////////////
+
+ComClock::time_point ComPipe::deadline(unsigned int timeout)
+{
+    return m_clock->Now() + boost::chrono::milliseconds(timeout);
+}
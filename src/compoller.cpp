@@ -0,0 +1,328 @@
+/**
+ * @file    compoller.cpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Multiplexed wait across a set of communication interfaces implementation.
+ */
+
+#include <boost/config.hpp>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#endif
+
+#if !defined(BOOST_WINDOWS) && !defined(__CYGWIN__)
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#include <climits>
+
+#include <boost/chrono/ceil.hpp>
+#include <boost/chrono/system_clocks.hpp>
+
+#include "cominterface/compoller.hpp"
+
+const unsigned int ComPoller::readable;
+const unsigned int ComPoller::writable;
+const unsigned int ComPoller::error;
+
+/**
+ * @brief Track the time left of a wait that can be restarted by signals.
+ */
+class PollTimeout
+{
+public:
+    explicit PollTimeout(unsigned int timeout) :
+        m_deadline(boost::chrono::steady_clock::now() + boost::chrono::milliseconds(timeout)),
+        m_infinite(timeout > static_cast<unsigned int>(INT_MAX)) {}
+
+    /**
+     * @brief Get the time left in the format of poll and epoll_wait.
+     * @return Time in milliseconds, -1 if there is no limit.
+     */
+    int remaining() const
+    {
+        if (m_infinite)
+            return -1;
+
+        boost::chrono::steady_clock::time_point now = boost::chrono::steady_clock::now();
+
+        if (now >= m_deadline)
+            return 0;
+
+        // Round up, so the wait doesn't end before the deadline
+        return static_cast<int>(boost::chrono::ceil<boost::chrono::milliseconds>(m_deadline - now).count());
+    }
+
+private:
+    boost::chrono::steady_clock::time_point m_deadline;     ///< End of the wait.
+    bool m_infinite;                                        ///< The timeout doesn't fit in the system call.
+};
+
+#if defined(__linux__)
+/**
+ * @brief Convert the requested events to the epoll format.
+ * @param events Requested events.
+ * @return epoll events.
+ */
+static uint32_t to_epoll_events(unsigned int events)
+{
+    uint32_t epoll_events = 0;
+
+    if (events & ComPoller::readable)
+        epoll_events |= EPOLLIN | EPOLLRDHUP;
+
+    if (events & ComPoller::writable)
+        epoll_events |= EPOLLOUT;
+
+    return epoll_events;
+}
+#endif
+
+////////////////////
+// Public Methods //
+////////////////////
+
+ComPoller::ComPoller() : m_epoll(-1)
+{
+#if defined(__linux__)
+    m_epoll = ::epoll_create1(EPOLL_CLOEXEC);
+#endif
+}
+
+ComPoller::~ComPoller()
+{
+#if defined(__linux__)
+    if (m_epoll >= 0)
+        ::close(m_epoll);
+#endif
+}
+
+bool ComPoller::Add(ComInterface *com, unsigned int events)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    if (!com || m_entries.count(com))
+        return false;
+
+    Entry entry;
+
+    entry.handle = com->GetReadinessHandle();
+    entry.events = events;
+
+    if (entry.handle < 0)
+        return false;
+
+#if defined(__linux__)
+    if (m_epoll >= 0)
+    {
+        struct epoll_event event = epoll_event();
+
+        event.events = to_epoll_events(events);
+        event.data.ptr = com;
+
+        if (::epoll_ctl(m_epoll, EPOLL_CTL_ADD, entry.handle, &event) != 0)
+            return false;
+    }
+#endif
+
+    m_entries[com] = entry;
+
+    return true;
+}
+
+bool ComPoller::Modify(ComInterface *com, unsigned int events)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    std::map<ComInterface *, Entry>::iterator it = m_entries.find(com);
+
+    if (it == m_entries.end())
+        return false;
+
+#if defined(__linux__)
+    if (m_epoll >= 0)
+    {
+        struct epoll_event event = epoll_event();
+
+        event.events = to_epoll_events(events);
+        event.data.ptr = com;
+
+        if (::epoll_ctl(m_epoll, EPOLL_CTL_MOD, it->second.handle, &event) != 0)
+            return false;
+    }
+#endif
+
+    it->second.events = events;
+
+    return true;
+}
+
+bool ComPoller::Remove(ComInterface *com)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    std::map<ComInterface *, Entry>::iterator it = m_entries.find(com);
+
+    if (it == m_entries.end())
+        return false;
+
+#if defined(__linux__)
+    if (m_epoll >= 0)
+    {
+        struct epoll_event event = epoll_event();
+
+        // The descriptor may have been closed, that already removed it
+        ::epoll_ctl(m_epoll, EPOLL_CTL_DEL, it->second.handle, &event);
+    }
+#endif
+
+    m_entries.erase(it);
+
+    return true;
+}
+
+size_t ComPoller::Size()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_entries.size();
+}
+
+int ComPoller::Wait(std::vector<ComPollItem>& ready, unsigned int timeout)
+{
+    ready.clear();
+
+#if defined(__linux__)
+    if (m_epoll >= 0)
+    {
+        std::vector<struct epoll_event> events;
+        PollTimeout time_left(timeout);
+        int ret_code;
+
+        {
+            // Lock for thread safe
+            boost::lock_guard<boost::mutex> lock(m_mutex);
+
+            events.resize(m_entries.empty() ? 1 : m_entries.size());
+        }
+
+        // The set is not locked while waiting, so it can be modified
+        // from other threads
+        do
+        {
+            ret_code = ::epoll_wait(m_epoll, &events[0], static_cast<int>(events.size()),
+                                    time_left.remaining());
+        }
+        while (ret_code < 0 && errno == EINTR);
+
+        if (ret_code < 0)
+            return -1;
+
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        for (int i = 0; i < ret_code; ++i)
+        {
+            ComInterface *com = static_cast<ComInterface *>(events[i].data.ptr);
+
+            // Skip the interfaces removed during the wait
+            if (!m_entries.count(com))
+                continue;
+
+            ComPollItem item(com, m_entries[com].events);
+
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP))
+                item.revents |= readable;
+
+            if (events[i].events & EPOLLOUT)
+                item.revents |= writable;
+
+            if (events[i].events & (EPOLLERR | EPOLLHUP))
+                item.revents |= error;
+
+            ready.push_back(item);
+        }
+
+        return static_cast<int>(ready.size());
+    }
+#endif
+
+    // Without epoll, wait for a copy of the set
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        for (std::map<ComInterface *, Entry>::iterator it = m_entries.begin();
+             it != m_entries.end(); ++it)
+            ready.push_back(ComPollItem(it->first, it->second.events));
+    }
+
+    int ret_code = WaitAny(ready, timeout);
+    size_t count = 0;
+
+    // Keep only the ready interfaces
+    for (size_t i = 0; i < ready.size(); ++i)
+    {
+        if (ready[i].revents)
+            ready[count++] = ready[i];
+    }
+
+    ready.resize(count);
+
+    return ret_code;
+}
+
+int ComPoller::WaitAny(std::vector<ComPollItem>& items, unsigned int timeout)
+{
+#if defined(BOOST_WINDOWS) || defined(__CYGWIN__)
+    return -1;
+#else
+    std::vector<struct pollfd> fds(items.size());
+    PollTimeout time_left(timeout);
+    int ret_code;
+
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        items[i].revents = 0;
+
+        fds[i].fd = items[i].com ? items[i].com->GetReadinessHandle() : -1;
+        fds[i].events = (items[i].events & readable ? POLLIN : 0) | (items[i].events & writable ? POLLOUT : 0);
+        fds[i].revents = 0;
+
+        // poll ignores the negative descriptors, so a closed interface
+        // would never be reported
+        if (fds[i].fd < 0)
+            return -1;
+    }
+
+    do
+    {
+        ret_code = ::poll(fds.empty() ? NULL : &fds[0], fds.size(), time_left.remaining());
+    }
+    while (ret_code < 0 && errno == EINTR);
+
+    if (ret_code < 0)
+        return -1;
+
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        if (fds[i].revents & POLLIN)
+            items[i].revents |= readable;
+
+        if (fds[i].revents & POLLOUT)
+            items[i].revents |= writable;
+
+        if (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL))
+            items[i].revents |= error;
+    }
+
+    return ret_code;
+#endif
+}
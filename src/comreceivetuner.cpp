@@ -0,0 +1,170 @@
+/**
+ * @file    comreceivetuner.cpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Adaptive size of the reads and of the kernel receive buffer implementation.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "cominterface/comreceivetuner.hpp"
+#include "cominterface/cominterface.hpp"
+
+/**
+ * @brief Growth factor of the read size, the ratio between the size
+ * classes of ComBufferPool.
+ */
+static const size_t growth_factor = 4;
+
+/**
+ * @brief Consecutive full reads that make the read size grow.
+ */
+static const unsigned int full_reads_to_grow = 2;
+
+/**
+ * @brief Maximum number of reads of a measure period.
+ */
+static const size_t period_reads = 64;
+
+/**
+ * @brief Maximum duration of a measure period, in milliseconds.
+ */
+static const unsigned int period_time = 250;
+
+/**
+ * @brief Time of received data that the kernel buffer must hold, in milliseconds.
+ */
+static const unsigned int kernel_buffer_time = 20;
+
+/**
+ * @brief Limits of the kernel receive buffer.
+ */
+static const size_t min_kernel_size = 4096;
+static const size_t max_kernel_size = 4 * 1024 * 1024;
+
+////////////////////
+// Public Methods //
+////////////////////
+
+ComReceiveTuner::ComReceiveTuner(ComInterface *com, size_t min_read_size, size_t max_read_size) :
+    m_com(com), m_min_read_size(min_read_size), m_max_read_size(max_read_size),
+    m_full_streak(0), m_requested_kernel_size(0)
+{
+    if (!m_com)
+        throw std::invalid_argument("invalid interface");
+
+    if (m_min_read_size == 0 || m_min_read_size > m_max_read_size)
+        throw std::invalid_argument("invalid read size");
+
+    // Start with a medium size, that adapts in a few reads
+    m_stats.read_size = std::max(m_min_read_size, std::min(m_max_read_size, static_cast<size_t>(4096)));
+
+    restart_period();
+}
+
+size_t ComReceiveTuner::GetReadSize()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_stats.read_size;
+}
+
+void ComReceiveTuner::Record(int received)
+{
+    if (received <= 0)
+        return;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    size_t size = static_cast<size_t>(received);
+
+    ++m_stats.reads;
+    m_stats.bytes += size;
+    ++m_period_reads;
+    m_period_bytes += size;
+    m_period_max = std::max(m_period_max, size);
+
+    // A full read means that more data was waiting
+    if (size >= m_stats.read_size)
+    {
+        ++m_stats.full_reads;
+
+        if (++m_full_streak >= full_reads_to_grow && m_stats.read_size < m_max_read_size)
+        {
+            m_stats.read_size = std::min(m_max_read_size, m_stats.read_size * growth_factor);
+            ++m_stats.grows;
+            m_full_streak = 0;
+
+            // The reads of the old size don't tell if the new one is too large
+            m_period_max = 0;
+        }
+    }
+    else
+        m_full_streak = 0;
+
+    double elapsed = boost::chrono::duration<double>(boost::chrono::steady_clock::now() -
+                                                     m_period_start).count();
+
+    if (m_period_reads >= period_reads || elapsed * 1000 >= period_time)
+    {
+        end_period(elapsed);
+        restart_period();
+    }
+}
+
+void ComReceiveTuner::GetStats(ComReceiveStats& stats)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    stats = m_stats;
+}
+
+/////////////////////
+// Private Methods //
+/////////////////////
+
+void ComReceiveTuner::restart_period()
+{
+    m_period_start = boost::chrono::steady_clock::now();
+    m_period_reads = 0;
+    m_period_bytes = 0;
+    m_period_max = 0;
+}
+
+void ComReceiveTuner::end_period(double elapsed)
+{
+    // The bursts of the period fit in a smaller buffer
+    if (m_period_max > 0 && m_period_max * growth_factor <= m_stats.read_size &&
+        m_stats.read_size > m_min_read_size)
+    {
+        m_stats.read_size = std::max(m_min_read_size, m_stats.read_size / growth_factor);
+        ++m_stats.shrinks;
+    }
+
+    if (elapsed > 0)
+        m_stats.throughput = m_period_bytes / elapsed;
+
+    // Hold the data received while the reader is not scheduled, rounded
+    // to a power of 2 so small changes of throughput don't reset it
+    size_t target = static_cast<size_t>(m_stats.throughput * kernel_buffer_time / 1000);
+
+    target = std::max(target, m_stats.read_size * 4);
+    target = std::min(std::max(target, min_kernel_size), max_kernel_size);
+
+    size_t kernel_size = min_kernel_size;
+
+    while (kernel_size < target)
+        kernel_size <<= 1;
+
+    if (kernel_size == m_requested_kernel_size)
+        return;
+
+    m_requested_kernel_size = kernel_size;
+
+    if (m_com->SetReceiveBufferSize(kernel_size))
+        m_stats.kernel_buffer_size = m_com->GetReceiveBufferSize();
+}
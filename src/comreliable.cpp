@@ -0,0 +1,849 @@
+/**
+ * @file    comreliable.cpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Reliable ordered byte stream over an unreliable link implementation.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+#include <boost/crc.hpp>
+#include <boost/random/mersenne_twister.hpp>
+
+#include "cominterface/comreliable.hpp"
+
+const size_t ComReliable::header_size;
+const size_t ComReliable::max_window;
+const size_t ComReliable::batch_frames;
+
+// Delimiter of the frames
+static const unsigned char frame_flag = 0x7E;
+
+// Escape of the flag and escape bytes inside a frame
+static const unsigned char frame_escape = 0x7D;
+
+// Number of frames acknowledged after a lost one that trigger its retransmission
+static const unsigned int fast_threshold = 3;
+
+// Append a byte to a frame, escaping it if needed
+static void stuff(std::vector<unsigned char>& frames, unsigned char byte)
+{
+    if (byte == frame_flag || byte == frame_escape)
+    {
+        frames.push_back(frame_escape);
+        frames.push_back(static_cast<unsigned char>(byte ^ 0x20));
+    }
+    else
+    {
+        frames.push_back(byte);
+    }
+}
+
+// Read a big endian 16-bit field
+static boost::uint16_t get16(const unsigned char *data)
+{
+    return static_cast<boost::uint16_t>((data[0] << 8) | data[1]);
+}
+
+// Write a big endian 16-bit field
+static void put16(unsigned char *data, boost::uint16_t value)
+{
+    data[0] = static_cast<unsigned char>(value >> 8);
+    data[1] = static_cast<unsigned char>(value);
+}
+
+////////////////////
+// Public Methods //
+////////////////////
+
+ComReliable::ComReliable(ComInterface *link, size_t window, size_t max_payload) :
+    m_link(link), m_window(window), m_max_payload(max_payload), m_snd_una(0), m_snd_nxt(0),
+    m_epoch(0), m_rcv_nxt(0), m_peer_epoch(0), m_ack_pending(false), m_escape(false),
+    m_overflow(false), m_srtt(0), m_rttvar(0), m_rto(1000), m_min_rto(10), m_max_rto(10000),
+    m_running(false), m_stop(false), m_failed(false), m_abort(0), m_read_timeout(1000),
+    m_write_timeout(1000), m_clock(ComClock::GetSystemClock())
+{
+    if (!m_link)
+        throw std::invalid_argument("invalid link");
+
+    if (m_window == 0 || m_window > max_window)
+        throw std::invalid_argument("invalid window size");
+
+    if (m_max_payload == 0 || m_max_payload > 0xFFFF - header_size - 2)
+        throw std::invalid_argument("invalid maximum payload size");
+
+    m_reorder.resize(m_window);
+    m_parse.reserve(header_size + m_max_payload + 2);
+}
+
+ComReliable::~ComReliable()
+{
+    // The streaming thread uses the virtual functions of the interface
+    StopStreaming();
+
+    stop();
+}
+
+bool ComReliable::Open()
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        if (m_running && !m_failed)
+            return true;
+    }
+
+    // A failed session is finished before starting the new one
+    stop();
+
+    if (!m_link->Opened() && !m_link->Open())
+        return false;
+
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        // A new session, so the other end discards the state of the previous one
+        boost::random::mt19937 random(static_cast<boost::uint32_t>(
+            boost::chrono::steady_clock::now().time_since_epoch().count()) ^
+            static_cast<boost::uint32_t>(reinterpret_cast<size_t>(this)));
+        boost::uint16_t epoch;
+
+        do
+        {
+            epoch = static_cast<boost::uint16_t>(random());
+        }
+        while (epoch == 0 || epoch == m_epoch);
+
+        m_epoch = epoch;
+        m_snd_una = 0;
+        m_snd_nxt = 0;
+        m_tx.clear();
+        m_unacked.clear();
+        m_rx.clear();
+        m_reorder.assign(m_window, std::vector<unsigned char>());
+        m_rcv_nxt = 0;
+        m_peer_epoch = 0;
+        m_ack_pending = false;
+        m_parse.clear();
+        m_escape = false;
+        m_overflow = false;
+        m_srtt = 0;
+        m_rttvar = 0;
+        m_rto = std::min(std::max(1000.0, static_cast<double>(m_min_rto)),
+                         static_cast<double>(m_max_rto));
+        m_stats = ComReliableStats();
+        m_stop = false;
+        m_failed = false;
+        m_readable.Clear();
+    }
+
+    ComStreamHandlers handlers;
+
+    handlers.on_data = boost::bind(&ComReliable::receive_handler, this, _1);
+    handlers.on_error = boost::bind(&ComReliable::failure_handler, this);
+    handlers.on_closed = boost::bind(&ComReliable::failure_handler, this);
+
+    if (!m_link->StartStreaming(handlers))
+        return false;
+
+    try
+    {
+        m_sender = boost::thread(boost::bind(&ComReliable::sender, this));
+    }
+    catch (boost::thread_resource_error&)
+    {
+        m_link->StopStreaming();
+        return false;
+    }
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_running = true;
+
+    return true;
+}
+
+bool ComReliable::Close()
+{
+    stop();
+
+    return m_link->Close();
+}
+
+bool ComReliable::Opened()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_running && !m_failed;
+}
+
+int ComReliable::ReadSome(void *buffer_in, size_t len)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    size_t received = take(buffer_in, len);
+
+    // Without data, report the failure of the link
+    if (received == 0 && (m_failed || !m_running))
+        return -1;
+
+    return static_cast<int>(received);
+}
+
+int ComReliable::WriteSome(const void *buffer_out, size_t len)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    if (m_failed || !m_running)
+        return -1;
+
+    return static_cast<int>(queue(buffer_out, len));
+}
+
+int ComReliable::Read(void *buffer_in, size_t len)
+{
+    size_t received = 0;
+
+    // Lock for thread safe
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+
+    ComClock::time_point deadline = this->deadline(m_read_timeout);
+    unsigned int abort = m_abort;
+
+    // Wait until all the data is received, the timeout expires or the
+    // operation is aborted
+    while (true)
+    {
+        received += take(static_cast<unsigned char *>(buffer_in) + received, len - received);
+
+        if (received == len || abort != m_abort)
+            break;
+
+        if (m_failed || !m_running)
+        {
+            if (received == 0)
+                return -1;
+
+            break;
+        }
+
+        if (m_clock->WaitUntil(m_rx_cond, lock, deadline) == boost::cv_status::timeout)
+        {
+            received += take(static_cast<unsigned char *>(buffer_in) + received, len - received);
+            break;
+        }
+    }
+
+    return static_cast<int>(received);
+}
+
+int ComReliable::Write(const void *buffer_out, size_t len)
+{
+    size_t written = 0;
+
+    // Lock for thread safe
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+
+    if (m_failed || !m_running)
+        return -1;
+
+    ComClock::time_point deadline = this->deadline(m_write_timeout);
+    unsigned int abort = m_abort;
+
+    // Wait until all the data is queued, the timeout expires or the
+    // operation is aborted
+    while (true)
+    {
+        written += queue(static_cast<const unsigned char *>(buffer_out) + written, len - written);
+
+        if (written == len || abort != m_abort || m_failed || !m_running)
+            break;
+
+        if (m_clock->WaitUntil(m_rx_cond, lock, deadline) == boost::cv_status::timeout)
+        {
+            written += queue(static_cast<const unsigned char *>(buffer_out) + written, len - written);
+            break;
+        }
+    }
+
+    return static_cast<int>(written);
+}
+
+void ComReliable::Abort()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    ++m_abort;
+    m_rx_cond.notify_all();
+}
+
+bool ComReliable::SetWriteTimeout(unsigned int write_timeout)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_write_timeout = write_timeout;
+
+    return true;
+}
+
+unsigned int ComReliable::GetWriteTimeout()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_write_timeout;
+}
+
+bool ComReliable::SetReadTimeout(unsigned int read_timeout)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_read_timeout = read_timeout;
+
+    return true;
+}
+
+unsigned int ComReliable::GetReadTimeout()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_read_timeout;
+}
+
+int ComReliable::GetReadinessHandle()
+{
+    return m_readable.GetHandle();
+}
+
+bool ComReliable::SetClock(ComClock *clock)
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        m_clock = clock ? clock : ComClock::GetSystemClock();
+
+        // The sender waits again with the new clock
+        m_tx_cond.notify_one();
+    }
+
+    m_link->SetClock(clock);
+
+    return true;
+}
+
+bool ComReliable::SetRetransmission(unsigned int min_rto, unsigned int max_rto)
+{
+    if (min_rto == 0 || min_rto > max_rto)
+        return false;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_min_rto = min_rto;
+    m_max_rto = max_rto;
+    m_rto = std::min(std::max(m_rto, static_cast<double>(m_min_rto)), static_cast<double>(m_max_rto));
+
+    return true;
+}
+
+size_t ComReliable::GetUnacknowledged()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    size_t count = m_tx.size();
+
+    for (std::deque<Segment>::const_iterator it = m_unacked.begin(); it != m_unacked.end(); ++it)
+        count += it->payload.size();
+
+    return count;
+}
+
+void ComReliable::GetStats(ComReliableStats& stats)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    stats = m_stats;
+    stats.srtt = m_srtt;
+    stats.rto = m_rto;
+}
+
+/////////////////////
+// Private Methods //
+/////////////////////
+
+void ComReliable::stop()
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        if (!m_running)
+            return;
+
+        m_stop = true;
+        m_tx_cond.notify_one();
+    }
+
+    m_sender.join();
+    m_link->StopStreaming();
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_running = false;
+    m_rx_cond.notify_all();
+}
+
+size_t ComReliable::take(void *buffer_in, size_t len)
+{
+    size_t count = std::min(len, m_rx.size());
+
+    if (count == 0)
+        return 0;
+
+    std::copy(m_rx.begin(), m_rx.begin() + count, static_cast<unsigned char *>(buffer_in));
+    m_rx.erase(m_rx.begin(), m_rx.begin() + count);
+
+    // A failed link stays readable, so that its closure is seen
+    if (m_rx.empty() && !m_failed)
+        m_readable.Clear();
+
+    return count;
+}
+
+size_t ComReliable::queue(const void *buffer_out, size_t len)
+{
+    size_t limit = m_window * m_max_payload;
+    size_t count = 0;
+
+    // The data pending to be sent is limited to a window
+    if (m_tx.size() < limit)
+        count = std::min(len, limit - m_tx.size());
+
+    if (count == 0)
+        return 0;
+
+    const unsigned char *data = static_cast<const unsigned char *>(buffer_out);
+
+    m_tx.insert(m_tx.end(), data, data + count);
+
+    if (m_unacked.size() < m_window)
+        m_tx_cond.notify_one();
+
+    return count;
+}
+
+void ComReliable::receive_handler(const ComBuffer& buffer)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    const unsigned char *data = buffer.Data();
+    size_t max_frame = header_size + m_max_payload + 2;
+
+    for (size_t i = 0; i < buffer.Size(); ++i)
+    {
+        unsigned char byte = data[i];
+
+        if (byte == frame_flag)
+        {
+            // Consecutive flags delimit empty frames, that are ignored
+            if (m_overflow || m_escape)
+                ++m_stats.bad_frames;
+            else if (!m_parse.empty())
+                process_frame(&m_parse[0], m_parse.size());
+
+            m_parse.clear();
+            m_escape = false;
+            m_overflow = false;
+        }
+        else if (m_overflow)
+        {
+            continue;
+        }
+        else if (byte == frame_escape)
+        {
+            m_escape = true;
+        }
+        else if (m_parse.size() == max_frame)
+        {
+            // The rest of the frame is discarded until the next flag
+            m_overflow = true;
+        }
+        else
+        {
+            m_parse.push_back(m_escape ? static_cast<unsigned char>(byte ^ 0x20) : byte);
+            m_escape = false;
+        }
+    }
+
+    m_tx_cond.notify_one();
+}
+
+void ComReliable::failure_handler()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_failed = true;
+    m_readable.Set();
+
+    m_tx_cond.notify_one();
+    m_rx_cond.notify_all();
+}
+
+void ComReliable::process_frame(const unsigned char *frame, size_t len)
+{
+    if (len < header_size + 2)
+    {
+        ++m_stats.bad_frames;
+        return;
+    }
+
+    boost::crc_ccitt_type crc;
+
+    crc.process_bytes(frame, len - 2);
+
+    size_t length = get16(frame + 15);
+
+    if (crc.checksum() != get16(frame + len - 2) || length != len - header_size - 2 ||
+        get16(frame + 1) == 0 ||
+        (frame[0] == frame_data && (length == 0 || length > m_max_payload)) ||
+        (frame[0] == frame_ack && length != 0) ||
+        (frame[0] != frame_data && frame[0] != frame_ack))
+    {
+        ++m_stats.bad_frames;
+        return;
+    }
+
+    boost::uint16_t epoch = get16(frame + 1);
+    boost::uint16_t base = get16(frame + 5);
+
+    // A new session of the other end restarts the reception from its
+    // oldest frame in flight
+    if (epoch != m_peer_epoch)
+    {
+        m_peer_epoch = epoch;
+        m_rcv_nxt = base;
+        m_reorder.assign(m_window, std::vector<unsigned char>());
+    }
+
+    // The acknowledgements of a previous session are ignored
+    if (get16(frame + 3) == m_epoch)
+    {
+        boost::uint32_t sack = (static_cast<boost::uint32_t>(frame[11]) << 24) |
+                               (static_cast<boost::uint32_t>(frame[12]) << 16) |
+                               (static_cast<boost::uint32_t>(frame[13]) << 8) |
+                               frame[14];
+
+        process_ack(get16(frame + 9), sack, m_clock->Now());
+    }
+
+    if (frame[0] != frame_data)
+        return;
+
+    boost::uint16_t offset = static_cast<boost::uint16_t>(get16(frame + 7) - m_rcv_nxt);
+    const unsigned char *payload = frame + header_size;
+
+    // The other end is answered even if the frame is repeated, because
+    // its acknowledgement could have been lost
+    m_ack_pending = true;
+
+    if (offset >= m_window || !m_reorder[offset].empty())
+    {
+        ++m_stats.duplicates;
+        return;
+    }
+
+    // Without room for the data, the frame is not acknowledged and it is
+    // sent again later
+    if (m_rx.size() + length > m_window * m_max_payload)
+        return;
+
+    m_reorder[offset].assign(payload, payload + length);
+    ++m_stats.frames_received;
+
+    if (offset != 0)
+        return;
+
+    // Deliver the frames received in order
+    while (!m_reorder.front().empty())
+    {
+        m_rx.insert(m_rx.end(), m_reorder.front().begin(), m_reorder.front().end());
+        m_reorder.pop_front();
+        m_reorder.push_back(std::vector<unsigned char>());
+        ++m_rcv_nxt;
+    }
+
+    m_readable.Set();
+    m_rx_cond.notify_all();
+}
+
+void ComReliable::process_ack(boost::uint16_t ack, boost::uint32_t sack,
+                              const ComClock::time_point& now)
+{
+    size_t acked = static_cast<boost::uint16_t>(ack - m_snd_una);
+
+    // An acknowledgement out of the frames in flight is not valid
+    if (acked > m_unacked.size())
+        return;
+
+    if (acked > 0)
+    {
+        const Segment& last = m_unacked[acked - 1];
+
+        // Karn's algorithm: the frames sent again don't measure the round trip time
+        if (last.transmissions == 1)
+            sample_rtt(boost::chrono::duration<double, boost::milli>(now - last.sent).count());
+
+        m_unacked.erase(m_unacked.begin(), m_unacked.begin() + acked);
+        m_snd_una = ack;
+    }
+
+    size_t sacked = 0;
+
+    // The selective acknowledgements refer to the frames after the first one
+    for (size_t i = 0; i < 32 && i + 1 < m_unacked.size(); ++i)
+    {
+        if (sack & (1UL << i))
+            m_unacked[i + 1].sacked = true;
+    }
+
+    // A frame with enough later frames acknowledged is considered lost
+    for (size_t i = m_unacked.size(); i > 0; --i)
+    {
+        Segment& segment = m_unacked[i - 1];
+
+        if (segment.sacked)
+        {
+            ++sacked;
+        }
+        else if (sacked >= fast_threshold && !segment.fast)
+        {
+            segment.retransmit = true;
+            segment.fast = true;
+        }
+    }
+}
+
+void ComReliable::sample_rtt(double rtt)
+{
+    // RFC 6298
+    if (m_srtt == 0)
+    {
+        m_srtt = std::max(rtt, 0.001);
+        m_rttvar = rtt / 2;
+    }
+    else
+    {
+        m_rttvar = 0.75 * m_rttvar + 0.25 * std::fabs(m_srtt - rtt);
+        m_srtt = 0.875 * m_srtt + 0.125 * rtt;
+    }
+
+    m_rto = m_srtt + std::max(1.0, 4 * m_rttvar);
+    m_rto = std::min(std::max(m_rto, static_cast<double>(m_min_rto)), static_cast<double>(m_max_rto));
+}
+
+void ComReliable::append_frame(FrameType type, boost::uint16_t seq,
+                               const unsigned char *payload, size_t len)
+{
+    unsigned char header[header_size];
+    boost::uint32_t sack = sack_bitmap();
+
+    header[0] = static_cast<unsigned char>(type);
+    put16(header + 1, m_epoch);
+    put16(header + 3, m_peer_epoch);
+    put16(header + 5, m_snd_una);
+    put16(header + 7, seq);
+    put16(header + 9, m_rcv_nxt);
+    header[11] = static_cast<unsigned char>(sack >> 24);
+    header[12] = static_cast<unsigned char>(sack >> 16);
+    header[13] = static_cast<unsigned char>(sack >> 8);
+    header[14] = static_cast<unsigned char>(sack);
+    put16(header + 15, static_cast<boost::uint16_t>(len));
+
+    boost::crc_ccitt_type crc;
+
+    crc.process_bytes(header, header_size);
+    crc.process_bytes(payload, len);
+
+    unsigned char checksum[2];
+
+    put16(checksum, crc.checksum());
+
+    m_frames.push_back(frame_flag);
+
+    for (size_t i = 0; i < header_size; ++i)
+        stuff(m_frames, header[i]);
+
+    for (size_t i = 0; i < len; ++i)
+        stuff(m_frames, payload[i]);
+
+    stuff(m_frames, checksum[0]);
+    stuff(m_frames, checksum[1]);
+
+    m_frames.push_back(frame_flag);
+
+    // Every frame carries the acknowledgement
+    m_ack_pending = false;
+}
+
+boost::uint32_t ComReliable::sack_bitmap()
+{
+    boost::uint32_t sack = 0;
+
+    for (size_t i = 0; i < 32 && i + 1 < m_window; ++i)
+    {
+        if (!m_reorder[i + 1].empty())
+            sack |= 1UL << i;
+    }
+
+    return sack;
+}
+
+ComClock::time_point ComReliable::gather(const ComClock::time_point& now)
+{
+    ComClock::time_point next = ComClock::time_point::max();
+    size_t frames = 0;
+    bool backoff = false;
+
+    m_frames.clear();
+
+    // The lost frames are sent first, because the other end can't deliver
+    // the next ones without them
+    for (std::deque<Segment>::iterator it = m_unacked.begin(); it != m_unacked.end(); ++it)
+    {
+        if (it->sacked)
+            continue;
+
+        if (frames < batch_frames && (it->retransmit || it->deadline <= now))
+        {
+            if (it->retransmit)
+            {
+                ++m_stats.fast_retransmissions;
+            }
+            else
+            {
+                // The timeout is doubled once for the frames that expire together
+                if (!backoff)
+                {
+                    m_rto = std::min(m_rto * 2, static_cast<double>(m_max_rto));
+                    backoff = true;
+                }
+
+                ++m_stats.timeouts;
+                it->fast = false;
+            }
+
+            append_frame(frame_data, it->seq, &it->payload[0], it->payload.size());
+
+            ++it->transmissions;
+            it->sent = now;
+            it->deadline = now + boost::chrono::microseconds(static_cast<long long>(m_rto * 1000));
+            it->retransmit = false;
+            ++m_stats.retransmissions;
+            ++m_stats.frames_sent;
+            ++frames;
+        }
+
+        next = std::min(next, it->deadline);
+    }
+
+    // New frames while there is room in the window
+    while (frames < batch_frames && m_unacked.size() < m_window && !m_tx.empty())
+    {
+        size_t length = std::min(m_tx.size(), m_max_payload);
+
+        m_unacked.push_back(Segment());
+
+        Segment& segment = m_unacked.back();
+
+        segment.seq = m_snd_nxt++;
+        segment.payload.assign(m_tx.begin(), m_tx.begin() + length);
+        segment.sent = now;
+        segment.deadline = now + boost::chrono::microseconds(static_cast<long long>(m_rto * 1000));
+        segment.transmissions = 1;
+        segment.sacked = false;
+        segment.retransmit = false;
+        segment.fast = false;
+
+        m_tx.erase(m_tx.begin(), m_tx.begin() + length);
+
+        append_frame(frame_data, segment.seq, &segment.payload[0], length);
+
+        next = std::min(next, segment.deadline);
+        ++m_stats.frames_sent;
+        ++frames;
+
+        // There is room for the blocked writes
+        m_rx_cond.notify_all();
+    }
+
+    // An acknowledgement alone if no data frame has carried it
+    if (m_ack_pending)
+    {
+        append_frame(frame_ack, m_snd_nxt, NULL, 0);
+        ++m_stats.acks_sent;
+    }
+
+    return next;
+}
+
+void ComReliable::sender()
+{
+    // Lock for thread safe
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+
+    while (!m_stop && !m_failed)
+    {
+        ComClock::time_point next = gather(m_clock->Now());
+
+        if (m_frames.empty())
+        {
+            // Wait for data, acknowledgements or the next retransmission
+            if (next == ComClock::time_point::max())
+                m_tx_cond.wait(lock);
+            else
+                m_clock->WaitUntil(m_tx_cond, lock, next);
+
+            continue;
+        }
+
+        // The link is written without locking the transport
+        lock.unlock();
+
+        int ret_code = m_link->Write(&m_frames[0], m_frames.size());
+
+        lock.lock();
+
+        // A partial frame is discarded by the other end, but a failed
+        // write means that the link is broken
+        if (ret_code < 0)
+        {
+            m_failed = true;
+            m_readable.Set();
+            m_rx_cond.notify_all();
+        }
+    }
+}
+
+ComClock::time_point ComReliable::deadline(unsigned int timeout)
+{
+    return m_clock->Now() + boost::chrono::milliseconds(timeout);
+}
@@ -0,0 +1,1419 @@
+/**
+ * @file    comrfc2217.cpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Remote serial ports over Telnet (RFC 2217) implementation.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+#include "cominterface/comrfc2217.hpp"
+
+const unsigned char ComTelnet::iac;
+const unsigned int ComRfc2217Server::poll_interval;
+const size_t ComRfc2217::num_commands;
+
+// Telnet commands
+static const unsigned char telnet_se = 240;
+static const unsigned char telnet_sb = 250;
+static const unsigned char telnet_will = 251;
+static const unsigned char telnet_wont = 252;
+static const unsigned char telnet_do = 253;
+static const unsigned char telnet_dont = 254;
+
+// Telnet options
+static const unsigned char option_binary = 0;
+static const unsigned char option_sga = 3;
+static const unsigned char option_comport = 44;
+
+// State of an option
+static const unsigned char flag_supported = 0x01;
+static const unsigned char flag_enabled = 0x02;
+static const unsigned char flag_requested = 0x04;
+static const unsigned char flag_refused = 0x08;
+
+// Maximum number of bytes of a subnegotiation, the rest is discarded
+static const size_t max_parameters = 256;
+
+// Commands of the option. The server answers with the command plus server_offset
+static const unsigned char signature = 0;
+static const unsigned char set_baudrate = 1;
+static const unsigned char set_datasize = 2;
+static const unsigned char set_parity = 3;
+static const unsigned char set_stopsize = 4;
+static const unsigned char set_control = 5;
+static const unsigned char notify_modemstate = 7;
+static const unsigned char set_linestate_mask = 10;
+static const unsigned char set_modemstate_mask = 11;
+static const unsigned char purge_data = 12;
+static const unsigned char server_offset = 100;
+
+// Values of SET-PARITY
+static const boost::uint32_t parity_none = 1;
+static const boost::uint32_t parity_odd = 2;
+static const boost::uint32_t parity_even = 3;
+static const boost::uint32_t parity_mark = 4;
+static const boost::uint32_t parity_space = 5;
+
+// Values of SET-CONTROL
+static const boost::uint32_t flow_none = 1;
+static const boost::uint32_t flow_software = 2;
+static const boost::uint32_t flow_hardware = 3;
+static const boost::uint32_t break_query = 4;
+static const boost::uint32_t break_on = 5;
+static const boost::uint32_t break_off = 6;
+static const boost::uint32_t dtr_query = 7;
+static const boost::uint32_t dtr_on = 8;
+static const boost::uint32_t dtr_off = 9;
+static const boost::uint32_t rts_query = 10;
+static const boost::uint32_t rts_on = 11;
+static const boost::uint32_t rts_off = 12;
+static const boost::uint32_t inbound_query = 13;
+static const boost::uint32_t inbound_none = 14;
+
+// Value of PURGE-DATA that purges both buffers
+static const boost::uint32_t purge_both = 3;
+
+// Duration of the break sequences in milliseconds
+static const unsigned int break_duration = 250;
+
+// Signature of the server
+static const char server_signature[] = "cominterface";
+
+// Append a command of the option, with its value
+static void append_command(std::vector<unsigned char>& out, unsigned char command,
+                           boost::uint32_t value)
+{
+    unsigned char parameters[5] = {command};
+    size_t len = 2;
+
+    // The baud rate is the only value of 4 bytes, in network order
+    if (command % server_offset == set_baudrate)
+    {
+        parameters[1] = static_cast<unsigned char>(value >> 24);
+        parameters[2] = static_cast<unsigned char>(value >> 16);
+        parameters[3] = static_cast<unsigned char>(value >> 8);
+        parameters[4] = static_cast<unsigned char>(value);
+        len = 5;
+    }
+    else
+    {
+        parameters[1] = static_cast<unsigned char>(value);
+    }
+
+    ComTelnet::Subnegotiation(option_comport, parameters, len, out);
+}
+
+// Get the value of a command of the option, from a subnegotiation
+static boost::uint32_t command_value(const std::vector<unsigned char>& parameters)
+{
+    if (parameters.size() >= 6 && parameters[1] % server_offset == set_baudrate)
+        return (static_cast<boost::uint32_t>(parameters[2]) << 24) |
+               (static_cast<boost::uint32_t>(parameters[3]) << 16) |
+               (static_cast<boost::uint32_t>(parameters[4]) << 8) |
+               static_cast<boost::uint32_t>(parameters[5]);
+
+    return parameters.size() >= 3 ? parameters[2] : 0;
+}
+
+///////////////
+// ComTelnet //
+///////////////
+
+ComTelnet::ComTelnet() : m_state(state_data), m_command(0)
+{
+    std::fill(m_local, m_local + 256, 0);
+    std::fill(m_remote, m_remote + 256, 0);
+}
+
+void ComTelnet::Reset()
+{
+    m_state = state_data;
+    m_parameters.clear();
+
+    for (size_t i = 0; i < 256; ++i)
+    {
+        m_local[i] &= flag_supported;
+        m_remote[i] &= flag_supported;
+    }
+}
+
+void ComTelnet::Support(unsigned char option, bool local, bool remote)
+{
+    m_local[option] = local ? (m_local[option] | flag_supported) : (m_local[option] & ~flag_supported);
+    m_remote[option] = remote ? (m_remote[option] | flag_supported) : (m_remote[option] & ~flag_supported);
+}
+
+void ComTelnet::Request(unsigned char option, bool local, std::vector<unsigned char>& out)
+{
+    unsigned char& state = local ? m_local[option] : m_remote[option];
+
+    if (state & (flag_enabled | flag_requested))
+        return;
+
+    state = (state & ~flag_refused) | flag_requested;
+
+    out.push_back(iac);
+    out.push_back(local ? telnet_will : telnet_do);
+    out.push_back(option);
+}
+
+bool ComTelnet::Enabled(unsigned char option, bool local) const
+{
+    return ((local ? m_local[option] : m_remote[option]) & flag_enabled) != 0;
+}
+
+bool ComTelnet::Refused(unsigned char option, bool local) const
+{
+    return ((local ? m_local[option] : m_remote[option]) & flag_refused) != 0;
+}
+
+void ComTelnet::Parse(const unsigned char *bytes, size_t len, std::vector<unsigned char>& data,
+                      std::vector<unsigned char>& replies,
+                      std::vector<std::vector<unsigned char> >& subnegotiations)
+{
+    size_t i = 0;
+
+    while (i < len)
+    {
+        unsigned char byte;
+
+        switch (m_state)
+        {
+        case state_data:
+        {
+            // The data between commands is copied at once
+            const void *next = std::memchr(bytes + i, iac, len - i);
+            size_t end = next ? static_cast<const unsigned char *>(next) - bytes : len;
+
+            data.insert(data.end(), bytes + i, bytes + end);
+            i = end;
+
+            if (next)
+            {
+                m_state = state_command;
+                ++i;
+            }
+
+            break;
+        }
+
+        case state_command:
+            byte = bytes[i++];
+
+            if (byte == iac)
+            {
+                data.push_back(iac);
+                m_state = state_data;
+            }
+            else if (byte >= telnet_will && byte <= telnet_dont)
+            {
+                m_command = byte;
+                m_state = state_option;
+            }
+            else if (byte == telnet_sb)
+            {
+                m_parameters.clear();
+                m_state = state_subnegotiation;
+            }
+            else
+            {
+                // The rest of commands (NOP, GA...) don't affect a serial port
+                m_state = state_data;
+            }
+
+            break;
+
+        case state_option:
+            negotiate(m_command, bytes[i++], replies);
+            m_state = state_data;
+            break;
+
+        case state_subnegotiation:
+            byte = bytes[i++];
+
+            if (byte == iac)
+                m_state = state_subnegotiation_iac;
+            else if (m_parameters.size() < max_parameters)
+                m_parameters.push_back(byte);
+
+            break;
+
+        case state_subnegotiation_iac:
+            byte = bytes[i++];
+
+            if (byte == iac)
+            {
+                if (m_parameters.size() < max_parameters)
+                    m_parameters.push_back(iac);
+
+                m_state = state_subnegotiation;
+            }
+            else
+            {
+                // A subnegotiation ends with SE, anything else aborts it
+                if (byte == telnet_se && !m_parameters.empty())
+                    subnegotiations.push_back(m_parameters);
+
+                m_state = state_data;
+            }
+
+            break;
+        }
+    }
+}
+
+void ComTelnet::Escape(const unsigned char *data, size_t len, std::vector<unsigned char>& out)
+{
+    const unsigned char *end = data + len;
+
+    out.reserve(out.size() + len + len / 64 + 1);
+
+    while (data < end)
+    {
+        const void *next = std::memchr(data, iac, end - data);
+        const unsigned char *stop = next ? static_cast<const unsigned char *>(next) + 1 : end;
+
+        out.insert(out.end(), data, stop);
+
+        if (next)
+            out.push_back(iac);
+
+        data = stop;
+    }
+}
+
+size_t ComTelnet::Unescaped(const unsigned char *escaped, size_t len)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < len; ++i, ++count)
+    {
+        // The second IAC of a pair is not data
+        if (escaped[i] == iac && i + 1 < len)
+            ++i;
+        else if (escaped[i] == iac)
+            break;
+    }
+
+    return count;
+}
+
+void ComTelnet::Subnegotiation(unsigned char option, const unsigned char *data, size_t len,
+                               std::vector<unsigned char>& out)
+{
+    out.push_back(iac);
+    out.push_back(telnet_sb);
+    out.push_back(option);
+
+    Escape(data, len, out);
+
+    out.push_back(iac);
+    out.push_back(telnet_se);
+}
+
+/////////////////////
+// Private Methods //
+/////////////////////
+
+void ComTelnet::negotiate(unsigned char command, unsigned char option, std::vector<unsigned char>& replies)
+{
+    bool local = command == telnet_do || command == telnet_dont;
+    bool enable = command == telnet_will || command == telnet_do;
+    unsigned char& state = local ? m_local[option] : m_remote[option];
+    unsigned char answer;
+
+    if (enable)
+    {
+        if (state & flag_enabled)
+            return;
+
+        // The answer to our request is not answered again
+        if (state & flag_requested)
+        {
+            state = (state & ~flag_requested) | flag_enabled;
+            return;
+        }
+
+        if (state & flag_supported)
+        {
+            state |= flag_enabled;
+            answer = local ? telnet_will : telnet_do;
+        }
+        else
+        {
+            answer = local ? telnet_wont : telnet_dont;
+        }
+    }
+    else
+    {
+        if (state & flag_requested)
+        {
+            state = (state & ~(flag_requested | flag_enabled)) | flag_refused;
+            return;
+        }
+
+        if (!(state & flag_enabled))
+            return;
+
+        state &= ~flag_enabled;
+        answer = local ? telnet_wont : telnet_dont;
+    }
+
+    replies.push_back(iac);
+    replies.push_back(answer);
+    replies.push_back(option);
+}
+
+////////////////
+// ComRfc2217 //
+////////////////
+
+ComRfc2217::ComRfc2217(ComInterface *link, unsigned int baud_rate, unsigned int data_bits,
+                       unsigned int stop_bits, char parity, char flow_control) :
+    m_link(link), m_modem_status(-1), m_running(false), m_failed(false), m_abort(0),
+    m_read_timeout(1000), m_clock(ComClock::GetSystemClock())
+{
+    if (!m_link)
+        throw std::invalid_argument("invalid link");
+
+    std::fill(m_config, m_config + num_commands, 0);
+    std::fill(m_acks, m_acks + num_commands, 0);
+    std::fill(m_ack_values, m_ack_values + num_commands, 0);
+
+    if (!SetBaudRate(baud_rate))
+        throw std::invalid_argument("invalid baud rate");
+
+    if (!SetDataBits(data_bits))
+        throw std::invalid_argument("invalid data bits value");
+
+    if (!SetStopBits(stop_bits))
+        throw std::invalid_argument("invalid stop bits value");
+
+    if (!SetParity(parity))
+        throw std::invalid_argument("invalid parity value");
+
+    if (!SetFlowControl(flow_control))
+        throw std::invalid_argument("invalid flow control value");
+
+    // A binary connection without go-aheads, as the terminal servers expect
+    m_telnet.Support(option_binary, true, true);
+    m_telnet.Support(option_sga, true, true);
+    m_telnet.Support(option_comport, true, false);
+}
+
+ComRfc2217::~ComRfc2217()
+{
+    // The streaming thread uses the virtual functions of the interface
+    StopStreaming();
+
+    stop();
+}
+
+bool ComRfc2217::Open()
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        if (m_running && !m_failed)
+            return true;
+    }
+
+    // A failed link is stopped before starting again
+    stop();
+
+    if (!m_link->Opened() && !m_link->Open())
+        return false;
+
+    std::vector<unsigned char> negotiation;
+
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        m_rx.clear();
+        m_telnet.Reset();
+        m_modem_status = -1;
+        m_failed = false;
+        m_readable.Clear();
+
+        // All the options are requested at once
+        m_telnet.Request(option_comport, true, negotiation);
+        m_telnet.Request(option_binary, true, negotiation);
+        m_telnet.Request(option_binary, false, negotiation);
+        m_telnet.Request(option_sga, true, negotiation);
+        m_telnet.Request(option_sga, false, negotiation);
+    }
+
+    ComStreamHandlers handlers;
+
+    handlers.on_data = boost::bind(&ComRfc2217::receive_handler, this, _1);
+    handlers.on_error = boost::bind(&ComRfc2217::failure_handler, this);
+    handlers.on_closed = boost::bind(&ComRfc2217::failure_handler, this);
+
+    if (!m_link->StartStreaming(handlers))
+        return false;
+
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        m_running = true;
+    }
+
+    bool accepted = send(negotiation);
+
+    if (accepted)
+    {
+        // Lock for thread safe
+        boost::unique_lock<boost::mutex> lock(m_mutex);
+
+        ComClock::time_point deadline = m_clock->Now() + boost::chrono::milliseconds(m_read_timeout);
+        unsigned int abort = m_abort;
+
+        // The commands are sent once the server accepts the option
+        while (accepted && !m_telnet.Enabled(option_comport, true))
+        {
+            if (m_telnet.Refused(option_comport, true) || m_failed || abort != m_abort ||
+                m_clock->WaitUntil(m_rx_cond, lock, deadline) == boost::cv_status::timeout)
+                accepted = m_telnet.Enabled(option_comport, true);
+        }
+    }
+
+    const unsigned char commands[] = {set_baudrate, set_datasize, set_parity, set_stopsize, set_control};
+    const size_t count = sizeof(commands) / sizeof(commands[0]);
+    boost::uint32_t values[count];
+
+    if (accepted)
+    {
+        {
+            // Lock for thread safe
+            boost::lock_guard<boost::mutex> lock(m_mutex);
+
+            for (size_t i = 0; i < count; ++i)
+                values[i] = m_config[commands[i]];
+        }
+
+        // The whole configuration is sent in a single write
+        accepted = request(commands, values, count);
+    }
+
+    if (!accepted)
+    {
+        stop();
+        return false;
+    }
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    // The server could have adjusted the values
+    for (size_t i = 0; i < count; ++i)
+        m_config[commands[i]] = m_ack_values[commands[i]];
+
+    return true;
+}
+
+bool ComRfc2217::Close()
+{
+    stop();
+
+    return m_link->Close();
+}
+
+bool ComRfc2217::Opened()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_running && !m_failed;
+}
+
+int ComRfc2217::ReadSome(void *buffer_in, size_t len)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    size_t received = take(buffer_in, len);
+
+    // Without data, report the failure of the link
+    if (received == 0 && (m_failed || !m_running))
+        return -1;
+
+    return static_cast<int>(received);
+}
+
+int ComRfc2217::WriteSome(const void *buffer_out, size_t len)
+{
+    return Write(buffer_out, len);
+}
+
+int ComRfc2217::Read(void *buffer_in, size_t len)
+{
+    size_t received = 0;
+
+    // Lock for thread safe
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+
+    ComClock::time_point deadline = m_clock->Now() + boost::chrono::milliseconds(m_read_timeout);
+    unsigned int abort = m_abort;
+
+    // Wait until all the data is received, the timeout expires or the
+    // operation is aborted
+    while (true)
+    {
+        received += take(static_cast<unsigned char *>(buffer_in) + received, len - received);
+
+        if (received == len || abort != m_abort)
+            break;
+
+        if (m_failed || !m_running)
+        {
+            if (received == 0)
+                return -1;
+
+            break;
+        }
+
+        if (m_clock->WaitUntil(m_rx_cond, lock, deadline) == boost::cv_status::timeout)
+        {
+            received += take(static_cast<unsigned char *>(buffer_in) + received, len - received);
+            break;
+        }
+    }
+
+    return static_cast<int>(received);
+}
+
+int ComRfc2217::Write(const void *buffer_out, size_t len)
+{
+    const unsigned char *data = static_cast<const unsigned char *>(buffer_out);
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> write_lock(m_write_mutex);
+
+    // Without IAC bytes, the data is written without copying it
+    if (len == 0 || std::memchr(data, ComTelnet::iac, len) == NULL)
+        return m_link->Write(data, len);
+
+    m_escaped.clear();
+    ComTelnet::Escape(data, len, m_escaped);
+
+    int ret_code = m_link->Write(&m_escaped[0], m_escaped.size());
+
+    if (ret_code < 0 || static_cast<size_t>(ret_code) == m_escaped.size())
+        return ret_code < 0 ? -1 : static_cast<int>(len);
+
+    return static_cast<int>(ComTelnet::Unescaped(&m_escaped[0], ret_code));
+}
+
+void ComRfc2217::Abort()
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        ++m_abort;
+        m_rx_cond.notify_all();
+    }
+
+    // The writes wait in the link
+    m_link->Abort();
+}
+
+bool ComRfc2217::SetWriteTimeout(unsigned int write_timeout)
+{
+    return m_link->SetWriteTimeout(write_timeout);
+}
+
+unsigned int ComRfc2217::GetWriteTimeout()
+{
+    return m_link->GetWriteTimeout();
+}
+
+bool ComRfc2217::SetReadTimeout(unsigned int read_timeout)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_read_timeout = read_timeout;
+
+    return true;
+}
+
+unsigned int ComRfc2217::GetReadTimeout()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_read_timeout;
+}
+
+int ComRfc2217::GetReadinessHandle()
+{
+    return m_readable.GetHandle();
+}
+
+bool ComRfc2217::SetClock(ComClock *clock)
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        m_clock = clock ? clock : ComClock::GetSystemClock();
+    }
+
+    m_link->SetClock(clock);
+
+    return true;
+}
+
+bool ComRfc2217::SetBaudRate(unsigned int baud_rate)
+{
+    if (baud_rate == 0)
+        return false;
+
+    return configure(set_baudrate, baud_rate);
+}
+
+unsigned int ComRfc2217::GetBaudRate()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_config[set_baudrate];
+}
+
+bool ComRfc2217::SetDataBits(unsigned int data_bits)
+{
+    if (data_bits < 5 || data_bits > 8)
+        return false;
+
+    return configure(set_datasize, data_bits);
+}
+
+unsigned int ComRfc2217::GetDataBits()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_config[set_datasize];
+}
+
+bool ComRfc2217::SetStopBits(unsigned int stop_bits)
+{
+    // The values of the option are the same ones, 3 is 1.5 stop bits
+    if (stop_bits < 1 || stop_bits > 3)
+        return false;
+
+    return configure(set_stopsize, stop_bits);
+}
+
+unsigned int ComRfc2217::GetStopBits()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_config[set_stopsize];
+}
+
+bool ComRfc2217::SetParity(char parity)
+{
+    switch (parity)
+    {
+    case 'n':
+    case 'N':
+        return configure(set_parity, parity_none);
+
+    case 'o':
+    case 'O':
+        return configure(set_parity, parity_odd);
+
+    case 'e':
+    case 'E':
+        return configure(set_parity, parity_even);
+
+    case 'm':
+    case 'M':
+        return configure(set_parity, parity_mark);
+
+    case 's':
+    case 'S':
+        return configure(set_parity, parity_space);
+
+    default:
+        return false;
+    }
+}
+
+char ComRfc2217::GetParity()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    switch (m_config[set_parity])
+    {
+    case parity_odd:
+        return 'o';
+
+    case parity_even:
+        return 'e';
+
+    case parity_mark:
+        return 'm';
+
+    case parity_space:
+        return 's';
+
+    default:
+        return 'n';
+    }
+}
+
+bool ComRfc2217::SetFlowControl(char flow_control)
+{
+    switch (flow_control)
+    {
+    case 'h':
+    case 'H':
+        return configure(set_control, flow_hardware);
+
+    case 's':
+    case 'S':
+        return configure(set_control, flow_software);
+
+    case 'n':
+    case 'N':
+        return configure(set_control, flow_none);
+
+    default:
+        return false;
+    }
+}
+
+char ComRfc2217::GetFlowControl()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    switch (m_config[set_control])
+    {
+    case flow_hardware:
+        return 'h';
+
+    case flow_software:
+        return 's';
+
+    default:
+        return 'n';
+    }
+}
+
+bool ComRfc2217::Flush()
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        m_rx.clear();
+
+        if (!m_failed)
+            m_readable.Clear();
+    }
+
+    return execute(purge_data, purge_both);
+}
+
+bool ComRfc2217::SendBreak()
+{
+    if (!execute(set_control, break_on))
+        return false;
+
+    {
+        // Lock for thread safe
+        boost::unique_lock<boost::mutex> lock(m_mutex);
+
+        ComClock::time_point deadline = m_clock->Now() + boost::chrono::milliseconds(break_duration);
+
+        while (m_clock->WaitUntil(m_rx_cond, lock, deadline) != boost::cv_status::timeout)
+        {
+        }
+    }
+
+    return execute(set_control, break_off);
+}
+
+bool ComRfc2217::SetDtr(bool state)
+{
+    return execute(set_control, state ? dtr_on : dtr_off);
+}
+
+bool ComRfc2217::SetRts(bool state)
+{
+    return execute(set_control, state ? rts_on : rts_off);
+}
+
+int ComRfc2217::GetModemStatus()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_modem_status;
+}
+
+/////////////////////
+// Private Methods //
+/////////////////////
+
+void ComRfc2217::stop()
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        if (!m_running)
+            return;
+    }
+
+    m_link->StopStreaming();
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_running = false;
+    m_rx_cond.notify_all();
+}
+
+size_t ComRfc2217::take(void *buffer_in, size_t len)
+{
+    size_t count = std::min(len, m_rx.size());
+
+    if (count == 0)
+        return 0;
+
+    std::copy(m_rx.begin(), m_rx.begin() + count, static_cast<unsigned char *>(buffer_in));
+    m_rx.erase(m_rx.begin(), m_rx.begin() + count);
+
+    // A failed link stays readable, so that its closure is seen
+    if (m_rx.empty() && !m_failed)
+        m_readable.Clear();
+
+    return count;
+}
+
+bool ComRfc2217::send(const std::vector<unsigned char>& bytes)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> write_lock(m_write_mutex);
+
+    if (bytes.empty())
+        return true;
+
+    return m_link->Write(&bytes[0], bytes.size()) == static_cast<int>(bytes.size());
+}
+
+bool ComRfc2217::request(const unsigned char *commands, const boost::uint32_t *values, size_t count)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> request_lock(m_request_mutex);
+
+    std::vector<unsigned char> bytes;
+    unsigned int acks[num_commands];
+    unsigned int abort;
+
+    for (size_t i = 0; i < count; ++i)
+        append_command(bytes, commands[i], values[i]);
+
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        std::copy(m_acks, m_acks + num_commands, acks);
+        abort = m_abort;
+    }
+
+    if (!send(bytes))
+        return false;
+
+    // Lock for thread safe
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+
+    ComClock::time_point deadline = m_clock->Now() + boost::chrono::milliseconds(m_read_timeout);
+
+    while (true)
+    {
+        size_t acknowledged = 0;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (m_acks[commands[i]] != acks[commands[i]])
+                ++acknowledged;
+        }
+
+        if (acknowledged == count)
+            return true;
+
+        if (m_failed || !m_running || abort != m_abort ||
+            m_clock->WaitUntil(m_rx_cond, lock, deadline) == boost::cv_status::timeout)
+            return false;
+    }
+}
+
+bool ComRfc2217::configure(unsigned char command, boost::uint32_t value)
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        // The configuration is sent when the link is opened
+        if (!m_running || m_failed)
+        {
+            m_config[command] = value;
+            return true;
+        }
+    }
+
+    if (!request(&command, &value, 1))
+        return false;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_config[command] = m_ack_values[command];
+
+    return m_config[command] == value;
+}
+
+bool ComRfc2217::execute(unsigned char command, boost::uint32_t value)
+{
+    if (!request(&command, &value, 1))
+        return false;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_ack_values[command] == value;
+}
+
+void ComRfc2217::receive_handler(const ComBuffer& buffer)
+{
+    std::vector<unsigned char> replies;
+
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        m_data.clear();
+        m_subnegotiations.clear();
+
+        m_telnet.Parse(buffer.Data(), buffer.Size(), m_data, replies, m_subnegotiations);
+
+        if (!m_data.empty())
+        {
+            m_rx.insert(m_rx.end(), m_data.begin(), m_data.end());
+            m_readable.Set();
+        }
+
+        for (size_t i = 0; i < m_subnegotiations.size(); ++i)
+        {
+            const std::vector<unsigned char>& parameters = m_subnegotiations[i];
+
+            if (parameters[0] != option_comport || parameters.size() < 2 ||
+                parameters[1] < server_offset || parameters[1] >= server_offset + num_commands)
+                continue;
+
+            unsigned char command = parameters[1] - server_offset;
+
+            // The state of the lines comes with the changes since the last notification
+            if (command == notify_modemstate)
+            {
+                m_modem_status = command_value(parameters) &
+                                 (ComSerial::modem_cts | ComSerial::modem_dsr |
+                                  ComSerial::modem_ri | ComSerial::modem_cd);
+                continue;
+            }
+
+            m_ack_values[command] = command_value(parameters);
+            ++m_acks[command];
+        }
+
+        m_rx_cond.notify_all();
+    }
+
+    send(replies);
+}
+
+void ComRfc2217::failure_handler()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_failed = true;
+    m_readable.Set();
+
+    m_rx_cond.notify_all();
+}
+
+//////////////////////
+// ComRfc2217Server //
+//////////////////////
+
+ComRfc2217Server::ComRfc2217Server(ComSerial *serial, ComInterface *link) :
+    m_serial(serial), m_link(link), m_dtr(true), m_rts(true), m_modem_mask(0xFF),
+    m_modem_status(-1), m_running(false), m_failed(false)
+{
+    if (!m_serial)
+        throw std::invalid_argument("invalid serial port");
+
+    if (!m_link)
+        throw std::invalid_argument("invalid link");
+
+    m_telnet.Support(option_binary, true, true);
+    m_telnet.Support(option_sga, true, true);
+    m_telnet.Support(option_comport, false, true);
+}
+
+ComRfc2217Server::~ComRfc2217Server()
+{
+    Stop();
+}
+
+bool ComRfc2217Server::Start()
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        if (m_running && !m_failed)
+            return true;
+    }
+
+    Stop();
+
+    if (!m_serial->Opened() && !m_serial->Open())
+        return false;
+
+    if (!m_link->Opened() && !m_link->Open())
+        return false;
+
+    std::vector<unsigned char> negotiation;
+
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        m_telnet.Reset();
+        m_modem_mask = 0xFF;
+        m_modem_status = -1;
+        m_failed = false;
+        m_readable.Clear();
+
+        m_telnet.Request(option_comport, false, negotiation);
+        m_telnet.Request(option_binary, true, negotiation);
+        m_telnet.Request(option_binary, false, negotiation);
+        m_telnet.Request(option_sga, true, negotiation);
+        m_telnet.Request(option_sga, false, negotiation);
+
+        m_running = true;
+    }
+
+    ComStreamHandlers serial_handlers;
+    ComStreamHandlers link_handlers;
+
+    serial_handlers.on_data = boost::bind(&ComRfc2217Server::serial_handler, this, _1);
+    serial_handlers.on_error = boost::bind(&ComRfc2217Server::failure_handler, this);
+    serial_handlers.on_closed = boost::bind(&ComRfc2217Server::failure_handler, this);
+
+    link_handlers.on_data = boost::bind(&ComRfc2217Server::link_handler, this, _1);
+    link_handlers.on_error = boost::bind(&ComRfc2217Server::failure_handler, this);
+    link_handlers.on_closed = boost::bind(&ComRfc2217Server::failure_handler, this);
+
+    if (!m_link->StartStreaming(link_handlers) || !m_serial->StartStreaming(serial_handlers) ||
+        !send(&negotiation[0], negotiation.size()))
+    {
+        Stop();
+        return false;
+    }
+
+    m_poller = boost::thread(boost::bind(&ComRfc2217Server::poll, this));
+
+    return true;
+}
+
+void ComRfc2217Server::Stop()
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        if (!m_running)
+            return;
+
+        m_running = false;
+        m_cond.notify_all();
+    }
+
+    if (m_poller.joinable())
+        m_poller.join();
+
+    m_serial->StopStreaming();
+    m_link->StopStreaming();
+}
+
+bool ComRfc2217Server::Running()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_running && !m_failed;
+}
+
+int ComRfc2217Server::GetReadinessHandle()
+{
+    return m_readable.GetHandle();
+}
+
+/////////////////////
+// Private Methods //
+/////////////////////
+
+bool ComRfc2217Server::send(const unsigned char *bytes, size_t len)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> write_lock(m_write_mutex);
+
+    return m_link->Write(bytes, len) == static_cast<int>(len);
+}
+
+void ComRfc2217Server::execute(const std::vector<unsigned char>& parameters,
+                               std::vector<unsigned char>& replies)
+{
+    unsigned char command = parameters[1];
+    boost::uint32_t value = command_value(parameters);
+    boost::uint32_t answer;
+    char setting;
+
+    switch (command)
+    {
+    case signature:
+        // An empty signature requests ours, the one of the client is ignored
+        if (parameters.size() == 2)
+        {
+            std::vector<unsigned char> text(1, signature + server_offset);
+
+            text.insert(text.end(), server_signature, server_signature + sizeof(server_signature) - 1);
+            ComTelnet::Subnegotiation(option_comport, &text[0], text.size(), replies);
+        }
+
+        return;
+
+    case set_baudrate:
+        // The value 0 queries the current one
+        if (value != 0)
+            m_serial->SetBaudRate(value);
+
+        answer = m_serial->GetBaudRate();
+        break;
+
+    case set_datasize:
+        if (value != 0)
+            m_serial->SetDataBits(value);
+
+        answer = m_serial->GetDataBits();
+        break;
+
+    case set_parity:
+        if (value >= parity_none && value <= parity_even)
+            m_serial->SetParity("noe"[value - parity_none]);
+
+        setting = m_serial->GetParity();
+        answer = setting == 'o' ? parity_odd : (setting == 'e' ? parity_even : parity_none);
+        break;
+
+    case set_stopsize:
+        if (value >= 1 && value <= 3)
+            m_serial->SetStopBits(value);
+
+        answer = m_serial->GetStopBits();
+        break;
+
+    case set_control:
+        if (value >= flow_none && value <= flow_hardware)
+            m_serial->SetFlowControl("nsh"[value - flow_none]);
+        else if (value == break_on)
+            m_serial->SendBreak();
+        else if ((value == dtr_on || value == dtr_off) && m_serial->SetDtr(value == dtr_on))
+            m_dtr = value == dtr_on;
+        else if ((value == rts_on || value == rts_off) && m_serial->SetRts(value == rts_on))
+            m_rts = value == rts_on;
+
+        // The break is sent at once, so it is over when the off command arrives
+        if (value >= break_query && value <= break_off)
+        {
+            answer = value == break_on ? break_on : break_off;
+        }
+        else if (value >= dtr_query && value <= dtr_off)
+        {
+            answer = m_dtr ? dtr_on : dtr_off;
+        }
+        else if (value >= rts_query && value <= rts_off)
+        {
+            answer = m_rts ? rts_on : rts_off;
+        }
+        else if (value >= inbound_query)
+        {
+            answer = inbound_none;
+        }
+        else
+        {
+            setting = m_serial->GetFlowControl();
+            answer = setting == 'h' ? flow_hardware : (setting == 's' ? flow_software : flow_none);
+        }
+
+        break;
+
+    case set_linestate_mask:
+        // The line state is not notified
+        answer = value;
+        break;
+
+    case set_modemstate_mask:
+        m_modem_mask = static_cast<unsigned char>(value);
+        answer = value;
+        break;
+
+    case purge_data:
+        // Both buffers are purged
+        m_serial->Flush();
+        answer = value;
+        break;
+
+    default:
+        // The suspensions of the flow and the notifications are not expected
+        return;
+    }
+
+    append_command(replies, command + server_offset, answer);
+}
+
+void ComRfc2217Server::notify_modem(int status, std::vector<unsigned char>& replies)
+{
+    if (status == m_modem_status)
+        return;
+
+    int changes = m_modem_status < 0 ? 0 : status ^ m_modem_status;
+    int value = status;
+
+    // The low bits are the changes of the lines, and the end of a ring
+    if (changes & ComSerial::modem_cts)
+        value |= 0x01;
+
+    if (changes & ComSerial::modem_dsr)
+        value |= 0x02;
+
+    if ((changes & ComSerial::modem_ri) && !(status & ComSerial::modem_ri))
+        value |= 0x04;
+
+    if (changes & ComSerial::modem_cd)
+        value |= 0x08;
+
+    m_modem_status = status;
+
+    if (value & m_modem_mask)
+        append_command(replies, notify_modemstate + server_offset, value & m_modem_mask);
+}
+
+void ComRfc2217Server::serial_handler(const ComBuffer& buffer)
+{
+    const unsigned char *data = buffer.Data();
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> write_lock(m_write_mutex);
+
+    // Without IAC bytes, the data is written without copying it
+    if (std::memchr(data, ComTelnet::iac, buffer.Size()) == NULL)
+    {
+        m_link->Write(data, buffer.Size());
+        return;
+    }
+
+    m_escaped.clear();
+    ComTelnet::Escape(data, buffer.Size(), m_escaped);
+
+    m_link->Write(&m_escaped[0], m_escaped.size());
+}
+
+void ComRfc2217Server::link_handler(const ComBuffer& buffer)
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        m_data.clear();
+        m_replies.clear();
+        m_subnegotiations.clear();
+
+        m_telnet.Parse(buffer.Data(), buffer.Size(), m_data, m_replies, m_subnegotiations);
+
+        for (size_t i = 0; i < m_subnegotiations.size(); ++i)
+        {
+            if (m_subnegotiations[i][0] == option_comport && m_subnegotiations[i].size() >= 2)
+                execute(m_subnegotiations[i], m_replies);
+        }
+    }
+
+    // The buffers are only used by the I/O thread of the link
+    if (!m_replies.empty())
+        send(&m_replies[0], m_replies.size());
+
+    if (!m_data.empty())
+        m_serial->Write(&m_data[0], m_data.size());
+}
+
+void ComRfc2217Server::failure_handler()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_failed = true;
+    m_readable.Set();
+}
+
+void ComRfc2217Server::poll()
+{
+    std::vector<unsigned char> notification;
+
+    // Lock for thread safe
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+
+    while (m_running)
+    {
+        lock.unlock();
+
+        int status = m_serial->GetModemStatus();
+
+        lock.lock();
+
+        // The lines are notified once the client accepts the option
+        if (status >= 0 && m_running && m_telnet.Enabled(option_comport, false))
+        {
+            notification.clear();
+            notify_modem(status, notification);
+
+            if (!notification.empty())
+            {
+                lock.unlock();
+                send(&notification[0], notification.size());
+                lock.lock();
+            }
+        }
+
+        if (m_running)
+            m_cond.wait_for(lock, boost::chrono::milliseconds(poll_interval));
+    }
+}
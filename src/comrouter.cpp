@@ -0,0 +1,317 @@
+/**
+ * @file    comrouter.cpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Routing of frames to handlers by the fields of their header implementation.
+ */
+
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+
+#include "cominterface/comrouter.hpp"
+
+/**
+ * @brief State of the automaton while it is compiled: the number of header
+ * bytes examined and the rules that still match.
+ */
+typedef std::pair<size_t, std::vector<unsigned int> > RouteState;
+
+/**
+ * @brief Get the state of the automaton for a set of rules, creating it if
+ * it doesn't exist.
+ * @param states Identifier of each state.
+ * @param pending States created and not expanded yet.
+ * @param state State.
+ * @return Identifier of the state.
+ */
+static unsigned int get_state(std::map<RouteState, unsigned int>& states,
+                              std::vector<RouteState>& pending, const RouteState& state)
+{
+    std::map<RouteState, unsigned int>::iterator it = states.find(state);
+
+    if (it != states.end())
+        return it->second;
+
+    // The state 0 is the state that matches nothing
+    unsigned int id = static_cast<unsigned int>(pending.size());
+
+    states.insert(std::make_pair(state, id));
+    pending.push_back(state);
+
+    return id;
+}
+
+//////////////////
+// ComRouteRule //
+//////////////////
+
+ComRouteRule& ComRouteRule::Match(size_t offset, unsigned char value, unsigned char mask)
+{
+    if (offset >= m_values.size())
+    {
+        m_values.resize(offset + 1, 0);
+        m_masks.resize(offset + 1, 0);
+    }
+
+    // The bits of previous matches of the byte that are not masked are kept
+    m_values[offset] = (m_values[offset] & ~mask) | (value & mask);
+    m_masks[offset] |= mask;
+
+    return *this;
+}
+
+ComRouteRule& ComRouteRule::MatchField(size_t offset, size_t size, unsigned int value)
+{
+    if (size == 0 || size > 4)
+        throw std::invalid_argument("invalid field size");
+
+    for (size_t i = 0; i < size; ++i)
+        Match(offset + i, static_cast<unsigned char>(value >> (8 * (size - 1 - i))));
+
+    return *this;
+}
+
+///////////////
+// ComRouter //
+///////////////
+
+ComRouter::ComRouter() : m_next_id(0)
+{
+
+}
+
+int ComRouter::Add(const ComRouteRule& rule, const Handler& handler)
+{
+    if (!handler)
+        return -1;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    int id = m_next_id++;
+    Entry& entry = m_rules[id];
+
+    entry.rule = rule;
+    entry.handler = handler;
+    m_table.reset();
+
+    return id;
+}
+
+bool ComRouter::Remove(int id)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    if (m_rules.erase(id) == 0)
+        return false;
+
+    m_table.reset();
+
+    return true;
+}
+
+void ComRouter::Clear()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_rules.clear();
+    m_table.reset();
+}
+
+size_t ComRouter::Compile()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return table()->first.size() - 1;
+}
+
+size_t ComRouter::Route(ComInterface *source, const ComBuffer& frame)
+{
+    return Route(source, frame.Data(), frame.Size(), frame);
+}
+
+size_t ComRouter::Route(ComInterface *source, const unsigned char *data, size_t size,
+                        const ComBuffer& frame)
+{
+    TablePtr table;
+
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        table = this->table();
+    }
+
+    // The handlers are called without locking the router, so they can
+    // change the rules
+    size_t length = std::min(size, table->depth);
+    const unsigned int *next = &table->next[0];
+    unsigned int state = 1;
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        state = next[(state << 8) | data[i]];
+
+        if (state == 0)
+            return 0;
+    }
+
+    unsigned int begin = table->first[state];
+    unsigned int end = table->first[state + 1];
+
+    for (unsigned int i = begin; i < end; ++i)
+        table->handlers[table->matched[i]](source, frame);
+
+    return end - begin;
+}
+
+size_t ComRouter::GetRules()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return m_rules.size();
+}
+
+/////////////////////
+// Private Methods //
+/////////////////////
+
+ComRouter::TablePtr ComRouter::table()
+{
+    if (m_table)
+        return m_table;
+
+    boost::shared_ptr<Table> table(new Table());
+    std::vector<const ComRouteRule *> rules;
+
+    table->depth = 0;
+
+    for (std::map<int, Entry>::iterator it = m_rules.begin(); it != m_rules.end(); ++it)
+    {
+        rules.push_back(&it->second.rule);
+        table->handlers.push_back(it->second.handler);
+        table->depth = std::max(table->depth, it->second.rule.Size());
+    }
+
+    // Group the byte values that all the rules treat in the same way at
+    // each offset, so each state is expanded once per group of values
+    std::vector<unsigned int> classes(table->depth << 8, 0);
+    std::vector<std::vector<unsigned char> > representatives(table->depth);
+
+    for (size_t depth = 0; depth < table->depth; ++depth)
+    {
+        unsigned int *current = &classes[depth << 8];
+        std::set<std::pair<unsigned char, unsigned char> > tests;
+
+        for (size_t i = 0; i < rules.size(); ++i)
+        {
+            if (depth < rules[i]->Size() && rules[i]->m_masks[depth] != 0)
+                tests.insert(std::make_pair(rules[i]->m_masks[depth], rules[i]->m_values[depth]));
+        }
+
+        for (std::set<std::pair<unsigned char, unsigned char> >::iterator it = tests.begin();
+             it != tests.end() && representatives[depth].size() < 256; ++it)
+        {
+            std::map<std::pair<unsigned int, bool>, unsigned int> split;
+
+            representatives[depth].clear();
+
+            for (unsigned int value = 0; value < 256; ++value)
+            {
+                std::pair<unsigned int, bool> key(current[value], (value & it->first) == it->second);
+                std::map<std::pair<unsigned int, bool>, unsigned int>::iterator found = split.find(key);
+
+                if (found == split.end())
+                {
+                    found = split.insert(std::make_pair(key, static_cast<unsigned int>(split.size()))).first;
+                    representatives[depth].push_back(static_cast<unsigned char>(value));
+                }
+
+                current[value] = found->second;
+            }
+        }
+
+        if (representatives[depth].empty())
+            representatives[depth].push_back(0);
+    }
+
+    // Subset construction: each state is the set of rules that match the
+    // bytes examined until it, so the same state is reached by all the
+    // headers that match the same rules
+    std::map<RouteState, unsigned int> states;
+    std::vector<RouteState> pending;
+    std::vector<std::vector<unsigned int> > targets(256);
+    std::vector<unsigned int> target_states(256);
+
+    pending.push_back(RouteState());
+    pending.push_back(RouteState());
+
+    for (unsigned int i = 0; i < rules.size(); ++i)
+        pending[1].second.push_back(i);
+
+    states.insert(std::make_pair(pending[1], 1u));
+    table->first.push_back(0);
+
+    for (size_t id = 0; id < pending.size(); ++id)
+    {
+        size_t depth = pending[id].first;
+        std::vector<unsigned int> current = pending[id].second;
+
+        table->next.resize((id + 1) << 8, 0);
+
+        // The rules that don't need more bytes match the frames that end here
+        for (size_t i = 0; i < current.size(); ++i)
+        {
+            if (rules[current[i]]->Size() <= depth)
+                table->matched.push_back(current[i]);
+        }
+
+        table->first.push_back(static_cast<unsigned int>(table->matched.size()));
+
+        if (id == 0 || depth == table->depth)
+            continue;
+
+        const unsigned int *value_classes = &classes[depth << 8];
+        const std::vector<unsigned char>& values = representatives[depth];
+
+        for (size_t i = 0; i < values.size(); ++i)
+            targets[i].clear();
+
+        // Distribute the rules by the groups of values that they accept in this byte
+        for (size_t i = 0; i < current.size(); ++i)
+        {
+            const ComRouteRule& rule = *rules[current[i]];
+            unsigned char mask = depth < rule.Size() ? rule.m_masks[depth] : 0;
+            unsigned char expected = depth < rule.Size() ? rule.m_values[depth] : 0;
+
+            if (mask == 0xFF)
+                targets[value_classes[expected]].push_back(current[i]);
+            else
+            {
+                for (size_t j = 0; j < values.size(); ++j)
+                {
+                    if ((values[j] & mask) == expected)
+                        targets[j].push_back(current[i]);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            target_states[i] = targets[i].empty() ? 0 :
+                               get_state(states, pending, RouteState(depth + 1, targets[i]));
+        }
+
+        for (size_t value = 0; value < 256; ++value)
+            table->next[(id << 8) | value] = target_states[value_classes[value]];
+    }
+
+    m_table = table;
+
+    return m_table;
+}
@@ -0,0 +1,651 @@
+/**
+ * @file    comsamples.cpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Decoding of streams of binary samples implementation.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <boost/atomic.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+#include "cominterface/comsamples.hpp"
+
+// The SIMD kernels are compiled for their instruction sets with function
+// attributes, and selected at run time
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COMSAMPLES_X86
+#include <immintrin.h>
+#endif
+
+const size_t ComSampleDecoder::max_channels;
+
+// Samples converted at a time, so the block stays in the L1 cache
+static const size_t block_samples = 2048;
+
+// Convert samples of bytes bytes to sign-extended integers
+typedef void (*ConvertKernel)(const unsigned char *src, size_t samples, unsigned int bytes,
+                              ComByteOrder order, boost::int32_t *dst);
+
+// Convert integer samples to floats
+typedef void (*FloatKernel)(const boost::int32_t *src, size_t samples, float scale, float *dst);
+
+// Deinterleave integer frames to an array per channel
+typedef void (*DeinterleaveKernel)(const boost::int32_t *src, size_t frames, size_t channels,
+                                   boost::int32_t *const *dst);
+
+static void convert_scalar(const unsigned char *src, size_t samples, unsigned int bytes,
+                           ComByteOrder order, boost::int32_t *dst)
+{
+    const unsigned int shift = 32 - 8 * bytes;
+
+    for (size_t i = 0; i < samples; ++i, src += bytes)
+    {
+        boost::uint32_t value = 0;
+
+        if (order == com_little_endian)
+        {
+            for (unsigned int j = bytes; j-- > 0; )
+                value = (value << 8) | src[j];
+        }
+        else
+        {
+            for (unsigned int j = 0; j < bytes; ++j)
+                value = (value << 8) | src[j];
+        }
+
+        // The sign is extended by moving the sample to the top of the word
+        dst[i] = static_cast<boost::int32_t>(value << shift) >> shift;
+    }
+}
+
+static void to_float_scalar(const boost::int32_t *src, size_t samples, float scale, float *dst)
+{
+    for (size_t i = 0; i < samples; ++i)
+        dst[i] = src[i] * scale;
+}
+
+// Deinterleave the frames from the first one, with a strided loop per channel
+static void deinterleave_frames(const boost::int32_t *src, size_t first, size_t frames,
+                                size_t channels, boost::int32_t *const *dst)
+{
+    for (size_t channel = 0; channel < channels; ++channel)
+    {
+        const boost::int32_t *sample = src + first * channels + channel;
+        boost::int32_t *out = dst[channel];
+
+        for (size_t i = first; i < frames; ++i, sample += channels)
+            out[i] = *sample;
+    }
+}
+
+static void deinterleave_scalar(const boost::int32_t *src, size_t frames, size_t channels,
+                                boost::int32_t *const *dst)
+{
+    deinterleave_frames(src, 0, frames, channels, dst);
+}
+
+#ifdef COMSAMPLES_X86
+
+// The bytes of each sample are shuffled to the top of a 32 bit lane, in the
+// native order, and shifted down with their sign
+__attribute__((target("ssse3")))
+static void convert_ssse3(const unsigned char *src, size_t samples, unsigned int bytes,
+                          ComByteOrder order, boost::int32_t *dst)
+{
+    const bool little = order == com_little_endian;
+    const size_t len = samples * bytes;
+    size_t i = 0;
+
+    if (bytes == 2)
+    {
+        const __m128i low = little ?
+            _mm_setr_epi8(-1, -1, 0, 1, -1, -1, 2, 3, -1, -1, 4, 5, -1, -1, 6, 7) :
+            _mm_setr_epi8(-1, -1, 1, 0, -1, -1, 3, 2, -1, -1, 5, 4, -1, -1, 7, 6);
+        const __m128i high = little ?
+            _mm_setr_epi8(-1, -1, 8, 9, -1, -1, 10, 11, -1, -1, 12, 13, -1, -1, 14, 15) :
+            _mm_setr_epi8(-1, -1, 9, 8, -1, -1, 11, 10, -1, -1, 13, 12, -1, -1, 15, 14);
+
+        for (; i + 8 <= samples; i += 8)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                             _mm_srai_epi32(_mm_shuffle_epi8(x, low), 16));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 4),
+                             _mm_srai_epi32(_mm_shuffle_epi8(x, high), 16));
+        }
+    }
+    else if (bytes == 3)
+    {
+        const __m128i mask = little ?
+            _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11) :
+            _mm_setr_epi8(-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9);
+
+        // 16 bytes are loaded for each 4 samples of 12 bytes
+        for (; 3 * i + 16 <= len; i += 4)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 3 * i));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                             _mm_srai_epi32(_mm_shuffle_epi8(x, mask), 8));
+        }
+    }
+    else
+    {
+        const __m128i mask = little ?
+            _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15) :
+            _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+        for (; i + 4 <= samples; i += 4)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 4 * i));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_shuffle_epi8(x, mask));
+        }
+    }
+
+    convert_scalar(src + i * bytes, samples - i, bytes, order, dst + i);
+}
+
+__attribute__((target("ssse3")))
+static void to_float_ssse3(const boost::int32_t *src, size_t samples, float scale, float *dst)
+{
+    const __m128 factor = _mm_set1_ps(scale);
+    size_t i = 0;
+
+    for (; i + 4 <= samples; i += 4)
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(x), factor));
+    }
+
+    to_float_scalar(src + i, samples - i, scale, dst + i);
+}
+
+// Transpose 4 frames of 4 channels, stored from a frame of each array
+__attribute__((target("ssse3")))
+static inline void transpose_4x4(__m128i r0, __m128i r1, __m128i r2, __m128i r3,
+                                 boost::int32_t *const *dst, size_t i)
+{
+    __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+    __m128i t1 = _mm_unpackhi_epi32(r0, r1);
+    __m128i t2 = _mm_unpacklo_epi32(r2, r3);
+    __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst[0] + i), _mm_unpacklo_epi64(t0, t2));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst[1] + i), _mm_unpackhi_epi64(t0, t2));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst[2] + i), _mm_unpacklo_epi64(t1, t3));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst[3] + i), _mm_unpackhi_epi64(t1, t3));
+}
+
+// The common numbers of channels are deinterleaved 4 frames at a time,
+// transposing blocks of 4 frames of 4 channels
+__attribute__((target("ssse3")))
+static void deinterleave_ssse3(const boost::int32_t *src, size_t frames, size_t channels,
+                               boost::int32_t *const *dst)
+{
+    const __m128i *in = reinterpret_cast<const __m128i *>(src);
+    size_t i = 0;
+
+    if (channels == 2)
+    {
+        for (; i + 4 <= frames; i += 4, in += 2)
+        {
+            __m128 a = _mm_castsi128_ps(_mm_loadu_si128(in));
+            __m128 b = _mm_castsi128_ps(_mm_loadu_si128(in + 1));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst[0] + i),
+                             _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst[1] + i),
+                             _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+        }
+    }
+    else if (channels == 4)
+    {
+        for (; i + 4 <= frames; i += 4, in += 4)
+        {
+            transpose_4x4(_mm_loadu_si128(in), _mm_loadu_si128(in + 1),
+                          _mm_loadu_si128(in + 2), _mm_loadu_si128(in + 3), dst, i);
+        }
+    }
+    else if (channels == 8)
+    {
+        for (; i + 4 <= frames; i += 4, in += 8)
+        {
+            transpose_4x4(_mm_loadu_si128(in), _mm_loadu_si128(in + 2),
+                          _mm_loadu_si128(in + 4), _mm_loadu_si128(in + 6), dst, i);
+            transpose_4x4(_mm_loadu_si128(in + 1), _mm_loadu_si128(in + 3),
+                          _mm_loadu_si128(in + 5), _mm_loadu_si128(in + 7), dst + 4, i);
+        }
+    }
+
+    deinterleave_frames(src, i, frames, channels, dst);
+}
+
+// The 16 bit samples are sign-extended by the processor, and the 24 bit
+// samples are split between the two halves of the register, whose bytes
+// are shuffled separately
+__attribute__((target("avx2")))
+static void convert_avx2(const unsigned char *src, size_t samples, unsigned int bytes,
+                         ComByteOrder order, boost::int32_t *dst)
+{
+    const bool little = order == com_little_endian;
+    const size_t len = samples * bytes;
+    size_t i = 0;
+
+    if (bytes == 2)
+    {
+        const __m128i swap = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+
+        for (; i + 8 <= samples; i += 8)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i));
+
+            if (!little)
+                x = _mm_shuffle_epi8(x, swap);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_cvtepi16_epi32(x));
+        }
+    }
+    else if (bytes == 3)
+    {
+        const __m256i halves = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+        const __m256i mask = little ?
+            _mm256_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+                             -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11) :
+            _mm256_setr_epi8(-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9,
+                             -1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9);
+
+        // 32 bytes are loaded for each 8 samples of 24 bytes
+        for (; 3 * i + 32 <= len; i += 8)
+        {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 3 * i));
+
+            x = _mm256_permutevar8x32_epi32(x, halves);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i),
+                                _mm256_srai_epi32(_mm256_shuffle_epi8(x, mask), 8));
+        }
+    }
+    else
+    {
+        const __m256i swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                              3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+        for (; i + 8 <= samples; i += 8)
+        {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 4 * i));
+
+            if (!little)
+                x = _mm256_shuffle_epi8(x, swap);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), x);
+        }
+    }
+
+    convert_scalar(src + i * bytes, samples - i, bytes, order, dst + i);
+}
+
+__attribute__((target("avx2")))
+static void to_float_avx2(const boost::int32_t *src, size_t samples, float scale, float *dst)
+{
+    const __m256 factor = _mm256_set1_ps(scale);
+    size_t i = 0;
+
+    for (; i + 8 <= samples; i += 8)
+    {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), factor));
+    }
+
+    to_float_scalar(src + i, samples - i, scale, dst + i);
+}
+
+// The common numbers of channels are deinterleaved 8 frames at a time. The
+// 4 and 8 channels are transposed inside each half of the registers, and
+// the halves are put in order at the end
+__attribute__((target("avx2")))
+static void deinterleave_avx2(const boost::int32_t *src, size_t frames, size_t channels,
+                              boost::int32_t *const *dst)
+{
+    const __m256i *in = reinterpret_cast<const __m256i *>(src);
+    size_t i = 0;
+
+    if (channels == 2)
+    {
+        const __m256i split = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+
+        for (; i + 8 <= frames; i += 8, in += 2)
+        {
+            __m256i a = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(in), split);
+            __m256i b = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(in + 1), split);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst[0] + i), _mm256_permute2x128_si256(a, b, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst[1] + i), _mm256_permute2x128_si256(a, b, 0x31));
+        }
+    }
+    else if (channels == 4)
+    {
+        // Each register has 2 frames, so the channels come out with the
+        // even frames in the low half and the odd ones in the high half
+        const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+        for (; i + 8 <= frames; i += 8, in += 4)
+        {
+            __m256i r0 = _mm256_loadu_si256(in);
+            __m256i r1 = _mm256_loadu_si256(in + 1);
+            __m256i r2 = _mm256_loadu_si256(in + 2);
+            __m256i r3 = _mm256_loadu_si256(in + 3);
+            __m256i t0 = _mm256_unpacklo_epi32(r0, r1);
+            __m256i t1 = _mm256_unpackhi_epi32(r0, r1);
+            __m256i t2 = _mm256_unpacklo_epi32(r2, r3);
+            __m256i t3 = _mm256_unpackhi_epi32(r2, r3);
+            __m256i c[4] =
+            {
+                _mm256_unpacklo_epi64(t0, t2), _mm256_unpackhi_epi64(t0, t2),
+                _mm256_unpacklo_epi64(t1, t3), _mm256_unpackhi_epi64(t1, t3)
+            };
+
+            for (size_t channel = 0; channel < 4; ++channel)
+            {
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst[channel] + i),
+                                    _mm256_permutevar8x32_epi32(c[channel], order));
+            }
+        }
+    }
+    else if (channels == 8)
+    {
+        for (; i + 8 <= frames; i += 8, in += 8)
+        {
+            __m256i t[8];
+            __m256i s[8];
+
+            for (size_t j = 0; j < 8; j += 2)
+            {
+                __m256i r0 = _mm256_loadu_si256(in + j);
+                __m256i r1 = _mm256_loadu_si256(in + j + 1);
+
+                t[j] = _mm256_unpacklo_epi32(r0, r1);
+                t[j + 1] = _mm256_unpackhi_epi32(r0, r1);
+            }
+
+            // Channels 0 to 3 of frames 0 to 3 and 4 to 7 in the low halves,
+            // and channels 4 to 7 in the high halves
+            for (size_t j = 0; j < 8; j += 4)
+            {
+                s[j] = _mm256_unpacklo_epi64(t[j], t[j + 2]);
+                s[j + 1] = _mm256_unpackhi_epi64(t[j], t[j + 2]);
+                s[j + 2] = _mm256_unpacklo_epi64(t[j + 1], t[j + 3]);
+                s[j + 3] = _mm256_unpackhi_epi64(t[j + 1], t[j + 3]);
+            }
+
+            for (size_t channel = 0; channel < 4; ++channel)
+            {
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst[channel] + i),
+                                    _mm256_permute2x128_si256(s[channel], s[channel + 4], 0x20));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst[channel + 4] + i),
+                                    _mm256_permute2x128_si256(s[channel], s[channel + 4], 0x31));
+            }
+        }
+    }
+
+    deinterleave_frames(src, i, frames, channels, dst);
+}
+
+#endif
+
+// Check if the processor supports a kernel
+static bool supported(const std::string& kernel)
+{
+    if (kernel == "scalar")
+        return true;
+
+#ifdef COMSAMPLES_X86
+    __builtin_cpu_init();
+
+    if (kernel == "ssse3")
+        return __builtin_cpu_supports("ssse3");
+
+    if (kernel == "avx2")
+        return __builtin_cpu_supports("avx2");
+#endif
+
+    return false;
+}
+
+/**
+ * @brief Implementation of the sample conversions.
+ */
+struct SampleKernel
+{
+    const char *name;           ///< Name of the kernel.
+    ConvertKernel convert;      ///< Function that converts the samples to integers.
+    FloatKernel to_float;       ///< Function that converts the integers to floats.
+    DeinterleaveKernel deinterleave;    ///< Function that deinterleaves the integer frames.
+};
+
+// Kernels, from the slowest to the fastest
+static const SampleKernel kernels[] =
+{
+    {"scalar", convert_scalar, to_float_scalar, deinterleave_scalar},
+#ifdef COMSAMPLES_X86
+    {"ssse3", convert_ssse3, to_float_ssse3, deinterleave_ssse3},
+    {"avx2", convert_avx2, to_float_avx2, deinterleave_avx2},
+#endif
+};
+
+static const size_t num_kernels = sizeof(kernels) / sizeof(kernels[0]);
+
+// Kernel in use. It is atomic, so it can be changed while other threads decode
+static boost::atomic<const SampleKernel *> kernel(&kernels[0]);
+
+// Find a kernel by its name
+static const SampleKernel *find_kernel(const std::string& name)
+{
+    for (size_t i = 0; i < num_kernels; ++i)
+    {
+        if (name == kernels[i].name)
+            return &kernels[i];
+    }
+
+    return NULL;
+}
+
+// The fastest kernel supported by the processor is selected before the
+// first ComSampleDecoder is used
+static struct SampleKernelSelector
+{
+    SampleKernelSelector()
+    {
+        for (size_t i = num_kernels; i-- > 0; )
+        {
+            if (supported(kernels[i].name))
+            {
+                kernel.store(&kernels[i], boost::memory_order_release);
+                break;
+            }
+        }
+    }
+} kernel_selector;
+
+ComSampleDecoder::ComSampleDecoder(unsigned int bits, ComByteOrder order, size_t channels) :
+    m_bytes(bits / 8), m_order(order), m_channels(channels), m_partial_size(0)
+{
+    if (bits != 16 && bits != 24 && bits != 32)
+        throw std::invalid_argument("invalid sample bits");
+
+    if (channels == 0 || channels > max_channels)
+        throw std::invalid_argument("invalid number of channels");
+
+    m_scale = 1.0f / static_cast<float>(1UL << (bits - 1));
+}
+
+////////////////////
+// Public Methods //
+////////////////////
+
+size_t ComSampleDecoder::GetFrameSize() const
+{
+    return m_bytes * m_channels;
+}
+
+size_t ComSampleDecoder::GetChannels() const
+{
+    return m_channels;
+}
+
+void ComSampleDecoder::Decode(const void *data, size_t frames, float *const *channels) const
+{
+    decode(static_cast<const unsigned char *>(data), frames, NULL, channels, 0);
+}
+
+void ComSampleDecoder::Decode(const void *data, size_t frames, boost::int32_t *const *channels) const
+{
+    decode(static_cast<const unsigned char *>(data), frames, channels, NULL, 0);
+}
+
+size_t ComSampleDecoder::GetFrameCount(size_t len)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return (m_partial_size + len) / GetFrameSize();
+}
+
+size_t ComSampleDecoder::Push(const void *data, size_t len, float *const *channels)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return push(static_cast<const unsigned char *>(data), len, NULL, channels);
+}
+
+size_t ComSampleDecoder::Push(const void *data, size_t len, boost::int32_t *const *channels)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    return push(static_cast<const unsigned char *>(data), len, channels, NULL);
+}
+
+void ComSampleDecoder::Reset()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    m_partial_size = 0;
+}
+
+std::string ComSampleDecoder::GetKernel()
+{
+    return kernel.load(boost::memory_order_acquire)->name;
+}
+
+bool ComSampleDecoder::SetKernel(const std::string& name)
+{
+    const SampleKernel *selected = find_kernel(name);
+
+    if (!selected || !supported(name))
+        return false;
+
+    kernel.store(selected, boost::memory_order_release);
+
+    return true;
+}
+
+/////////////////////
+// Private Methods //
+/////////////////////
+
+void ComSampleDecoder::decode(const unsigned char *data, size_t frames, boost::int32_t *const *ints,
+                              float *const *floats, size_t offset) const
+{
+    boost::int32_t block[block_samples];
+    boost::int32_t planar[block_samples];
+    boost::int32_t *planes[max_channels];
+    const size_t block_frames = block_samples / m_channels;
+    const size_t frame_size = GetFrameSize();
+    const SampleKernel *functions = kernel.load(boost::memory_order_acquire);
+
+    for (size_t done = 0; done < frames; )
+    {
+        const size_t count = std::min(block_frames, frames - done);
+        const unsigned char *src = data + done * frame_size;
+
+        // A single channel doesn't need to be deinterleaved, so its
+        // integers are converted straight to its array
+        if (m_channels == 1 && ints)
+        {
+            functions->convert(src, count, m_bytes, m_order, ints[0] + offset + done);
+        }
+        else
+        {
+            functions->convert(src, count * m_channels, m_bytes, m_order, block);
+
+            if (m_channels == 1)
+            {
+                functions->to_float(block, count, m_scale, floats[0] + offset + done);
+            }
+            else
+            {
+                // The integers are deinterleaved to the arrays of the
+                // channels, or to a planar block to convert them to floats
+                for (size_t channel = 0; channel < m_channels; ++channel)
+                    planes[channel] = ints ? ints[channel] + offset + done : planar + channel * count;
+
+                functions->deinterleave(block, count, m_channels, planes);
+
+                if (!ints)
+                {
+                    for (size_t channel = 0; channel < m_channels; ++channel)
+                        functions->to_float(planes[channel], count, m_scale, floats[channel] + offset + done);
+                }
+            }
+        }
+
+        done += count;
+    }
+}
+
+size_t ComSampleDecoder::push(const unsigned char *data, size_t len, boost::int32_t *const *ints,
+                              float *const *floats)
+{
+    const size_t frame_size = GetFrameSize();
+    size_t frames = 0;
+
+    // Complete the frame of the previous chunk
+    if (m_partial_size > 0)
+    {
+        size_t missing = std::min(len, frame_size - m_partial_size);
+
+        std::memcpy(m_partial + m_partial_size, data, missing);
+        m_partial_size += missing;
+        data += missing;
+        len -= missing;
+
+        if (m_partial_size < frame_size)
+            return 0;
+
+        decode(m_partial, 1, ints, floats, 0);
+        m_partial_size = 0;
+        frames = 1;
+    }
+
+    // The whole frames are decoded from the received data, without copying it
+    size_t whole = len / frame_size;
+
+    decode(data, whole, ints, floats, frames);
+    frames += whole;
+
+    // Keep the incomplete frame at the end
+    m_partial_size = len - whole * frame_size;
+    std::memcpy(m_partial, data + whole * frame_size, m_partial_size);
+
+    return frames;
+}
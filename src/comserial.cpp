@@ -11,12 +11,59 @@
 #include <sys/file.h>
 #endif
 
+#include <algorithm>
+#include <climits>
 #include <stdexcept>
 
+#include <boost/asio.hpp>
 #include <boost/bind.hpp>
 #include <boost/chrono.hpp>
+#include <boost/thread.hpp>
 
 #include "cominterface/comserial.hpp"
+#include "cominterface/comtimer.hpp"
+#include "cominterface/handlerallocator.hpp"
+
+/**
+ * @brief Private implementation of the serial port interface, that keeps
+ * boost::asio out of its header.
+ */
+struct ComSerial::Impl
+{
+    Impl() : m_io_service(), m_port(m_io_service), m_timer(m_io_service),
+             m_min_batch(1), m_max_latency(0) {}
+
+    // Control de boost asio
+    boost::asio::io_service m_io_service;               ///< Service for access OS resources.
+    boost::asio::serial_port m_port;                    ///< Serial port handler.
+    ComTimer m_timer;                                   ///< Timeout timer for the asynchronous operations.
+    boost::chrono::milliseconds m_write_timeout;        ///< Time in milliseconds for the transmission timeout timer.
+    boost::chrono::milliseconds m_read_timeout;         ///< Time in milliseconds for the reception timeout timer.
+
+    // Configuracin del puerto serie
+    std::string m_device;                                       ///< Name of the serial port.
+    boost::asio::serial_port_base::baud_rate m_baud_rate;       ///< Baudrate.
+    boost::asio::serial_port_base::character_size m_data_bits;  ///< Number of data bits.
+    boost::asio::serial_port_base::stop_bits m_stop_bits;       ///< Number of stop bits.
+    boost::asio::serial_port_base::parity m_parity;             ///< Parity.
+    boost::asio::serial_port_base::flow_control m_flow_control; ///< Flow control.
+
+    boost::mutex m_mutex;       ///< Mutex to make the interface thread safe.
+
+    // Handlers memory
+    HandlerAllocator m_read_write_allocator;    ///< Recycled memory for the read/write handlers.
+    HandlerAllocator m_timer_allocator;         ///< Recycled memory for the timeout timer handlers.
+
+    // Read coalescing
+    size_t m_min_batch;                                 ///< Number of bytes that ends the wait of ReadBatch.
+    boost::chrono::milliseconds m_max_latency;          ///< Maximum time that received data waits for a batch.
+};
+
+const int ComSerial::modem_cts;
+const int ComSerial::modem_dsr;
+const int ComSerial::modem_ri;
+const int ComSerial::modem_cd;
+const size_t ComSerial::impl_size;
 
 ////////////////////
 // Public Methods //
@@ -25,7 +72,7 @@
 ComSerial::ComSerial(const std::string& device, unsigned int baud_rate,
                      unsigned int data_bits, unsigned int stop_bits,
                      char parity, char flow_control, unsigned int timeout):
-                         m_io_service(), m_port(m_io_service), m_timer(m_io_service)
+                         m_impl()
 {
     if (!SetDevice(device))
         throw std::invalid_argument("invalid device name");
@@ -51,7 +98,8 @@ ComSerial::ComSerial(const std::string& device, unsigned int baud_rate,
 
 ComSerial::~ComSerial()
 {
-
+    // The streaming thread uses the virtual functions of the interface
+    StopStreaming();
 }
 
 bool ComSerial::Open()
@@ -59,14 +107,14 @@ bool ComSerial::Open()
     boost::system::error_code ec;
 
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     // If the serial port is already opened, close it
-    if (m_port.is_open())
-        m_port.close(ec);
+    if (m_impl->m_port.is_open())
+        m_impl->m_port.close(ec);
 
     // Open the serial port
-    m_port.open(m_device, ec);
+    m_impl->m_port.open(m_impl->m_device, ec);
 
     // Error at opening?
     if (ec)
@@ -74,10 +122,10 @@ bool ComSerial::Open()
 
 #if !defined(BOOST_WINDOWS) && !defined(__CYGWIN__)
     // In Linux, it is necessary to set exclusive access to the serial port
-    if (0 != ::ioctl(m_port.lowest_layer().native_handle(), TIOCEXCL) ||
-        0 != ::flock(m_port.lowest_layer().native_handle(), LOCK_EX | LOCK_NB))
+    if (0 != ::ioctl(m_impl->m_port.lowest_layer().native_handle(), TIOCEXCL) ||
+        0 != ::flock(m_impl->m_port.lowest_layer().native_handle(), LOCK_EX | LOCK_NB))
     {
-        m_port.close(ec);
+        m_impl->m_port.close(ec);
         return false;
     }
 #endif
@@ -85,15 +133,15 @@ bool ComSerial::Open()
     // Set the serial port configuration
     try
     {
-        m_port.set_option(m_baud_rate);
-        m_port.set_option(m_data_bits);
-        m_port.set_option(m_stop_bits);
-        m_port.set_option(m_parity);
-        m_port.set_option(m_flow_control);
+        m_impl->m_port.set_option(m_impl->m_baud_rate);
+        m_impl->m_port.set_option(m_impl->m_data_bits);
+        m_impl->m_port.set_option(m_impl->m_stop_bits);
+        m_impl->m_port.set_option(m_impl->m_parity);
+        m_impl->m_port.set_option(m_impl->m_flow_control);
     }
     catch (std::exception &e)
     {
-        m_port.close(ec);
+        m_impl->m_port.close(ec);
         return false;
     }
 
@@ -105,11 +153,11 @@ bool ComSerial::Close()
     boost::system::error_code ec;
 
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     // If the serial port is opened, close it
-    if (m_port.is_open())
-        m_port.close(ec);
+    if (m_impl->m_port.is_open())
+        m_impl->m_port.close(ec);
 
     // Error at closing?
     if (ec)
@@ -121,9 +169,24 @@ bool ComSerial::Close()
 bool ComSerial::Opened()
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
-    return m_port.is_open();
+    return m_impl->m_port.is_open();
+}
+
+int ComSerial::GetNativeHandle()
+{
+#if defined(BOOST_WINDOWS) || defined(__CYGWIN__)
+    return -1;
+#else
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    if (!m_impl->m_port.is_open())
+        return -1;
+
+    return m_impl->m_port.native_handle();
+#endif
 }
 
 int ComSerial::ReadSome(void *buffer_in, size_t len)
@@ -132,7 +195,7 @@ int ComSerial::ReadSome(void *buffer_in, size_t len)
     int ret_code;
 
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     // Get the number of available bytes in the kernel read buffer
     ret_code = available_for_read();
@@ -143,7 +206,7 @@ int ComSerial::ReadSome(void *buffer_in, size_t len)
         return ret_code;
 
     // Make a synchronous read
-    ret_code = m_port.read_some(boost::asio::buffer(buffer_in, len), ec);
+    ret_code = m_impl->m_port.read_some(boost::asio::buffer(buffer_in, len), ec);
 
     if (ec)
         ret_code = -1;
@@ -157,7 +220,7 @@ int ComSerial::WriteSome(const void *buffer_out, size_t len)
     int ret_code;
 
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     // Get the number of remaining bytes in the kernel write buffer
     ret_code = pending_for_write();
@@ -173,7 +236,7 @@ int ComSerial::WriteSome(const void *buffer_out, size_t len)
     }
 
     // Make a synchronous write
-    ret_code = m_port.write_some(boost::asio::buffer(buffer_out, len), ec);
+    ret_code = m_impl->m_port.write_some(boost::asio::buffer(buffer_out, len), ec);
 
     if (ec)
         ret_code = -1;
@@ -187,24 +250,26 @@ int ComSerial::Read(void *buffer_in, size_t len)
     int ret_code;
 
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     // Due to previous cancellation of operations on io_service, it is
     // necessary to reset it
-    m_port.get_io_service().reset();
+    m_impl->m_port.get_io_service().reset();
 
     // Set the timeout for the asynchronous operations
-    m_timer.expires_from_now(m_read_timeout);
-    m_timer.async_wait(boost::bind(&ComSerial::timeout_handler, this,
-                                   boost::asio::placeholders::error));
+    m_impl->m_timer.ExpiresFromNow(m_impl->m_read_timeout);
+    m_impl->m_timer.AsyncWait(make_alloc_handler(m_impl->m_timer_allocator,
+                                         boost::bind(&ComSerial::timeout_handler, this,
+                                                     boost::asio::placeholders::error)));
 
     // Start the asynchronous operation (blocking read)
-    boost::asio::async_read(m_port, boost::asio::buffer(buffer_in, len),
-                            boost::bind(&ComSerial::read_write_handler, this,
-                                        _1, _2, &ret_code));
+    boost::asio::async_read(m_impl->m_port, boost::asio::buffer(buffer_in, len),
+                            make_alloc_handler(m_impl->m_read_write_allocator,
+                                               boost::bind(&ComSerial::read_write_handler, this,
+                                                           _1, _2, &ret_code)));
 
     // Wait until the asynchronous operations are completed
-    m_port.get_io_service().run(ec);
+    m_impl->m_port.get_io_service().run(ec);
 
     if (ec)
         ret_code = -1;
@@ -218,24 +283,96 @@ int ComSerial::Write(const void *buffer_out, size_t len)
     int ret_code;
 
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     // Due to previous cancellation of operations on io_service, it is
     // necessary to reset it
-    m_port.get_io_service().reset();
+    m_impl->m_port.get_io_service().reset();
 
     // Set the timeout for the asynchronous operations
-    m_timer.expires_from_now(m_write_timeout);
-    m_timer.async_wait(boost::bind(&ComSerial::timeout_handler, this,
-                                   boost::asio::placeholders::error));
+    m_impl->m_timer.ExpiresFromNow(m_impl->m_write_timeout);
+    m_impl->m_timer.AsyncWait(make_alloc_handler(m_impl->m_timer_allocator,
+                                         boost::bind(&ComSerial::timeout_handler, this,
+                                                     boost::asio::placeholders::error)));
 
     // Start the asynchronous operation (blocking write)
-    boost::asio::async_write(m_port, boost::asio::buffer(buffer_out, len),
-                            boost::bind(&ComSerial::read_write_handler, this,
-                                        _1, _2, &ret_code));
+    boost::asio::async_write(m_impl->m_port, boost::asio::buffer(buffer_out, len),
+                             make_alloc_handler(m_impl->m_read_write_allocator,
+                                                boost::bind(&ComSerial::read_write_handler, this,
+                                                            _1, _2, &ret_code)));
 
     // Wait until the asynchronous operations are completed
-    m_port.get_io_service().run(ec);
+    m_impl->m_port.get_io_service().run(ec);
+
+    if (ec)
+        ret_code = -1;
+
+    return ret_code;
+}
+
+int ComSerial::ReadBatch(void *buffer_in, size_t len)
+{
+    boost::system::error_code ec;
+    ComClock::time_point now = m_impl->m_timer.Now();
+    ComClock::time_point deadline = now + m_impl->m_read_timeout;
+    ComClock::time_point batch_deadline = ComClock::time_point::max();
+    int ret_code;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    // Due to previous cancellation of operations on io_service, it is
+    // necessary to reset it
+    m_impl->m_port.get_io_service().reset();
+
+    while (true)
+    {
+        int available = available_for_read();
+
+        if (available < 0)
+            return -1;
+
+        now = m_impl->m_timer.Now();
+
+        if (available > 0)
+        {
+            // The batch deadline starts when the first bytes are seen
+            if (batch_deadline == ComClock::time_point::max())
+                batch_deadline = now + m_impl->m_max_latency;
+
+            // Return the data if the batch is completed, the coalescing is
+            // disabled or the data can't wait more
+            if (static_cast<size_t>(available) >= m_impl->m_min_batch ||
+                m_impl->m_max_latency.count() == 0 ||
+                now >= batch_deadline || now >= deadline)
+                break;
+
+            // Sleep the time that the rest of the batch needs to arrive
+            ComClock::time_point wake_up = now + character_time() *
+                                           static_cast<long>(m_impl->m_min_batch - available);
+
+            wait_until(std::min(wake_up, std::min(batch_deadline, deadline)));
+        }
+        else
+        {
+            if (now >= deadline)
+                return 0;
+
+            // Wake up with the first byte
+            ret_code = wait_readable(deadline);
+
+            if (ret_code < 0)
+                return -1;
+
+            // The serial port is ready but there is no data: an error
+            // is pending, that the read reports
+            if (ret_code > 0 && available_for_read() == 0)
+                break;
+        }
+    }
+
+    // Make a synchronous read of the available data
+    ret_code = m_impl->m_port.read_some(boost::asio::buffer(buffer_in, len), ec);
 
     if (ec)
         ret_code = -1;
@@ -248,21 +385,21 @@ void ComSerial::Abort()
     boost::system::error_code ec;
 
     // Cancel the timeout timer asynchronous operations
-    m_timer.cancel(ec);
+    m_impl->m_timer.Cancel(ec);
 
     // Cancel the serial port asynchronous operations
-    m_port.cancel(ec);
+    m_impl->m_port.cancel(ec);
 }
 
 bool ComSerial::SetWriteTimeout(unsigned int write_timeout)
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     if (write_timeout == 0)
         return false;
 
-    m_write_timeout = boost::posix_time::milliseconds(write_timeout);
+    m_impl->m_write_timeout = boost::chrono::milliseconds(write_timeout);
 
     return true;
 }
@@ -270,41 +407,65 @@ bool ComSerial::SetWriteTimeout(unsigned int write_timeout)
 unsigned int ComSerial::GetWriteTimeout()
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
-    return m_write_timeout.total_milliseconds();
+    return m_impl->m_write_timeout.count();
 }
 
 bool ComSerial::SetReadTimeout(unsigned int read_timeout)
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     if (read_timeout == 0)
         return false;
 
-    m_read_timeout = boost::posix_time::milliseconds(read_timeout);
+    m_impl->m_read_timeout = boost::chrono::milliseconds(read_timeout);
 
     return true;
 }
 
-unsigned int ComSerial::GetReadTimeout()
-{
+unsigned int ComSerial::GetReadTimeout()
+{
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
-
-    return m_read_timeout.total_milliseconds();
-}
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    return m_impl->m_read_timeout.count();
+}
+
+bool ComSerial::SetReadCoalescing(size_t min_batch, unsigned int max_latency)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    if (min_batch == 0 || min_batch > static_cast<size_t>(INT_MAX))
+        return false;
+
+    m_impl->m_min_batch = min_batch;
+    m_impl->m_max_latency = boost::chrono::milliseconds(max_latency);
+
+    return true;
+}
+
+bool ComSerial::SetClock(ComClock *clock)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    m_impl->m_timer.SetClock(clock);
+
+    return true;
+}
 
 bool ComSerial::SetDevice(const std::string& device)
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     if (device.empty())
         return false;
 
-    m_device = device;
+    m_impl->m_device = device;
 
     return true;
 }
@@ -312,83 +473,83 @@ bool ComSerial::SetDevice(const std::string& device)
 std::string ComSerial::GetDevice()
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
-    return m_device;
+    return m_impl->m_device;
 }
 
 bool ComSerial::SetBaudRate(unsigned int baud_rate)
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     if (baud_rate == 0)
         return false;
 
     try
     {
-        m_baud_rate = boost::asio::serial_port_base::baud_rate(baud_rate);
+        m_impl->m_baud_rate = boost::asio::serial_port_base::baud_rate(baud_rate);
     }
     catch (...)
     {
         return false;
     }
 
-    return true;
+    return reconfigure();
 }
 
 unsigned int ComSerial::GetBaudRate()
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
-    return m_baud_rate.value();
+    return m_impl->m_baud_rate.value();
 }
 
 bool ComSerial::SetDataBits(unsigned int data_bits)
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     try
     {
-        m_data_bits = boost::asio::serial_port_base::character_size(data_bits);
+        m_impl->m_data_bits = boost::asio::serial_port_base::character_size(data_bits);
     }
     catch (...)
     {
         return false;
     }
 
-    return true;
+    return reconfigure();
 }
 
 unsigned int ComSerial::GetDataBits()
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
-    return m_data_bits.value();
+    return m_impl->m_data_bits.value();
 }
 
 bool ComSerial::SetStopBits(unsigned int stop_bits)
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     try
     {
         switch (stop_bits)
         {
         case 1:
-            m_stop_bits = boost::asio::serial_port_base::stop_bits(boost::asio::serial_port_base::stop_bits::one);
+            m_impl->m_stop_bits = boost::asio::serial_port_base::stop_bits(boost::asio::serial_port_base::stop_bits::one);
             break;
 
         case 2:
-            m_stop_bits = boost::asio::serial_port_base::stop_bits(boost::asio::serial_port_base::stop_bits::two);
+            m_impl->m_stop_bits = boost::asio::serial_port_base::stop_bits(boost::asio::serial_port_base::stop_bits::two);
             break;
 
         case 3:
-            m_stop_bits = boost::asio::serial_port_base::stop_bits(boost::asio::serial_port_base::stop_bits::onepointfive);
+            m_impl->m_stop_bits = boost::asio::serial_port_base::stop_bits(boost::asio::serial_port_base::stop_bits::onepointfive);
             break;
 
         default:
@@ -400,17 +561,17 @@ bool ComSerial::SetStopBits(unsigned int stop_bits)
         return false;
     }
 
-    return true;
+    return reconfigure();
 }
 
 unsigned int ComSerial::GetStopBits()
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     unsigned int ret_code = 0;
 
-    switch (m_stop_bits.value())
+    switch (m_impl->m_stop_bits.value())
     {
     case boost::asio::serial_port_base::stop_bits::one:
         ret_code = 1;
@@ -434,7 +595,7 @@ unsigned int ComSerial::GetStopBits()
 bool ComSerial::SetParity(char parity)
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     try
     {
@@ -442,17 +603,17 @@ bool ComSerial::SetParity(char parity)
         {
         case 'e':
         case 'E':
-            m_parity = boost::asio::serial_port_base::parity(boost::asio::serial_port_base::parity::even);
+            m_impl->m_parity = boost::asio::serial_port_base::parity(boost::asio::serial_port_base::parity::even);
             break;
 
         case 'o':
         case 'O':
-            m_parity = boost::asio::serial_port_base::parity(boost::asio::serial_port_base::parity::odd);
+            m_impl->m_parity = boost::asio::serial_port_base::parity(boost::asio::serial_port_base::parity::odd);
             break;
 
         case 'n':
         case 'N':
-            m_parity = boost::asio::serial_port_base::parity(boost::asio::serial_port_base::parity::none);
+            m_impl->m_parity = boost::asio::serial_port_base::parity(boost::asio::serial_port_base::parity::none);
             break;
 
         default:
@@ -464,17 +625,17 @@ bool ComSerial::SetParity(char parity)
         return false;
     }
 
-    return true;
+    return reconfigure();
 }
 
 char ComSerial::GetParity()
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     char ret_code = '\0';
 
-    switch (m_parity.value())
+    switch (m_impl->m_parity.value())
     {
     case boost::asio::serial_port_base::parity::even:
         ret_code = 'e';
@@ -498,40 +659,40 @@ char ComSerial::GetParity()
 bool ComSerial::SetFlowControl(char flow_control)
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     switch (flow_control)
     {
     case 'h':
     case 'H':
-        m_flow_control = boost::asio::serial_port_base::flow_control(boost::asio::serial_port_base::flow_control::hardware);
+        m_impl->m_flow_control = boost::asio::serial_port_base::flow_control(boost::asio::serial_port_base::flow_control::hardware);
         break;
 
     case 's':
     case 'S':
-        m_flow_control = boost::asio::serial_port_base::flow_control(boost::asio::serial_port_base::flow_control::software);
+        m_impl->m_flow_control = boost::asio::serial_port_base::flow_control(boost::asio::serial_port_base::flow_control::software);
         break;
 
     case 'n':
     case 'N':
-        m_flow_control = boost::asio::serial_port_base::flow_control(boost::asio::serial_port_base::flow_control::none);
+        m_impl->m_flow_control = boost::asio::serial_port_base::flow_control(boost::asio::serial_port_base::flow_control::none);
         break;
 
     default:
         return false;
     }
 
-    return true;
+    return reconfigure();
 }
 
 char ComSerial::GetFlowControl()
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     char ret_code = '\0';
 
-    switch (m_flow_control.value())
+    switch (m_impl->m_flow_control.value())
     {
     case boost::asio::serial_port_base::flow_control::hardware:
         ret_code = 'h';
@@ -557,13 +718,13 @@ bool ComSerial::Flush()
     bool ok;
 
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
 #if defined(BOOST_WINDOWS) || defined(__CYGWIN__)
-    ok = (::PurgeComm(m_port.lowest_layer().native_handle(), PURGE_RXABORT |
+    ok = (::PurgeComm(m_impl->m_port.lowest_layer().native_handle(), PURGE_RXABORT |
                       PURGE_RXCLEAR | PURGE_TXABORT | PURGE_TXCLEAR) != 0);
 #else
-    ok = (::tcflush(m_port.lowest_layer().native_handle(), TCIOFLUSH) == 0);
+    ok = (::tcflush(m_impl->m_port.lowest_layer().native_handle(), TCIOFLUSH) == 0);
 #endif
 
 //    // Error?
@@ -588,9 +749,9 @@ bool ComSerial::SendBreak()
     boost::system::error_code ec;
 
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
-    m_port.send_break(ec);
+    m_impl->m_port.send_break(ec);
 
     if (ec)
         return false;
@@ -598,10 +759,193 @@ bool ComSerial::SendBreak()
     return true;
 }
 
+bool ComSerial::SetDtr(bool state)
+{
+    bool ok;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+#if defined(BOOST_WINDOWS) || defined(__CYGWIN__)
+    ok = (0 != ::EscapeCommFunction(m_impl->m_port.lowest_layer().native_handle(), state ? SETDTR : CLRDTR));
+#else
+    int line = TIOCM_DTR;
+
+    ok = (0 == ::ioctl(m_impl->m_port.lowest_layer().native_handle(), state ? TIOCMBIS : TIOCMBIC, &line));
+#endif
+
+    return ok;
+}
+
+bool ComSerial::SetRts(bool state)
+{
+    bool ok;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+#if defined(BOOST_WINDOWS) || defined(__CYGWIN__)
+    ok = (0 != ::EscapeCommFunction(m_impl->m_port.lowest_layer().native_handle(), state ? SETRTS : CLRRTS));
+#else
+    int line = TIOCM_RTS;
+
+    ok = (0 == ::ioctl(m_impl->m_port.lowest_layer().native_handle(), state ? TIOCMBIS : TIOCMBIC, &line));
+#endif
+
+    return ok;
+}
+
+int ComSerial::GetModemStatus()
+{
+    int value = 0;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+#if defined(BOOST_WINDOWS) || defined(__CYGWIN__)
+    DWORD status;
+
+    // The bits of the status are the same as the ones of the lines
+    if (0 == ::GetCommModemStatus(m_impl->m_port.lowest_layer().native_handle(), &status))
+        return -1;
+
+    value = static_cast<int>(status) & (modem_cts | modem_dsr | modem_ri | modem_cd);
+#else
+    int lines;
+
+    if (0 > ::ioctl(m_impl->m_port.lowest_layer().native_handle(), TIOCMGET, &lines))
+        return -1;
+
+    if (lines & TIOCM_CTS)
+        value |= modem_cts;
+
+    if (lines & TIOCM_DSR)
+        value |= modem_dsr;
+
+    if (lines & TIOCM_RI)
+        value |= modem_ri;
+
+    if (lines & TIOCM_CD)
+        value |= modem_cd;
+#endif
+
+    return value;
+}
+
+int ComSerial::ReadTimestamped(void *buffer_in, size_t len, std::vector<ComSerialChunk>& chunks)
+{
+    boost::system::error_code ec;
+    size_t received = 0;
+    int ret_code = 0;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    chunks.clear();
+
+    // Due to previous cancellation of operations on io_service, it is
+    // necessary to reset it
+    m_impl->m_port.get_io_service().reset();
+
+    // Set the timeout for the asynchronous operations
+    m_impl->m_timer.ExpiresFromNow(m_impl->m_read_timeout);
+    m_impl->m_timer.AsyncWait(make_alloc_handler(m_impl->m_timer_allocator,
+                                         boost::bind(&ComSerial::timeout_handler, this,
+                                                     boost::asio::placeholders::error)));
+
+    // Read chunk by chunk, so each one gets its own arrival timestamp
+    while (received < len)
+    {
+        boost::system::error_code read_error = boost::asio::error::would_block;
+        size_t bytes = 0;
+        ComSerialChunk chunk;
+
+        m_impl->m_port.async_read_some(boost::asio::buffer(static_cast<char *>(buffer_in) + received,
+                                                   len - received),
+                               make_alloc_handler(m_impl->m_read_write_allocator,
+                                                  boost::bind(&ComSerial::chunk_handler, this,
+                                                              _1, _2, &read_error, &bytes,
+                                                              &chunk.arrival)));
+
+        while (read_error == boost::asio::error::would_block &&
+               m_impl->m_port.get_io_service().run_one(ec))
+            ;
+
+        if (bytes > 0)
+        {
+            chunk.offset = received;
+            chunk.length = bytes;
+            chunks.push_back(chunk);
+
+            received += bytes;
+        }
+
+        // If the read has been canceled, the timeout expired and the
+        // bytes received until now are returned
+        if (ec || (read_error && read_error != boost::asio::error::operation_aborted))
+            ret_code = -1;
+
+        if (ec || read_error)
+            break;
+    }
+
+    // Cancel the timeout timer and wait for its handler
+    m_impl->m_timer.Cancel(ec);
+    m_impl->m_port.get_io_service().run(ec);
+
+    if (ret_code < 0)
+        return -1;
+
+    return received;
+}
+
+boost::chrono::nanoseconds ComSerial::GetCharacterTime()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    return character_time();
+}
+
+boost::chrono::steady_clock::time_point ComSerial::EstimateArrival(const ComSerialChunk& chunk,
+                                                                   size_t index)
+{
+    if (index >= chunk.length)
+        return chunk.arrival;
+
+    return chunk.arrival - GetCharacterTime() * static_cast<long>(chunk.length - 1 - index);
+}
+
 /////////////////////
 // Private Methods //
 /////////////////////
 
+boost::chrono::nanoseconds ComSerial::character_time()
+{
+    // Bits are counted in halves because of the 1.5 stop bits
+    unsigned int half_bits = 2 * (1 + m_impl->m_data_bits.value());
+
+    if (m_impl->m_parity.value() != boost::asio::serial_port_base::parity::none)
+        half_bits += 2;
+
+    switch (m_impl->m_stop_bits.value())
+    {
+    case boost::asio::serial_port_base::stop_bits::onepointfive:
+        half_bits += 3;
+        break;
+
+    case boost::asio::serial_port_base::stop_bits::two:
+        half_bits += 4;
+        break;
+
+    default:
+        half_bits += 2;
+    }
+
+    return boost::chrono::nanoseconds(static_cast<boost::int_least64_t>(half_bits) *
+                                      500000000 / m_impl->m_baud_rate.value());
+}
+
 void ComSerial::read_write_handler(const boost::system::error_code &error,
                                    size_t bytes_transferred, int *ret_code)
 {
@@ -615,7 +959,7 @@ void ComSerial::read_write_handler(const boost::system::error_code &error,
         *ret_code = bytes_transferred;
 
     // Cancel the timeout timer
-    m_timer.cancel(ec);
+    m_impl->m_timer.Cancel(ec);
 }
 
 void ComSerial::timeout_handler(const boost::system::error_code &error)
@@ -628,7 +972,74 @@ void ComSerial::timeout_handler(const boost::system::error_code &error)
         return;
 
     // If the timeout timer expired, cancel the serial port operation
-    m_port.cancel(ec);
+    m_impl->m_port.cancel(ec);
+}
+
+void ComSerial::wait_handler(const boost::system::error_code &error,
+                             boost::system::error_code *ret_error)
+{
+    *ret_error = error;
+}
+
+int ComSerial::wait_readable(const ComClock::time_point& deadline)
+{
+    boost::system::error_code ec;
+    boost::system::error_code wait_error = boost::asio::error::would_block;
+
+    // Set the timeout for the asynchronous operations
+    m_impl->m_timer.ExpiresAt(deadline);
+    m_impl->m_timer.AsyncWait(make_alloc_handler(m_impl->m_timer_allocator,
+                                         boost::bind(&ComSerial::timeout_handler, this,
+                                                     boost::asio::placeholders::error)));
+
+    // Start the asynchronous operation (wait until ready to read)
+    m_impl->m_port.async_read_some(boost::asio::null_buffers(),
+                           make_alloc_handler(m_impl->m_read_write_allocator,
+                                              boost::bind(&ComSerial::wait_handler, this,
+                                                          _1, &wait_error)));
+
+    while (wait_error == boost::asio::error::would_block &&
+           m_impl->m_port.get_io_service().run_one(ec))
+        ;
+
+    // Cancel the timeout timer and wait for its handler
+    m_impl->m_timer.Cancel(ec);
+    m_impl->m_port.get_io_service().run(ec);
+    m_impl->m_port.get_io_service().reset();
+
+    // If the wait has been canceled, the deadline expired
+    if (!wait_error)
+        return 1;
+    else if (wait_error == boost::asio::error::operation_aborted)
+        return 0;
+    else
+        return -1;
+}
+
+void ComSerial::wait_until(const ComClock::time_point& deadline)
+{
+    boost::system::error_code ec;
+    boost::system::error_code wait_error = boost::asio::error::would_block;
+
+    // The timer is waited asynchronously, so Abort() can cancel it
+    m_impl->m_timer.ExpiresAt(deadline);
+    m_impl->m_timer.AsyncWait(make_alloc_handler(m_impl->m_timer_allocator,
+                                         boost::bind(&ComSerial::wait_handler, this,
+                                                     _1, &wait_error)));
+
+    m_impl->m_port.get_io_service().run(ec);
+    m_impl->m_port.get_io_service().reset();
+}
+
+void ComSerial::chunk_handler(const boost::system::error_code &error, size_t bytes_transferred,
+                              boost::system::error_code *ret_error, size_t *ret_bytes,
+                              boost::chrono::steady_clock::time_point *arrival)
+{
+    // Take the timestamp as soon as the reactor completes the read
+    *arrival = m_impl->m_timer.Now();
+
+    *ret_error = error;
+    *ret_bytes = bytes_transferred;
 }
 
 int ComSerial::available_for_read()
@@ -638,12 +1049,12 @@ int ComSerial::available_for_read()
 #if defined(BOOST_WINDOWS) || defined(__CYGWIN__)
     COMSTAT status;
 
-    if (0 != ::ClearCommError(m_port.lowest_layer().native_handle(), NULL, &status))
+    if (0 != ::ClearCommError(m_impl->m_port.lowest_layer().native_handle(), NULL, &status))
         value = status.cbInQue;
     else
         value = -1;
 #else
-    if (0 > ::ioctl(m_port.lowest_layer().native_handle(), FIONREAD, &value))
+    if (0 > ::ioctl(m_impl->m_port.lowest_layer().native_handle(), FIONREAD, &value))
         value = -1;
 #endif
 
@@ -671,12 +1082,12 @@ int ComSerial::pending_for_write()
 #if defined(BOOST_WINDOWS) || defined(__CYGWIN__)
     COMSTAT status;
 
-    if (0 != ::ClearCommError(m_port.lowest_layer().native_handle(), NULL, &status))
+    if (0 != ::ClearCommError(m_impl->m_port.lowest_layer().native_handle(), NULL, &status))
         value = status.cbOutQue;
     else
         value = -1;
 #else
-    if (0 > ::ioctl(m_port.lowest_layer().native_handle(), TIOCOUTQ, &value))
+    if (0 > ::ioctl(m_impl->m_port.lowest_layer().native_handle(), TIOCOUTQ, &value))
         value = -1;
 #endif
 
@@ -696,3 +1107,27 @@ int ComSerial::pending_for_write()
 
     return value;
 }
+
+bool ComSerial::reconfigure()
+{
+    boost::system::error_code ec;
+
+    if (!m_impl->m_port.is_open())
+        return true;
+
+    m_impl->m_port.set_option(m_impl->m_baud_rate, ec);
+
+    if (!ec)
+        m_impl->m_port.set_option(m_impl->m_data_bits, ec);
+
+    if (!ec)
+        m_impl->m_port.set_option(m_impl->m_stop_bits, ec);
+
+    if (!ec)
+        m_impl->m_port.set_option(m_impl->m_parity, ec);
+
+    if (!ec)
+        m_impl->m_port.set_option(m_impl->m_flow_control, ec);
+
+    return !ec;
+}
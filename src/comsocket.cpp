@@ -10,10 +10,206 @@
 // This allows to cancel the asynchronous operations.
 #define BOOST_ASIO_ENABLE_CANCELIO
 
+#if defined(__linux__)
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <time.h>
+
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+
+#include <cstring>
+#endif
+
+#include <algorithm>
+#include <climits>
+
+#include <boost/asio.hpp>
+#include <boost/atomic.hpp>
 #include <boost/bind.hpp>
 #include <boost/chrono.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
 
 #include "cominterface/comsocket.hpp"
+#include "cominterface/comtimer.hpp"
+#include "cominterface/handlerallocator.hpp"
+
+const size_t ComSocket::post_batch;
+const size_t ComSocket::impl_size;
+
+/**
+ * @brief Message posted to a socket.
+ */
+struct ComSocket::PostNode
+{
+    PostNode() : next(NULL) {}
+
+    ComBuffer message;                  ///< Message to write.
+    boost::atomic<PostNode *> next;     ///< Next node of the queue.
+};
+
+/**
+ * @brief Messages posted to a socket. The queue is an intrusive lock-free
+ * queue with multiple producers (the threads that call Post) and one
+ * consumer (the owner that writes the messages). The counter of pending
+ * messages elects the owner: the producer that increments it from 0.
+ */
+struct ComSocket::PostQueue
+{
+    PostQueue() : head(&stub), tail(&stub), count(0), bytes(0), failed(false) {}
+
+    ~PostQueue()
+    {
+        PostNode *node;
+
+        while ((node = pop()))
+            delete node;
+    }
+
+    PostNode stub;                      ///< Node that keeps the queue not empty.
+    boost::atomic<PostNode *> head;     ///< Last node pushed.
+    PostNode *tail;                     ///< Next node to pop. Only used by the owner.
+    boost::atomic<size_t> count;        ///< Number of messages posted and not written.
+    boost::atomic<size_t> bytes;        ///< Number of bytes posted and not written.
+    boost::atomic<bool> failed;         ///< A write has failed since the last Open.
+
+    /**
+     * @brief Push a node. It is safe for multiple producers.
+     * @param node Node.
+     */
+    void push(PostNode *node)
+    {
+        node->next.store(NULL, boost::memory_order_relaxed);
+
+        PostNode *prev = head.exchange(node, boost::memory_order_acq_rel);
+
+        prev->next.store(node, boost::memory_order_release);
+    }
+
+    /**
+     * @brief Pop a node. It is only called by the owner of the queue.
+     * @return Node, or NULL if the queue is empty or a push is in progress.
+     */
+    PostNode *pop()
+    {
+        PostNode *first = tail;
+        PostNode *next = first->next.load(boost::memory_order_acquire);
+
+        // Skip the stub node
+        if (first == &stub)
+        {
+            if (!next)
+                return NULL;
+
+            tail = next;
+            first = next;
+            next = next->next.load(boost::memory_order_acquire);
+        }
+
+        if (next)
+        {
+            tail = next;
+            return first;
+        }
+
+        // The last node can only be taken when it is the head, after
+        // pushing the stub node behind it
+        if (first != head.load(boost::memory_order_acquire))
+            return NULL;
+
+        push(&stub);
+
+        next = first->next.load(boost::memory_order_acquire);
+
+        if (next)
+        {
+            tail = next;
+            return first;
+        }
+
+        return NULL;
+    }
+};
+
+/**
+ * @brief Private implementation of the socket interface, that keeps
+ * boost::asio out of its header.
+ */
+struct ComSocket::Impl
+{
+    Impl() : m_io_service(), m_socket(m_io_service),
+             m_timer(m_io_service), m_acceptor(m_io_service),
+             m_rx_timestamps(false), m_tx_timestamps(false), m_no_delay(false),
+             m_receive_buffer_size(0),
+             m_min_batch(1), m_max_latency(0), m_low_watermark(1),
+             m_post_queue(new PostQueue()) {}
+
+    // Control de boost asio
+    boost::asio::io_service m_io_service;               ///< Service for access OS resources.
+    boost::asio::ip::tcp::socket m_socket;              ///< Socket handler.
+    ComTimer m_timer;                                   ///< Timeout timer for the asynchronous operations.
+    boost::asio::ip::tcp::acceptor m_acceptor;          ///< Acceptor for incoming connections in server mode.
+    boost::chrono::milliseconds m_write_timeout;        ///< Time in milliseconds for the transmission timeout timer.
+    boost::chrono::milliseconds m_read_timeout;         ///< Time in milliseconds for the reception timeout timer.
+    boost::chrono::milliseconds m_open_timeout;         ///< Time in milliseconds for the open timeout timer.
+
+    // Configuracin de la conexin
+    boost::asio::ip::address m_address;                 ///< IP address.
+    unsigned int m_port;                                ///< TCP port.
+
+    boost::mutex m_mutex;                               ///< Mutex to make the interface thread safe.
+
+    // Kernel timestamps
+    bool m_rx_timestamps;                               ///< Timestamp the reception of data.
+    bool m_tx_timestamps;                               ///< Timestamp the acknowledgement of transmitted data.
+    bool m_no_delay;                                    ///< The Nagle algorithm is disabled.
+    size_t m_receive_buffer_size;                       ///< Kernel receive buffer size, 0 for the system default.
+
+    // Read coalescing
+    size_t m_min_batch;                                 ///< Number of bytes that ends the wait of ReadBatch.
+    boost::chrono::milliseconds m_max_latency;          ///< Maximum time that received data waits for a batch.
+    size_t m_low_watermark;                             ///< Current receive low watermark of the socket.
+
+    // Handlers memory
+    HandlerAllocator m_read_write_allocator;            ///< Recycled memory for the read/write handlers.
+    HandlerAllocator m_timer_allocator;                 ///< Recycled memory for the timeout timer handlers.
+
+    // Posted messages
+    boost::scoped_ptr<PostQueue> m_post_queue;          ///< Messages posted and not written yet.
+    std::vector<boost::asio::const_buffer> m_post_buffers;  ///< Buffers of the messages gathered in a write.
+};
+
+/**
+ * @brief Restorer of the default receive low watermark of a socket. It is
+ * raised while ReadBatch waits for a batch, and restored when it returns.
+ */
+struct ComSocket::LowWatermarkGuard
+{
+    explicit LowWatermarkGuard(ComSocket& socket) : socket(socket) {}
+
+    ~LowWatermarkGuard()
+    {
+        socket.set_low_watermark(1);
+    }
+
+    ComSocket& socket;                  ///< Socket whose watermark is restored.
+};
+
+#if defined(__linux__)
+/**
+ * @brief Convert a kernel timestamp to a system clock time point.
+ * @param ts Kernel timestamp.
+ * @return Time point.
+ */
+static boost::chrono::system_clock::time_point to_time_point(const struct timespec& ts)
+{
+    return boost::chrono::system_clock::time_point(
+               boost::chrono::duration_cast<boost::chrono::system_clock::duration>(
+                   boost::chrono::seconds(ts.tv_sec) + boost::chrono::nanoseconds(ts.tv_nsec)));
+}
+#endif
 
 ////////////////////
 // Public Methods //
@@ -21,8 +217,7 @@
 
 ComSocket::ComSocket(const std::string& address, unsigned int port,
                      unsigned int timeout):
-                       m_io_service(), m_socket(m_io_service),
-                       m_timer(m_io_service), m_acceptor(m_io_service)
+                       m_impl()
 {
     if (!SetAddress(address))
         throw std::invalid_argument("invalid IP address");
@@ -38,7 +233,8 @@ ComSocket::ComSocket(const std::string& address, unsigned int port,
 
 ComSocket::~ComSocket()
 {
-
+    // The streaming thread uses the virtual functions of the interface
+    StopStreaming();
 }
 
 bool ComSocket::Open()
@@ -47,52 +243,58 @@ bool ComSocket::Open()
     bool ret_code = false;
 
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     // Due to previous cancellation of operations on io_service, it is
     // necessary to reset it
-    m_socket.get_io_service().reset();
+    m_impl->m_socket.get_io_service().reset();
 
     // If the socket is already opened, close it
-    if (m_socket.is_open())
-        m_socket.close(ec);
+    if (m_impl->m_socket.is_open())
+        m_impl->m_socket.close(ec);
+
+    // The new socket starts with the default receive low watermark
+    m_impl->m_low_watermark = 1;
+
+    // The posted messages can be written again
+    m_impl->m_post_queue->failed.store(false, boost::memory_order_release);
 
     // If the IP address is unspecified, the mode is server.
     // Else, the mode is client
-    if (m_address.is_unspecified())
+    if (m_impl->m_address.is_unspecified())
     {
         // Set the timeout for the asynchronous operations
-        m_timer.expires_from_now(m_open_timeout);
-        m_timer.async_wait(boost::bind(&ComSocket::timeout_accept_handler, this,
-                                       boost::asio::placeholders::error));
+        m_impl->m_timer.ExpiresFromNow(m_impl->m_open_timeout);
+        m_impl->m_timer.AsyncWait(boost::bind(&ComSocket::timeout_accept_handler, this,
+                                      boost::asio::placeholders::error));
 
         // Connection endpoint
-        boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::tcp::v4(), m_port);
+        boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::tcp::v4(), m_impl->m_port);
 
         // Connection acceptor
         try
         {
-            m_acceptor.open(endpoint.protocol());
-            m_acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
-            m_acceptor.bind(endpoint);
-            m_acceptor.listen();
+            m_impl->m_acceptor.open(endpoint.protocol());
+            m_impl->m_acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
+            m_impl->m_acceptor.bind(endpoint);
+            m_impl->m_acceptor.listen();
         }
         catch (std::exception &e)
         {
-            m_acceptor.close(ec);
+            m_impl->m_acceptor.close(ec);
             return false;
         }
 
         // Start the asynchronous operation (accept)
-        m_acceptor.async_accept(m_socket, boost::bind(&ComSocket::open_handler,
+        m_impl->m_acceptor.async_accept(m_impl->m_socket, boost::bind(&ComSocket::open_handler,
                                                     this, _1, &ret_code));
 
         // Wait until the asynchronous operations are completed
-        m_acceptor.get_io_service().run(ec);
+        m_impl->m_acceptor.get_io_service().run(ec);
 
         // Close the acceptance of new connections
         boost::system::error_code ec_acceptor_close;
-        m_acceptor.close(ec_acceptor_close);
+        m_impl->m_acceptor.close(ec_acceptor_close);
 
         // There is no matter of the error code. If an error occurs, the return
         // code will be false
@@ -102,19 +304,19 @@ bool ComSocket::Open()
     else
     {
         // Set the timeout for the asynchronous operations
-        m_timer.expires_from_now(m_open_timeout);
-        m_timer.async_wait(boost::bind(&ComSocket::timeout_handler, this,
-                                       boost::asio::placeholders::error));
+        m_impl->m_timer.ExpiresFromNow(m_impl->m_open_timeout);
+        m_impl->m_timer.AsyncWait(boost::bind(&ComSocket::timeout_handler, this,
+                                      boost::asio::placeholders::error));
 
         // Connection endpoint
-        boost::asio::ip::tcp::endpoint endpoint(m_address, m_port);
+        boost::asio::ip::tcp::endpoint endpoint(m_impl->m_address, m_impl->m_port);
 
         // Start the asynchronous operation (connect)
-        m_socket.async_connect(endpoint, boost::bind(&ComSocket::open_handler,
+        m_impl->m_socket.async_connect(endpoint, boost::bind(&ComSocket::open_handler,
                                                      this, _1, &ret_code));
 
         // Wait until the asynchronous operations are completed
-        m_socket.get_io_service().run(ec);
+        m_impl->m_socket.get_io_service().run(ec);
     }
 
     if (ec)
@@ -122,12 +324,25 @@ bool ComSocket::Open()
     else
     {
         // Set the socket synchronous operations to non blocking mode
-        m_socket.non_blocking(true, ec);
+        m_impl->m_socket.non_blocking(true, ec);
+
+        // Disable the Nagle algorithm if it has been configured
+        if (!ec && m_impl->m_no_delay)
+            m_impl->m_socket.set_option(boost::asio::ip::tcp::no_delay(true), ec);
+
+        // Set the kernel receive buffer if it has been configured
+        if (!ec && m_impl->m_receive_buffer_size > 0)
+            m_impl->m_socket.set_option(boost::asio::socket_base::receive_buffer_size(
+                                    static_cast<int>(m_impl->m_receive_buffer_size)), ec);
+
+        // Enable the kernel timestamps if they have been configured
+        if (!ec && (m_impl->m_rx_timestamps || m_impl->m_tx_timestamps) && !apply_timestamping())
+            ec = boost::asio::error::operation_not_supported;
 
         // If the operation fails, close the socket and return false
         if (ec)
         {
-            m_socket.close(ec);
+            m_impl->m_socket.close(ec);
             ret_code = false;
         }
     }
@@ -140,11 +355,11 @@ bool ComSocket::Close()
     boost::system::error_code ec;
 
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     // If the socket is opened, close it
-    if (m_socket.is_open())
-        m_socket.close(ec);
+    if (m_impl->m_socket.is_open())
+        m_impl->m_socket.close(ec);
 
     // Error?
     if (ec)
@@ -156,9 +371,70 @@ bool ComSocket::Close()
 bool ComSocket::Opened()
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    return m_impl->m_socket.is_open();
+}
+
+int ComSocket::GetNativeHandle()
+{
+#if defined(BOOST_WINDOWS) || defined(__CYGWIN__)
+    return -1;
+#else
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    if (!m_impl->m_socket.is_open())
+        return -1;
+
+    return m_impl->m_socket.native_handle();
+#endif
+}
+
+bool ComSocket::SetReceiveBufferSize(size_t size)
+{
+    boost::system::error_code ec;
+
+    if (size == 0 || size > static_cast<size_t>(INT_MAX))
+        return false;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    m_impl->m_receive_buffer_size = size;
+
+    // If the socket is already opened, apply the new configuration.
+    // Else, it will be applied on Open
+    if (m_impl->m_socket.is_open())
+        m_impl->m_socket.set_option(boost::asio::socket_base::receive_buffer_size(static_cast<int>(size)), ec);
+
+    return !ec;
+}
+
+size_t ComSocket::GetReceiveBufferSize()
+{
+    boost::system::error_code ec;
+    boost::asio::socket_base::receive_buffer_size option;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    if (!m_impl->m_socket.is_open())
+        return m_impl->m_receive_buffer_size;
+
+    m_impl->m_socket.get_option(option, ec);
+
+    return ec ? 0 : static_cast<size_t>(option.value());
+}
 
-    return m_socket.is_open();
+bool ComSocket::SetClock(ComClock *clock)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    m_impl->m_timer.SetClock(clock);
+
+    return true;
 }
 
 int ComSocket::ReadSome(void *buffer_in, size_t len)
@@ -167,10 +443,10 @@ int ComSocket::ReadSome(void *buffer_in, size_t len)
     int ret_code;
 
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     // Make a non blocking read
-    ret_code = m_socket.read_some(boost::asio::buffer(buffer_in, len), ec);
+    ret_code = m_impl->m_socket.read_some(boost::asio::buffer(buffer_in, len), ec);
 
     // If error would_block occurs, there is no data available. Else,
     // an unexpected error occurs
@@ -191,10 +467,10 @@ int ComSocket::WriteSome(const void *buffer_out, size_t len)
     int ret_code;
 
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     // Make a non blocking write
-    ret_code = m_socket.write_some(boost::asio::buffer(buffer_out, len), ec);
+    ret_code = m_impl->m_socket.write_some(boost::asio::buffer(buffer_out, len), ec);
 
     // If error would_block occurs, the operation can't be made. Else,
     // an unexpected error occurs
@@ -215,24 +491,26 @@ int ComSocket::Read(void *buffer_in, size_t len)
     int ret_code;
 
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     // Due to previous cancellation of operations on io_service, it is
     // necessary to reset it
-    m_socket.get_io_service().reset();
+    m_impl->m_socket.get_io_service().reset();
 
     // Set the timeout for the asynchronous operations
-    m_timer.expires_from_now(m_read_timeout);
-    m_timer.async_wait(boost::bind(&ComSocket::timeout_handler, this,
-                                   boost::asio::placeholders::error));
+    m_impl->m_timer.ExpiresFromNow(m_impl->m_read_timeout);
+    m_impl->m_timer.AsyncWait(make_alloc_handler(m_impl->m_timer_allocator,
+                                         boost::bind(&ComSocket::timeout_handler, this,
+                                                     boost::asio::placeholders::error)));
 
     // Start the asynchronous operation (blocking read)
-    boost::asio::async_read(m_socket, boost::asio::buffer(buffer_in, len),
-                            boost::bind(&ComSocket::read_write_handler, this,
-                                        _1, _2, &ret_code));
+    boost::asio::async_read(m_impl->m_socket, boost::asio::buffer(buffer_in, len),
+                            make_alloc_handler(m_impl->m_read_write_allocator,
+                                               boost::bind(&ComSocket::read_write_handler, this,
+                                                           _1, _2, &ret_code)));
 
     // Wait until the asynchronous operations are completed
-    m_socket.get_io_service().run(ec);
+    m_impl->m_socket.get_io_service().run(ec);
 
     if (ec)
         ret_code = -1;
@@ -246,24 +524,26 @@ int ComSocket::Write(const void *buffer_out, size_t len)
     int ret_code;
 
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     // Due to previous cancellation of operations on io_service, it is
     // necessary to reset it
-    m_socket.get_io_service().reset();
+    m_impl->m_socket.get_io_service().reset();
 
     // Set the timeout for the asynchronous operations
-    m_timer.expires_from_now(m_write_timeout);
-    m_timer.async_wait(boost::bind(&ComSocket::timeout_handler, this,
-                                   boost::asio::placeholders::error));
+    m_impl->m_timer.ExpiresFromNow(m_impl->m_write_timeout);
+    m_impl->m_timer.AsyncWait(make_alloc_handler(m_impl->m_timer_allocator,
+                                         boost::bind(&ComSocket::timeout_handler, this,
+                                                     boost::asio::placeholders::error)));
 
     // Start the asynchronous operation (blocking write)
-    boost::asio::async_write(m_socket, boost::asio::buffer(buffer_out, len),
-                            boost::bind(&ComSocket::read_write_handler, this,
-                                        _1, _2, &ret_code));
+    boost::asio::async_write(m_impl->m_socket, boost::asio::buffer(buffer_out, len),
+                             make_alloc_handler(m_impl->m_read_write_allocator,
+                                                boost::bind(&ComSocket::read_write_handler, this,
+                                                            _1, _2, &ret_code)));
 
     // Wait until the asynchronous operations are completed
-    m_socket.get_io_service().run(ec);
+    m_impl->m_socket.get_io_service().run(ec);
 
     if (ec)
         ret_code = -1;
@@ -271,38 +551,118 @@ int ComSocket::Write(const void *buffer_out, size_t len)
     return ret_code;
 }
 
+int ComSocket::ReadBatch(void *buffer_in, size_t len)
+{
+    boost::system::error_code ec;
+    ComClock::time_point now = m_impl->m_timer.Now();
+    ComClock::time_point deadline = now + m_impl->m_read_timeout;
+    ComClock::time_point batch_deadline = ComClock::time_point::max();
+    int ret_code;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    // The other waits on the socket wake up with the first byte
+    LowWatermarkGuard low_watermark(*this);
+
+    // Due to previous cancellation of operations on io_service, it is
+    // necessary to reset it
+    m_impl->m_socket.get_io_service().reset();
+
+    while (true)
+    {
+        size_t available = m_impl->m_socket.available(ec);
+
+        if (ec)
+            return -1;
+
+        now = m_impl->m_timer.Now();
+
+        if (available > 0)
+        {
+            // The batch deadline starts when the first bytes are seen
+            if (batch_deadline == ComClock::time_point::max())
+                batch_deadline = now + m_impl->m_max_latency;
+
+            // Return the data if the batch is completed, the coalescing is
+            // disabled or the data can't wait more
+            if (available >= m_impl->m_min_batch || m_impl->m_max_latency.count() == 0 ||
+                now >= batch_deadline || now >= deadline)
+                break;
+
+            // Only wake up when the batch is completed
+            if (!set_low_watermark(m_impl->m_min_batch))
+                return -1;
+
+            ret_code = wait_readable(std::min(batch_deadline, deadline));
+        }
+        else
+        {
+            if (now >= deadline)
+                return 0;
+
+            // Wake up with the first byte
+            if (!set_low_watermark(1))
+                return -1;
+
+            ret_code = wait_readable(deadline);
+
+            // The socket is ready but there is no data: the connection has
+            // been closed or an error is pending, that the read reports
+            if (ret_code > 0 && m_impl->m_socket.available(ec) == 0 && !ec)
+                break;
+        }
+
+        if (ret_code < 0)
+            return -1;
+    }
+
+    // Make a non blocking read of the available data
+    ret_code = m_impl->m_socket.read_some(boost::asio::buffer(buffer_in, len), ec);
+
+    if (ec)
+    {
+        if (ec == boost::asio::error::would_block)
+            ret_code = 0;
+        else
+            ret_code = -1;
+    }
+
+    return ret_code;
+}
+
 void ComSocket::Abort()
 {
     boost::system::error_code ec;
 
     // Cancel the timeout timer asynchronous operations
-    m_timer.cancel(ec);
+    m_impl->m_timer.Cancel(ec);
 
     // Cancel the socket asynchronous operations
-    m_socket.cancel(ec);
+    m_impl->m_socket.cancel(ec);
 
     // In Windows Server 2003, Windows XP and older, cancel don't work
     // if it is called from a thread different from the thread that calls
     // the asynchronous operation
     if (ec == boost::asio::error::operation_not_supported)
-        m_socket.close(ec);
+        m_impl->m_socket.close(ec);
 
     // Cancel the acceptor asynchronous operations
-    m_acceptor.cancel(ec);
+    m_impl->m_acceptor.cancel(ec);
 
     if (ec == boost::asio::error::operation_not_supported)
-        m_acceptor.close(ec);
+        m_impl->m_acceptor.close(ec);
 }
 
 bool ComSocket::SetWriteTimeout(unsigned int write_timeout)
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     if (write_timeout == 0)
         return false;
 
-    m_write_timeout = boost::posix_time::milliseconds(write_timeout);
+    m_impl->m_write_timeout = boost::chrono::milliseconds(write_timeout);
 
     return true;
 }
@@ -310,41 +670,55 @@ bool ComSocket::SetWriteTimeout(unsigned int write_timeout)
 unsigned int ComSocket::GetWriteTimeout()
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
-    return m_write_timeout.total_milliseconds();
+    return m_impl->m_write_timeout.count();
 }
 
 bool ComSocket::SetReadTimeout(unsigned int read_timeout)
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     if (read_timeout == 0)
         return false;
 
-    m_read_timeout = boost::posix_time::milliseconds(read_timeout);
+    m_impl->m_read_timeout = boost::chrono::milliseconds(read_timeout);
 
     return true;
 }
 
-unsigned int ComSocket::GetReadTimeout()
-{
+unsigned int ComSocket::GetReadTimeout()
+{
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
-
-    return m_read_timeout.total_milliseconds();
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    return m_impl->m_read_timeout.count();
+}
+
+bool ComSocket::SetReadCoalescing(size_t min_batch, unsigned int max_latency)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    if (min_batch == 0 || min_batch > static_cast<size_t>(INT_MAX))
+        return false;
+
+    m_impl->m_min_batch = min_batch;
+    m_impl->m_max_latency = boost::chrono::milliseconds(max_latency);
+
+    return true;
 }
 
 bool ComSocket::SetOpenTimeout(unsigned int open_timeout)
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     if (open_timeout == 0)
         return false;
 
-    m_open_timeout = boost::posix_time::milliseconds(open_timeout);
+    m_impl->m_open_timeout = boost::chrono::milliseconds(open_timeout);
 
     return true;
 }
@@ -352,22 +726,22 @@ bool ComSocket::SetOpenTimeout(unsigned int open_timeout)
 unsigned int ComSocket::GetOpenTimeout()
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
-    return m_open_timeout.total_milliseconds();
+    return m_impl->m_open_timeout.count();
 }
 
 bool ComSocket::SetAddress(const std::string& address)
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     boost::system::error_code ec;
 
     if (address.empty())
-        m_address = boost::asio::ip::address();
+        m_impl->m_address = boost::asio::ip::address();
     else
-        m_address = boost::asio::ip::address::from_string(address, ec);
+        m_impl->m_address = boost::asio::ip::address::from_string(address, ec);
 
     if (ec)
         return false;
@@ -378,23 +752,23 @@ bool ComSocket::SetAddress(const std::string& address)
 std::string ComSocket::GetAddress()
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
-    if (m_address.is_unspecified())
+    if (m_impl->m_address.is_unspecified())
         return std::string();
     else
-        return m_address.to_string();
+        return m_impl->m_address.to_string();
 }
 
 bool ComSocket::SetPort(unsigned int port)
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
 
     if (port > 65535)
         return false;
 
-    m_port = port;
+    m_impl->m_port = port;
 
     return true;
 }
@@ -402,9 +776,213 @@ bool ComSocket::SetPort(unsigned int port)
 unsigned int ComSocket::GetPort()
 {
     // Lock for thread safe
-    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    return m_impl->m_port;
+}
+
+bool ComSocket::SetTimestamping(bool rx, bool tx_ack)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+#if defined(__linux__)
+    m_impl->m_rx_timestamps = rx;
+    m_impl->m_tx_timestamps = tx_ack;
+
+    // If the socket is already opened, apply the new configuration.
+    // Else, it will be applied on Open
+    if (m_impl->m_socket.is_open())
+        return apply_timestamping();
+
+    return true;
+#else
+    return !rx && !tx_ack;
+#endif
+}
+
+bool ComSocket::SetNoDelay(bool no_delay)
+{
+    boost::system::error_code ec;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    m_impl->m_no_delay = no_delay;
+
+    // If the socket is already opened, apply the new configuration.
+    // Else, it will be applied on Open
+    if (m_impl->m_socket.is_open())
+        m_impl->m_socket.set_option(boost::asio::ip::tcp::no_delay(no_delay), ec);
+
+    return !ec;
+}
+
+int ComSocket::ReadSomeTimestamped(void *buffer_in, size_t len, ComTimestamps& timestamps)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    timestamps = ComTimestamps();
 
-    return m_port;
+    int ret_code = recv_timestamped(buffer_in, len, timestamps);
+
+    timestamps.returned = boost::chrono::system_clock::now();
+
+    return ret_code;
+}
+
+int ComSocket::ReadTimestamped(void *buffer_in, size_t len, ComTimestamps& timestamps)
+{
+    boost::system::error_code ec;
+    size_t received = 0;
+    int ret_code = 0;
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    timestamps = ComTimestamps();
+
+    // Due to previous cancellation of operations on io_service, it is
+    // necessary to reset it
+    m_impl->m_socket.get_io_service().reset();
+
+    // Set the timeout for the asynchronous operations
+    m_impl->m_timer.ExpiresFromNow(m_impl->m_read_timeout);
+    m_impl->m_timer.AsyncWait(make_alloc_handler(m_impl->m_timer_allocator,
+                                         boost::bind(&ComSocket::timeout_handler, this,
+                                                     boost::asio::placeholders::error)));
+
+    // The data is read with recvmsg to get the control messages with the
+    // timestamps, and the reactor is only used to wait until the socket
+    // is ready to read
+    while (received < len)
+    {
+        ret_code = recv_timestamped(static_cast<char *>(buffer_in) + received,
+                                    len - received, timestamps);
+
+        if (ret_code < 0)
+            break;
+
+        if (ret_code > 0)
+        {
+            received += ret_code;
+            continue;
+        }
+
+        // No data available, wait for it or for the timeout
+        boost::system::error_code wait_error = boost::asio::error::would_block;
+
+        m_impl->m_socket.async_read_some(boost::asio::null_buffers(),
+                                 make_alloc_handler(m_impl->m_read_write_allocator,
+                                                    boost::bind(&ComSocket::wait_handler, this,
+                                                                _1, &wait_error)));
+
+        while (wait_error == boost::asio::error::would_block &&
+               m_impl->m_socket.get_io_service().run_one(ec))
+            ;
+
+        // If the wait has been canceled, the timeout expired and the
+        // bytes received until now are returned
+        if (ec || (wait_error && wait_error != boost::asio::error::operation_aborted))
+            ret_code = -1;
+
+        if (ec || wait_error)
+            break;
+    }
+
+    // Cancel the timeout timer and wait for its handler
+    m_impl->m_timer.Cancel(ec);
+    m_impl->m_socket.get_io_service().run(ec);
+
+    timestamps.returned = boost::chrono::system_clock::now();
+
+    if (ret_code < 0)
+        return -1;
+
+    return received;
+}
+
+bool ComSocket::ReadTxTimestamp(unsigned int& byte_id,
+                                boost::chrono::system_clock::time_point& acked)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+#if defined(__linux__)
+    char control[512];
+    struct msghdr msg;
+    bool has_id = false;
+    bool has_time = false;
+
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    // The timestamps are queued in the error queue of the socket. Due to
+    // SOF_TIMESTAMPING_OPT_TSONLY, the transmitted data is not returned
+    if (::recvmsg(m_impl->m_socket.native_handle(), &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+        return false;
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPING)
+        {
+            struct scm_timestamping ts;
+
+            std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+            acked = to_time_point(ts.ts[0]);
+            has_time = true;
+        }
+        else if ((cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_RECVERR) ||
+                 (cmsg->cmsg_level == IPPROTO_IPV6 && cmsg->cmsg_type == IPV6_RECVERR))
+        {
+            struct sock_extended_err err;
+
+            std::memcpy(&err, CMSG_DATA(cmsg), sizeof(err));
+
+            if (err.ee_origin == SO_EE_ORIGIN_TIMESTAMPING && err.ee_info == SCM_TSTAMP_ACK)
+            {
+                byte_id = err.ee_data;
+                has_id = true;
+            }
+        }
+    }
+
+    return has_id && has_time;
+#else
+    return false;
+#endif
+}
+
+int ComSocket::Post(const ComBuffer& message)
+{
+    if (m_impl->m_post_queue->failed.load(boost::memory_order_acquire))
+        return -1;
+
+    if (message.Size() == 0)
+        return 0;
+
+    PostNode *node = new PostNode();
+
+    node->message = message;
+    m_impl->m_post_queue->bytes.fetch_add(message.Size(), boost::memory_order_relaxed);
+
+    // The message is counted before its push, so only one producer finds
+    // the queue idle and becomes its owner
+    bool owner = m_impl->m_post_queue->count.fetch_add(1, boost::memory_order_acq_rel) == 0;
+
+    m_impl->m_post_queue->push(node);
+
+    if (owner)
+        drain_posted();
+
+    return static_cast<int>(message.Size());
+}
+
+size_t ComSocket::GetPostedBytes()
+{
+    return m_impl->m_post_queue->bytes.load(boost::memory_order_relaxed);
 }
 
 //////////////////////
@@ -423,7 +1001,7 @@ void ComSocket::open_handler(const boost::system::error_code &error, bool *ret_c
         *ret_code = true;
 
     // Cancel the timeout timer
-    m_timer.cancel(ec);
+    m_impl->m_timer.Cancel(ec);
 }
 
 void ComSocket::read_write_handler(const boost::system::error_code &error,
@@ -439,7 +1017,7 @@ void ComSocket::read_write_handler(const boost::system::error_code &error,
         *ret_code = bytes_transferred;
 
     // Cancel the timeout timer
-    m_timer.cancel(ec);
+    m_impl->m_timer.Cancel(ec);
 }
 
 void ComSocket::timeout_handler(const boost::system::error_code &error)
@@ -452,7 +1030,7 @@ void ComSocket::timeout_handler(const boost::system::error_code &error)
         return;
 
     // If the timeout timer expired, cancel the socket operation
-    m_socket.cancel(ec);
+    m_impl->m_socket.cancel(ec);
 }
 
 void ComSocket::timeout_accept_handler(const boost::system::error_code &error)
@@ -465,5 +1043,264 @@ void ComSocket::timeout_accept_handler(const boost::system::error_code &error)
         return;
 
     // If the timeout timer expired, cancel the socket operation
-    m_acceptor.cancel(ec);
+    m_impl->m_acceptor.cancel(ec);
+}
+
+void ComSocket::wait_handler(const boost::system::error_code &error,
+                             boost::system::error_code *ret_error)
+{
+    *ret_error = error;
+}
+
+int ComSocket::wait_readable(const ComClock::time_point& deadline)
+{
+    boost::system::error_code ec;
+    boost::system::error_code wait_error = boost::asio::error::would_block;
+
+    // Set the timeout for the asynchronous operations
+    m_impl->m_timer.ExpiresAt(deadline);
+    m_impl->m_timer.AsyncWait(make_alloc_handler(m_impl->m_timer_allocator,
+                                         boost::bind(&ComSocket::timeout_handler, this,
+                                                     boost::asio::placeholders::error)));
+
+    // Start the asynchronous operation (wait until ready to read)
+    m_impl->m_socket.async_read_some(boost::asio::null_buffers(),
+                             make_alloc_handler(m_impl->m_read_write_allocator,
+                                                boost::bind(&ComSocket::wait_handler, this,
+                                                            _1, &wait_error)));
+
+    while (wait_error == boost::asio::error::would_block &&
+           m_impl->m_socket.get_io_service().run_one(ec))
+        ;
+
+    // Cancel the timeout timer and wait for its handler
+    m_impl->m_timer.Cancel(ec);
+    m_impl->m_socket.get_io_service().run(ec);
+    m_impl->m_socket.get_io_service().reset();
+
+    // If the wait has been canceled, the deadline expired
+    if (!wait_error)
+        return 1;
+    else if (wait_error == boost::asio::error::operation_aborted)
+        return 0;
+    else
+        return -1;
+}
+
+bool ComSocket::set_low_watermark(size_t low_watermark)
+{
+    boost::system::error_code ec;
+
+    if (low_watermark == m_impl->m_low_watermark)
+        return true;
+
+    m_impl->m_socket.set_option(boost::asio::socket_base::receive_low_watermark(
+                            static_cast<int>(low_watermark)), ec);
+
+    if (ec)
+        return false;
+
+    m_impl->m_low_watermark = low_watermark;
+
+    return true;
+}
+
+void ComSocket::drain_posted()
+{
+    std::vector<PostNode *> nodes;
+
+    nodes.reserve(post_batch);
+
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_impl->m_mutex);
+
+    size_t pending = m_impl->m_post_queue->count.load(boost::memory_order_acquire);
+
+    while (true)
+    {
+        size_t len = 0;
+
+        nodes.clear();
+
+        // Gather the counted messages. A message is counted before its
+        // push finishes, so the push is waited for
+        while (nodes.size() < std::min(pending, post_batch))
+        {
+            PostNode *node = m_impl->m_post_queue->pop();
+
+            if (!node)
+            {
+                boost::this_thread::yield();
+                continue;
+            }
+
+            nodes.push_back(node);
+            len += node->message.Size();
+        }
+
+        // After a failure, the messages are discarded until the next Open
+        if (!m_impl->m_post_queue->failed.load(boost::memory_order_acquire) && !write_gather(nodes, len))
+            m_impl->m_post_queue->failed.store(true, boost::memory_order_release);
+
+        for (size_t i = 0; i < nodes.size(); ++i)
+            delete nodes[i];
+
+        m_impl->m_post_queue->bytes.fetch_sub(len, boost::memory_order_relaxed);
+
+        // The ownership is released when all the counted messages are
+        // written. A later Post becomes the new owner
+        pending = m_impl->m_post_queue->count.fetch_sub(nodes.size(), boost::memory_order_acq_rel) -
+                  nodes.size();
+
+        if (pending == 0)
+            break;
+    }
+}
+
+bool ComSocket::write_gather(const std::vector<PostNode *>& nodes, size_t len)
+{
+    std::vector<boost::asio::const_buffer>& buffers = m_impl->m_post_buffers;
+    boost::system::error_code ec;
+    int ret_code;
+
+    buffers.clear();
+
+    for (size_t i = 0; i < nodes.size(); ++i)
+        buffers.push_back(boost::asio::buffer(nodes[i]->message.Data(), nodes[i]->message.Size()));
+
+    // Most times the socket accepts all the data at once, without the
+    // timeout timer and the reactor
+    size_t written = m_impl->m_socket.write_some(buffers, ec);
+
+    if (ec && ec != boost::asio::error::would_block)
+        return false;
+
+    if (written == len)
+        return true;
+
+    // Skip the written bytes
+    std::vector<boost::asio::const_buffer> rest;
+    size_t skip = written;
+
+    for (size_t i = 0; i < buffers.size(); ++i)
+    {
+        size_t size = boost::asio::buffer_size(buffers[i]);
+
+        if (skip >= size)
+        {
+            skip -= size;
+            continue;
+        }
+
+        rest.push_back(buffers[i] + skip);
+        skip = 0;
+    }
+
+    // Due to previous cancellation of operations on io_service, it is
+    // necessary to reset it
+    m_impl->m_socket.get_io_service().reset();
+
+    // Set the timeout for the asynchronous operations
+    m_impl->m_timer.ExpiresFromNow(m_impl->m_write_timeout);
+    m_impl->m_timer.AsyncWait(make_alloc_handler(m_impl->m_timer_allocator,
+                                         boost::bind(&ComSocket::timeout_handler, this,
+                                                     boost::asio::placeholders::error)));
+
+    // Start the asynchronous operation (blocking write of the rest)
+    boost::asio::async_write(m_impl->m_socket, rest,
+                             make_alloc_handler(m_impl->m_read_write_allocator,
+                                                boost::bind(&ComSocket::read_write_handler, this,
+                                                            _1, _2, &ret_code)));
+
+    // Wait until the asynchronous operations are completed
+    m_impl->m_socket.get_io_service().run(ec);
+
+    return !ec && ret_code >= 0 && written + static_cast<size_t>(ret_code) == len;
+}
+
+bool ComSocket::apply_timestamping()
+{
+#if defined(__linux__)
+    int flags = 0;
+
+    if (m_impl->m_rx_timestamps)
+        flags |= SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+
+    // Each acknowledgement timestamp is identified by the index of the
+    // last acknowledged byte, and it doesn't return the transmitted data
+    if (m_impl->m_tx_timestamps)
+        flags |= SOF_TIMESTAMPING_TX_ACK | SOF_TIMESTAMPING_SOFTWARE |
+                 SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+
+    return ::setsockopt(m_impl->m_socket.native_handle(), SOL_SOCKET, SO_TIMESTAMPING,
+                        &flags, sizeof(flags)) == 0;
+#else
+    return !m_impl->m_rx_timestamps && !m_impl->m_tx_timestamps;
+#endif
+}
+
+int ComSocket::recv_timestamped(void *buffer_in, size_t len, ComTimestamps& timestamps)
+{
+#if defined(__linux__)
+    char control[CMSG_SPACE(sizeof(struct scm_timestamping))];
+    struct iovec iov;
+    struct msghdr msg;
+    ssize_t ret;
+
+    iov.iov_base = buffer_in;
+    iov.iov_len = len;
+
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    do
+    {
+        ret = ::recvmsg(m_impl->m_socket.native_handle(), &msg, MSG_DONTWAIT);
+    } while (ret < 0 && errno == EINTR);
+
+    // If there is no data available, return 0. Else, an unexpected
+    // error occurs
+    if (ret < 0)
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+
+    // The connection has been closed by the peer
+    if (ret == 0)
+        return len == 0 ? 0 : -1;
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPING)
+        {
+            struct scm_timestamping ts;
+
+            std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+
+            timestamps.last_rx = to_time_point(ts.ts[0]);
+
+            if (timestamps.first_rx == boost::chrono::system_clock::time_point())
+                timestamps.first_rx = timestamps.last_rx;
+        }
+    }
+
+    return ret;
+#else
+    boost::system::error_code ec;
+    int ret_code;
+
+    // Without kernel timestamps, make a normal non blocking read
+    ret_code = m_impl->m_socket.read_some(boost::asio::buffer(buffer_in, len), ec);
+
+    if (ec)
+    {
+        if (ec == boost::asio::error::would_block)
+            ret_code = 0;
+        else
+            ret_code = -1;
+    }
+
+    return ret_code;
+#endif
 }
@@ -0,0 +1,90 @@
+/**
+ * @file    comtimer.cpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   Timeout timer of the asynchronous operations, driven by a ComClock implementation.
+ */
+
+#include <boost/bind.hpp>
+
+#include "cominterface/comtimer.hpp"
+
+////////////////////
+// Public Methods //
+////////////////////
+
+ComTimer::ComTimer(boost::asio::io_service& io_service) :
+    m_io_service(io_service), m_timer(io_service),
+    m_clock(ComClock::GetSystemClock()), m_waits(0)
+{
+
+}
+
+ComTimer::~ComTimer()
+{
+    boost::system::error_code ec;
+
+    // The clock must not keep waits of a destroyed timer
+    Cancel(ec);
+}
+
+void ComTimer::SetClock(ComClock *clock)
+{
+    m_clock = clock ? clock : ComClock::GetSystemClock();
+}
+
+ComClock *ComTimer::GetClock()
+{
+    return m_clock;
+}
+
+ComClock::time_point ComTimer::Now()
+{
+    return m_clock->Now();
+}
+
+void ComTimer::ExpiresAt(const ComClock::time_point& expiry)
+{
+    m_expiry = expiry;
+
+    // The pending waits are canceled, as with the asio timers
+    if (m_clock != ComClock::GetSystemClock())
+        m_clock->cancel(*this);
+
+    m_timer.expires_at(expiry);
+}
+
+void ComTimer::ExpiresFromNow(const ComClock::duration& time)
+{
+    ExpiresAt(m_clock->Now() + time);
+}
+
+size_t ComTimer::Cancel(boost::system::error_code& ec)
+{
+    size_t count = 0;
+
+    if (m_clock != ComClock::GetSystemClock())
+        count = m_clock->cancel(*this);
+
+    return count + m_timer.cancel(ec);
+}
+
+/////////////////////
+// Private Methods //
+/////////////////////
+
+void ComTimer::hold()
+{
+    if (m_waits++ == 0)
+        m_work.reset(new boost::asio::io_service::work(m_io_service));
+}
+
+void ComTimer::complete(const ComTimerHandler& handler, const boost::system::error_code& error)
+{
+    // The handler is posted before releasing the work, so the service
+    // doesn't stop between them
+    m_io_service.post(boost::bind(handler, error));
+
+    if (--m_waits == 0)
+        m_work.reset();
+}
@@ -0,0 +1,1392 @@
+/**
+ * @file    comzmodem.cpp
+ * @author  Juan Manuel Fernndez Muoz
+ * @date    October, 2026
+ * @brief   ZMODEM file transfer over a communication interface implementation.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <boost/crc.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "cominterface/comzmodem.hpp"
+
+const size_t ComZmodem::max_subpacket;
+
+// Characters of the protocol
+static const unsigned char zpad = '*';
+static const unsigned char zdle = 0x18;
+static const unsigned char zbin = 'A';
+static const unsigned char zhex = 'B';
+static const unsigned char zbin32 = 'C';
+static const unsigned char xon = 0x11;
+static const unsigned char xoff = 0x13;
+
+// Ends of the data subpackets, and escaped rubouts
+static const int zcrce = 'h';       // End of frame, no answer
+static const int zcrcg = 'i';       // The frame continues, no answer
+static const int zcrcq = 'j';       // The frame continues, ZACK expected
+static const int zcrcw = 'k';       // End of frame, ZACK expected
+static const int zrub0 = 'l';
+static const int zrub1 = 'm';
+
+// Types of frame
+static const int zrqinit = 0;
+static const int zrinit = 1;
+static const int zsinit = 2;
+static const int zack = 3;
+static const int zfile = 4;
+static const int zskip = 5;
+static const int znak = 6;
+static const int zfin = 8;
+static const int zrpos = 9;
+static const int zdata = 10;
+static const int zeof = 11;
+static const int zcrc = 13;
+static const int zchallenge = 14;
+static const int zstderr = 19;
+
+// Capabilities of the receiver (ZF0 of ZRINIT)
+static const unsigned char canfdx = 0x01;
+static const unsigned char canovio = 0x02;
+static const unsigned char canfc32 = 0x20;
+
+// Conversion of a file (ZF0 of ZFILE)
+static const unsigned char zcbin = 1;
+static const unsigned char zcresum = 3;
+
+// Errors of the reads
+static const int error_timeout = -1;
+static const int error_link = -2;
+static const int error_data = -3;
+static const int error_cancel = -4;
+
+// Attempts of each message, and of each position of the data
+static const unsigned int max_retries = 10;
+
+// Bytes skipped while looking for a header
+static const size_t max_garbage = 2 * ComZmodem::max_subpacket;
+
+// Bytes of data gathered before writing them to the link
+static const size_t write_size = 16384;
+
+// CRC of the headers and the subpackets without CRC-32
+typedef boost::crc_optimal<16, 0x1021, 0, 0, false, false> crc16_type;
+
+// Check if a byte is a flow control character, that is ignored
+static bool flow_control(int c)
+{
+    return (c & 0x7F) == xon || (c & 0x7F) == xoff;
+}
+
+// Set a position, from ZP0 (least significant byte) to ZP3
+static void set_position(unsigned char *data, size_t position)
+{
+    data[0] = static_cast<unsigned char>(position);
+    data[1] = static_cast<unsigned char>(position >> 8);
+    data[2] = static_cast<unsigned char>(position >> 16);
+    data[3] = static_cast<unsigned char>(position >> 24);
+}
+
+// Get a position, from ZP0 (least significant byte) to ZP3
+static size_t get_position(const unsigned char *data)
+{
+    return static_cast<size_t>(data[0]) | (static_cast<size_t>(data[1]) << 8) |
+           (static_cast<size_t>(data[2]) << 16) | (static_cast<size_t>(data[3]) << 24);
+}
+
+// Get the value of a hexadecimal digit, or -1
+static int hex_value(int c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+
+    return -1;
+}
+
+// Get the name of a path, without its directories
+static std::string base_name(const std::string& path)
+{
+    size_t separator = path.find_last_of("/\\");
+
+    return separator == std::string::npos ? path : path.substr(separator + 1);
+}
+
+////////////////////
+// Public Methods //
+////////////////////
+
+ComZmodem::ComZmodem(ComInterface *link) :
+    m_link(link), m_subpacket(1024), m_window(32768), m_resume(true), m_timeout(10000),
+    m_abort(false), m_in(max_subpacket), m_in_pos(0), m_in_len(0), m_last(0), m_cancels(0)
+{
+    if (!m_link)
+        throw std::invalid_argument("invalid link");
+
+    m_out.reserve(write_size + 2 * max_subpacket);
+}
+
+ComZmodem::~ComZmodem()
+{
+
+}
+
+bool ComZmodem::SendFile(const std::string& path, const std::string& name)
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        m_stats = ComZmodemStats();
+    }
+
+    m_abort = false;
+
+    std::ifstream file(path.c_str(), std::ios::binary | std::ios::ate);
+
+    if (!file)
+        return false;
+
+    std::streamoff size = file.tellg();
+
+    file.close();
+
+    // The positions of the protocol have 32 bits
+    if (size < 0 || size > 0xFFFFFFFFLL)
+        return false;
+
+    boost::interprocess::file_mapping mapping;
+    boost::interprocess::mapped_region region;
+    const unsigned char *data = NULL;
+
+    // An empty file can't be mapped
+    if (size > 0)
+    {
+        try
+        {
+            boost::interprocess::file_mapping(path.c_str(), boost::interprocess::read_only).swap(mapping);
+            boost::interprocess::mapped_region(mapping, boost::interprocess::read_only).swap(region);
+        }
+        catch (boost::interprocess::interprocess_exception&)
+        {
+            return false;
+        }
+
+        region.advise(boost::interprocess::mapped_region::advice_sequential);
+        data = static_cast<const unsigned char *>(region.get_address());
+    }
+
+    unsigned int timeout = m_link->GetReadTimeout();
+
+    m_link->SetReadTimeout(m_timeout);
+    m_in_pos = 0;
+    m_in_len = 0;
+    m_out.clear();
+    m_last = 0;
+    m_cancels = 0;
+
+    bool ret_code = send_session(data, static_cast<size_t>(size), name.empty() ? base_name(path) : name);
+
+    m_link->SetReadTimeout(timeout);
+
+    return ret_code;
+}
+
+bool ComZmodem::ReceiveFiles(const std::string& directory, std::vector<std::string>& files)
+{
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        m_stats = ComZmodemStats();
+    }
+
+    m_abort = false;
+    files.clear();
+
+    unsigned int timeout = m_link->GetReadTimeout();
+
+    m_link->SetReadTimeout(m_timeout);
+    m_in_pos = 0;
+    m_in_len = 0;
+    m_out.clear();
+    m_last = 0;
+    m_cancels = 0;
+
+    bool ret_code = receive_session(directory, files);
+
+    m_link->SetReadTimeout(timeout);
+
+    return ret_code;
+}
+
+bool ComZmodem::SetSubpacketSize(size_t size)
+{
+    if (size < 32 || size > max_subpacket)
+        return false;
+
+    m_subpacket = size;
+
+    return true;
+}
+
+void ComZmodem::SetWindow(size_t window)
+{
+    m_window = window;
+}
+
+void ComZmodem::SetResume(bool resume)
+{
+    m_resume = resume;
+}
+
+bool ComZmodem::SetTimeout(unsigned int timeout)
+{
+    if (timeout == 0)
+        return false;
+
+    m_timeout = timeout;
+
+    return true;
+}
+
+void ComZmodem::Abort()
+{
+    m_abort = true;
+
+    // Interrupt the current read
+    m_link->Abort();
+}
+
+void ComZmodem::GetStats(ComZmodemStats& stats)
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    stats = m_stats;
+}
+
+/////////////////////
+// Private Methods //
+/////////////////////
+
+bool ComZmodem::send_session(const unsigned char *data, size_t size, const std::string& name)
+{
+    Header header;
+    unsigned char zero[4] = {0, 0, 0, 0};
+    unsigned int retries = 0;
+
+    // Request the capabilities of the receiver
+    while (true)
+    {
+        put_hex_header(zrqinit, zero);
+
+        if (!flush())
+            return false;
+
+        int type = read_header(header);
+
+        if (type == zrinit)
+            break;
+
+        if (type == error_link || type == error_cancel || m_abort)
+        {
+            cancel();
+            return false;
+        }
+
+        if (type == zchallenge)
+        {
+            put_hex_header(zack, header.data);
+            continue;
+        }
+
+        if (++retries > max_retries)
+        {
+            cancel();
+            return false;
+        }
+    }
+
+    bool crc32 = (header.data[3] & canfc32) != 0;
+    size_t buffer = static_cast<size_t>(header.data[0]) | (static_cast<size_t>(header.data[1]) << 8);
+    size_t window = m_window;
+
+    // A receiver that can't read while writing the file has a buffer size
+    if (buffer > 0)
+        window = window > 0 ? std::min(window, buffer) : buffer;
+
+    // Name, size, modification time, mode, serial number, files and bytes left
+    std::ostringstream sizes;
+
+    sizes << size << " 0 100644 0 1 " << size;
+
+    std::vector<unsigned char> info(name.begin(), name.end());
+    std::string fields = sizes.str();
+
+    info.push_back(0);
+    info.insert(info.end(), fields.begin(), fields.end());
+    info.push_back(0);
+
+    size_t offset = 0;
+    bool skipped = false;
+
+    retries = 0;
+
+    bool offer = true;
+
+    // Offer the file until the receiver requests a position or skips it
+    while (true)
+    {
+        if (offer)
+        {
+            unsigned char flags[4] = {0, 0, 0, m_resume ? zcresum : zcbin};
+
+            put_binary_header(zfile, flags, crc32);
+            put_subpacket(&info[0], info.size(), zcrcw, crc32);
+        }
+
+        if (!flush())
+            return false;
+
+        int type = read_header(header);
+
+        offer = false;
+
+        if (type == zrpos)
+        {
+            offset = std::min(get_position(header.data), size);
+            break;
+        }
+
+        if (type == zskip)
+        {
+            skipped = true;
+            break;
+        }
+
+        if (type == error_link || type == error_cancel || m_abort)
+        {
+            cancel();
+            return false;
+        }
+
+        // The receiver checks its partial file with the CRC of the start of ours
+        if (type == zcrc)
+        {
+            size_t len = get_position(header.data);
+            boost::crc_32_type crc;
+            unsigned char checksum[4];
+
+            crc.process_bytes(data, len == 0 || len > size ? size : len);
+            set_position(checksum, crc.checksum());
+            put_hex_header(zcrc, checksum);
+            continue;
+        }
+
+        if (++retries > max_retries)
+        {
+            cancel();
+            return false;
+        }
+
+        // A repeated ZRINIT answers a previous ZRQINIT, the offer is on its way
+        offer = type != zrinit;
+    }
+
+    if (!skipped)
+    {
+        {
+            // Lock for thread safe
+            boost::lock_guard<boost::mutex> lock(m_mutex);
+
+            m_stats.resumed = offset;
+        }
+
+        if (!send_data(data, size, crc32, window, offset))
+            return false;
+
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        m_stats.files = 1;
+        m_stats.bytes = size - offset;
+    }
+
+    // End the session. The file is already received, so the errors are ignored
+    for (retries = 0; retries < max_retries; ++retries)
+    {
+        put_hex_header(zfin, zero);
+
+        if (!flush())
+            break;
+
+        int type = read_header(header);
+
+        if (type == zfin || type == error_link || type == error_cancel)
+            break;
+    }
+
+    m_out.push_back('O');
+    m_out.push_back('O');
+    flush();
+
+    return !skipped;
+}
+
+bool ComZmodem::send_data(const unsigned char *data, size_t size, bool crc32,
+                          size_t window, size_t offset)
+{
+    Header header;
+    unsigned int retries = 0;
+    size_t acked = offset;          // Position acknowledged by the receiver
+    size_t query = offset;          // Position of the last acknowledgement request
+    bool frame = false;             // A data frame is open
+    bool eof = false;               // The end of the file has been sent
+    size_t failed = offset;         // Position of the last error
+
+    while (true)
+    {
+        if (m_abort)
+        {
+            cancel();
+            return false;
+        }
+
+        int end = zcrcg;
+
+        if (offset < size)
+        {
+            if (!frame)
+            {
+                unsigned char position[4];
+
+                set_position(position, offset);
+                put_binary_header(zdata, position, crc32);
+
+                frame = true;
+                query = offset;
+            }
+
+            size_t len = std::min(m_subpacket, size - offset);
+
+            // The acknowledgements are requested at half window, so the
+            // sender only stops if they are late
+            if (offset + len == size)
+                end = zcrce;
+            else if (window > 0 && offset + len - acked >= window)
+                end = zcrcw;
+            else if (window > 0 && offset + len - query >= window / 2)
+                end = zcrcq;
+
+            put_subpacket(data + offset, len, end, crc32);
+            offset += len;
+
+            if (end == zcrcq)
+                query = offset;
+
+            if (end == zcrce || end == zcrcw)
+                frame = false;
+
+            if ((end != zcrcg || m_out.size() >= write_size) && !flush())
+                return false;
+
+            // Keep streaming while the receiver doesn't answer
+            if (end != zcrcw && !pending())
+                continue;
+        }
+        else if (!eof)
+        {
+            unsigned char position[4];
+
+            set_position(position, size);
+            put_binary_header(zeof, position, crc32);
+
+            if (!flush())
+                return false;
+
+            eof = true;
+        }
+
+        int type = read_header(header);
+        size_t position = get_position(header.data);
+
+        if (type == zack)
+        {
+            if (position > acked && position <= offset)
+                acked = position;
+
+            retries = 0;
+        }
+        else if (type == zrpos && position <= size)
+        {
+            // The receiver lost data, send it again from its position. The
+            // attempts are counted while the errors don't progress
+            if (position > failed)
+                retries = 0;
+
+            failed = position;
+
+            if (++retries > max_retries)
+            {
+                cancel();
+                return false;
+            }
+
+            {
+                // Lock for thread safe
+                boost::lock_guard<boost::mutex> lock(m_mutex);
+
+                m_stats.retransmitted += offset > position ? offset - position : 0;
+                ++m_stats.errors;
+            }
+
+            offset = position;
+            acked = position;
+            frame = false;
+            eof = false;
+        }
+        else if (type == zrinit && eof)
+        {
+            // The receiver has the whole file
+            return true;
+        }
+        else if (type == zskip)
+        {
+            return false;
+        }
+        else if (type == error_link || type == error_cancel)
+        {
+            cancel();
+            return false;
+        }
+        else if (type == error_timeout)
+        {
+            count_error();
+
+            if (++retries > max_retries)
+            {
+                cancel();
+                return false;
+            }
+
+            // Send the end of the file or the unacknowledged data again
+            if (eof)
+            {
+                eof = false;
+            }
+            else if (end == zcrcw)
+            {
+                offset = acked;
+                frame = false;
+            }
+        }
+        else if (type == error_data)
+        {
+            count_error();
+        }
+    }
+}
+
+bool ComZmodem::receive_session(const std::string& directory, std::vector<std::string>& files)
+{
+    Header header;
+    unsigned char capabilities[4] = {0, 0, 0, canfdx | canovio | canfc32};
+    unsigned char zero[4] = {0, 0, 0, 0};
+    std::vector<unsigned char> info;
+    unsigned int retries = 0;
+
+    put_hex_header(zrinit, capabilities);
+
+    if (!flush())
+        return false;
+
+    while (true)
+    {
+        if (m_abort)
+        {
+            cancel();
+            return false;
+        }
+
+        int type = read_header(header);
+
+        if (type == zfile)
+        {
+            int end = read_subpacket(info, header.crc32);
+
+            if (end < 0)
+            {
+                count_error();
+                put_hex_header(znak, zero);
+                flush();
+                continue;
+            }
+
+            retries = 0;
+
+            // The name ends with a NUL, that a corrupted offer may lack, and the size follows it
+            info.push_back(0);
+            info.push_back(0);
+
+            // The paths of the sender are not trusted
+            std::string name = base_name(reinterpret_cast<const char *>(&info[0]));
+            size_t length = std::strlen(reinterpret_cast<const char *>(&info[0]));
+            size_t size = std::strtoul(reinterpret_cast<const char *>(&info[0]) + length + 1, NULL, 10);
+
+            if (name.empty() || name == "." || name == "..")
+            {
+                put_hex_header(zskip, zero);
+                flush();
+                continue;
+            }
+
+            std::string path = directory.empty() ? name : directory + "/" + name;
+            size_t offset = 0;
+
+            // A partial file is resumed from its end, if it is the start of the offered one
+            if (m_resume || header.data[3] == zcresum)
+            {
+                std::ifstream partial(path.c_str(), std::ios::binary | std::ios::ate);
+
+                if (partial && partial.tellg() > 0 && static_cast<size_t>(partial.tellg()) <= size)
+                    offset = static_cast<size_t>(partial.tellg());
+
+                if (offset > 0)
+                {
+                    int ret_code = check_partial(partial, offset);
+
+                    if (ret_code < 0)
+                        return false;
+
+                    if (ret_code == 0)
+                        offset = 0;
+                }
+            }
+
+            if (!receive_data(path, offset))
+                return false;
+
+            files.push_back(path);
+
+            {
+                // Lock for thread safe
+                boost::lock_guard<boost::mutex> lock(m_mutex);
+
+                ++m_stats.files;
+            }
+
+            put_hex_header(zrinit, capabilities);
+
+            if (!flush())
+                return false;
+        }
+        else if (type == zfin)
+        {
+            put_hex_header(zfin, zero);
+            flush();
+
+            // The sender ends with "OO", that is not waited for long
+            m_link->SetReadTimeout(std::min(m_timeout, 1000U));
+            read_byte();
+            read_byte();
+
+            return true;
+        }
+        else if (type == zsinit)
+        {
+            if (read_subpacket(info, header.crc32) >= 0)
+            {
+                unsigned char one[4] = {1, 0, 0, 0};
+
+                put_hex_header(zack, one);
+            }
+            else
+            {
+                put_hex_header(znak, zero);
+            }
+
+            flush();
+        }
+        else if (type == error_link || type == error_cancel)
+        {
+            cancel();
+            return false;
+        }
+        else if (type == error_data)
+        {
+            count_error();
+        }
+        else if (type == error_timeout || type == zrqinit || type == zeof || type == zdata)
+        {
+            // The sender has not received the capabilities, or the end of the last file
+            if (type == error_timeout)
+            {
+                count_error();
+
+                if (++retries > max_retries)
+                {
+                    cancel();
+                    return false;
+                }
+            }
+
+            put_hex_header(zrinit, capabilities);
+
+            if (!flush())
+                return false;
+        }
+    }
+}
+
+int ComZmodem::check_partial(std::ifstream& partial, size_t len)
+{
+    Header header;
+    std::vector<unsigned char> buffer(65536);
+    boost::crc_32_type crc;
+    unsigned char position[4];
+
+    // CRC-32 of the partial file
+    partial.seekg(0);
+
+    for (size_t done = 0; done < len; )
+    {
+        size_t chunk = std::min(buffer.size(), len - done);
+
+        if (!partial.read(reinterpret_cast<char *>(&buffer[0]), chunk))
+            return 0;
+
+        crc.process_bytes(&buffer[0], chunk);
+        done += chunk;
+    }
+
+    set_position(position, len);
+
+    for (unsigned int retries = 0; retries <= max_retries; ++retries)
+    {
+        put_hex_header(zcrc, position);
+
+        if (!flush())
+            return -1;
+
+        int type = read_header(header);
+
+        if (type == zcrc)
+            return get_position(header.data) == crc.checksum() ? 1 : 0;
+
+        if (type == error_link || type == error_cancel || m_abort)
+        {
+            cancel();
+            return -1;
+        }
+
+        // The sender repeats the offer while it waits for the answer
+        if (type == zfile)
+            read_subpacket(buffer, header.crc32);
+        else
+            count_error();
+    }
+
+    // The partial file can't be checked, so it is received again
+    return 0;
+}
+
+bool ComZmodem::receive_data(const std::string& path, size_t offset)
+{
+    std::ofstream file(path.c_str(), std::ios::binary |
+                       (offset > 0 ? std::ios::app : std::ios::trunc) | std::ios::out);
+
+    if (!file)
+    {
+        cancel();
+        return false;
+    }
+
+    {
+        // Lock for thread safe
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+
+        m_stats.resumed += offset;
+    }
+
+    Header header;
+    std::vector<unsigned char> data;
+    unsigned int retries = 0;
+
+    data.reserve(max_subpacket);
+
+    if (!send_position(zrpos, offset))
+        return false;
+
+    while (true)
+    {
+        if (m_abort)
+        {
+            cancel();
+            return false;
+        }
+
+        int type = read_header(header);
+
+        if (type == zdata)
+        {
+            // The data after an error is discarded until it is sent again
+            if (get_position(header.data) != offset)
+            {
+                if (!send_position(zrpos, offset))
+                    return false;
+
+                continue;
+            }
+
+            while (true)
+            {
+                int end = read_subpacket(data, header.crc32);
+
+                if (end == error_link || end == error_cancel)
+                {
+                    cancel();
+                    return false;
+                }
+
+                if (end < 0)
+                {
+                    count_error();
+
+                    if (++retries > max_retries)
+                    {
+                        cancel();
+                        return false;
+                    }
+
+                    if (!send_position(zrpos, offset))
+                        return false;
+
+                    break;
+                }
+
+                if (!data.empty() && !file.write(reinterpret_cast<const char *>(&data[0]), data.size()))
+                {
+                    cancel();
+                    return false;
+                }
+
+                offset += data.size();
+                retries = 0;
+
+                {
+                    // Lock for thread safe
+                    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+                    m_stats.bytes += data.size();
+                }
+
+                if ((end == zcrcq || end == zcrcw) && !send_position(zack, offset))
+                    return false;
+
+                if (end == zcrce || end == zcrcw)
+                    break;
+            }
+        }
+        else if (type == zeof)
+        {
+            // An end of file at another position is from a previous attempt
+            if (get_position(header.data) != offset)
+                continue;
+
+            file.close();
+
+            return !file.fail();
+        }
+        else if (type == zfile)
+        {
+            // The sender has not received the position
+            read_subpacket(data, header.crc32);
+
+            if (!send_position(zrpos, offset))
+                return false;
+        }
+        else if (type == error_timeout)
+        {
+            count_error();
+
+            if (++retries > max_retries)
+            {
+                cancel();
+                return false;
+            }
+
+            if (!send_position(zrpos, offset))
+                return false;
+        }
+        else if (type == error_data)
+        {
+            count_error();
+        }
+        else if (type < 0 || type == zfin)
+        {
+            cancel();
+            return false;
+        }
+    }
+}
+
+int ComZmodem::read_byte()
+{
+    if (m_in_pos == m_in_len)
+    {
+        if (m_abort)
+            return error_cancel;
+
+        int ret_code = m_link->ReadBatch(&m_in[0], m_in.size());
+
+        if (ret_code < 0)
+            return m_abort ? error_cancel : error_link;
+
+        if (ret_code == 0)
+            return m_abort ? error_cancel : error_timeout;
+
+        m_in_pos = 0;
+        m_in_len = ret_code;
+    }
+
+    unsigned char c = m_in[m_in_pos++];
+
+    // Five cancel characters in a row cancel the transfer
+    m_cancels = c == zdle ? m_cancels + 1 : 0;
+
+    if (m_cancels >= 5)
+        return error_cancel;
+
+    return c;
+}
+
+int ComZmodem::read_escaped()
+{
+    int c;
+
+    do
+    {
+        c = read_byte();
+    }
+    while (c >= 0 && flow_control(c));
+
+    if (c != zdle)
+        return c;
+
+    do
+    {
+        c = read_byte();
+    }
+    while (c >= 0 && flow_control(c));
+
+    if (c < 0)
+        return c;
+
+    switch (c)
+    {
+    case zcrce:
+    case zcrcg:
+    case zcrcq:
+    case zcrcw:
+        return 0x100 | c;
+
+    case zrub0:
+        return 0x7F;
+
+    case zrub1:
+        return 0xFF;
+
+    default:
+        if ((c & 0x60) == 0x40)
+            return c ^ 0x40;
+
+        return error_data;
+    }
+}
+
+int ComZmodem::read_header(Header& header)
+{
+    size_t garbage = 0;
+
+    while (true)
+    {
+        int c = read_byte();
+
+        if (c < 0)
+            return c;
+
+        if ((c & 0x7F) != zpad)
+        {
+            if (++garbage > max_garbage)
+                return error_data;
+
+            continue;
+        }
+
+        // One or two pads before the header
+        do
+        {
+            c = read_byte();
+        }
+        while (c >= 0 && (c & 0x7F) == zpad);
+
+        if (c < 0)
+            return c;
+
+        if (c != zdle)
+            continue;
+
+        int format = read_byte();
+        unsigned char bytes[9];
+        size_t count = format == zbin32 ? 9 : 7;
+
+        if (format < 0)
+            return format;
+
+        if (format == zhex)
+        {
+            for (size_t i = 0; i < 7; ++i)
+            {
+                int high = read_byte();
+                int low = read_byte();
+
+                if (high < 0 || low < 0)
+                    return high < 0 ? high : low;
+
+                if (hex_value(high) < 0 || hex_value(low) < 0)
+                    return error_data;
+
+                bytes[i] = static_cast<unsigned char>((hex_value(high) << 4) | hex_value(low));
+            }
+
+            // The line ends with CR and LF
+            if ((read_byte() & 0x7F) == '\r')
+                read_byte();
+        }
+        else if (format == zbin || format == zbin32)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                int value = read_escaped();
+
+                if (value < 0)
+                    return value;
+
+                if (value > 0xFF)
+                    return error_data;
+
+                bytes[i] = static_cast<unsigned char>(value);
+            }
+        }
+        else
+        {
+            continue;
+        }
+
+        if (format == zbin32)
+        {
+            boost::crc_32_type crc;
+
+            crc.process_bytes(bytes, 5);
+
+            if (crc.checksum() != get_position(bytes + 5))
+                return error_data;
+        }
+        else
+        {
+            crc16_type crc;
+
+            crc.process_bytes(bytes, 5);
+
+            if (crc.checksum() != ((bytes[5] << 8) | bytes[6]))
+                return error_data;
+        }
+
+        if (bytes[0] > zstderr)
+            return error_data;
+
+        header.type = bytes[0];
+        std::copy(bytes + 1, bytes + 5, header.data);
+        header.crc32 = format == zbin32;
+
+        return header.type;
+    }
+}
+
+int ComZmodem::read_subpacket(std::vector<unsigned char>& data, bool crc32)
+{
+    data.clear();
+
+    while (true)
+    {
+        int c = read_escaped();
+
+        if (c < 0)
+            return c;
+
+        if (c <= 0xFF)
+        {
+            if (data.size() == max_subpacket)
+                return error_data;
+
+            data.push_back(static_cast<unsigned char>(c));
+            continue;
+        }
+
+        unsigned char end = static_cast<unsigned char>(c);
+        unsigned char checksum[4];
+
+        for (size_t i = 0; i < (crc32 ? 4U : 2U); ++i)
+        {
+            int value = read_escaped();
+
+            if (value < 0)
+                return value;
+
+            if (value > 0xFF)
+                return error_data;
+
+            checksum[i] = static_cast<unsigned char>(value);
+        }
+
+        // The CRC includes the end of the subpacket
+        if (crc32)
+        {
+            boost::crc_32_type crc;
+
+            crc.process_bytes(data.empty() ? NULL : &data[0], data.size());
+            crc.process_byte(end);
+
+            return crc.checksum() == get_position(checksum) ? end : error_data;
+        }
+
+        crc16_type crc;
+
+        crc.process_bytes(data.empty() ? NULL : &data[0], data.size());
+        crc.process_byte(end);
+
+        return crc.checksum() == ((checksum[0] << 8) | checksum[1]) ? end : error_data;
+    }
+}
+
+bool ComZmodem::pending()
+{
+    while (true)
+    {
+        if (m_in_pos == m_in_len)
+        {
+            int ret_code = m_link->ReadSome(&m_in[0], m_in.size());
+
+            if (ret_code <= 0)
+                return false;
+
+            m_in_pos = 0;
+            m_in_len = ret_code;
+        }
+
+        if ((m_in[m_in_pos] & 0x7F) == zpad)
+            return true;
+
+        // The cancel sequence is detected when it is read
+        if (read_byte() == error_cancel)
+        {
+            m_abort = true;
+            return false;
+        }
+    }
+}
+
+void ComZmodem::put_escaped(unsigned char byte)
+{
+    bool escape;
+
+    switch (byte)
+    {
+    case zdle:
+    case 0x10:
+    case 0x90:
+    case xon:
+    case xon | 0x80:
+    case xoff:
+    case xoff | 0x80:
+        escape = true;
+        break;
+
+    // Telnet interprets "@" followed by CR
+    case '\r':
+    case '\r' | 0x80:
+        escape = (m_last & 0x7F) == '@';
+        break;
+
+    default:
+        escape = false;
+        break;
+    }
+
+    if (escape)
+    {
+        m_out.push_back(zdle);
+        byte ^= 0x40;
+    }
+
+    m_out.push_back(byte);
+    m_last = byte;
+}
+
+void ComZmodem::put_hex_header(int type, const unsigned char *data)
+{
+    static const char digits[] = "0123456789abcdef";
+    unsigned char bytes[7];
+    crc16_type crc;
+
+    bytes[0] = static_cast<unsigned char>(type);
+    std::copy(data, data + 4, bytes + 1);
+
+    crc.process_bytes(bytes, 5);
+    bytes[5] = static_cast<unsigned char>(crc.checksum() >> 8);
+    bytes[6] = static_cast<unsigned char>(crc.checksum());
+
+    m_out.push_back(zpad);
+    m_out.push_back(zpad);
+    m_out.push_back(zdle);
+    m_out.push_back(zhex);
+
+    for (size_t i = 0; i < 7; ++i)
+    {
+        m_out.push_back(digits[bytes[i] >> 4]);
+        m_out.push_back(digits[bytes[i] & 0x0F]);
+    }
+
+    m_out.push_back('\r');
+    m_out.push_back('\n' | 0x80);
+    m_last = '\n' | 0x80;
+
+    // The receiver could have been stopped by a spurious XOFF
+    if (type != zack && type != zfin)
+    {
+        m_out.push_back(xon);
+        m_last = xon;
+    }
+}
+
+void ComZmodem::put_binary_header(int type, const unsigned char *data, bool crc32)
+{
+    unsigned char bytes[5];
+
+    bytes[0] = static_cast<unsigned char>(type);
+    std::copy(data, data + 4, bytes + 1);
+
+    m_out.push_back(zpad);
+    m_out.push_back(zdle);
+    m_out.push_back(crc32 ? zbin32 : zbin);
+
+    for (size_t i = 0; i < 5; ++i)
+        put_escaped(bytes[i]);
+
+    if (crc32)
+    {
+        boost::crc_32_type crc;
+        unsigned char checksum[4];
+
+        crc.process_bytes(bytes, 5);
+        set_position(checksum, crc.checksum());
+
+        for (size_t i = 0; i < 4; ++i)
+            put_escaped(checksum[i]);
+    }
+    else
+    {
+        crc16_type crc;
+
+        crc.process_bytes(bytes, 5);
+        put_escaped(static_cast<unsigned char>(crc.checksum() >> 8));
+        put_escaped(static_cast<unsigned char>(crc.checksum()));
+    }
+}
+
+void ComZmodem::put_subpacket(const unsigned char *data, size_t len, int end, bool crc32)
+{
+    for (size_t i = 0; i < len; ++i)
+        put_escaped(data[i]);
+
+    m_out.push_back(zdle);
+    m_out.push_back(static_cast<unsigned char>(end));
+    m_last = static_cast<unsigned char>(end);
+
+    if (crc32)
+    {
+        boost::crc_32_type crc;
+        unsigned char checksum[4];
+
+        crc.process_bytes(data, len);
+        crc.process_byte(static_cast<unsigned char>(end));
+        set_position(checksum, crc.checksum());
+
+        for (size_t i = 0; i < 4; ++i)
+            put_escaped(checksum[i]);
+    }
+    else
+    {
+        crc16_type crc;
+
+        crc.process_bytes(data, len);
+        crc.process_byte(static_cast<unsigned char>(end));
+        put_escaped(static_cast<unsigned char>(crc.checksum() >> 8));
+        put_escaped(static_cast<unsigned char>(crc.checksum()));
+    }
+}
+
+bool ComZmodem::flush()
+{
+    if (m_out.empty())
+        return true;
+
+    int ret_code = m_link->Write(&m_out[0], m_out.size());
+    bool written = ret_code == static_cast<int>(m_out.size());
+
+    m_out.clear();
+
+    return written;
+}
+
+bool ComZmodem::send_position(int type, size_t position)
+{
+    unsigned char data[4];
+
+    set_position(data, position);
+    put_hex_header(type, data);
+
+    return flush();
+}
+
+void ComZmodem::cancel()
+{
+    m_out.clear();
+
+    // Cancel characters followed by backspaces to erase them from a terminal
+    m_out.insert(m_out.end(), 8, zdle);
+    m_out.insert(m_out.end(), 8, '\b');
+
+    flush();
+}
+
+void ComZmodem::count_error()
+{
+    // Lock for thread safe
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+
+    ++m_stats.errors;
+}